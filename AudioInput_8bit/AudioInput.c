@@ -100,6 +100,16 @@ uint32_t audio_sampling_frequency;
 int16_t channel_volume[MAX_AUDIO_CHANNELS];
 /** current selector unit values */
 uint8_t selector_unit[NUM_ALTERNATE_SETTINGS];
+/** Data stage buffer for the class request being handled. Control transfers
+ * complete asynchronously (see Endpoint_Control_Task()), so this has to
+ * outlive the request handler. */
+static union {
+	uint8_t selector;
+	int16_t volume;
+	uint8_t freq_byte[3];
+} control_data;
+/** The selector unit or microphone that a pending "set" request applies to */
+static uint8_t control_target;
 
 
 // forward declarations
@@ -115,6 +125,9 @@ static inline uint8_t ConvertVolumeToByte(int16_t volume);
 void ProcessSelectorRequest(uint8_t bRequest, uint8_t bmRequestType, uint8_t entityId);
 void ProcessVolumeRequest(uint8_t bRequest, uint8_t bmRequestType, uint8_t entityId, uint8_t channelNumber);
 void ProcessSamplingFrequencyRequest(uint8_t bRequest, uint8_t bmRequestType);
+void SelectorReceived(const uint8_t ErrorCode);
+void VolumeReceived(const uint8_t ErrorCode);
+void SamplingFrequencyReceived(const uint8_t ErrorCode);
 static inline void SendNAK(void);
 static inline void ShowVal(uint16_t val);
 
@@ -181,12 +194,19 @@ int main(void)
 			uint8_t PrevEndpoint = Endpoint_GetCurrentEndpoint();
 	
 			Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+
+			// send or receive the next packet of any class request data
+			Endpoint_Control_Task();
 	
 			if (Endpoint_IsSetupReceived())
 				USB_Device_ProcessControlPacket();
 	
 			Endpoint_SelectEndpoint(PrevEndpoint);
 		}
+		else if (Endpoint_Control_IsBusy()) {
+			// complete any class request data transfer cut off by a disconnect
+			Endpoint_Control_Task();
+		}
 	}
 
 	return 0;
@@ -318,8 +338,6 @@ EVENT_HANDLER(USB_UnhandledControlPacket)
 void ProcessSelectorRequest(uint8_t bRequest, uint8_t bmRequestType,
 		uint8_t entityId)
 {
-	uint8_t value;
-	
 	uint8_t selector_index = entityId == SELECTOR_UNIT_ID1 ? 0
 			: entityId == SELECTOR_UNIT_ID2 ? 1
 			: entityId == SELECTOR_UNIT_ID4 ? 2
@@ -329,16 +347,16 @@ void ProcessSelectorRequest(uint8_t bRequest, uint8_t bmRequestType,
 	if (bmRequestType & AUDIO_REQ_TYPE_GET_MASK) {
 		switch (bRequest) {
 			case AUDIO_REQ_GET_Cur:
-				value = selector_unit[selector_index] + 1;
+				control_data.selector = selector_unit[selector_index] + 1;
 				break;
 			case AUDIO_REQ_GET_Min:
-				value = 1;
+				control_data.selector = 1;
 				break;
 			case AUDIO_REQ_GET_Max:
-				value = num_selections[selector_index];
+				control_data.selector = num_selections[selector_index];
 				break;
 			case AUDIO_REQ_GET_Res:
-				value = 1;
+				control_data.selector = 1;
 				break;
 			default:
 				// FIXME send NAK?
@@ -346,21 +364,16 @@ void ProcessSelectorRequest(uint8_t bRequest, uint8_t bmRequestType,
 				return;
 		}
 		Endpoint_ClearSetupReceived();
-		// FIXME check this is correct order to send the three bytes
-		Endpoint_Write_Control_Stream(&value, 1);
-		Endpoint_ClearSetupOUT();
+		Endpoint_Write_Control_Async(&control_data.selector, 1, ENDPOINT_MEMSPACE_RAM, NULL);
 		return;
 	}
 	else {
 		if (bRequest == AUDIO_REQ_SET_Cur) {
-			/* A request for the current setting of a particular channel's input gain. */
+			/* A request to change a selector unit's setting, which is stored by
+			 * SelectorReceived() once the data stage completes. */
+			control_target = selector_index;
 			Endpoint_ClearSetupReceived();
-			Endpoint_Read_Control_Stream(&value, 1);
-			Endpoint_ClearSetupIN();
-
-			// store the new value (HACK check that we need to subtract 1)
-			selector_unit[selector_index] = value - 1;
-			
+			Endpoint_Read_Control_Async(&control_data.selector, 1, SelectorReceived);
 			return;
 		}
 	}
@@ -370,11 +383,20 @@ void ProcessSelectorRequest(uint8_t bRequest, uint8_t bmRequestType,
 }
 
 
+void SelectorReceived(const uint8_t ErrorCode)
+{
+	if (ErrorCode != ENDPOINT_RWCSTREAM_ERROR_NoError)
+		return;
+
+	// store the new value (HACK check that we need to subtract 1)
+	selector_unit[control_target] = control_data.selector - 1;
+}
+
+
 void ProcessVolumeRequest(uint8_t bRequest, uint8_t bmRequestType,
 		uint8_t entityId, uint8_t channelNumber)
 {
 	uint8_t buf;
-	int16_t value;
 
 	// FIXME add master control: if channelNumber == 0xFF, then get all gain control settings.
 	
@@ -412,16 +434,16 @@ void ProcessVolumeRequest(uint8_t bRequest, uint8_t bmRequestType,
 					buf = 0x1f;
 				}
 				channel_volume[microphone_index] = ConvertByteToVolume(buf);
-				value = channel_volume[microphone_index];
+				control_data.volume = channel_volume[microphone_index];
 				break;
 			case AUDIO_REQ_GET_Min:
-				value = ConvertByteToVolume(PREAMP_MINIMUM_SETPOINT);
+				control_data.volume = ConvertByteToVolume(PREAMP_MINIMUM_SETPOINT);
 				break;
 			case AUDIO_REQ_GET_Max:
-				value = ConvertByteToVolume(PREAMP_MAXIMUM_SETPOINT);
+				control_data.volume = ConvertByteToVolume(PREAMP_MAXIMUM_SETPOINT);
 				break;
 			case AUDIO_REQ_GET_Res:
-				value = 1;
+				control_data.volume = 1;
 				break;
 			default:
 				// FIXME send NAK?
@@ -429,22 +451,17 @@ void ProcessVolumeRequest(uint8_t bRequest, uint8_t bmRequestType,
 				return;
 		}
 		Endpoint_ClearSetupReceived();
-		Endpoint_Write_Control_Stream(&value, sizeof(value));
-		Endpoint_ClearSetupOUT();
+		Endpoint_Write_Control_Async(&control_data.volume, sizeof(control_data.volume),
+				ENDPOINT_MEMSPACE_RAM, NULL);
 	}
 	else {
 		if (bRequest == AUDIO_REQ_SET_Cur) {
-			/* A request to set a particular channel's input gain. */
+			/* A request to set a particular channel's input gain, which is
+			 * applied by VolumeReceived() once the data stage completes. */
+			control_target = microphone_index;
 			Endpoint_ClearSetupReceived();
-			Endpoint_Read_Control_Stream(&value, sizeof(value));
-			Endpoint_ClearSetupIN();
-
-			// cache the value
-			channel_volume[microphone_index] = value;
-			// convert to a digital pot value
-			uint8_t pot_value = ConvertVolumeToByte(value);
-			// set the pot
-			PreAmps_set(microphone_index, pot_value);
+			Endpoint_Read_Control_Async(&control_data.volume, sizeof(control_data.volume),
+					VolumeReceived);
 			return;
 		}
 		else {
@@ -455,10 +472,23 @@ void ProcessVolumeRequest(uint8_t bRequest, uint8_t bmRequestType,
 }
 
 
+void VolumeReceived(const uint8_t ErrorCode)
+{
+	if (ErrorCode != ENDPOINT_RWCSTREAM_ERROR_NoError)
+		return;
+
+	// cache the value
+	channel_volume[control_target] = control_data.volume;
+	// convert to a digital pot value
+	uint8_t pot_value = ConvertVolumeToByte(control_data.volume);
+	// set the pot
+	PreAmps_set(control_target, pot_value);
+}
+
+
 void ProcessSamplingFrequencyRequest(uint8_t bRequest, uint8_t bmRequestType)
 {
-	uint8_t freq_byte[3];
-	uint32_t sampling_frequency;
+	uint8_t *freq_byte = control_data.freq_byte;
 	
 	// find out if its a "get" or a "set" request
 	if (bmRequestType & AUDIO_REQ_TYPE_GET_MASK) {
@@ -490,29 +520,15 @@ void ProcessSamplingFrequencyRequest(uint8_t bRequest, uint8_t bmRequestType)
 		}
 		Endpoint_ClearSetupReceived();
 		// FIXME check this is correct order to send the three bytes
-		Endpoint_Write_Control_Stream(freq_byte, 3);
-		Endpoint_ClearSetupOUT();
+		Endpoint_Write_Control_Async(freq_byte, 3, ENDPOINT_MEMSPACE_RAM, NULL);
 		return;
 	}
 	else {
 		if (bRequest == AUDIO_REQ_SET_Cur) {
-			/* A request to set the sampling frequency */
+			/* A request to set the sampling frequency, which is applied by
+			 * SamplingFrequencyReceived() once the data stage completes. */
 			Endpoint_ClearSetupReceived();
-			Endpoint_Read_Control_Stream(freq_byte, 3);
-			Endpoint_ClearSetupIN();
-
-			// update the sampling frequency
-			sampling_frequency = ((uint32_t)(freq_byte[2]) << 16)
-					| ((uint32_t)(freq_byte[1]) << 8)
-					| ((uint32_t)(freq_byte[0]));
-			
-			// limit the frequency to our bounds
-			if (sampling_frequency < LOWEST_AUDIO_SAMPLE_FREQUENCY)
-				sampling_frequency = LOWEST_AUDIO_SAMPLE_FREQUENCY;
-			else if (sampling_frequency > HIGHEST_AUDIO_SAMPLE_FREQUENCY)
-				sampling_frequency = HIGHEST_AUDIO_SAMPLE_FREQUENCY;
-			
-			ConfigureSamplingTimer(sampling_frequency);
+			Endpoint_Read_Control_Async(freq_byte, 3, SamplingFrequencyReceived);
 			return;
 		}
 	}
@@ -522,6 +538,29 @@ void ProcessSamplingFrequencyRequest(uint8_t bRequest, uint8_t bmRequestType)
 }
 
 
+void SamplingFrequencyReceived(const uint8_t ErrorCode)
+{
+	uint8_t *freq_byte = control_data.freq_byte;
+	uint32_t sampling_frequency;
+
+	if (ErrorCode != ENDPOINT_RWCSTREAM_ERROR_NoError)
+		return;
+
+	// update the sampling frequency
+	sampling_frequency = ((uint32_t)(freq_byte[2]) << 16)
+			| ((uint32_t)(freq_byte[1]) << 8)
+			| ((uint32_t)(freq_byte[0]));
+	
+	// limit the frequency to our bounds
+	if (sampling_frequency < LOWEST_AUDIO_SAMPLE_FREQUENCY)
+		sampling_frequency = LOWEST_AUDIO_SAMPLE_FREQUENCY;
+	else if (sampling_frequency > HIGHEST_AUDIO_SAMPLE_FREQUENCY)
+		sampling_frequency = HIGHEST_AUDIO_SAMPLE_FREQUENCY;
+	
+	ConfigureSamplingTimer(sampling_frequency);
+}
+
+
 /** Determine the microphone ADC index (starting at 0) of the specified 
  * channel (starting at 1) in the current configuration */
 uint8_t GetMicrophoneIndex(uint8_t channel, uint8_t alternateSetting)
@@ -117,7 +117,8 @@ int32_t Audio_Device_ReadSample24(USB_ClassInfo_Audio_Device_t* const AudioInter
 {
 	int32_t Sample;
 
-	Sample = (((uint32_t)Endpoint_Read_Byte() << 16) | Endpoint_Read_Word_LE());
+	Sample = Endpoint_Read_Word_LE();
+	Sample = (((int32_t)(int8_t)Endpoint_Read_Byte() << 16) | (uint16_t)Sample);
 		  
 	if (!(Endpoint_BytesInEndpoint()))
 	  Endpoint_ClearOUT();
@@ -143,8 +144,8 @@ void Audio_Device_WriteSample16(USB_ClassInfo_Audio_Device_t* const AudioInterfa
 
 void Audio_Device_WriteSample24(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const int32_t Sample)
 {
-	Endpoint_Write_Byte(Sample >> 16);
 	Endpoint_Write_Word_LE(Sample);
+	Endpoint_Write_Byte(Sample >> 16);
 
 	if (Endpoint_BytesInEndpoint() == AudioInterfaceInfo->Config.DataINEndpointSize)
 	  Endpoint_ClearIN();
@@ -168,4 +169,159 @@ bool Audio_Device_IsReadyForNextSample(USB_ClassInfo_Audio_Device_t* const Audio
 	return Endpoint_IsINReady();
 }
 
+uint16_t Audio_Device_ReadFrames16(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, int16_t* Samples,
+                                   const uint8_t TotalChannels, const uint16_t MaxFrames)
+{
+	uint16_t FrameSize = (TotalChannels * sizeof(int16_t));
+	uint16_t FramesRem = MaxFrames;
+
+	if (!(FrameSize) || (FrameSize > AudioInterfaceInfo->Config.DataOUTEndpointSize))
+	  return 0;
+
+	if (!(Audio_Device_IsSampleReceived(AudioInterfaceInfo)))
+	  return 0;
+
+	while (FramesRem)
+	{
+		uint16_t PacketFrames = (Endpoint_BytesInEndpoint() / FrameSize);
+
+		if (PacketFrames > FramesRem)
+		  PacketFrames = FramesRem;
+
+		FramesRem -= PacketFrames;
+
+		for (uint16_t SamplesRem = (PacketFrames * TotalChannels); SamplesRem; SamplesRem--)
+		  *(Samples++) = (int16_t)Endpoint_Read_Word_LE();
+
+		// any partial frame left over is discarded along with the packet
+		if (Endpoint_BytesInEndpoint() < FrameSize)
+		{
+			Endpoint_ClearOUT();
+
+			if (!(Endpoint_IsOUTReceived()))
+			  break;
+		}
+	}
+
+	return (MaxFrames - FramesRem);
+}
+
+uint16_t Audio_Device_ReadFrames24(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, int32_t* Samples,
+                                   const uint8_t TotalChannels, const uint16_t MaxFrames)
+{
+	uint16_t FrameSize = (TotalChannels * 3);
+	uint16_t FramesRem = MaxFrames;
+
+	if (!(FrameSize) || (FrameSize > AudioInterfaceInfo->Config.DataOUTEndpointSize))
+	  return 0;
+
+	if (!(Audio_Device_IsSampleReceived(AudioInterfaceInfo)))
+	  return 0;
+
+	while (FramesRem)
+	{
+		uint16_t PacketFrames = (Endpoint_BytesInEndpoint() / FrameSize);
+
+		if (PacketFrames > FramesRem)
+		  PacketFrames = FramesRem;
+
+		FramesRem -= PacketFrames;
+
+		for (uint16_t SamplesRem = (PacketFrames * TotalChannels); SamplesRem; SamplesRem--)
+		{
+			uint16_t SampleLow = Endpoint_Read_Word_LE();
+
+			*(Samples++) = (((int32_t)(int8_t)Endpoint_Read_Byte() << 16) | SampleLow);
+		}
+
+		if (Endpoint_BytesInEndpoint() < FrameSize)
+		{
+			Endpoint_ClearOUT();
+
+			if (!(Endpoint_IsOUTReceived()))
+			  break;
+		}
+	}
+
+	return (MaxFrames - FramesRem);
+}
+
+uint16_t Audio_Device_WriteFrames16(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const int16_t* Samples,
+                                    const uint8_t TotalChannels, const uint16_t TotalFrames)
+{
+	uint16_t FrameSize = (TotalChannels * sizeof(int16_t));
+	uint16_t FramesRem = TotalFrames;
+
+	if (!(FrameSize) || (FrameSize > AudioInterfaceInfo->Config.DataINEndpointSize))
+	  return 0;
+
+	if (!(Audio_Device_IsReadyForNextSample(AudioInterfaceInfo)))
+	  return 0;
+
+	while (FramesRem)
+	{
+		// only whole frames are written to each packet, so that no frame is split across two frame periods
+		uint16_t PacketFrames = ((AudioInterfaceInfo->Config.DataINEndpointSize - Endpoint_BytesInEndpoint()) / FrameSize);
+
+		if (PacketFrames > FramesRem)
+		  PacketFrames = FramesRem;
+
+		FramesRem -= PacketFrames;
+
+		for (uint16_t SamplesRem = (PacketFrames * TotalChannels); SamplesRem; SamplesRem--)
+		  Endpoint_Write_Word_LE(*(Samples++));
+
+		if ((AudioInterfaceInfo->Config.DataINEndpointSize - Endpoint_BytesInEndpoint()) < FrameSize)
+		{
+			Endpoint_ClearIN();
+
+			if (!(Endpoint_IsINReady()))
+			  break;
+		}
+	}
+
+	return (TotalFrames - FramesRem);
+}
+
+uint16_t Audio_Device_WriteFrames24(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const int32_t* Samples,
+                                    const uint8_t TotalChannels, const uint16_t TotalFrames)
+{
+	uint16_t FrameSize = (TotalChannels * 3);
+	uint16_t FramesRem = TotalFrames;
+
+	if (!(FrameSize) || (FrameSize > AudioInterfaceInfo->Config.DataINEndpointSize))
+	  return 0;
+
+	if (!(Audio_Device_IsReadyForNextSample(AudioInterfaceInfo)))
+	  return 0;
+
+	while (FramesRem)
+	{
+		uint16_t PacketFrames = ((AudioInterfaceInfo->Config.DataINEndpointSize - Endpoint_BytesInEndpoint()) / FrameSize);
+
+		if (PacketFrames > FramesRem)
+		  PacketFrames = FramesRem;
+
+		FramesRem -= PacketFrames;
+
+		for (uint16_t SamplesRem = (PacketFrames * TotalChannels); SamplesRem; SamplesRem--)
+		{
+			int32_t Sample = *(Samples++);
+
+			Endpoint_Write_Word_LE(Sample);
+			Endpoint_Write_Byte(Sample >> 16);
+		}
+
+		if ((AudioInterfaceInfo->Config.DataINEndpointSize - Endpoint_BytesInEndpoint()) < FrameSize)
+		{
+			Endpoint_ClearIN();
+
+			if (!(Endpoint_IsINReady()))
+			  break;
+		}
+	}
+
+	return (TotalFrames - FramesRem);
+}
+
 #endif
\ No newline at end of file
@@ -38,6 +38,10 @@
  *  \section Module Description
  *  Device Mode USB Class driver framework interface, for the Audio USB Class driver.
  *
+ *  Samples may be moved either one at a time, or as blocks of interleaved multichannel audio frames. The block functions
+ *  select the streaming endpoint and check its readiness once per isochronous packet rather than once per sample, and
+ *  so should be used where the sample rate or channel count is high.
+ *
  *  @{
  */
 
@@ -198,6 +202,66 @@
 			 */
 			bool Audio_Device_IsReadyForNextSample(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Reads a block of 16-bit audio frames from the given audio interface. Each frame holds one sample for each of the
+			 *  interface's channels, which are placed into the Samples array interleaved in the order they were received. Frames
+			 *  are read from as many received packets as are waiting, up to the given maximum, and each packet is released back
+			 *  to the host once it has been read.
+			 *
+			 *  \note The Audio Streaming data endpoint must be large enough to hold at least one frame, otherwise no frames are moved.
+			 *
+			 *  \param[in,out] AudioInterfaceInfo  Pointer to a structure containing an Audio Class configuration and state.
+			 *  \param[out] Samples  Pointer to an array where the interleaved signed 16-bit samples are to be placed
+			 *  \param[in] TotalChannels  Number of channels, and so samples, in each frame
+			 *  \param[in] MaxFrames  Maximum number of frames to place into the Samples array
+			 *
+			 *  \return Number of frames read, zero if no samples were waiting
+			 */
+			uint16_t Audio_Device_ReadFrames16(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, int16_t* Samples,
+			                                   const uint8_t TotalChannels, const uint16_t MaxFrames) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Reads a block of 24-bit audio frames from the given audio interface, which are received from the host packed into
+			 *  three bytes per sample. This is otherwise identical to \ref Audio_Device_ReadFrames16().
+			 *
+			 *  \param[in,out] AudioInterfaceInfo  Pointer to a structure containing an Audio Class configuration and state.
+			 *  \param[out] Samples  Pointer to an array where the interleaved signed 24-bit samples are to be placed
+			 *  \param[in] TotalChannels  Number of channels, and so samples, in each frame
+			 *  \param[in] MaxFrames  Maximum number of frames to place into the Samples array
+			 *
+			 *  \return Number of frames read, zero if no samples were waiting
+			 */
+			uint16_t Audio_Device_ReadFrames24(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, int32_t* Samples,
+			                                   const uint8_t TotalChannels, const uint16_t MaxFrames) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Writes a block of 16-bit audio frames to the given audio interface. Each frame holds one sample for each of the
+			 *  interface's channels, interleaved in the Samples array. Whole frames are packed into each isochronous packet, which
+			 *  is sent once it cannot hold another frame; frames are written until the block is complete or no endpoint bank is
+			 *  free, so the return value should be checked to find where the next call should resume from.
+			 *
+			 *  \note The Audio Streaming data endpoint must be large enough to hold at least one frame, otherwise no frames are moved.
+			 *
+			 *  \param[in,out] AudioInterfaceInfo  Pointer to a structure containing an Audio Class configuration and state.
+			 *  \param[in] Samples  Pointer to an array of interleaved signed 16-bit samples
+			 *  \param[in] TotalChannels  Number of channels, and so samples, in each frame
+			 *  \param[in] TotalFrames  Number of frames in the Samples array
+			 *
+			 *  \return Number of frames written, zero if the interface was not ready for more samples
+			 */
+			uint16_t Audio_Device_WriteFrames16(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const int16_t* Samples,
+			                                    const uint8_t TotalChannels, const uint16_t TotalFrames) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Writes a block of 24-bit audio frames to the given audio interface, which are sent to the host packed into three
+			 *  bytes per sample. This is otherwise identical to \ref Audio_Device_WriteFrames16().
+			 *
+			 *  \param[in,out] AudioInterfaceInfo  Pointer to a structure containing an Audio Class configuration and state.
+			 *  \param[in] Samples  Pointer to an array of interleaved signed 24-bit samples
+			 *  \param[in] TotalChannels  Number of channels, and so samples, in each frame
+			 *  \param[in] TotalFrames  Number of frames in the Samples array
+			 *
+			 *  \return Number of frames written, zero if the interface was not ready for more samples
+			 */
+			uint16_t Audio_Device_WriteFrames24(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const int32_t* Samples,
+			                                    const uint8_t TotalChannels, const uint16_t TotalFrames) ATTR_NON_NULL_PTR_ARG(1, 2);
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
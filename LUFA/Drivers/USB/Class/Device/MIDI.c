@@ -46,7 +46,7 @@ bool MIDI_Device_ConfigureEndpoints(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 	{
 		if (!(Endpoint_ConfigureEndpoint(MIDIInterfaceInfo->Config.DataINEndpointNumber, EP_TYPE_BULK,
 										 ENDPOINT_DIR_IN, MIDIInterfaceInfo->Config.DataINEndpointSize,
-										 ENDPOINT_BANK_SINGLE)))
+										 (MIDIInterfaceInfo->Config.DataINEndpointDoubleBank ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE))))
 		{
 			return false;
 		}
@@ -56,7 +56,7 @@ bool MIDI_Device_ConfigureEndpoints(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 	{
 		if (!(Endpoint_ConfigureEndpoint(MIDIInterfaceInfo->Config.DataOUTEndpointNumber, EP_TYPE_BULK,
 										 ENDPOINT_DIR_OUT, MIDIInterfaceInfo->Config.DataOUTEndpointSize,
-										 ENDPOINT_BANK_SINGLE)))
+										 (MIDIInterfaceInfo->Config.DataOUTEndpointDoubleBank ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE))))
 		{
 			return false;
 		}
@@ -67,7 +67,17 @@ bool MIDI_Device_ConfigureEndpoints(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 
 void MIDI_Device_USBTask(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 {
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	  return;
+
+	if (MIDIInterfaceInfo->State.FlushPending && !(MIDIInterfaceInfo->State.FlushMSRemaining))
+	  MIDI_Device_Flush(MIDIInterfaceInfo);
+}
 
+void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
+{
+	if (MIDIInterfaceInfo->State.FlushMSRemaining)
+	  MIDIInterfaceInfo->State.FlushMSRemaining--;
 }
 
 uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo, MIDI_EventPacket_t* const Event)
@@ -77,33 +87,76 @@ uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 	
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataINEndpointNumber);
 
-	if (Endpoint_IsReadWriteAllowed());
-	{
-		uint8_t ErrorCode;
+	uint8_t ErrorCode;
 
-		if ((ErrorCode = Endpoint_Write_Stream_LE(Event, sizeof(MIDI_EventPacket_t), NO_STREAM_CALLBACK)) != ENDPOINT_RWSTREAM_NoError)
-		  return ErrorCode;
+	if ((ErrorCode = Endpoint_Write_Stream_LE(Event, sizeof(MIDI_EventPacket_t), NO_STREAM_CALLBACK)) != ENDPOINT_RWSTREAM_NoError)
+	  return ErrorCode;
 
+	/* Batched events are held in the bank until it is full or the flush period has elapsed - endpoint banks are a
+	   multiple of the event packet size, so an event is never split across two banks */
+	if (!(MIDIInterfaceInfo->Config.DataINFlushMS) || !(Endpoint_IsReadWriteAllowed()))
+	{
 		Endpoint_ClearIN();
+		MIDIInterfaceInfo->State.FlushPending = false;
+	}
+	else if (!(MIDIInterfaceInfo->State.FlushPending))
+	{
+		MIDIInterfaceInfo->State.FlushMSRemaining = MIDIInterfaceInfo->Config.DataINFlushMS;
+		MIDIInterfaceInfo->State.FlushPending     = true;
 	}
 	
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+void MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
+{
+	MIDIInterfaceInfo->State.FlushPending = false;
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	  return;
+	
+	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataINEndpointNumber);
+
+	if (Endpoint_BytesInEndpoint())
+	  Endpoint_ClearIN();
+}
+
 bool MIDI_Device_ReceiveEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo, MIDI_EventPacket_t* const Event)
 {
 	if (USB_DeviceState != DEVICE_STATE_Configured)
 	  return false;
 	
+	return (MIDI_Device_ReceiveEventPackets(MIDIInterfaceInfo, Event, 1) != 0);
+}
+
+uint8_t MIDI_Device_ReceiveEventPackets(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo, MIDI_EventPacket_t* const Events,
+                                        const uint8_t MaxEvents)
+{
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	  return 0;
+	
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataOUTEndpointNumber);
 
-	if (!(Endpoint_IsReadWriteAllowed()))
-	  return false;
+	/* Release a drained or zero length packet, or one whose remaining bytes are too short to hold an event, so that
+	   the next one (if already in the other bank) can be read */
+	if (Endpoint_IsOUTReceived() && (Endpoint_BytesInEndpoint() < sizeof(MIDI_EventPacket_t)))
+	  Endpoint_ClearOUT();
+
+	if (!(Endpoint_IsOUTReceived()))
+	  return 0;
+
+	uint16_t TotalEvents = (Endpoint_BytesInEndpoint() / sizeof(MIDI_EventPacket_t));
 
-	Endpoint_Read_Stream_LE(Event, sizeof(MIDI_EventPacket_t), NO_STREAM_CALLBACK);
-	Endpoint_ClearOUT();
+	if (TotalEvents > MaxEvents)
+	  TotalEvents = MaxEvents;
+
+	if (TotalEvents)
+	  Endpoint_Read_Stream_LE(Events, (TotalEvents * sizeof(MIDI_EventPacket_t)), NO_STREAM_CALLBACK);
+
+	if (Endpoint_BytesInEndpoint() < sizeof(MIDI_EventPacket_t))
+	  Endpoint_ClearOUT();
 	
-	return true;
+	return TotalEvents;
 }
 
 #endif
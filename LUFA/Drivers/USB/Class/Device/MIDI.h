@@ -38,6 +38,12 @@
  *  \section Module Description
  *  Device Mode USB Class driver framework interface, for the MIDI USB Class driver.
  *
+ *  Event packets sent to the host may be batched, so that several events travel in each IN endpoint bank rather than
+ *  one per USB transaction. When the interface's DataINFlushMS configuration value is non-zero, each event is written
+ *  into the current IN bank and the bank is only sent once it is full, or once the given number of milliseconds have
+ *  elapsed since the first event was written to it (see \ref MIDI_Device_MillisecondElapsed()). Received event
+ *  packets can likewise be drained from each OUT bank several at a time with \ref MIDI_Device_ReceiveEventPackets().
+ *
  *  @{
  */
 
@@ -70,15 +76,26 @@
 
 					uint8_t  DataINEndpointNumber; /**< Endpoint number of the incomming MIDI data, if available (zero if unused) */
 					uint16_t DataINEndpointSize; /**< Size in bytes of the incomming MIDI data endpoint, if available (zero if unused) */
+					bool     DataINEndpointDoubleBank; /**< Indicates if the incomming MIDI data endpoint should use double banking */
 
 					uint8_t  DataOUTEndpointNumber; /**< Endpoint number of the outgoing MIDI data, if available (zero if unused) */
 					uint16_t DataOUTEndpointSize; /**< Size in bytes of the outgoing MIDI data endpoint, if available (zero if unused) */
+					bool     DataOUTEndpointDoubleBank; /**< Indicates if the outgoing MIDI data endpoint should use double banking */
+
+					uint8_t  DataINFlushMS; /**< Longest time in mS that an event packet may wait in the incomming MIDI data endpoint's
+					                         *   bank for further events to be batched with it, or zero to send each event packet
+					                         *   to the host as soon as it is written
+					                         */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */									 
 				struct
 				{
-					// No state information for this class yet
+					bool     FlushPending; /**< Indicates if event packets are waiting in the incomming MIDI data endpoint's bank */
+					volatile uint8_t FlushMSRemaining; /**< Total number of mS remaining before the waiting event packets are sent to the
+					                                    *   host - this should be decremented by the user application via
+					                                    *   \ref MIDI_Device_MillisecondElapsed(), which may be called from an interrupt
+					                                    */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -109,7 +126,23 @@
 			 */
 			void MIDI_Device_USBTask(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Indicates that a millisecond has elapsed on the given MIDI interface, and the time remaining before batched event
+			 *  packets are sent to the host should be decremented. This should be called once per millisecond when the interface's
+			 *  DataINFlushMS configuration value is non-zero. It is recommended that this be called by the
+			 *  \ref EVENT_USB_Device_StartOfFrame() event, once SOF events have been enabled via \ref USB_Device_EnableSOFEvents(),
+			 *  in which case a DataINFlushMS value of 1 sends batched events at the next frame after they were written.
+			 *
+			 *  The waiting event packets are sent by \ref MIDI_Device_USBTask() rather than by this function, so that the endpoint
+			 *  selection of the main program loop is not disturbed from within the SOF interrupt.
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 */
+			void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
 			/** Sends a MIDI event packet to the host. If no host is connected, the event packet is discarded.
+			 *
+			 *  If the interface's DataINFlushMS configuration value is non-zero, the event packet is written to the current IN
+			 *  endpoint bank and is only sent once the bank is full, the flush period elapses or \ref MIDI_Device_Flush() is called.
 			 *
 			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
 			 *  \param[in] Event  Pointer to a populated USB_MIDI_EventPacket_t structure containing the MIDI event to send
@@ -119,7 +152,15 @@
 			uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
 			                                    MIDI_EventPacket_t* const Event) ATTR_NON_NULL_PTR_ARG(1, 2);
 
-			/** Receives a MIDI event packet from the host.
+			/** Sends any MIDI event packets batched in the IN endpoint bank to the host immediately, without waiting for the bank
+			 *  to fill or the flush period to elapse.
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 */
+			void MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Receives a MIDI event packet from the host. Each OUT packet may hold several event packets; the packet is only
+			 *  released back to the host once all of its events have been read.
 			 *
 			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
 			 *  \param[out] Event  Pointer to a USB_MIDI_EventPacket_t structure where the received MIDI event is to be placed
@@ -129,6 +170,19 @@
 			bool MIDI_Device_ReceiveEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
 			                                    MIDI_EventPacket_t* const Event) ATTR_NON_NULL_PTR_ARG(1, 2);
 
+			/** Receives all the MIDI event packets held in the current OUT endpoint bank from the host, up to the given maximum,
+			 *  in a single call. The bank is released back to the host once all of its events have been read, discarding any
+			 *  trailing bytes too short to form an event packet.
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 *  \param[out] Events  Pointer to an array of USB_MIDI_EventPacket_t structures where the received MIDI events are to be placed
+			 *  \param[in] MaxEvents  Maximum number of MIDI events to place into the Events array
+			 *
+			 *  \return Number of MIDI event packets received, zero if none were waiting
+			 */
+			uint8_t MIDI_Device_ReceiveEventPackets(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+			                                        MIDI_EventPacket_t* const Events, const uint8_t MaxEvents) ATTR_NON_NULL_PTR_ARG(1, 2);
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
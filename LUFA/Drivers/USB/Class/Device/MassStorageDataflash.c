@@ -0,0 +1,213 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2009.
+
+  dean [at] fourwalledcubicle [dot] com
+      www.fourwalledcubicle.com
+*/
+
+/*
+  Copyright 2009  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, and distribute this software
+  and its documentation for any purpose and without fee is hereby
+  granted, provided that the above copyright notice appear in all
+  copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#include "../../HighLevel/USBMode.h"
+#if defined(USB_CAN_BE_DEVICE)
+
+#define INCLUDE_FROM_MS_DATAFLASH_C
+#include "MassStorageDataflash.h"
+
+/* Buffer each Dataflash IC last started programming a page from, so that the next page written to the IC goes into its
+   other buffer while that program runs. Boards with several ICs spread consecutive pages across them in turn. */
+static bool LastProgramFromBuffer2[DATAFLASH_TOTALCHIPS];
+
+bool MS_Dataflash_WriteBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, const uint32_t BlockAddress,
+                              const uint16_t TotalBlocks)
+{
+	uint16_t CurrDFPage     = (BlockAddress / MS_DATAFLASH_BLOCKS_PER_PAGE);
+	uint16_t CurrDFPageByte = ((BlockAddress % MS_DATAFLASH_BLOCKS_PER_PAGE) * MS_DATAFLASH_BLOCK_SIZE);
+	uint32_t BytesRem       = ((uint32_t)TotalBlocks * MS_DATAFLASH_BLOCK_SIZE);
+
+	Endpoint_SelectEndpoint(MSInterfaceInfo->Config.DataOUTEndpointNumber);
+
+	if (Endpoint_WaitUntilReady())
+	  return false;
+
+	while (BytesRem)
+	{
+		uint8_t  Chip       = (CurrDFPage % DATAFLASH_TOTALCHIPS);
+		bool     UseBuffer2 = !(LastProgramFromBuffer2[Chip]);
+		uint16_t PageBytes  = (DATAFLASH_PAGE_SIZE - CurrDFPageByte);
+
+		if (PageBytes > BytesRem)
+		  PageBytes = BytesRem;
+
+		Dataflash_SelectChipFromPage(CurrDFPage);
+
+		// a page which is only partly overwritten keeps the rest of its contents, so it is copied into the buffer first
+		if (PageBytes != DATAFLASH_PAGE_SIZE)
+		{
+			Dataflash_WaitWhileBusy();
+			Dataflash_SendByte(UseBuffer2 ? DF_CMD_MAINMEMTOBUFF2 : DF_CMD_MAINMEMTOBUFF1);
+			Dataflash_SendAddressBytes(CurrDFPage, 0);
+			Dataflash_WaitWhileBusy();
+		}
+
+		// buffer writes are allowed while the IC is programming from its other buffer
+		Dataflash_SendByte(UseBuffer2 ? DF_CMD_BUFF2WRITE : DF_CMD_BUFF1WRITE);
+		Dataflash_SendAddressBytes(0, CurrDFPageByte);
+
+		if (!(MS_Dataflash_ReadEndpoint(MSInterfaceInfo, PageBytes)))
+		{
+			Dataflash_DeselectChip();
+			return false;
+		}
+
+		// the IC may still be programming its last page, but that has been overlapped with the transfer of this one
+		Dataflash_WaitWhileBusy();
+		Dataflash_SendByte(UseBuffer2 ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
+		Dataflash_SendAddressBytes(CurrDFPage, 0);
+		Dataflash_DeselectChip();
+
+		LastProgramFromBuffer2[Chip] = UseBuffer2;
+
+		BytesRem      -= PageBytes;
+		CurrDFPageByte = 0;
+		CurrDFPage++;
+	}
+
+	if (!(Endpoint_IsReadWriteAllowed()))
+	  Endpoint_ClearOUT();
+
+	return true;
+}
+
+bool MS_Dataflash_ReadBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, const uint32_t BlockAddress,
+                             const uint16_t TotalBlocks)
+{
+	uint16_t CurrDFPage     = (BlockAddress / MS_DATAFLASH_BLOCKS_PER_PAGE);
+	uint16_t CurrDFPageByte = ((BlockAddress % MS_DATAFLASH_BLOCKS_PER_PAGE) * MS_DATAFLASH_BLOCK_SIZE);
+	uint32_t BytesRem       = ((uint32_t)TotalBlocks * MS_DATAFLASH_BLOCK_SIZE);
+
+	Endpoint_SelectEndpoint(MSInterfaceInfo->Config.DataINEndpointNumber);
+
+	if (Endpoint_WaitUntilReady())
+	  return false;
+
+	while (BytesRem)
+	{
+		uint16_t PageBytes = (DATAFLASH_PAGE_SIZE - CurrDFPageByte);
+
+		if (PageBytes > BytesRem)
+		  PageBytes = BytesRem;
+
+		// the read is restarted for each page, as the ICs' pages are longer than the part of them used and the next
+		// page may be on another IC
+		Dataflash_SelectChipFromPage(CurrDFPage);
+		Dataflash_WaitWhileBusy();
+		Dataflash_SendByte(DF_CMD_CONTARRAYREAD_LF);
+		Dataflash_SendAddressBytes(CurrDFPage, CurrDFPageByte);
+
+		#if (DF_CMD_CONTARRAYREAD_LF == 0xE8)
+		// the legacy continuous array read opcode is followed by four don't care bytes
+		for (uint8_t DummyByte = 0; DummyByte < 4; DummyByte++)
+		  Dataflash_SendByte(0x00);
+		#endif
+
+		if (!(MS_Dataflash_WriteEndpoint(MSInterfaceInfo, PageBytes)))
+		{
+			Dataflash_DeselectChip();
+			return false;
+		}
+
+		BytesRem      -= PageBytes;
+		CurrDFPageByte = 0;
+		CurrDFPage++;
+	}
+
+	Dataflash_DeselectChip();
+
+	if (!(Endpoint_IsReadWriteAllowed()))
+	  Endpoint_ClearIN();
+
+	return true;
+}
+
+void MS_Dataflash_WaitForWrites(void)
+{
+	for (uint8_t Chip = 0; Chip < DATAFLASH_TOTALCHIPS; Chip++)
+	{
+		Dataflash_SelectChipFromPage(Chip);
+		Dataflash_WaitWhileBusy();
+	}
+
+	Dataflash_DeselectChip();
+}
+
+static bool MS_Dataflash_ReadEndpoint(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, uint16_t Bytes)
+{
+	while (Bytes)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearOUT();
+
+			if (Endpoint_WaitUntilReady())
+			  return false;
+		}
+
+		if (MSInterfaceInfo->State.IsMassStoreReset)
+		  return false;
+
+		// endpoint banks are a multiple of 16 bytes, so a bank can't empty part way through these
+		for (uint8_t ByteNum = 0; ByteNum < 16; ByteNum++)
+		  Dataflash_SendByte(Endpoint_Read_Byte());
+
+		Bytes -= 16;
+	}
+
+	return true;
+}
+
+static bool MS_Dataflash_WriteEndpoint(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, uint16_t Bytes)
+{
+	while (Bytes)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearIN();
+
+			if (Endpoint_WaitUntilReady())
+			  return false;
+		}
+
+		if (MSInterfaceInfo->State.IsMassStoreReset)
+		  return false;
+
+		for (uint8_t ByteNum = 0; ByteNum < 16; ByteNum++)
+		  Endpoint_Write_Byte(Dataflash_ReceiveByte());
+
+		Bytes -= 16;
+	}
+
+	return true;
+}
+
+#endif
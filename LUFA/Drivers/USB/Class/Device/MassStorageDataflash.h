@@ -0,0 +1,139 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2009.
+
+  dean [at] fourwalledcubicle [dot] com
+      www.fourwalledcubicle.com
+*/
+
+/*
+  Copyright 2009  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, and distribute this software
+  and its documentation for any purpose and without fee is hereby
+  granted, provided that the above copyright notice appear in all
+  copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \ingroup Group_USBClassMSDevice
+ *  @defgroup Group_USBClassMassStorageDataflash Mass Storage Device Dataflash Storage
+ *
+ *  \section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LUFA/Drivers/USB/Class/Device/MassStorage.c
+ *    - LUFA/Drivers/USB/Class/Device/MassStorageDataflash.c
+ *
+ *  \section Module Description
+ *  Dataflash storage for the Mass Storage device class driver, for boards with Dataflash ICs. The board's Dataflash
+ *  ICs are presented as a single medium of \ref MS_DATAFLASH_BLOCK_SIZE byte blocks, which the user application's
+ *  SCSI READ (10) and WRITE (10) handlers can move directly between the Mass Storage interface's data endpoints and
+ *  the Dataflash.
+ *
+ *  Written data is streamed from the OUT endpoint into one of the Dataflash's two SRAM buffers while the page before
+ *  it programs from the other buffer, so that the USB transfer of each page overlaps the programming of the last.
+ *  Reads use the Dataflash's continuous array read, which is restarted at each page so that the unused bytes at the
+ *  end of each Dataflash page are skipped.
+ *
+ *  As this module depends on the board Dataflash driver, it is not included by the Mass Storage class driver's
+ *  dispatch header; user applications should include LUFA/Drivers/USB/Class/Device/MassStorageDataflash.h
+ *  directly. The SPI and Dataflash drivers must be initialized before use, with the SPI running at the fastest rate
+ *  the board allows, and the Mass Storage interface's data endpoints must be at least 16 bytes in size.
+ *
+ *  @{
+ */
+
+#ifndef _MS_CLASS_DEVICE_DATAFLASH_H_
+#define _MS_CLASS_DEVICE_DATAFLASH_H_
+
+	/* Includes: */
+		#include "MassStorage.h"
+		#include "../../../Board/Dataflash.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Size in bytes of each block of the Dataflash medium, as reported to the host. */
+			#define MS_DATAFLASH_BLOCK_SIZE       512
+
+			/** Number of blocks held in each Dataflash page. */
+			#define MS_DATAFLASH_BLOCKS_PER_PAGE  (DATAFLASH_PAGE_SIZE / MS_DATAFLASH_BLOCK_SIZE)
+
+			/** Total number of blocks in the Dataflash medium, across all of the board's Dataflash ICs. */
+			#define MS_DATAFLASH_TOTAL_BLOCKS     ((uint32_t)DATAFLASH_PAGES * DATAFLASH_TOTALCHIPS * MS_DATAFLASH_BLOCKS_PER_PAGE)
+
+		/* Function Prototypes: */
+			/** Writes blocks to the Dataflash from the Mass Storage interface's OUT data endpoint, for a SCSI WRITE (10)
+			 *  command. Programming of the last page written is left running when this returns, and is waited for
+			 *  by the next Dataflash access made through this module.
+			 *
+			 *  The command block's DataTransferLength is not altered, so that the caller can do so once it knows the
+			 *  transfer has succeeded.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in] BlockAddress  Address of the first block to write
+			 *  \param[in] TotalBlocks  Number of blocks to write
+			 *
+			 *  \return Boolean true if all of the blocks were written, false if the transfer was aborted by a Mass Storage
+			 *          reset or an endpoint error
+			 */
+			bool MS_Dataflash_WriteBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, const uint32_t BlockAddress,
+			                              const uint16_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Reads blocks from the Dataflash to the Mass Storage interface's IN data endpoint, for a SCSI READ (10)
+			 *  command.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in] BlockAddress  Address of the first block to read
+			 *  \param[in] TotalBlocks  Number of blocks to read
+			 *
+			 *  \return Boolean true if all of the blocks were read, false if the transfer was aborted by a Mass Storage
+			 *          reset or an endpoint error
+			 */
+			bool MS_Dataflash_ReadBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, const uint32_t BlockAddress,
+			                             const uint16_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Waits for any page programming left running by \ref MS_Dataflash_WriteBlocks() to complete. This should be
+			 *  called before the Dataflash is accessed other than through this module, or before the board is powered
+			 *  down.
+			 */
+			void MS_Dataflash_WaitForWrites(void);
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#if (DATAFLASH_PAGE_SIZE % MS_DATAFLASH_BLOCK_SIZE)
+				#error DATAFLASH_PAGE_SIZE must be a multiple of MS_DATAFLASH_BLOCK_SIZE.
+			#endif
+
+		/* Function Prototypes: */
+			#if defined(INCLUDE_FROM_MS_DATAFLASH_C)
+				static bool MS_Dataflash_ReadEndpoint(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, uint16_t Bytes);
+				static bool MS_Dataflash_WriteEndpoint(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo, uint16_t Bytes);
+			#endif
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
@@ -112,25 +112,37 @@ void RNDIS_Device_ProcessControlRequest(USB_ClassInfo_RNDIS_Device_t* const RNDI
 
 bool RNDIS_Device_ConfigureEndpoints(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
 {
+	/* Buffers still lent from the last configuration are handed back before the queues are emptied */
+	for (uint8_t QueueIndex = 0; QueueIndex < RNDIS_FRAME_QUEUE_DEPTH; QueueIndex++)
+	{
+		if (QueueIndex < RNDISInterfaceInfo->State.ReceiveLent)
+		  RNDISInterfaceInfo->State.ReceiveBuffers[(RNDISInterfaceInfo->State.ReceiveFirst + QueueIndex) %
+		                                           RNDIS_FRAME_QUEUE_DEPTH]->LentToDriver = false;
+
+		if (QueueIndex < RNDISInterfaceInfo->State.SendCount)
+		  RNDISInterfaceInfo->State.SendBuffers[(RNDISInterfaceInfo->State.SendFirst + QueueIndex) %
+		                                        RNDIS_FRAME_QUEUE_DEPTH]->LentToDriver = false;
+	}
+
 	memset(&RNDISInterfaceInfo->State, 0x00, sizeof(RNDISInterfaceInfo->State));
 
 	if (!(Endpoint_ConfigureEndpoint(RNDISInterfaceInfo->Config.DataINEndpointNumber, EP_TYPE_BULK,
 							         ENDPOINT_DIR_IN, RNDISInterfaceInfo->Config.DataINEndpointSize,
-							         ENDPOINT_BANK_SINGLE)))
+							         (RNDISInterfaceInfo->Config.DataINEndpointDoubleBank ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE))))
 	{
 		return false;
 	}
 
 	if (!(Endpoint_ConfigureEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpointNumber, EP_TYPE_BULK,
 	                                 ENDPOINT_DIR_OUT, RNDISInterfaceInfo->Config.DataOUTEndpointSize,
-	                                 ENDPOINT_BANK_SINGLE)))
+	                                 (RNDISInterfaceInfo->Config.DataOUTEndpointDoubleBank ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE))))
 	{
 		return false;
 	}
 
 	if (!(Endpoint_ConfigureEndpoint(RNDISInterfaceInfo->Config.NotificationEndpointNumber, EP_TYPE_INTERRUPT,
 	                                 ENDPOINT_DIR_IN, RNDISInterfaceInfo->Config.NotificationEndpointSize,
-	                                 ENDPOINT_BANK_SINGLE)))
+	                                 (RNDISInterfaceInfo->Config.NotificationEndpointDoubleBank ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE))))
 	{
 		return false;
 	}
@@ -167,49 +179,205 @@ void RNDIS_Device_USBTask(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo
 	
 	if ((RNDISInterfaceInfo->State.CurrRNDISState == RNDIS_Data_Initialized) && !(MessageHeader->MessageLength))
 	{
-		RNDIS_Packet_Message_t RNDISPacketHeader;
-
 		Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpointNumber);
 
-		if (Endpoint_IsOUTReceived() && !(RNDISInterfaceInfo->State.FrameIN.FrameInBuffer))
+		/* A transfer may hold several packet messages, so the OUT bank is only released once it has been emptied; any
+		   messages left in it once the lent receive buffers are all filled are read on a later pass */
+		while (Endpoint_IsOUTReceived() && (RNDISInterfaceInfo->State.ReceiveFilled < RNDISInterfaceInfo->State.ReceiveLent))
 		{
-			Endpoint_Read_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NO_STREAM_CALLBACK);
+			/* Hosts end transfers with a zero length packet or a single padding byte instead of a full length packet */
+			if (Endpoint_BytesInEndpoint() <= 1)
+			{
+				Endpoint_ClearOUT();
+				continue;
+			}
 
-			if (RNDISPacketHeader.DataLength > ETHERNET_FRAME_SIZE_MAX)
+			if (!(RNDIS_Device_ReadPacketMessage(RNDISInterfaceInfo)))
 			{
 				Endpoint_StallTransaction();
 				return;
 			}
-			
-			Endpoint_Read_Stream_LE(RNDISInterfaceInfo->State.FrameIN.FrameData, RNDISPacketHeader.DataLength, NO_STREAM_CALLBACK);
-
-			Endpoint_ClearOUT();
-			
-			RNDISInterfaceInfo->State.FrameIN.FrameLength = RNDISPacketHeader.DataLength;
 
-			RNDISInterfaceInfo->State.FrameIN.FrameInBuffer = true;
+			if (!(Endpoint_IsReadWriteAllowed()))
+			  Endpoint_ClearOUT();
 		}
 		
 		Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpointNumber);
-		
-		if (Endpoint_IsINReady() && RNDISInterfaceInfo->State.FrameOUT.FrameInBuffer)
-		{
-			memset(&RNDISPacketHeader, 0, sizeof(RNDIS_Packet_Message_t));
-
-			RNDISPacketHeader.MessageType   = REMOTE_NDIS_PACKET_MSG;
-			RNDISPacketHeader.MessageLength = (sizeof(RNDIS_Packet_Message_t) + RNDISInterfaceInfo->State.FrameOUT.FrameLength);
-			RNDISPacketHeader.DataOffset    = (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
-			RNDISPacketHeader.DataLength    = RNDISInterfaceInfo->State.FrameOUT.FrameLength;
 
-			Endpoint_Write_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NO_STREAM_CALLBACK);
-			Endpoint_Write_Stream_LE(RNDISInterfaceInfo->State.FrameOUT.FrameData, RNDISPacketHeader.DataLength, NO_STREAM_CALLBACK);
+		/* The next transfer can't start until the last one has been ended */
+		if (RNDISInterfaceInfo->State.SendZLP && Endpoint_IsINReady())
+		{
 			Endpoint_ClearIN();
-			
-			RNDISInterfaceInfo->State.FrameOUT.FrameInBuffer = false;
+			RNDISInterfaceInfo->State.SendZLP = false;
 		}
+		
+		if (Endpoint_IsINReady() && !(RNDISInterfaceInfo->State.SendZLP) && RNDISInterfaceInfo->State.SendCount)
+		  RNDIS_Device_SendPacketMessages(RNDISInterfaceInfo);
 	}
 }							
 
+bool RNDIS_Device_LendReceiveBuffer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                    RNDIS_Frame_Buffer_t* const Buffer)
+{
+	if (RNDISInterfaceInfo->State.ReceiveLent == RNDIS_FRAME_QUEUE_DEPTH)
+	  return false;
+
+	Buffer->LentToDriver = true;
+
+	RNDISInterfaceInfo->State.ReceiveBuffers[(RNDISInterfaceInfo->State.ReceiveFirst +
+	                                          RNDISInterfaceInfo->State.ReceiveLent) % RNDIS_FRAME_QUEUE_DEPTH] = Buffer;
+	RNDISInterfaceInfo->State.ReceiveLent++;
+
+	return true;
+}
+
+RNDIS_Frame_Buffer_t* RNDIS_Device_GetReceivedFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if (!(RNDISInterfaceInfo->State.ReceiveFilled))
+	  return NULL;
+
+	RNDIS_Frame_Buffer_t* Buffer = RNDISInterfaceInfo->State.ReceiveBuffers[RNDISInterfaceInfo->State.ReceiveFirst];
+
+	if (++RNDISInterfaceInfo->State.ReceiveFirst == RNDIS_FRAME_QUEUE_DEPTH)
+	  RNDISInterfaceInfo->State.ReceiveFirst = 0;
+
+	RNDISInterfaceInfo->State.ReceiveFilled--;
+	RNDISInterfaceInfo->State.ReceiveLent--;
+
+	Buffer->LentToDriver = false;
+
+	return Buffer;
+}
+
+bool RNDIS_Device_SendFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                            RNDIS_Frame_Buffer_t* const Buffer)
+{
+	if (RNDISInterfaceInfo->State.SendCount == RNDIS_FRAME_QUEUE_DEPTH)
+	  return false;
+
+	Buffer->LentToDriver = true;
+
+	RNDISInterfaceInfo->State.SendBuffers[(RNDISInterfaceInfo->State.SendFirst +
+	                                       RNDISInterfaceInfo->State.SendCount) % RNDIS_FRAME_QUEUE_DEPTH] = Buffer;
+	RNDISInterfaceInfo->State.SendCount++;
+
+	return true;
+}
+
+static bool RNDIS_Device_ReadPacketMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	RNDIS_Packet_Message_t RNDISPacketHeader;
+
+	Endpoint_Read_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NO_STREAM_CALLBACK);
+
+	/* DataOffset is counted from the end of the message type and length fields */
+	uint32_t DataStart = (sizeof(RNDIS_Message_Header_t) + RNDISPacketHeader.DataOffset);
+
+	if ((RNDISPacketHeader.MessageType != REMOTE_NDIS_PACKET_MSG) ||
+	    (RNDISPacketHeader.MessageLength > RNDIS_PACKET_MESSAGE_SIZE_MAX) ||
+	    (RNDISPacketHeader.DataLength > ETHERNET_FRAME_SIZE_MAX) ||
+	    (DataStart < sizeof(RNDIS_Packet_Message_t)) ||
+	    ((DataStart + RNDISPacketHeader.DataLength) > RNDISPacketHeader.MessageLength))
+	{
+		return false;
+	}
+
+	RNDIS_Frame_Buffer_t* Buffer = RNDISInterfaceInfo->State.ReceiveBuffers[(RNDISInterfaceInfo->State.ReceiveFirst +
+	                                                                         RNDISInterfaceInfo->State.ReceiveFilled) %
+	                                                                        RNDIS_FRAME_QUEUE_DEPTH];
+
+	if (DataStart != sizeof(RNDIS_Packet_Message_t))
+	  Endpoint_Discard_Stream(DataStart - sizeof(RNDIS_Packet_Message_t), NO_STREAM_CALLBACK);
+
+	/* Frames are streamed straight into the application's buffer, or dropped if they won't fit in it */
+	if (RNDISPacketHeader.DataLength > Buffer->BufferSize)
+	{
+		Endpoint_Discard_Stream(RNDISPacketHeader.MessageLength - DataStart, NO_STREAM_CALLBACK);
+		return true;
+	}
+
+	Endpoint_Read_Stream_LE(Buffer->FrameData, RNDISPacketHeader.DataLength, NO_STREAM_CALLBACK);
+
+	/* Messages batched into one transfer are padded out to the alignment given to the host */
+	if (RNDISPacketHeader.MessageLength != (DataStart + RNDISPacketHeader.DataLength))
+	  Endpoint_Discard_Stream(RNDISPacketHeader.MessageLength - (DataStart + RNDISPacketHeader.DataLength), NO_STREAM_CALLBACK);
+
+	Buffer->FrameLength = RNDISPacketHeader.DataLength;
+
+	RNDISInterfaceInfo->State.ReceiveFilled++;
+
+	return true;
+}
+
+static void RNDIS_Device_SendPacketMessages(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	RNDIS_Packet_Message_t RNDISPacketHeader;
+	uint32_t               TransferLength = 0;
+	uint8_t                PacketsInTransfer = 0;
+	uint32_t               PaddingBytes = 0;
+
+	memset(&RNDISPacketHeader, 0, sizeof(RNDIS_Packet_Message_t));
+
+	RNDISPacketHeader.MessageType = REMOTE_NDIS_PACKET_MSG;
+	RNDISPacketHeader.DataOffset  = (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
+
+	while (RNDISInterfaceInfo->State.SendCount)
+	{
+		RNDIS_Frame_Buffer_t* Buffer = RNDISInterfaceInfo->State.SendBuffers[RNDISInterfaceInfo->State.SendFirst];
+		uint16_t MessageLength       = (sizeof(RNDIS_Packet_Message_t) + Buffer->FrameLength);
+		uint16_t PaddedLength        = ((MessageLength + (RNDIS_PACKET_ALIGNMENT - 1)) & ~(RNDIS_PACKET_ALIGNMENT - 1));
+		bool     SendNextInTransfer  = false;
+
+		/* The next queued frame joins this transfer only if the host has said it will accept the combined length */
+		if ((RNDISInterfaceInfo->State.SendCount > 1) && (PacketsInTransfer < (RNDIS_MAX_PACKETS_PER_TRANSFER - 1)))
+		{
+			RNDIS_Frame_Buffer_t* NextBuffer = RNDISInterfaceInfo->State.SendBuffers[(RNDISInterfaceInfo->State.SendFirst + 1) %
+			                                                                         RNDIS_FRAME_QUEUE_DEPTH];
+
+			SendNextInTransfer = ((TransferLength + PaddedLength + sizeof(RNDIS_Packet_Message_t) + NextBuffer->FrameLength) <=
+			                      RNDISInterfaceInfo->State.HostMaxTransferSize);
+		}
+
+		if (SendNextInTransfer)
+		  MessageLength = PaddedLength;
+
+		RNDISPacketHeader.MessageLength = MessageLength;
+		RNDISPacketHeader.DataLength    = Buffer->FrameLength;
+
+		Endpoint_Write_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NO_STREAM_CALLBACK);
+		Endpoint_Write_Stream_LE(Buffer->FrameData, Buffer->FrameLength, NO_STREAM_CALLBACK);
+
+		if (MessageLength != (sizeof(RNDIS_Packet_Message_t) + Buffer->FrameLength))
+		  Endpoint_Write_Stream_LE(&PaddingBytes, (MessageLength - (sizeof(RNDIS_Packet_Message_t) + Buffer->FrameLength)), NO_STREAM_CALLBACK);
+
+		/* The frame is now in the endpoint banks, so the application can reuse its buffer */
+		Buffer->LentToDriver = false;
+
+		if (++RNDISInterfaceInfo->State.SendFirst == RNDIS_FRAME_QUEUE_DEPTH)
+		  RNDISInterfaceInfo->State.SendFirst = 0;
+
+		RNDISInterfaceInfo->State.SendCount--;
+
+		TransferLength += MessageLength;
+		PacketsInTransfer++;
+
+		if (!(SendNextInTransfer))
+		  break;
+	}
+
+	Endpoint_ClearIN();
+
+	/* A transfer filling its last packet is ended with a zero length packet, so the host doesn't wait for more; if no
+	   bank is free for it yet, it is sent on a later pass rather than waiting for the host here */
+	if (!(TransferLength % RNDISInterfaceInfo->Config.DataINEndpointSize))
+	{
+		if (Endpoint_IsINReady())
+		  Endpoint_ClearIN();
+		else
+		  RNDISInterfaceInfo->State.SendZLP = true;
+	}
+}
+
 void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
 {
 	/* Note: Only a single buffer is used for both the received message and its response to save SRAM. Because of
@@ -226,6 +394,8 @@ void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const
 			               (RNDIS_Initialize_Message_t*)&RNDISInterfaceInfo->State.RNDISMessageBuffer;
 			RNDIS_Initialize_Complete_t* INITIALIZE_Response =
 			               (RNDIS_Initialize_Complete_t*)&RNDISInterfaceInfo->State.RNDISMessageBuffer;
+
+			RNDISInterfaceInfo->State.HostMaxTransferSize = INITIALIZE_Message->MaxTransferSize;
 			
 			INITIALIZE_Response->MessageType           = REMOTE_NDIS_INITIALIZE_CMPLT;
 			INITIALIZE_Response->MessageLength         = sizeof(RNDIS_Initialize_Complete_t);
@@ -236,9 +406,9 @@ void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const
 			INITIALIZE_Response->MinorVersion          = REMOTE_NDIS_VERSION_MINOR;			
 			INITIALIZE_Response->DeviceFlags           = REMOTE_NDIS_DF_CONNECTIONLESS;
 			INITIALIZE_Response->Medium                = REMOTE_NDIS_MEDIUM_802_3;
-			INITIALIZE_Response->MaxPacketsPerTransfer = 1;
-			INITIALIZE_Response->MaxTransferSize       = (sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX);
-			INITIALIZE_Response->PacketAlignmentFactor = 0;
+			INITIALIZE_Response->MaxPacketsPerTransfer = RNDIS_MAX_PACKETS_PER_TRANSFER;
+			INITIALIZE_Response->MaxTransferSize       = RNDIS_MAX_TRANSFER_SIZE;
+			INITIALIZE_Response->PacketAlignmentFactor = RNDIS_PACKET_ALIGNMENT_FACTOR;
 			INITIALIZE_Response->AFListOffset          = 0;
 			INITIALIZE_Response->AFListSize            = 0;
 			
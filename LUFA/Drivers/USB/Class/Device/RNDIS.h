@@ -38,6 +38,15 @@
  *  \section Module Description
  *  Device Mode USB Class driver framework interface, for the RNDIS USB Class driver.
  *
+ *  Ethernet frames are held in buffers owned by the user application, described by \ref RNDIS_Frame_Buffer_t, which are
+ *  lent to the class driver to receive frames into (\ref RNDIS_Device_LendReceiveBuffer()) or to send frames from
+ *  (\ref RNDIS_Device_SendFrame()). Frame data is streamed directly between the data endpoints and these buffers, so the
+ *  driver keeps no frame buffers of its own and frames need not be copied between the driver and the application's network
+ *  stack. Up to \ref RNDIS_FRAME_QUEUE_DEPTH buffers may be lent in each direction, so that several frames can be received
+ *  from or sent to the host in a single pass of \ref RNDIS_Device_USBTask(). If \ref RNDIS_MAX_PACKETS_PER_TRANSFER is
+ *  more than one, the host is told that it may send several packets in each USB transfer, and queued frames are sent to the
+ *  host in the same way (up to the transfer size the host gives at initialization).
+ *
  *  @{
  */
 
@@ -56,8 +65,47 @@
 			extern "C" {
 		#endif
 
+	/* Preprocessor checks and defines: */
+		#if !defined(RNDIS_FRAME_QUEUE_DEPTH) || defined(__DOXYGEN__)
+			/** Constant indicating the number of frame buffers which may be lent to each RNDIS interface in each direction.
+			 *  The buffers themselves are owned by the user application, so each extra entry costs the driver only a pointer.
+			 *  By default this is set to 1 frame, but this can be overridden by
+			 *  defining RNDIS_FRAME_QUEUE_DEPTH to another non-zero value in the user project makefile, passing the define
+			 *  to the compiler using the -D compiler switch.
+			 */
+			#define RNDIS_FRAME_QUEUE_DEPTH              1
+		#endif
+
+		#if !defined(RNDIS_MAX_PACKETS_PER_TRANSFER) || defined(__DOXYGEN__)
+			/** Constant indicating the maximum number of RNDIS packet messages sent or accepted in a single USB transfer.
+			 *  Values above one enable the RNDIS multiple packet mode, which is advertised to the host when it initializes
+			 *  the adapter. By default this is set to 1 packet, but this can be overridden by defining
+			 *  RNDIS_MAX_PACKETS_PER_TRANSFER to another non-zero value in the user project makefile, passing the define to
+			 *  the compiler using the -D compiler switch.
+			 */
+			#define RNDIS_MAX_PACKETS_PER_TRANSFER       1
+		#endif
+
+		#if (RNDIS_FRAME_QUEUE_DEPTH == 0) || (RNDIS_MAX_PACKETS_PER_TRANSFER == 0)
+			#error RNDIS_FRAME_QUEUE_DEPTH and RNDIS_MAX_PACKETS_PER_TRANSFER must be non-zero.
+		#endif
+
 	/* Public Interface - May be used in end-application: */
-		/* Type Defines: */					 
+		/* Type Defines: */
+			/** Type define for a frame buffer owned by the user application, which is lent to the RNDIS class driver to
+			 *  receive a frame from the host into, or to send a frame to the host from.
+			 */
+			typedef struct
+			{
+				uint8_t* FrameData; /**< Pointer to the application's frame data buffer */
+				uint16_t BufferSize; /**< Size in bytes of the frame data buffer; received frames larger than this are dropped */
+				uint16_t FrameLength; /**< Length in bytes of the Ethernet frame stored in the buffer */
+				bool     LentToDriver; /**< Indicates if the buffer is currently lent to the class driver, and so must not be
+				                        *   altered by the user application
+				                        */
+			} RNDIS_Frame_Buffer_t;
+
+
 			/** Class state structure. An instance of this structure should be made for each RNDIS interface
 			 *  within the user application, and passed to each of the RNDIS class driver functions as the
 			 *  RNDISInterfaceInfo parameter. This stores each RNDIS interface's configuration and state information.
@@ -70,12 +118,15 @@
 
 					uint8_t  DataINEndpointNumber; /**< Endpoint number of the CDC interface's IN data endpoint */
 					uint16_t DataINEndpointSize; /**< Size in bytes of the CDC interface's IN data endpoint */
+					bool     DataINEndpointDoubleBank; /**< Indicates if the CDC interface's IN data endpoint should use double banking */
 
 					uint8_t  DataOUTEndpointNumber; /**< Endpoint number of the CDC interface's OUT data endpoint */
 					uint16_t DataOUTEndpointSize;  /**< Size in bytes of the CDC interface's OUT data endpoint */
+					bool     DataOUTEndpointDoubleBank; /**< Indicates if the CDC interface's OUT data endpoint should use double banking */
 
 					uint8_t  NotificationEndpointNumber; /**< Endpoint number of the CDC interface's IN notification endpoint, if used */
 					uint16_t NotificationEndpointSize;  /**< Size in bytes of the CDC interface's IN notification endpoint, if used */
+					bool     NotificationEndpointDoubleBank; /**< Indicates if the CDC interface's IN notification endpoint should use double banking */
 					
 					char*         AdapterVendorDescription; /**< String description of the adapter vendor */
 					MAC_Address_t AdapterMACAddress; /**< MAC address of the adapter */
@@ -90,12 +141,19 @@
 					bool     ResponseReady; /**< Internal flag indicating if a RNDIS message is waiting to be returned to the host */
 					uint8_t  CurrRNDISState; /**< Current RNDIS state of the adapter, a value from the RNDIS_States_t enum */
 					uint32_t CurrPacketFilter; /**< Current packet filter mode, used internally by the class driver */
-					Ethernet_Frame_Info_t FrameIN; /**< Structure holding the last received Ethernet frame from the host, for user
-													*   processing
-													*/
-					Ethernet_Frame_Info_t FrameOUT; /**< Structure holding the next Ethernet frame to send to the host, populated by the
-													 *   user application
-													 */
+					uint32_t HostMaxTransferSize; /**< Largest USB transfer the host accepts, as given when it initialized the adapter */
+					RNDIS_Frame_Buffer_t* ReceiveBuffers[RNDIS_FRAME_QUEUE_DEPTH]; /**< Queue of buffers lent to receive frames from the
+					                                                                *   host, filled buffers first and then empty ones
+					                                                                */
+					uint8_t  ReceiveFirst; /**< Index of the oldest buffer in the ReceiveBuffers queue */
+					uint8_t  ReceiveFilled; /**< Number of buffers in the ReceiveBuffers queue holding a received frame */
+					uint8_t  ReceiveLent; /**< Total number of buffers in the ReceiveBuffers queue */
+					RNDIS_Frame_Buffer_t* SendBuffers[RNDIS_FRAME_QUEUE_DEPTH]; /**< Queue of buffers lent to send frames to the host */
+					uint8_t  SendFirst; /**< Index of the oldest buffer in the SendBuffers queue */
+					uint8_t  SendCount; /**< Number of buffers in the SendBuffers queue */
+					bool     SendZLP; /**< Internal flag indicating if the last transfer to the host is still to be ended with a
+					                   *   zero length packet
+					                   */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -125,11 +183,62 @@
 			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing a RNDIS Class configuration and state.
 			 */
 			void RNDIS_Device_USBTask(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Lends a buffer to the class driver to receive a frame from the host into. The buffer's FrameData and BufferSize
+			 *  elements must be set before it is lent; it is then owned by the class driver (with its LentToDriver element set)
+			 *  until it is returned holding a frame by \ref RNDIS_Device_GetReceivedFrame(). Buffers lent to an interface are
+			 *  returned to the application, empty, when the interface's endpoints are next configured.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing a RNDIS Class configuration and state.
+			 *  \param[in,out] Buffer  Pointer to the buffer to lend to the class driver
+			 *
+			 *  \return Boolean true if the buffer was lent, false if \ref RNDIS_FRAME_QUEUE_DEPTH receive buffers are already lent
+			 */
+			bool RNDIS_Device_LendReceiveBuffer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                                    RNDIS_Frame_Buffer_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Returns the buffer holding the oldest Ethernet frame received from the host to the user application. Frames
+			 *  are returned in the order they were received, and the buffer may be lent again once the frame has been
+			 *  processed.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing a RNDIS Class configuration and state.
+			 *
+			 *  \return Pointer to the buffer holding the received frame, or NULL if no frames are waiting
+			 */
+			RNDIS_Frame_Buffer_t* RNDIS_Device_GetReceivedFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+			                                                    ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Lends a buffer holding an Ethernet frame to the class driver, to be sent to the host on a later call to
+			 *  \ref RNDIS_Device_USBTask(). The buffer's FrameData and FrameLength elements must be set before it is lent;
+			 *  it is then owned by the class driver until the frame has been written to the endpoint, at which point the
+			 *  buffer's LentToDriver element is cleared.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing a RNDIS Class configuration and state.
+			 *  \param[in,out] Buffer  Pointer to the buffer holding the frame to send
+			 *
+			 *  \return Boolean true if the frame was queued, false if \ref RNDIS_FRAME_QUEUE_DEPTH frames are already waiting
+			 */
+			bool RNDIS_Device_SendFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                            RNDIS_Frame_Buffer_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1, 2);
 		
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#if (RNDIS_MAX_PACKETS_PER_TRANSFER > 1)
+				#define RNDIS_PACKET_ALIGNMENT_FACTOR    2
+			#else
+				#define RNDIS_PACKET_ALIGNMENT_FACTOR    0
+			#endif
+
+			#define RNDIS_PACKET_ALIGNMENT               (1 << RNDIS_PACKET_ALIGNMENT_FACTOR)
+			#define RNDIS_PACKET_MESSAGE_SIZE_MAX        (sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX + \
+			                                              (RNDIS_PACKET_ALIGNMENT - 1))
+			#define RNDIS_MAX_TRANSFER_SIZE              ((uint32_t)RNDIS_MAX_PACKETS_PER_TRANSFER * RNDIS_PACKET_MESSAGE_SIZE_MAX)
+
 		/* Function Prototypes: */
 		#if defined(INCLUDE_FROM_RNDIS_CLASS_DEVICE_C)
+			static bool RNDIS_Device_ReadPacketMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+			static void RNDIS_Device_SendPacketMessages(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 			static void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 			static bool RNDIS_Device_ProcessNDISQuery(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo, 
 			                                          const uint32_t OId, void* const QueryData, const uint16_t QuerySize,
@@ -37,156 +37,94 @@
 uint8_t CDC_Host_ConfigurePipes(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint16_t ConfigDescriptorSize,
                                 uint8_t* ConfigDescriptorData)
 {
-	uint8_t FoundEndpoints = 0;
+	USB_ConfigIndex_t ConfigIndex;
+	bool              FoundDataInterface = false;
 
 	memset(&CDCInterfaceInfo->State, 0x00, sizeof(CDCInterfaceInfo->State));
 
-	if (DESCRIPTOR_TYPE(ConfigDescriptorData) != DTYPE_Configuration)
+	if (USB_GetConfigIndex(&ConfigIndex, ConfigDescriptorSize, ConfigDescriptorData) == CONFIGINDEX_InvalidConfigDescriptor)
 	  return CDC_ENUMERROR_InvalidConfigDescriptor;
-	
-	if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-	                              DComp_CDC_Host_NextCDCControlInterface) != DESCRIPTOR_SEARCH_COMP_Found)
-	{
-		return CDC_ENUMERROR_NoCDCInterfaceFound;
-	}
-	
-	CDCInterfaceInfo->State.ControlInterfaceNumber = DESCRIPTOR_CAST(ConfigDescriptorData, USB_Descriptor_Interface_t).InterfaceNumber;
 
-	while (FoundEndpoints != (CDC_FOUND_NOTIFICATION_IN | CDC_FOUND_DATAPIPE_IN | CDC_FOUND_DATAPIPE_OUT))
+	for (uint8_t ControlIndex = 0; ControlIndex < ConfigIndex.TotalInterfaces; ControlIndex++)
 	{
-		if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-		                              DComp_CDC_Host_NextCDCInterfaceEndpoint) != DESCRIPTOR_SEARCH_COMP_Found)
-		{
-			if (FoundEndpoints & CDC_FOUND_NOTIFICATION_IN)
-			{
-				if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData, 
-				                              DComp_CDC_Host_NextCDCDataInterface) != DESCRIPTOR_SEARCH_COMP_Found)
-				{
-					return CDC_ENUMERROR_NoCDCInterfaceFound;
-				}
-			}
-			else
-			{
-				FoundEndpoints = 0;
-
-				Pipe_SelectPipe(CDCInterfaceInfo->Config.DataINPipeNumber);
-				Pipe_DisablePipe();
-				Pipe_SelectPipe(CDCInterfaceInfo->Config.DataOUTPipeNumber);
-				Pipe_DisablePipe();
-				Pipe_SelectPipe(CDCInterfaceInfo->Config.NotificationPipeNumber);
-				Pipe_DisablePipe();
-			
-				if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-				                              DComp_CDC_Host_NextCDCControlInterface) != DESCRIPTOR_SEARCH_COMP_Found)
-				{
-					return CDC_ENUMERROR_NoCDCInterfaceFound;
-				}
-			}
+		USB_ConfigIndex_Interface_t* ControlInterface = &ConfigIndex.Interfaces[ControlIndex];
 
-			if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-			                              DComp_CDC_Host_NextCDCInterfaceEndpoint) != DESCRIPTOR_SEARCH_COMP_Found)
-			{
-				return CDC_ENUMERROR_EndpointsNotFound;
-			}
-		}
-		
-		USB_Descriptor_Endpoint_t* EndpointData = DESCRIPTOR_PCAST(ConfigDescriptorData, USB_Descriptor_Endpoint_t);
-
-		if ((EndpointData->Attributes & EP_TYPE_MASK) == EP_TYPE_INTERRUPT)
+		/* Alternate settings are indexed separately, but only the default settings are active without a SET_INTERFACE */
+		if ((ControlInterface->AlternateSetting != 0)                    ||
+		    (ControlInterface->Class            != CDC_CONTROL_CLASS)    ||
+		    (ControlInterface->SubClass         != CDC_CONTROL_SUBCLASS) ||
+		    (ControlInterface->Protocol         != CDC_CONTROL_PROTOCOL))
 		{
-			if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-			{							   
-				Pipe_ConfigurePipe(CDCInterfaceInfo->Config.NotificationPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize, PIPE_BANK_SINGLE);
-				CDCInterfaceInfo->State.NotificationPipeSize = EndpointData->EndpointSize;
-
-				Pipe_SetInterruptPeriod(EndpointData->PollingIntervalMS);
-				
-				FoundEndpoints |= CDC_FOUND_NOTIFICATION_IN;
-			}
+			continue;
 		}
-		else
+
+		const USB_ConfigIndex_Endpoint_t* NotificationEndpoint =
+		        USB_ConfigIndex_FindEndpoint(&ConfigIndex, ControlInterface, EP_TYPE_INTERRUPT, true);
+
+		if (NotificationEndpoint == NULL)
+		  continue;
+
+		uint8_t DataInterfaceNumber = CDC_Host_GetDataInterfaceNumber(ControlInterface, ConfigDescriptorSize,
+		                                                              ConfigDescriptorData);
+
+		for (uint8_t DataIndex = 0; DataIndex < ConfigIndex.TotalInterfaces; DataIndex++)
 		{
-			if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-			{
-				Pipe_ConfigurePipe(CDCInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize, PIPE_BANK_SINGLE);
-				CDCInterfaceInfo->State.DataINPipeSize = EndpointData->EndpointSize;
+			USB_ConfigIndex_Interface_t* DataInterface = &ConfigIndex.Interfaces[DataIndex];
 
-				FoundEndpoints |= CDC_FOUND_DATAPIPE_IN;
+			if ((DataInterface->InterfaceNumber  != DataInterfaceNumber) ||
+			    (DataInterface->AlternateSetting != 0)                   ||
+			    (DataInterface->Class            != CDC_DATA_CLASS)      ||
+			    (DataInterface->SubClass         != CDC_DATA_SUBCLASS)   ||
+			    (DataInterface->Protocol         != CDC_DATA_PROTOCOL))
+			{
+				continue;
 			}
-			else
+
+			FoundDataInterface = true;
+
+			const USB_ConfigIndex_Endpoint_t* DataINEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, DataInterface,
+			                                                                                 EP_TYPE_BULK, true);
+			const USB_ConfigIndex_Endpoint_t* DataOUTEndpoint = USB_ConfigIndex_FindEndpoint(&ConfigIndex, DataInterface,
+			                                                                                 EP_TYPE_BULK, false);
+
+			/* Some devices use interrupt endpoints for their data interface, which are driven as bulk pipes */
+			if (DataINEndpoint == NULL)
+			  DataINEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, DataInterface, EP_TYPE_INTERRUPT, true);
+
+			if (DataOUTEndpoint == NULL)
+			  DataOUTEndpoint = USB_ConfigIndex_FindEndpoint(&ConfigIndex, DataInterface, EP_TYPE_INTERRUPT, false);
+
+			if ((DataINEndpoint == NULL) || (DataOUTEndpoint == NULL))
+			  continue;
+
+			/* A packet is only taken from the pipe once it fits in the receive buffer, so a smaller buffer would stall */
+			if ((CDCInterfaceInfo->Config.DataINBuffer != NULL) &&
+			    (CDCInterfaceInfo->Config.DataINBufferSize < DataINEndpoint->EndpointSize))
 			{
-				Pipe_ConfigurePipe(CDCInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize, PIPE_BANK_SINGLE);
-				CDCInterfaceInfo->State.DataOUTPipeSize = EndpointData->EndpointSize;
-				
-				FoundEndpoints |= CDC_FOUND_DATAPIPE_OUT;
+				return CDC_ENUMERROR_BufferTooSmall;
 			}
-		}
-	}
 
-	CDCInterfaceInfo->State.IsActive = true;
-	return CDC_ENUMERROR_NoError;
-}
+			Pipe_ConfigurePipe(CDCInterfaceInfo->Config.NotificationPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
+			                   NotificationEndpoint->EndpointAddress, NotificationEndpoint->EndpointSize, PIPE_BANK_SINGLE);
+			CDCInterfaceInfo->State.NotificationPipeSize = NotificationEndpoint->EndpointSize;
 
-static uint8_t DComp_CDC_Host_NextCDCControlInterface(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		USB_Descriptor_Interface_t* CurrentInterface = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                                USB_Descriptor_Interface_t);
-	
-		if ((CurrentInterface->Class    == CDC_CONTROL_CLASS)    &&
-		    (CurrentInterface->SubClass == CDC_CONTROL_SUBCLASS) &&
-			(CurrentInterface->Protocol == CDC_CONTROL_PROTOCOL))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	
-	return DESCRIPTOR_SEARCH_NotFound;
-}
+			Pipe_SetInterruptPeriod(NotificationEndpoint->PollingIntervalMS);
 
-static uint8_t DComp_CDC_Host_NextCDCDataInterface(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		USB_Descriptor_Interface_t* CurrentInterface = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                                USB_Descriptor_Interface_t);
-	
-		if ((CurrentInterface->Class    == CDC_DATA_CLASS)    &&
-		    (CurrentInterface->SubClass == CDC_DATA_SUBCLASS) &&
-			(CurrentInterface->Protocol == CDC_DATA_PROTOCOL))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	
-	return DESCRIPTOR_SEARCH_NotFound;
-}
+			Pipe_ConfigurePipe(CDCInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
+			                   DataINEndpoint->EndpointAddress, DataINEndpoint->EndpointSize, PIPE_BANK_SINGLE);
+			CDCInterfaceInfo->State.DataINPipeSize = DataINEndpoint->EndpointSize;
 
-static uint8_t DComp_CDC_Host_NextCDCInterfaceEndpoint(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Endpoint)
-	{
-		USB_Descriptor_Endpoint_t* CurrentEndpoint = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                              USB_Descriptor_Endpoint_t);
-	
-		uint8_t EndpointType = (CurrentEndpoint->Attributes & EP_TYPE_MASK);
-	
-		if (((EndpointType == EP_TYPE_BULK) || (EndpointType == EP_TYPE_INTERRUPT)) &&
-		    !(Pipe_IsEndpointBound(CurrentEndpoint->EndpointAddress)))
-		{
-			return DESCRIPTOR_SEARCH_Found;
+			Pipe_ConfigurePipe(CDCInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
+			                   DataOUTEndpoint->EndpointAddress, DataOUTEndpoint->EndpointSize, PIPE_BANK_SINGLE);
+			CDCInterfaceInfo->State.DataOUTPipeSize = DataOUTEndpoint->EndpointSize;
+
+			CDCInterfaceInfo->State.ControlInterfaceNumber = ControlInterface->InterfaceNumber;
+			CDCInterfaceInfo->State.IsActive = true;
+			return CDC_ENUMERROR_NoError;
 		}
 	}
-	else if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		return DESCRIPTOR_SEARCH_Fail;
-	}
 
-	return DESCRIPTOR_SEARCH_NotFound;
+	return (FoundDataInterface) ? CDC_ENUMERROR_EndpointsNotFound : CDC_ENUMERROR_NoCDCInterfaceFound;
 }
 
 void CDC_Host_USBTask(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
@@ -217,6 +155,9 @@ void CDC_Host_USBTask(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
 	}
 	
 	Pipe_Freeze();
+
+	if (CDCInterfaceInfo->Config.DataINBuffer != NULL)
+	  CDC_Host_FillBuffer(CDCInterfaceInfo);
 }
 
 uint8_t CDC_Host_SetLineEncoding(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
@@ -296,6 +237,12 @@ uint16_t CDC_Host_BytesReceived(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo
 
 	if ((USB_HostState != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive))
 	  return BytesInPipe;
+
+	if (CDCInterfaceInfo->Config.DataINBuffer != NULL)
+	{
+		CDC_Host_FillBuffer(CDCInterfaceInfo);
+		return CDCInterfaceInfo->State.DataINBufferCount;
+	}
 	
 	Pipe_SelectPipe(CDCInterfaceInfo->Config.DataINPipeNumber);	
 	Pipe_Unfreeze();
@@ -315,6 +262,12 @@ uint8_t CDC_Host_ReceiveByte(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
 
 	if ((USB_HostState != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive))
 	  return ReceivedByte;
+
+	if (CDCInterfaceInfo->Config.DataINBuffer != NULL)
+	{
+		CDC_Host_ReceiveData(CDCInterfaceInfo, &ReceivedByte, sizeof(ReceivedByte));
+		return ReceivedByte;
+	}
 	  
 	Pipe_SelectPipe(CDCInterfaceInfo->Config.DataINPipeNumber);	
 	Pipe_Unfreeze();
@@ -329,6 +282,156 @@ uint8_t CDC_Host_ReceiveByte(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
 	return ReceivedByte;
 }
 
+uint16_t CDC_Host_ReceiveData(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer, const uint16_t Length)
+{
+	uint16_t BytesRead;
+
+	if ((USB_HostState != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive))
+	  return 0;
+
+	if (CDCInterfaceInfo->Config.DataINBuffer != NULL)
+	{
+		CDC_Host_FillBuffer(CDCInterfaceInfo);
+
+		BytesRead = CDC_Host_CopyFromBuffer(CDCInterfaceInfo, Buffer, Length);
+
+		CDCInterfaceInfo->State.DataINBufferStart += BytesRead;
+		CDCInterfaceInfo->State.DataINBufferCount -= BytesRead;
+
+		if (CDCInterfaceInfo->State.DataINBufferStart >= CDCInterfaceInfo->Config.DataINBufferSize)
+		  CDCInterfaceInfo->State.DataINBufferStart -= CDCInterfaceInfo->Config.DataINBufferSize;
+
+		/* Room may now have been made for a packet which was held in the pipe */
+		CDC_Host_FillBuffer(CDCInterfaceInfo);
+
+		return BytesRead;
+	}
+
+	Pipe_SelectPipe(CDCInterfaceInfo->Config.DataINPipeNumber);	
+	Pipe_Unfreeze();
+
+	if (Pipe_IsINReceived() && !(Pipe_BytesInPipe()))
+	  Pipe_ClearIN();
+
+	BytesRead = Pipe_BytesInPipe();
+
+	if (BytesRead > Length)
+	  BytesRead = Length;
+
+	if (BytesRead)
+	  Pipe_Read_Stream_LE(Buffer, BytesRead, NO_STREAM_CALLBACK);
+
+	if (Pipe_IsINReceived() && !(Pipe_BytesInPipe()))
+	  Pipe_ClearIN();
+
+	Pipe_Freeze();
+
+	return BytesRead;
+}
+
+uint16_t CDC_Host_PeekData(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer, const uint16_t Length)
+{
+	if ((USB_HostState != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive) ||
+	    (CDCInterfaceInfo->Config.DataINBuffer == NULL))
+	{
+		return 0;
+	}
+
+	CDC_Host_FillBuffer(CDCInterfaceInfo);
+
+	return CDC_Host_CopyFromBuffer(CDCInterfaceInfo, Buffer, Length);
+}
+
+static uint8_t CDC_Host_GetDataInterfaceNumber(const USB_ConfigIndex_Interface_t* const ControlInterface,
+                                               const uint16_t ConfigDescriptorSize,
+                                               const uint8_t* const ConfigDescriptorData)
+{
+	uint16_t Offset = (ControlInterface->Offset + DESCRIPTOR_SIZE(&ConfigDescriptorData[ControlInterface->Offset]));
+
+	/* The control interface's functional descriptors lie between its interface descriptor and the next one */
+	while ((ConfigDescriptorSize - Offset) >= sizeof(USB_Descriptor_Header_t))
+	{
+		const uint8_t* CurrDescriptor = &ConfigDescriptorData[Offset];
+		uint8_t        CurrSize       = DESCRIPTOR_SIZE(CurrDescriptor);
+
+		if ((CurrSize < sizeof(USB_Descriptor_Header_t)) || (CurrSize > (ConfigDescriptorSize - Offset)) ||
+		    (DESCRIPTOR_TYPE(CurrDescriptor) == DTYPE_Interface))
+		{
+			break;
+		}
+
+		/* The Union descriptor holds the control interface's number, then the numbers of its subordinate interfaces */
+		if ((DESCRIPTOR_TYPE(CurrDescriptor) == CDC_DTYPE_CSInterface) && (CurrSize >= 5) &&
+		    (CurrDescriptor[2] == CDC_DSUBTYPE_CSInterface_Union))
+		{
+			return CurrDescriptor[4];
+		}
+
+		Offset += CurrSize;
+	}
+
+	return (ControlInterface->InterfaceNumber + 1);
+}
+
+static void CDC_Host_FillBuffer(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
+{
+	uint8_t* DataINBuffer = CDCInterfaceInfo->Config.DataINBuffer;
+	uint16_t BufferSize   = CDCInterfaceInfo->Config.DataINBufferSize;
+
+	Pipe_SelectPipe(CDCInterfaceInfo->Config.DataINPipeNumber);
+
+	// the pipe is left unfrozen so that the next packet can arrive while the application runs
+	Pipe_Unfreeze();
+
+	while (Pipe_IsINReceived())
+	{
+		uint16_t BytesInPipe = Pipe_BytesInPipe();
+
+		// a packet which does not fit is left in the pipe, which NAKs the device until there is room for it
+		if (BytesInPipe > (BufferSize - CDCInterfaceInfo->State.DataINBufferCount))
+		  break;
+
+		uint16_t BufferEnd = (CDCInterfaceInfo->State.DataINBufferStart + CDCInterfaceInfo->State.DataINBufferCount);
+
+		if (BufferEnd >= BufferSize)
+		  BufferEnd -= BufferSize;
+
+		uint16_t FirstBytes = (BufferSize - BufferEnd);
+
+		if (FirstBytes > BytesInPipe)
+		  FirstBytes = BytesInPipe;
+
+		if (FirstBytes)
+		  Pipe_Read_Stream_LE(&DataINBuffer[BufferEnd], FirstBytes, NO_STREAM_CALLBACK);
+
+		if (BytesInPipe - FirstBytes)
+		  Pipe_Read_Stream_LE(DataINBuffer, (BytesInPipe - FirstBytes), NO_STREAM_CALLBACK);
+
+		CDCInterfaceInfo->State.DataINBufferCount += BytesInPipe;
+
+		Pipe_ClearIN();
+	}
+}
+
+static uint16_t CDC_Host_CopyFromBuffer(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer, uint16_t Length)
+{
+	uint8_t* DataINBuffer = CDCInterfaceInfo->Config.DataINBuffer;
+	uint16_t BufferStart  = CDCInterfaceInfo->State.DataINBufferStart;
+
+	if (Length > CDCInterfaceInfo->State.DataINBufferCount)
+	  Length = CDCInterfaceInfo->State.DataINBufferCount;
+
+	uint16_t FirstBytes = (CDCInterfaceInfo->Config.DataINBufferSize - BufferStart);
+
+	if (FirstBytes > Length)
+	  FirstBytes = Length;
+
+	memcpy(Buffer, &DataINBuffer[BufferStart], FirstBytes);
+	memcpy(&Buffer[FirstBytes], DataINBuffer, (Length - FirstBytes));
+
+	return Length;
+}
+
 void CDC_Host_Event_Stub(void)
 {
 
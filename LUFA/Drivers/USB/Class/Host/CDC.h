@@ -38,6 +38,12 @@
  *  \section Module Description
  *  Host Mode USB Class driver framework interface, for the CDC USB Class driver.
  *
+ *  Data received from the attached device may optionally be buffered by the driver. When a receive buffer is given in
+ *  the interface's configuration, \ref CDC_Host_USBTask() drains each packet arriving on the data IN pipe into it as a
+ *  ring buffer, and the data IN pipe is left running between calls so that the next packet can be received in the
+ *  background. Received data can then be read or peeked at in blocks without touching the pipe. A packet is left in
+ *  the pipe until the buffer has room for all of it, which holds off the device until the application catches up.
+ *
  *  @{
  */
 
@@ -66,6 +72,15 @@
 					uint8_t  DataINPipeNumber; /**< Pipe number of the CDC interface's IN data pipe */
 					uint8_t  DataOUTPipeNumber; /**< Pipe number of the CDC interface's OUT data pipe */
 					uint8_t  NotificationPipeNumber; /**< Pipe number of the CDC interface's IN notification endpoint, if used */			
+
+					uint8_t* DataINBuffer; /**< Pointer to a buffer where data received from the device is to be stored until
+					                        *   it is read by the application, or NULL to read data directly from the data IN
+					                        *   pipe
+					                        */
+					uint16_t DataINBufferSize; /**< Size in bytes of the receive buffer, if used. This must be at least
+					                            *   as large as the device's data IN endpoint, or \ref CDC_Host_ConfigurePipes()
+					                            *   will fail, and should ideally be several times larger
+					                            */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -81,6 +96,9 @@
 					uint16_t DataOUTPipeSize;  /**< Size in bytes of the CDC interface's OUT data pipe */
 					uint16_t NotificationPipeSize;  /**< Size in bytes of the CDC interface's IN notification pipe, if used */
 
+					uint16_t DataINBufferStart; /**< Index within the receive buffer of the oldest buffered byte, if used */
+					uint16_t DataINBufferCount; /**< Number of received bytes waiting in the receive buffer, if used */
+
 					struct
 					{
 						uint8_t HostToDevice; /**< Control line states from the host to device, as a set of CDC_CONTROL_LINE_OUT_*
@@ -116,6 +134,7 @@
 				CDC_ENUMERROR_InvalidConfigDescriptor    = 1, /**< The device returned an invalid Configuration Descriptor */
 				CDC_ENUMERROR_NoCDCInterfaceFound        = 2, /**< A compatible CDC interface was not found in the device's Configuration Descriptor */
 				CDC_ENUMERROR_EndpointsNotFound          = 3, /**< Compatible CDC endpoints were not found in the device's CDC interface */
+				CDC_ENUMERROR_BufferTooSmall             = 4, /**< The interface's receive buffer is smaller than the device's data IN endpoint */
 			};
 	
 		/* Function Prototypes: */
@@ -132,6 +151,10 @@
 			 *  This should be called once after the stack has enumerated the attached device, while the host state machine is in
 			 *  the Addressed state.
 			 *
+			 *  \note Only the default alternate setting of each interface is used, as no SET_INTERFACE request is sent. The
+			 *        data interface used is the one named by the control interface's Union functional descriptor, or the
+			 *        next interface after it if the device has no Union functional descriptor.
+			 *
 			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing an CDC Class host configuration and state
 			 *  \param[in] ConfigDescriptorSize  Length of the attached device's Configuration Descriptor
 			 *  \param[in] DeviceConfigDescriptor  Pointer to a buffer containing the attached device's Configuration Descriptor
@@ -199,6 +222,32 @@
 			 *  \return Next received byte from the device, or 0 if no data received
 			 */
 			uint8_t CDC_Host_ReceiveByte(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Reads a block of data received from the device, up to the given length. If the interface has a receive buffer, data
+			 *  is copied out of it in at most two contiguous runs; otherwise data is read from at most one packet waiting in the
+			 *  data IN pipe.
+			 *
+			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class host configuration and state
+			 *  \param[out] Buffer  Pointer to a buffer where the received data is to be placed
+			 *  \param[in] Length  Maximum number of bytes to place into the buffer
+			 *
+			 *  \return Number of bytes read, zero if no data was waiting or a device is not connected
+			 */
+			uint16_t CDC_Host_ReceiveData(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer,
+			                              const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Copies a block of data received from the device, up to the given length, without removing it from the interface's
+			 *  receive buffer, so that the application can scan for the end of a line or message before reading it. As data cannot
+			 *  be returned to the data IN pipe once read, this requires the interface to have a receive buffer.
+			 *
+			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class host configuration and state
+			 *  \param[out] Buffer  Pointer to a buffer where the received data is to be placed
+			 *  \param[in] Length  Maximum number of bytes to place into the buffer
+			 *
+			 *  \return Number of bytes copied, zero if no data was waiting or the interface has no receive buffer
+			 */
+			uint16_t CDC_Host_PeekData(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer,
+			                           const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1, 2);
 			
 			/** CDC class driver event for a control line state change on a CDC host interface. This event fires each time the device notifies
 			 *  the host of a control line state change (containing the virtual serial control line states, such as DCD) and may be hooked in the
@@ -220,18 +269,21 @@
 			#define CDC_DATA_SUBCLASS               0x00
 			#define CDC_DATA_PROTOCOL               0x00
 			
-			#define CDC_FOUND_DATAPIPE_IN           (1 << 0)
-			#define CDC_FOUND_DATAPIPE_OUT          (1 << 1)
-			#define CDC_FOUND_NOTIFICATION_IN       (1 << 2)
+			#define CDC_DTYPE_CSInterface           0x24
+			#define CDC_DSUBTYPE_CSInterface_Union  0x06
 
 		/* Function Prototypes: */
 			#if defined(INCLUDE_FROM_CDC_CLASS_HOST_C)
+				static uint8_t CDC_Host_GetDataInterfaceNumber(const USB_ConfigIndex_Interface_t* const ControlInterface,
+				                                               const uint16_t ConfigDescriptorSize,
+				                                               const uint8_t* const ConfigDescriptorData);
+				static void CDC_Host_FillBuffer(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo);
+				static uint16_t CDC_Host_CopyFromBuffer(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo, uint8_t* Buffer,
+				                                        uint16_t Length);
+
 				void CDC_Host_Event_Stub(void);
 				void EVENT_CDC_Host_ControLineStateChanged(USB_ClassInfo_CDC_Host_t* CDCInterfaceInfo)
 				                                           ATTR_WEAK ATTR_NON_NULL_PTR_ARG(1) ATTR_ALIAS(CDC_Host_Event_Stub);
-				static uint8_t DComp_CDC_Host_NextCDCControlInterface(void* CurrentDescriptor) ATTR_NON_NULL_PTR_ARG(1);
-				static uint8_t DComp_CDC_Host_NextCDCDataInterface(void* CurrentDescriptor) ATTR_NON_NULL_PTR_ARG(1);
-				static uint8_t DComp_CDC_Host_NextCDCInterfaceEndpoint(void* CurrentDescriptor);
 			#endif	
 	#endif
 				
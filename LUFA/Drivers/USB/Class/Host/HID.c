@@ -37,87 +37,64 @@
 uint8_t HID_Host_ConfigurePipes(USB_ClassInfo_HID_Host_t* const HIDInterfaceInfo, uint16_t ConfigDescriptorSize,
                                 uint8_t* ConfigDescriptorData)
 {
-	uint8_t FoundEndpoints = 0;
+	USB_ConfigIndex_t ConfigIndex;
+	bool              FoundHIDInterface = false;
 
 	memset(&HIDInterfaceInfo->State, 0x00, sizeof(HIDInterfaceInfo->State));
 
-	if (DESCRIPTOR_TYPE(ConfigDescriptorData) != DTYPE_Configuration)
+	if (USB_GetConfigIndex(&ConfigIndex, ConfigDescriptorSize, ConfigDescriptorData) == CONFIGINDEX_InvalidConfigDescriptor)
 	  return HID_ENUMERROR_InvalidConfigDescriptor;
-	
-	USB_Descriptor_Interface_t* CurrentHIDInterface;
-	
-	do
+
+	for (uint8_t InterfaceIndex = 0; InterfaceIndex < ConfigIndex.TotalInterfaces; InterfaceIndex++)
 	{
-		if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-									  DComp_HID_Host_NextHIDInterface) != DESCRIPTOR_SEARCH_COMP_Found)
+		USB_ConfigIndex_Interface_t* HIDInterface = &ConfigIndex.Interfaces[InterfaceIndex];
+
+		if ((HIDInterface->Class != HID_INTERFACE_CLASS) ||
+		    (HIDInterfaceInfo->Config.HIDInterfaceProtocol &&
+		     (HIDInterface->Protocol != HIDInterfaceInfo->Config.HIDInterfaceProtocol)))
 		{
-			return HID_ENUMERROR_NoHIDInterfaceFound;
+			continue;
 		}
-		
-		CurrentHIDInterface = DESCRIPTOR_PCAST(ConfigDescriptorData, USB_Descriptor_Interface_t);
-	} while (HIDInterfaceInfo->Config.HIDInterfaceProtocol &&
-	         (CurrentHIDInterface->Protocol != HIDInterfaceInfo->Config.HIDInterfaceProtocol));
 
-	HIDInterfaceInfo->State.InterfaceNumber      = CurrentHIDInterface->InterfaceNumber;
-	HIDInterfaceInfo->State.SupportsBootProtocol = (CurrentHIDInterface->SubClass != HID_NON_BOOT_PROTOCOL);
+		FoundHIDInterface = true;
 
-	if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData, DComp_NextHID) != DESCRIPTOR_SEARCH_COMP_Found)
-	{
-		return HID_ENUMERROR_NoHIDDescriptorFound;
-	}
+		const USB_ConfigIndex_Endpoint_t* DataINEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, HIDInterface,
+		                                                                                 EP_TYPE_INTERRUPT, true);
+		const USB_ConfigIndex_Endpoint_t* DataOUTEndpoint = USB_ConfigIndex_FindEndpoint(&ConfigIndex, HIDInterface,
+		                                                                                 EP_TYPE_INTERRUPT, false);
 
-	HIDInterfaceInfo->State.HIDReportSize = DESCRIPTOR_CAST(ConfigDescriptorData, USB_HID_Descriptor_t).HIDReportLength;
+		if (DataINEndpoint == NULL)
+		  continue;
 
-	while (FoundEndpoints != (HID_FOUND_DATAPIPE_IN | HID_FOUND_DATAPIPE_OUT))
-	{
-		if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &ConfigDescriptorData,
-		                              DComp_HID_Host_NextHIDInterfaceEndpoint) != DESCRIPTOR_SEARCH_COMP_Found)
-		{
-			if (FoundEndpoints & HID_FOUND_DATAPIPE_IN)
-			  break;
-				
-			return HID_ENUMERROR_EndpointsNotFound;
-		}
-		
-		USB_Descriptor_Endpoint_t* EndpointData = DESCRIPTOR_PCAST(ConfigDescriptorData, USB_Descriptor_Endpoint_t);
+		uint8_t* HIDDescriptor     = &ConfigDescriptorData[HIDInterface->Offset];
+		uint16_t HIDDescriptorSize = (ConfigDescriptorSize - HIDInterface->Offset);
 
-		if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-		{
-			Pipe_ConfigurePipe(HIDInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
-							   EndpointData->EndpointAddress, EndpointData->EndpointSize, PIPE_BANK_SINGLE);
-			HIDInterfaceInfo->State.DataINPipeSize = EndpointData->EndpointSize;
-			
-			FoundEndpoints |= HID_FOUND_DATAPIPE_IN;
-		}
-		else
+		if (USB_GetNextDescriptorComp(&HIDDescriptorSize, &HIDDescriptor, DComp_NextHID) != DESCRIPTOR_SEARCH_COMP_Found)
+		  return HID_ENUMERROR_NoHIDDescriptorFound;
+
+		HIDInterfaceInfo->State.HIDReportSize = DESCRIPTOR_CAST(HIDDescriptor, USB_HID_Descriptor_t).HIDReportLength;
+
+		Pipe_ConfigurePipe(HIDInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
+		                   DataINEndpoint->EndpointAddress, DataINEndpoint->EndpointSize, PIPE_BANK_SINGLE);
+		HIDInterfaceInfo->State.DataINPipeSize = DataINEndpoint->EndpointSize;
+
+		if (DataOUTEndpoint != NULL)
 		{
 			Pipe_ConfigurePipe(HIDInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_OUT,
-							   EndpointData->EndpointAddress, EndpointData->EndpointSize, PIPE_BANK_SINGLE);
-			HIDInterfaceInfo->State.DataOUTPipeSize = EndpointData->EndpointSize;
-			
+			                   DataOUTEndpoint->EndpointAddress, DataOUTEndpoint->EndpointSize, PIPE_BANK_SINGLE);
+			HIDInterfaceInfo->State.DataOUTPipeSize = DataOUTEndpoint->EndpointSize;
+
 			HIDInterfaceInfo->State.DeviceUsesOUTPipe = true;
-			
-			FoundEndpoints |= HID_FOUND_DATAPIPE_OUT;		
 		}
-	}
 
-	HIDInterfaceInfo->State.LargestReportSize = 8;
-	HIDInterfaceInfo->State.IsActive = true;
-	return HID_ENUMERROR_NoError;
-}
-
-static uint8_t DComp_HID_Host_NextHIDInterface(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		USB_Descriptor_Interface_t* CurrentInterface = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                                USB_Descriptor_Interface_t);
-	
-		if (CurrentInterface->Class == HID_INTERFACE_CLASS)
-		  return DESCRIPTOR_SEARCH_Found;
+		HIDInterfaceInfo->State.InterfaceNumber      = HIDInterface->InterfaceNumber;
+		HIDInterfaceInfo->State.SupportsBootProtocol = (HIDInterface->SubClass != HID_NON_BOOT_PROTOCOL);
+		HIDInterfaceInfo->State.LargestReportSize    = 8;
+		HIDInterfaceInfo->State.IsActive = true;
+		return HID_ENUMERROR_NoError;
 	}
-	
-	return DESCRIPTOR_SEARCH_NotFound;
+
+	return (FoundHIDInterface) ? HID_ENUMERROR_EndpointsNotFound : HID_ENUMERROR_NoHIDInterfaceFound;
 }
 
 static uint8_t DComp_NextHID(void* CurrentDescriptor)
@@ -130,24 +107,6 @@ static uint8_t DComp_NextHID(void* CurrentDescriptor)
 	  return DESCRIPTOR_SEARCH_NotFound;	  
 }
 
-static uint8_t DComp_HID_Host_NextHIDInterfaceEndpoint(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Endpoint)
-	{
-		USB_Descriptor_Endpoint_t* CurrentEndpoint = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                              USB_Descriptor_Endpoint_t);	
-
-		if (!(Pipe_IsEndpointBound(CurrentEndpoint->EndpointAddress)))
-		  return DESCRIPTOR_SEARCH_Found;
-	}
-	else if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		return DESCRIPTOR_SEARCH_Fail;
-	}
-
-	return DESCRIPTOR_SEARCH_NotFound;
-}
-
 void HID_Host_USBTask(USB_ClassInfo_HID_Host_t* const HIDInterfaceInfo)
 {
 
@@ -341,7 +300,7 @@ uint8_t HID_Host_SetReportProtocol(USB_ClassInfo_HID_Host_t* const HIDInterfaceI
 		return HID_ERROR_LOGICAL | ErrorCode;
 	}
 
-	uint8_t LargestReportSizeBits = HIDInterfaceInfo->Config.HIDParserData->LargestReportSizeBits;
+	uint16_t LargestReportSizeBits = HIDInterfaceInfo->Config.HIDParserData->LargestReportSizeBits;
 	HIDInterfaceInfo->State.LargestReportSize = (LargestReportSizeBits >> 3) + ((LargestReportSizeBits & 0x07) != 0);
 
 	return 0;
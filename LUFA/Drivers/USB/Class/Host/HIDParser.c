@@ -33,21 +33,20 @@
 
 #include "HIDParser.h"
 
-uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID_ReportInfo_t* const ParserData)
+static uint8_t USB_ParseHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID_ParserState_t* const State)
 {
 	HID_StateTable_t      StateTable[HID_STATETABLE_STACK_DEPTH];
 	HID_StateTable_t*     CurrStateTable          = &StateTable[0];
 	HID_CollectionPath_t* CurrCollectionPath      = NULL;
-	HID_ReportSizeInfo_t* CurrReportIDInfo        = &ParserData->ReportIDSizes[0];			
+	HID_ReportSizeInfo_t* CurrReportIDInfo        = &State->ReportIDSizes[0];			
 	uint16_t              UsageStack[HID_USAGE_STACK_DEPTH];
 	uint8_t               UsageStackSize          = 0;
+	uint8_t               ErrorCode;
 
-	ParserData->TotalReportItems   = 0;
-	ParserData->TotalDeviceReports = 1;
-	ParserData->UsingReportIDs     = false;
-	
-	for (uint8_t CurrCollection = 0; CurrCollection < HID_MAX_COLLECTIONS; CurrCollection++)
-	  ParserData->CollectionPaths[CurrCollection].Parent = NULL;
+	State->TotalCollections      = 0;
+	State->TotalDeviceReports    = 1;
+	State->LargestReportSizeBits = 0;
+	State->UsingReportIDs        = false;
 
 	memset(CurrStateTable,   0x00, sizeof(HID_StateTable_t));
 	memset(CurrReportIDInfo, 0x00, sizeof(HID_ReportSizeInfo_t));
@@ -56,6 +55,7 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 	{
 		uint8_t  HIDReportItem  = *ReportData;
 		uint32_t ReportItemData = 0;
+		uint8_t  DataBytes      = 0;
 		
 		ReportData++;
 		ReportSize--;
@@ -63,22 +63,25 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 		switch (HIDReportItem & DATA_SIZE_MASK)
 		{
 			case DATA_SIZE_4:
-				ReportItemData  = *((uint32_t*)ReportData);
-				ReportSize     -= 4;
-				ReportData     += 4;
+				DataBytes = 4;
 				break;
 			case DATA_SIZE_2:
-				ReportItemData  = *((uint16_t*)ReportData);
-				ReportSize     -= 2;
-				ReportData     += 2;
+				DataBytes = 2;
 				break;
 			case DATA_SIZE_1:
-				ReportItemData  = *((uint8_t*)ReportData);
-				ReportSize     -= 1;
-				ReportData     += 1;
+				DataBytes = 1;
 				break;
 		}
 
+		if (ReportSize < DataBytes)
+		  return HID_PARSE_TruncatedReportItem;
+
+		for (uint8_t i = 0; i < DataBytes; i++)
+		  ReportItemData |= ((uint32_t)ReportData[i] << (i * 8));
+
+		ReportSize -= DataBytes;
+		ReportData += DataBytes;
+
 		switch (HIDReportItem & (TYPE_MASK | TAG_MASK))
 		{
 			case (TYPE_GLOBAL | TAG_GLOBAL_PUSH):
@@ -87,7 +90,7 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 	
 				memcpy((CurrStateTable + 1),
 				       CurrStateTable,
-				       sizeof(HID_ReportItem_t));
+				       sizeof(HID_StateTable_t));
 
 				CurrStateTable++;
 				break;
@@ -127,30 +130,30 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 			case (TYPE_GLOBAL | TAG_GLOBAL_REPORTID):
 				CurrStateTable->ReportID                    = ReportItemData;
 
-				if (ParserData->UsingReportIDs)
+				if (State->UsingReportIDs)
 				{
 					CurrReportIDInfo = NULL;
 
-					for (uint8_t i = 0; i < ParserData->TotalDeviceReports; i++)
+					for (uint8_t i = 0; i < State->TotalDeviceReports; i++)
 					{
-						if (ParserData->ReportIDSizes[i].ReportID == CurrStateTable->ReportID)
+						if (State->ReportIDSizes[i].ReportID == CurrStateTable->ReportID)
 						{
-							CurrReportIDInfo = &ParserData->ReportIDSizes[i];
+							CurrReportIDInfo = &State->ReportIDSizes[i];
 							break;
 						}
 					}
 					
 					if (CurrReportIDInfo == NULL)
 					{
-						if (ParserData->TotalDeviceReports++ > HID_MAX_REPORT_IDS)
+						if (State->TotalDeviceReports == HID_MAX_REPORT_IDS)
 						  return HID_PARSE_InsufficientReportIDItems;
 					
-						CurrReportIDInfo = &ParserData->ReportIDSizes[ParserData->TotalDeviceReports - 1];
+						CurrReportIDInfo = &State->ReportIDSizes[State->TotalDeviceReports++];
 						memset(CurrReportIDInfo, 0x00, sizeof(HID_ReportSizeInfo_t));
 					}
 				}
 
-				ParserData->UsingReportIDs = true;				
+				State->UsingReportIDs = true;				
 
 				CurrReportIDInfo->ReportID     = CurrStateTable->ReportID;
 				break;
@@ -167,26 +170,13 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 				CurrStateTable->Attributes.Usage.MinMax.Maximum = ReportItemData;
 				break;
 			case (TYPE_MAIN | TAG_MAIN_COLLECTION):
-				if (CurrCollectionPath == NULL)
-				{
-					CurrCollectionPath = &ParserData->CollectionPaths[0];
-				}
-				else
-				{
-					HID_CollectionPath_t* ParentCollectionPath = CurrCollectionPath;
-			
-					CurrCollectionPath = &ParserData->CollectionPaths[1];
+				if (State->TotalCollections == HID_MAX_COLLECTIONS)
+				  return HID_PARSE_InsufficientCollectionPaths;
 
-					while (CurrCollectionPath->Parent != NULL);
-					{
-						if (CurrCollectionPath == &ParserData->CollectionPaths[HID_MAX_COLLECTIONS - 1])
-						  return HID_PARSE_InsufficientCollectionPaths;
-					
-						CurrCollectionPath++;
-					}
+				HID_CollectionPath_t* ParentCollectionPath = CurrCollectionPath;
 
-					CurrCollectionPath->Parent = ParentCollectionPath;
-				}
+				CurrCollectionPath = &State->CollectionPaths[State->TotalCollections++];
+				CurrCollectionPath->Parent = ParentCollectionPath;
 				
 				CurrCollectionPath->Type = ReportItemData;
 				CurrCollectionPath->Usage.Page = CurrStateTable->Attributes.Usage.Page;
@@ -195,8 +185,8 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 				{
 					CurrCollectionPath->Usage.Usage = UsageStack[0];
 
-					for (uint8_t i = 0; i < UsageStackSize; i++)
-					  UsageStack[i] = UsageStack[i + 1];
+					for (uint8_t i = 1; i < UsageStackSize; i++)
+					  UsageStack[i - 1] = UsageStack[i];
 					  
 					UsageStackSize--;
 				}
@@ -212,6 +202,9 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 		
 				CurrCollectionPath = CurrCollectionPath->Parent;
 
+				if (State->FreeEndedCollections)
+				  State->TotalCollections--;
+
 				break;
 			case (TYPE_MAIN | TAG_MAIN_INPUT):
 			case (TYPE_MAIN | TAG_MAIN_OUTPUT):
@@ -227,13 +220,14 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 					NewReportItem.ItemFlags      = ReportItemData;
 					NewReportItem.CollectionPath = CurrCollectionPath;
 					NewReportItem.ReportID       = CurrStateTable->ReportID;
+					NewReportItem.Value          = 0;
 
 					if (UsageStackSize)
 					{
 						NewReportItem.Attributes.Usage.Usage = UsageStack[0];
 
-						for (uint8_t i = 0; i < UsageStackSize; i++)
-						  UsageStack[i] = UsageStack[i + 1];
+						for (uint8_t i = 1; i < UsageStackSize; i++)
+						  UsageStack[i - 1] = UsageStack[i];
 						  
 						UsageStackSize--;
 					}
@@ -268,19 +262,11 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 					
 					CurrReportIDInfo->ReportSizeBits[ReportSizeIndex] += CurrStateTable->Attributes.BitSize;
 
-					if (ParserData->LargestReportSizeBits < CurrReportIDInfo->ReportSizeBits[ReportSizeIndex])
-					  ParserData->LargestReportSizeBits = CurrReportIDInfo->ReportSizeBits[ReportSizeIndex];
-					
-					if (!(ReportItemData & IOF_CONSTANT) && CALLBACK_HIDParser_FilterHIDReportItem(&CurrStateTable->Attributes))
-					{					
-						if (ParserData->TotalReportItems == HID_MAX_REPORTITEMS)
-						  return HID_PARSE_InsufficientReportItems;
-					
-						memcpy(&ParserData->ReportItems[ParserData->TotalReportItems],
-						       &NewReportItem, sizeof(HID_ReportItem_t));
+					if (State->LargestReportSizeBits < CurrReportIDInfo->ReportSizeBits[ReportSizeIndex])
+					  State->LargestReportSizeBits = CurrReportIDInfo->ReportSizeBits[ReportSizeIndex];
 					
-						ParserData->TotalReportItems++;
-					}
+					if ((ErrorCode = State->ItemSink(State, &NewReportItem)) != HID_PARSE_Successful)
+					  return ErrorCode;
 				}
 				
 				UsageStackSize = 0;
@@ -296,12 +282,80 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID
 		}
 	}
 	
+	return HID_PARSE_Successful;
+}
+
+static uint8_t USB_StoreHIDReportItem(HID_ParserState_t* const State, HID_ReportItem_t* const ReportItem)
+{
+	HID_ReportInfo_t* ParserData = State->ParserData;
+
+	if ((ReportItem->ItemFlags & IOF_CONSTANT) || !(CALLBACK_HIDParser_FilterHIDReportItem(&ReportItem->Attributes)))
+	  return HID_PARSE_Successful;
+
+	if (ParserData->TotalReportItems == HID_MAX_REPORTITEMS)
+	  return HID_PARSE_InsufficientReportItems;
+
+	memcpy(&ParserData->ReportItems[ParserData->TotalReportItems], ReportItem, sizeof(HID_ReportItem_t));
+
+	ParserData->TotalReportItems++;
+
+	return HID_PARSE_Successful;
+}
+
+static uint8_t USB_StreamHIDReportItem(HID_ParserState_t* const State, HID_ReportItem_t* const ReportItem)
+{
+	if (!(State->ItemCallback(ReportItem)))
+	  return HID_PARSE_StreamAborted;
+
+	return HID_PARSE_Successful;
+}
+
+uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID_ReportInfo_t* const ParserData)
+{
+	HID_ParserState_t State =
+		{
+			.CollectionPaths      = ParserData->CollectionPaths,
+			.FreeEndedCollections = false,
+			.ReportIDSizes        = ParserData->ReportIDSizes,
+			.ItemSink             = USB_StoreHIDReportItem,
+			.ParserData           = ParserData,
+		};
+	uint8_t ErrorCode;
+
+	ParserData->TotalReportItems = 0;
+
+	ErrorCode = USB_ParseHIDReport(ReportData, ReportSize, &State);
+
+	ParserData->TotalDeviceReports    = State.TotalDeviceReports;
+	ParserData->LargestReportSizeBits = State.LargestReportSizeBits;
+	ParserData->UsingReportIDs        = State.UsingReportIDs;
+
+	if (ErrorCode != HID_PARSE_Successful)
+	  return ErrorCode;
+
 	if (!(ParserData->TotalReportItems))
 	  return HID_PARSE_NoUnfilteredReportItems;
 	
 	return HID_PARSE_Successful;
 }
 
+uint8_t USB_StreamHIDReport(const uint8_t* ReportData, uint16_t ReportSize, const HID_ReportItemCallbackPtr_t ItemCallback)
+{
+	HID_CollectionPath_t CollectionPaths[HID_MAX_COLLECTIONS];
+	HID_ReportSizeInfo_t ReportIDSizes[HID_MAX_REPORT_IDS];
+
+	HID_ParserState_t State =
+		{
+			.CollectionPaths      = CollectionPaths,
+			.FreeEndedCollections = true,
+			.ReportIDSizes        = ReportIDSizes,
+			.ItemSink             = USB_StreamHIDReportItem,
+			.ItemCallback         = ItemCallback,
+		};
+
+	return USB_ParseHIDReport(ReportData, ReportSize, &State);
+}
+
 bool USB_GetHIDReportItemInfo(const uint8_t* ReportData, HID_ReportItem_t* const ReportItem)
 {
 	uint16_t DataBitsRem  = ReportItem->Attributes.BitSize;
@@ -352,6 +406,95 @@ void USB_SetHIDReportItemInfo(uint8_t* ReportData, const HID_ReportItem_t* Repor
 	}
 }
 
+bool USB_CompileHIDReportPlan(HID_ReportInfo_t* const ParserData, const uint8_t ReportID,
+                              const uint8_t ReportType, HID_ReportPlan_t* const Plan)
+{
+	Plan->ReportID   = ReportID;
+	Plan->TotalSteps = 0;
+
+	for (uint8_t ItemIndex = 0; ItemIndex < ParserData->TotalReportItems; ItemIndex++)
+	{
+		HID_ReportItem_t* ReportItem = &ParserData->ReportItems[ItemIndex];
+
+		if ((ReportItem->ItemType != ReportType) || (ReportItem->ReportID != ReportID))
+		  continue;
+
+		HID_ReportPlanStep_t* Step    = &Plan->Steps[Plan->TotalSteps++];
+		uint8_t               BitSize = ReportItem->Attributes.BitSize;
+
+		if (BitSize > 32)
+		  BitSize = 32;
+
+		Step->ReportItem = ReportItem;
+		Step->ByteOffset = (ReportItem->BitOffset / 8);
+		Step->BitShift   = (ReportItem->BitOffset % 8);
+		Step->TotalBytes = (BitSize) ? ((Step->BitShift + BitSize + 7) / 8) : 0;
+
+		if (!(BitSize) || (!(Step->BitShift) && !(BitSize % 8)))
+		  Step->Mask = 0;
+		else
+		  Step->Mask = (0xFFFFFFFF >> (32 - BitSize));
+	}
+
+	return (Plan->TotalSteps != 0);
+}
+
+bool USB_ExecuteHIDReportPlan(const uint8_t* ReportData, const HID_ReportPlan_t* const Plan)
+{
+	if (Plan->ReportID)
+	{
+		if (Plan->ReportID != ReportData[0])
+		  return false;
+
+		ReportData++;
+	}
+
+	const HID_ReportPlanStep_t* Step = Plan->Steps;
+
+	for (uint8_t StepsRem = Plan->TotalSteps; StepsRem; StepsRem--, Step++)
+	{
+		const uint8_t* ItemData = &ReportData[Step->ByteOffset];
+		uint32_t       Value;
+
+		switch (Step->TotalBytes)
+		{
+			case 0:
+				Value = 0;
+				break;
+			case 1:
+				Value = ItemData[0];
+				break;
+			case 2:
+				Value = (ItemData[0] | ((uint16_t)ItemData[1] << 8));
+				break;
+			case 3:
+				Value = (ItemData[0] | ((uint16_t)ItemData[1] << 8) | ((uint32_t)ItemData[2] << 16));
+				break;
+			default:
+				Value = (ItemData[0] | ((uint16_t)ItemData[1] << 8) | ((uint32_t)ItemData[2] << 16) |
+				         ((uint32_t)ItemData[3] << 24));
+				break;
+		}
+
+		if (Step->Mask)
+		{
+			if (Step->BitShift)
+			{
+				Value >>= Step->BitShift;
+
+				if (Step->TotalBytes == 5)
+				  Value |= ((uint32_t)ItemData[4] << (32 - Step->BitShift));
+			}
+
+			Value &= Step->Mask;
+		}
+
+		Step->ReportItem->Value = Value;
+	}
+
+	return true;
+}
+
 uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData, const uint8_t ReportID, const uint8_t ReportType)
 {
 	for (uint8_t i = 0; i < HID_MAX_REPORT_IDS; i++)
@@ -49,7 +49,8 @@
  *  item's IN, OUT and FEATURE items along with each item's attributes.
  *
  *  This library portion also allows for easy setting and retrieval of data from a HID report, including devices
- *  with multiple reports on the one HID interface.
+ *  with multiple reports on the one HID interface. Applications which decode every incoming report can compile
+ *  an extraction plan for each report once after parsing, and then retrieve all of a report's items in one call.
  *
  *  @{
  */
@@ -97,7 +98,8 @@
 			 *  processed in the report item descriptor. A large value allows for more COLLECTION items to be
 			 *  processed, but consumes more memory. By default this is set to 5 collections, but this can be
 			 *  overridden by defining HID_MAX_COLLECTIONS to another value in the user project makefile, passing
-			 *  the define to the compiler using the -D compiler switch.
+			 *  the define to the compiler using the -D compiler switch. When reports are parsed with \ref USB_StreamHIDReport(),
+			 *  this limits the nesting depth of COLLECTION items rather than their total number.
 			 */
 			#define HID_MAX_COLLECTIONS           5
 		#endif
@@ -145,6 +147,8 @@
 				HID_PARSE_UsageStackOverflow          = 6, /**< More than \ref HID_USAGE_STACK_DEPTH usages listed in a row. */
 				HID_PARSE_InsufficientReportIDItems   = 7, /**< More than \ref HID_MAX_REPORT_IDS report IDs in the device. */
 				HID_PARSE_NoUnfilteredReportItems     = 8, /**< All report items from the device were filtered by the filtering callback routine. */
+				HID_PARSE_StreamAborted               = 9, /**< The item callback given to \ref USB_StreamHIDReport() stopped the parse. */
+				HID_PARSE_TruncatedReportItem         = 10, /**< The report descriptor ended part way through an item's data. */
 			};
 		
 		/* Type Defines: */		
@@ -209,7 +213,7 @@
 			typedef struct
 			{
 				uint8_t                      ReportID; /** Report ID of the report within the HID interface */
-				uint8_t                      ReportSizeBits[3]; /** Total number of bits in each report type for the given Report ID,
+				uint16_t                     ReportSizeBits[3]; /** Total number of bits in each report type for the given Report ID,
 				                                                 *  indexed by the \ref HID_ReportItemTypes_t enum
 																 */
 			} HID_ReportSizeInfo_t;
@@ -233,6 +237,41 @@
 				                                              *   element in its HID report descriptor.
 				                                              */
 			} HID_ReportInfo_t;
+
+			/** Type define for a single step of a \ref HID_ReportPlan_t extraction plan, holding the precomputed position
+			 *  of one report item within its report.
+			 */
+			typedef struct
+			{
+				HID_ReportItem_t*            ReportItem; /**< Report item whose Value member is set by the step. */
+				uint16_t                     ByteOffset; /**< Offset of the item's first byte in the report, after any report ID. */
+				uint8_t                      BitShift;   /**< Position of the item's least significant bit in its first byte. */
+				uint8_t                      TotalBytes; /**< Number of report bytes the item spans, from 0 to 5. */
+				uint32_t                     Mask;       /**< Mask applied to the item's value once shifted into place, or 0 if
+				                                          *   the item fills whole bytes and needs neither shifting nor masking.
+				                                          */
+			} HID_ReportPlanStep_t;
+
+			/** Type define for a compiled extraction plan, which decodes all the items of one report in a single pass. Plans
+			 *  are built from a processed \ref HID_ReportInfo_t structure by \ref USB_CompileHIDReportPlan(), and reference
+			 *  its report items, so the structure must remain in memory while the plan is in use.
+			 */
+			typedef struct
+			{
+				uint8_t                      ReportID;   /**< Report ID of the report the plan decodes, or 0x00 if the device has
+				                                          *   only one report.
+				                                          */
+				uint8_t                      TotalSteps; /**< Total number of steps stored in the Steps array. */
+				HID_ReportPlanStep_t         Steps[HID_MAX_REPORTITEMS]; /**< Extraction steps, one per report item. */
+			} HID_ReportPlan_t;
+
+			/** Type define for a report item callback given to \ref USB_StreamHIDReport(), which is called once for each
+			 *  report item as it is decoded. The item (and its collection path) is only valid for the duration of the call,
+			 *  so the callback should copy anything it needs to keep.
+			 *
+			 *  \return Boolean true to continue parsing the report descriptor, false to stop the parse
+			 */
+			typedef bool (* const HID_ReportItemCallbackPtr_t)(const HID_ReportItem_t* const ReportItem);
 			
 		/* Function Prototypes: */
 			/** Function to process a given HID report returned from an attached device, and store it into a given
@@ -247,6 +286,25 @@
 			uint8_t USB_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize, HID_ReportInfo_t* const ParserData)
 			                             ATTR_NON_NULL_PTR_ARG(1, 3);
 
+			/** Function to process a given HID report returned from an attached device, passing each report item to a
+			 *  callback as it is decoded rather than storing it into a \ref HID_ReportInfo_t structure. All IN, OUT and
+			 *  FEATURE items are given to the callback, including constant (padding) items, so that the application can
+			 *  keep only the items it will use, in whatever storage suits it. The parser state is held on the stack for
+			 *  the duration of the call only, and collections are released as they end, so \ref HID_MAX_COLLECTIONS
+			 *  limits the nesting depth of collections rather than their total number. \ref HID_MAX_REPORTITEMS does not
+			 *  apply.
+			 *
+			 *  \note \ref CALLBACK_HIDParser_FilterHIDReportItem() is not called by this function.
+			 *
+			 *  \param[in] ReportData  Buffer containing the device's HID report table
+			 *  \param[in] ReportSize  Size in bytes of the HID report table
+			 *  \param[in] ItemCallback  Routine to call for each report item decoded
+			 *
+			 *  \return A value in the \ref HID_Parse_ErrorCodes_t enum
+			 */
+			uint8_t USB_StreamHIDReport(const uint8_t* ReportData, uint16_t ReportSize, const HID_ReportItemCallbackPtr_t ItemCallback)
+			                            ATTR_NON_NULL_PTR_ARG(1);
+
 			/** Extracts the given report item's value out of the given HID report and places it into the Value
 			 *  member of the report item's \ref HID_ReportItem_t structure.
 			 *
@@ -283,10 +341,38 @@
 			uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData, const uint8_t ReportID,
 			                              const uint8_t ReportType) ATTR_NON_NULL_PTR_ARG(1) ATTR_CONST;
 
+			/** Compiles an extraction plan for the given report from a processed \ref HID_ReportInfo_t structure. Each report
+			 *  item of the given type and report ID is given a step holding its byte offset, shift and mask, so that the
+			 *  bit offsets need not be recomputed for every report received. The plan can then be run on each incoming report
+			 *  with \ref USB_ExecuteHIDReportPlan(), in place of calling \ref USB_GetHIDReportItemInfo() for each item.
+			 *
+			 *  \param[in] ParserData  Pointer to a \ref HID_ReportInfo_t instance containing the parser output
+			 *  \param[in] ReportID  Report ID of the report to compile a plan for, or 0x00 if the device has only one report
+			 *  \param[in] ReportType  Type of the report to compile a plan for, a value from the \ref HID_ReportItemTypes_t enum
+			 *  \param[out] Plan  Pointer to a \ref HID_ReportPlan_t instance for the compiled plan
+			 *
+			 *  \return Boolean true if at least one report item was found for the plan, false otherwise
+			 */
+			bool USB_CompileHIDReportPlan(HID_ReportInfo_t* const ParserData, const uint8_t ReportID,
+			                              const uint8_t ReportType, HID_ReportPlan_t* const Plan)
+			                              ATTR_NON_NULL_PTR_ARG(1, 4);
+
+			/** Extracts every report item in a compiled extraction plan out of the given HID report, placing each item's
+			 *  value into the Value member of its \ref HID_ReportItem_t structure.
+			 *
+			 *  \param[in] ReportData  Buffer containing an IN or FEATURE report from an attached device
+			 *  \param[in] Plan  Pointer to a plan compiled by \ref USB_CompileHIDReportPlan()
+			 *
+			 *  \return Boolean true if the report was the one the plan was compiled for, false otherwise
+			 */
+			bool USB_ExecuteHIDReportPlan(const uint8_t* ReportData, const HID_ReportPlan_t* const Plan)
+			                              ATTR_NON_NULL_PTR_ARG(1, 2);
+
 			/** Callback routine for the HID Report Parser. This callback <b>must</b> be implemented by the user code when
-			 *  the parser is used, to determine what report IN, OUT and FEATURE item's information is stored into the user
-			 *  HID_ReportInfo_t structure. This can be used to filter only those items the application will be using, so that
-			 *  no RAM is wasted storing the attributes for report items which will never be referenced by the application.
+			 *  \ref USB_ProcessHIDReport() is used, to determine what report IN, OUT and FEATURE item's information is stored
+			 *  into the user HID_ReportInfo_t structure. This can be used to filter only those items the application will be
+			 *  using, so that no RAM is wasted storing the attributes for report items which will never be referenced by the
+			 *  application.
 			 *
 			 *  \param[in] CurrentItemAttributes  Pointer to the current report item attributes for user checking
 			 *
@@ -303,6 +389,20 @@
 				 uint8_t                     ReportCount;
 				 uint8_t                     ReportID;
 			} HID_StateTable_t;
+
+			typedef struct HID_ParserState
+			{
+				HID_CollectionPath_t*        CollectionPaths;
+				uint8_t                      TotalCollections;
+				bool                         FreeEndedCollections;
+				HID_ReportSizeInfo_t*        ReportIDSizes;
+				uint8_t                      TotalDeviceReports;
+				uint16_t                     LargestReportSizeBits;
+				bool                         UsingReportIDs;
+				uint8_t                      (*ItemSink)(struct HID_ParserState* const State, HID_ReportItem_t* const ReportItem);
+				HID_ReportInfo_t*            ParserData;
+				bool                         (*ItemCallback)(const HID_ReportItem_t* const ReportItem);
+			} HID_ParserState_t;
 	#endif
 			
 	/* Disable C linkage for C++ Compilers: */
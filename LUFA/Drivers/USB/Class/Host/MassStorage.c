@@ -37,94 +37,51 @@
 uint8_t MS_Host_ConfigurePipes(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, uint16_t ConfigDescriptorSize,
 							   uint8_t* DeviceConfigDescriptor)
 {
-	uint8_t FoundEndpoints = 0;
+	USB_ConfigIndex_t ConfigIndex;
+	bool              FoundMSInterface = false;
 	
 	memset(&MSInterfaceInfo->State, 0x00, sizeof(MSInterfaceInfo->State));
 
-	if (DESCRIPTOR_TYPE(DeviceConfigDescriptor) != DTYPE_Configuration)
+	if (USB_GetConfigIndex(&ConfigIndex, ConfigDescriptorSize, DeviceConfigDescriptor) == CONFIGINDEX_InvalidConfigDescriptor)
 	  return MS_ENUMERROR_InvalidConfigDescriptor;
 	
-	if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &DeviceConfigDescriptor,
-	                              DComp_NextMSInterface) != DESCRIPTOR_SEARCH_COMP_Found)
+	for (uint8_t InterfaceIndex = 0; InterfaceIndex < ConfigIndex.TotalInterfaces; InterfaceIndex++)
 	{
-		return MS_ENUMERROR_NoMSInterfaceFound;
-	}
+		USB_ConfigIndex_Interface_t* MSInterface = &ConfigIndex.Interfaces[InterfaceIndex];
 
-	MSInterfaceInfo->State.InterfaceNumber = DESCRIPTOR_PCAST(DeviceConfigDescriptor, USB_Descriptor_Interface_t)->InterfaceNumber;
-	
-	while (FoundEndpoints != (MS_FOUND_DATAPIPE_IN | MS_FOUND_DATAPIPE_OUT))
-	{
-		if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &DeviceConfigDescriptor,
-		                              DComp_NextMSInterfaceEndpoint) != DESCRIPTOR_SEARCH_COMP_Found)
+		if ((MSInterface->Class    != MASS_STORE_CLASS)    ||
+		    (MSInterface->SubClass != MASS_STORE_SUBCLASS) ||
+		    (MSInterface->Protocol != MASS_STORE_PROTOCOL))
 		{
-			return MS_ENUMERROR_EndpointsNotFound;
+			continue;
 		}
-		
-		USB_Descriptor_Endpoint_t* EndpointData = DESCRIPTOR_PCAST(DeviceConfigDescriptor, USB_Descriptor_Endpoint_t);
-
-		if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-		{
-			Pipe_ConfigurePipe(MSInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
-			                   EndpointData->EndpointAddress, EndpointData->EndpointSize,
-			                   PIPE_BANK_DOUBLE);
-			MSInterfaceInfo->State.DataINPipeSize = EndpointData->EndpointSize;
-
-			FoundEndpoints |= MS_FOUND_DATAPIPE_IN;
-		}
-		else
-		{
-			Pipe_ConfigurePipe(MSInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
-			                   EndpointData->EndpointAddress, EndpointData->EndpointSize,
-			                   PIPE_BANK_DOUBLE);
-			MSInterfaceInfo->State.DataOUTPipeSize = EndpointData->EndpointSize;
 
-			FoundEndpoints |= MS_FOUND_DATAPIPE_OUT;
-		}		
-	}
+		FoundMSInterface = true;
 
-	MSInterfaceInfo->State.IsActive = true;
-	return MS_ENUMERROR_NoError;
-}
+		const USB_ConfigIndex_Endpoint_t* DataINEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, MSInterface,
+		                                                                                 EP_TYPE_BULK, true);
+		const USB_ConfigIndex_Endpoint_t* DataOUTEndpoint = USB_ConfigIndex_FindEndpoint(&ConfigIndex, MSInterface,
+		                                                                                 EP_TYPE_BULK, false);
 
-static uint8_t DComp_NextMSInterface(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		USB_Descriptor_Interface_t* CurrentInterface = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                                USB_Descriptor_Interface_t);
-
-		if ((CurrentInterface->Class    == MASS_STORE_CLASS)    &&
-		    (CurrentInterface->SubClass == MASS_STORE_SUBCLASS) &&
-		    (CurrentInterface->Protocol == MASS_STORE_PROTOCOL))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	
-	return DESCRIPTOR_SEARCH_NotFound;
-}
+		if ((DataINEndpoint == NULL) || (DataOUTEndpoint == NULL))
+		  continue;
 
-static uint8_t DComp_NextMSInterfaceEndpoint(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Endpoint)
-	{
-		USB_Descriptor_Endpoint_t* CurrentEndpoint = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                              USB_Descriptor_Endpoint_t);
+		Pipe_ConfigurePipe(MSInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
+		                   DataINEndpoint->EndpointAddress, DataINEndpoint->EndpointSize,
+		                   PIPE_BANK_DOUBLE);
+		MSInterfaceInfo->State.DataINPipeSize = DataINEndpoint->EndpointSize;
 
-		uint8_t EndpointType = (CurrentEndpoint->Attributes & EP_TYPE_MASK);
+		Pipe_ConfigurePipe(MSInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
+		                   DataOUTEndpoint->EndpointAddress, DataOUTEndpoint->EndpointSize,
+		                   PIPE_BANK_DOUBLE);
+		MSInterfaceInfo->State.DataOUTPipeSize = DataOUTEndpoint->EndpointSize;
 
-		if ((EndpointType == EP_TYPE_BULK) &&
-		    (!(Pipe_IsEndpointBound(CurrentEndpoint->EndpointAddress))))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	else if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		return DESCRIPTOR_SEARCH_Fail;
+		MSInterfaceInfo->State.InterfaceNumber = MSInterface->InterfaceNumber;
+		MSInterfaceInfo->State.IsActive = true;
+		return MS_ENUMERROR_NoError;
 	}
 
-	return DESCRIPTOR_SEARCH_NotFound;
+	return (FoundMSInterface) ? MS_ENUMERROR_EndpointsNotFound : MS_ENUMERROR_NoMSInterfaceFound;
 }
 
 void MS_Host_USBTask(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
@@ -221,7 +178,8 @@ static uint8_t MS_Host_SendReceiveData(USB_ClassInfo_MS_Host_t* const MSInterfac
                                        MS_CommandBlockWrapper_t* const SCSICommandBlock, void* BufferPtr)
 {
 	uint8_t  ErrorCode = PIPE_RWSTREAM_NoError;
-	uint16_t BytesRem  = SCSICommandBlock->DataTransferLength;
+	uint32_t BytesRem  = SCSICommandBlock->DataTransferLength;
+	uint8_t* DataPtr   = (uint8_t*)BufferPtr;
 
 	if (SCSICommandBlock->Flags & COMMAND_DIRECTION_DATA_IN)
 	{
@@ -234,8 +192,17 @@ static uint8_t MS_Host_SendReceiveData(USB_ClassInfo_MS_Host_t* const MSInterfac
 		Pipe_SelectPipe(MSInterfaceInfo->Config.DataINPipeNumber);
 		Pipe_Unfreeze();
 		
-		if ((ErrorCode = Pipe_Read_Stream_LE(BufferPtr, BytesRem, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
-		  return ErrorCode;
+		// the pipe streams take 16-bit lengths, so longer transfers are read in pieces
+		while (BytesRem)
+		{
+			uint16_t ChunkBytes = (BytesRem > 0xFFFF) ? 0xFFFF : BytesRem;
+
+			if ((ErrorCode = Pipe_Read_Stream_LE(DataPtr, ChunkBytes, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+			  return ErrorCode;
+
+			DataPtr  += ChunkBytes;
+			BytesRem -= ChunkBytes;
+		}
 
 		Pipe_ClearIN();
 	}
@@ -244,8 +211,16 @@ static uint8_t MS_Host_SendReceiveData(USB_ClassInfo_MS_Host_t* const MSInterfac
 		Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipeNumber);
 		Pipe_Unfreeze();
 
-		if ((ErrorCode = Pipe_Write_Stream_LE(BufferPtr, BytesRem, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
-		  return ErrorCode;
+		while (BytesRem)
+		{
+			uint16_t ChunkBytes = (BytesRem > 0xFFFF) ? 0xFFFF : BytesRem;
+
+			if ((ErrorCode = Pipe_Write_Stream_LE(DataPtr, ChunkBytes, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+			  return ErrorCode;
+
+			DataPtr  += ChunkBytes;
+			BytesRem -= ChunkBytes;
+		}
 
 		Pipe_ClearOUT();
 		
@@ -522,7 +497,7 @@ uint8_t MS_Host_PreventAllowMediumRemoval(USB_ClassInfo_MS_Host_t* const MSInter
 }
 
 uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex, const uint32_t BlockAddress,
-                                 const uint8_t Blocks, const uint16_t BlockSize, void* BlockBuffer)
+                                 const uint16_t Blocks, const uint16_t BlockSize, void* BlockBuffer)
 {
 	if ((USB_HostState != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
 	  return HOST_SENDCONTROL_DeviceDisconnect;
@@ -545,8 +520,8 @@ uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 					(BlockAddress >> 8),
 					(BlockAddress & 0xFF),  // LSB of Block Address
 					0x00,                   // Unused (reserved)
-					0x00,                   // MSB of Total Blocks to Read
-					Blocks,                 // LSB of Total Blocks to Read
+					(Blocks >> 8),          // MSB of Total Blocks to Read
+					(Blocks & 0xFF),        // LSB of Total Blocks to Read
 					0x00                    // Unused (control)
 				}
 		};
@@ -563,7 +538,7 @@ uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 }
 
 uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex, const uint32_t BlockAddress,
-                                  const uint8_t Blocks, const uint16_t BlockSize, void* BlockBuffer)
+                                  const uint16_t Blocks, const uint16_t BlockSize, void* BlockBuffer)
 {
 	if ((USB_HostState != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
 	  return HOST_SENDCONTROL_DeviceDisconnect;
@@ -586,8 +561,8 @@ uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo
 					(BlockAddress >> 8),
 					(BlockAddress & 0xFF),  // LSB of Block Address
 					0x00,                   // Unused (reserved)
-					0x00,                   // MSB of Total Blocks to Write
-					Blocks,                 // LSB of Total Blocks to Write
+					(Blocks >> 8),          // MSB of Total Blocks to Write
+					(Blocks & 0xFF),        // LSB of Total Blocks to Write
 					0x00                    // Unused (control)
 				}
 		};
@@ -603,4 +578,190 @@ uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo
 	return PIPE_RWSTREAM_NoError;
 }
 
+static uint16_t MS_Host_PrepareBlockCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                            MS_CommandBlockWrapper_t* const SCSICommandBlock,
+                                            const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize)
+{
+	uint16_t CommandBlocks = (Blocks > MS_HOST_MAX_BLOCKS_PER_COMMAND) ? MS_HOST_MAX_BLOCKS_PER_COMMAND : Blocks;
+
+	SCSICommandBlock->Tag = ++MSInterfaceInfo->State.TransactionTag;
+
+	if (MSInterfaceInfo->State.TransactionTag == 0xFFFFFFFF)
+	  MSInterfaceInfo->State.TransactionTag = 1;
+
+	SCSICommandBlock->DataTransferLength = ((uint32_t)CommandBlocks * BlockSize);
+	SCSICommandBlock->SCSICommandData[2] = (BlockAddress >> 24);
+	SCSICommandBlock->SCSICommandData[3] = (BlockAddress >> 16);
+	SCSICommandBlock->SCSICommandData[4] = (BlockAddress >> 8);
+	SCSICommandBlock->SCSICommandData[5] = (BlockAddress & 0xFF);
+	SCSICommandBlock->SCSICommandData[7] = (CommandBlocks >> 8);
+	SCSICommandBlock->SCSICommandData[8] = (CommandBlocks & 0xFF);
+
+	return CommandBlocks;
+}
+
+static uint8_t MS_Host_WaitForStreamBank(void)
+{
+	uint16_t TimeoutMSRem = COMMAND_DATA_TIMEOUT_MS;
+
+	for (;;)
+	{
+		if ((Pipe_GetPipeToken() == PIPE_TOKEN_IN) ? Pipe_IsINReceived() : Pipe_IsOUTReady())
+		  return PIPE_RWSTREAM_NoError;
+
+		if (Pipe_IsStalled())
+		  return PIPE_RWSTREAM_PipeStalled;
+		else if (USB_HostState == HOST_STATE_Unattached)
+		  return PIPE_RWSTREAM_DeviceDisconnected;
+
+		if (USB_INT_HasOccurred(USB_INT_HSOFI))
+		{
+			USB_INT_Clear(USB_INT_HSOFI);
+
+			if (!(TimeoutMSRem--))
+			  return PIPE_RWSTREAM_Timeout;
+		}
+	}
+}
+
+static uint8_t MS_Host_StreamBlockData(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                       MS_CommandBlockWrapper_t* const SCSICommandBlock,
+                                       MS_BlockStreamCallbackPtr_t Callback)
+{
+	bool     DataIN    = ((SCSICommandBlock->Flags & COMMAND_DIRECTION_DATA_IN) != 0);
+	uint16_t PipeSize  = (DataIN) ? MSInterfaceInfo->State.DataINPipeSize : MSInterfaceInfo->State.DataOUTPipeSize;
+	uint32_t BytesRem  = SCSICommandBlock->DataTransferLength;
+	uint8_t  ErrorCode;
+
+	Pipe_SelectPipe((DataIN) ? MSInterfaceInfo->Config.DataINPipeNumber : MSInterfaceInfo->Config.DataOUTPipeNumber);
+	Pipe_Unfreeze();
+
+	// the pipe is left running between banks, so that the device can fill (or empty) one bank while the callback
+	// works on the other
+	while (BytesRem)
+	{
+		if ((ErrorCode = MS_Host_WaitForStreamBank()) != PIPE_RWSTREAM_NoError)
+		  return ErrorCode;
+
+		uint16_t BankBytes = (DataIN) ? Pipe_BytesInPipe() : PipeSize;
+
+		if (BankBytes > BytesRem)
+		  BankBytes = BytesRem;
+
+		if (!(Callback(MSInterfaceInfo, BankBytes)))
+		  return PIPE_RWSTREAM_CallbackAborted;
+
+		BytesRem -= BankBytes;
+
+		if (DataIN)
+		{
+			Pipe_ClearIN();
+
+			// a short packet ends the data early, which the residue in the returned status will show
+			if (BankBytes < PipeSize)
+			  break;
+		}
+		else
+		{
+			Pipe_ClearOUT();
+		}
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t MS_Host_StreamBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                    uint32_t BlockAddress, uint32_t Blocks, const uint16_t BlockSize,
+                                    MS_BlockStreamCallbackPtr_t Callback, const bool DataIN)
+{
+	if ((USB_HostState != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
+	  return HOST_SENDCONTROL_DeviceDisconnect;
+
+	uint8_t ErrorCode = PIPE_RWSTREAM_NoError;
+
+	MS_CommandBlockWrapper_t SCSICommandBlock = (MS_CommandBlockWrapper_t)
+		{
+			.Signature          = CBW_SIGNATURE,
+			.Flags              = (DataIN) ? COMMAND_DIRECTION_DATA_IN : COMMAND_DIRECTION_DATA_OUT,
+			.LUN                = LUNIndex,
+			.SCSICommandLength  = 10,
+			.SCSICommandData    =
+				{
+					(DataIN) ? SCSI_CMD_READ_10 : SCSI_CMD_WRITE_10,
+					0x00,                   // Unused (control bits, all off)
+					0x00,                   // MSB of Block Address
+					0x00,
+					0x00,
+					0x00,                   // LSB of Block Address
+					0x00,                   // Unused (reserved)
+					0x00,                   // MSB of Total Blocks
+					0x00,                   // LSB of Total Blocks
+					0x00                    // Unused (control)
+				}
+		};
+
+	MS_CommandStatusWrapper_t SCSICommandStatus;
+
+	uint16_t CommandBlocks = MS_Host_PrepareBlockCommand(MSInterfaceInfo, &SCSICommandBlock, BlockAddress, Blocks, BlockSize);
+
+	while (Blocks)
+	{
+		// the command block is left in the OUT pipe's bank to be sent while the data phase starts
+		Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipeNumber);
+		Pipe_Unfreeze();
+
+		if ((ErrorCode = Pipe_Write_Stream_LE(&SCSICommandBlock, sizeof(MS_CommandBlockWrapper_t),
+		                                      NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+		{
+			break;
+		}
+
+		Pipe_ClearOUT();
+
+		if ((ErrorCode = MS_Host_StreamBlockData(MSInterfaceInfo, &SCSICommandBlock, Callback)) != PIPE_RWSTREAM_NoError)
+		  break;
+
+		BlockAddress += CommandBlocks;
+		Blocks       -= CommandBlocks;
+
+		// the device can send its status into the free IN bank while the next command block is made up
+		Pipe_SelectPipe(MSInterfaceInfo->Config.DataINPipeNumber);
+		Pipe_Unfreeze();
+
+		if (Blocks)
+		  CommandBlocks = MS_Host_PrepareBlockCommand(MSInterfaceInfo, &SCSICommandBlock, BlockAddress, Blocks, BlockSize);
+
+		if ((ErrorCode = MS_Host_GetReturnedStatus(MSInterfaceInfo, &SCSICommandStatus)) != PIPE_RWSTREAM_NoError)
+		  break;
+
+		if (SCSICommandStatus.DataTransferResidue)
+		{
+			ErrorCode = MS_ERROR_LOGICAL_CMD_FAILED;
+			break;
+		}
+	}
+
+	Pipe_SelectPipe(MSInterfaceInfo->Config.DataINPipeNumber);
+	Pipe_Freeze();
+
+	Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipeNumber);
+	Pipe_Freeze();
+
+	return ErrorCode;
+}
+
+uint8_t MS_Host_ReadDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                      const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+                                      MS_BlockStreamCallbackPtr_t Callback)
+{
+	return MS_Host_StreamBlocks(MSInterfaceInfo, LUNIndex, BlockAddress, Blocks, BlockSize, Callback, true);
+}
+
+uint8_t MS_Host_WriteDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                       const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+                                       MS_BlockStreamCallbackPtr_t Callback)
+{
+	return MS_Host_StreamBlocks(MSInterfaceInfo, LUNIndex, BlockAddress, Blocks, BlockSize, Callback, false);
+}
+
 #endif
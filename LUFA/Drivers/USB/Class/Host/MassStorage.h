@@ -53,6 +53,18 @@
 			extern "C" {
 		#endif
 
+	/* Preprocessor checks and defines: */
+		#if !defined(MS_HOST_MAX_BLOCKS_PER_COMMAND) || defined(__DOXYGEN__)
+			/** Constant indicating the maximum number of blocks moved by each READ (10) or WRITE (10) command issued by
+			 *  \ref MS_Host_ReadDeviceBlockStream() and \ref MS_Host_WriteDeviceBlockStream(), which split longer transfers
+			 *  into several commands. Larger values mean fewer command and status round-trips per transfer, but some devices
+			 *  fail commands which move too much data at once. By default this is set to 128 blocks, but this can be overridden
+			 *  by defining MS_HOST_MAX_BLOCKS_PER_COMMAND to another non-zero 16-bit value in the user project makefile, passing
+			 *  the define to the compiler using the -D compiler switch.
+			 */
+			#define MS_HOST_MAX_BLOCKS_PER_COMMAND  128
+		#endif
+
 	/* Public Interface - May be used in end-application: */
 		/* Macros: */
 			/** Error code for some Mass Storage Host functions, indicating a logical (and not hardware) error */
@@ -90,6 +102,19 @@
 						  */
 			} USB_ClassInfo_MS_Host_t;
 
+			/** Type define for a block stream callback, given to \ref MS_Host_ReadDeviceBlockStream() and
+			 *  \ref MS_Host_WriteDeviceBlockStream(). The callback is run each time a bank of the data pipe is ready, with
+			 *  the data pipe selected, and must read (or write) exactly BankBytes bytes of block data from (or to) the pipe
+			 *  bank with the Pipe byte or stream functions. The driver clears the bank once the callback returns.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to the MS Class host configuration and state of the transfer
+			 *  \param[in] BankBytes  Number of bytes waiting in the bank (for reads) or to be written to it (for writes)
+			 *
+			 *  \return Boolean true to continue the transfer, or false to abort it
+			 */
+			typedef bool (* const MS_BlockStreamCallbackPtr_t)(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+			                                                   const uint16_t BankBytes);
+
 			/** Type define for a SCSI Sense structure. Structures of this type are filled out by the
 			 *  device via the MassStore_RequestSense() function, indicating the current sense data of the
 			 *  device (giving explicit error codes for the last issued command). For details of the
@@ -284,7 +309,7 @@
 			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED if not ready
 			 */
 			uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
-			                                 const uint32_t BlockAddress, const uint8_t Blocks, const uint16_t BlockSize,
+			                                 const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
 			                                 void* BlockBuffer) ATTR_NON_NULL_PTR_ARG(1, 6);
 		
 			/** Writes blocks of data to the attached Mass Storage device's medium.
@@ -299,9 +324,52 @@
 			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED if not ready
 			 */
 			uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
-			                                  const uint32_t BlockAddress, const uint8_t Blocks, const uint16_t BlockSize,
+			                                  const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
 			                                  void* BlockBuffer) ATTR_NON_NULL_PTR_ARG(1, 6);
 
+			/** Reads blocks of data from the attached Mass Storage device's medium, passing the data to a callback one pipe
+			 *  bank at a time rather than into a single buffer. Long transfers are split into commands of at most
+			 *  \ref MS_HOST_MAX_BLOCKS_PER_COMMAND blocks, and the data pipe is kept running between banks so that the
+			 *  device can fill one bank while the callback empties the other.
+			 *
+			 *  If the callback aborts the transfer, the device is left part way through a command and the interface must
+			 *  be reset with \ref MS_Host_ResetMSInterface() before it is used again.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a MS Class host configuration and state
+			 *  \param[in] LUNIndex  LUN index within the device the command is being issued to
+			 *  \param[in] BlockAddress  Starting block address within the device to read from
+			 *  \param[in] Blocks  Total number of blocks to read
+			 *  \param[in] BlockSize  Size in bytes of each block within the device
+			 *  \param[in] Callback  Callback to receive each bank of block data, see \ref MS_BlockStreamCallbackPtr_t
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED if a
+			 *          command failed or returned less data than requested
+			 */
+			uint8_t MS_Host_ReadDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+			                                      const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+			                                      MS_BlockStreamCallbackPtr_t Callback) ATTR_NON_NULL_PTR_ARG(1, 6);
+
+			/** Writes blocks of data to the attached Mass Storage device's medium, taking the data from a callback one
+			 *  pipe bank at a time rather than from a single buffer. Long transfers are split into commands as with
+			 *  \ref MS_Host_ReadDeviceBlockStream().
+			 *
+			 *  If the callback aborts the transfer, the device is left part way through a command and the interface must
+			 *  be reset with \ref MS_Host_ResetMSInterface() before it is used again.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a MS Class host configuration and state
+			 *  \param[in] LUNIndex  LUN index within the device the command is being issued to
+			 *  \param[in] BlockAddress  Starting block address within the device to write to
+			 *  \param[in] Blocks  Total number of blocks to write
+			 *  \param[in] BlockSize  Size in bytes of each block within the device
+			 *  \param[in] Callback  Callback to supply each bank of block data, see \ref MS_BlockStreamCallbackPtr_t
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED if a
+			 *          command failed
+			 */
+			uint8_t MS_Host_WriteDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+			                                       const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+			                                       MS_BlockStreamCallbackPtr_t Callback) ATTR_NON_NULL_PTR_ARG(1, 6);
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Macros: */
@@ -319,15 +387,9 @@
 			#define COMMAND_DIRECTION_DATA_IN      (1 << 7)
 			
 			#define COMMAND_DATA_TIMEOUT_MS        2000
-
-			#define MS_FOUND_DATAPIPE_IN           (1 << 0)
-			#define MS_FOUND_DATAPIPE_OUT          (1 << 1)
 			
 		/* Function Prototypes: */
 			#if defined(INCLUDE_FROM_MS_CLASS_HOST_C)		
-				static uint8_t DComp_NextMSInterface(void* CurrentDescriptor);
-				static uint8_t DComp_NextMSInterfaceEndpoint(void* CurrentDescriptor);
-				
 				static uint8_t MS_Host_SendCommand(USB_ClassInfo_MS_Host_t* MSInterfaceInfo,
 				                                   MS_CommandBlockWrapper_t* SCSICommandBlock,
 				                                   void* BufferPtr);
@@ -336,6 +398,16 @@
                                                        MS_CommandBlockWrapper_t* SCSICommandBlock, void* BufferPtr);
 				static uint8_t MS_Host_GetReturnedStatus(USB_ClassInfo_MS_Host_t* MSInterfaceInfo,
 				                                         MS_CommandStatusWrapper_t* SCSICommandStatus);
+				static uint16_t MS_Host_PrepareBlockCommand(USB_ClassInfo_MS_Host_t* MSInterfaceInfo,
+				                                            MS_CommandBlockWrapper_t* SCSICommandBlock,
+				                                            uint32_t BlockAddress, uint32_t Blocks, uint16_t BlockSize);
+				static uint8_t MS_Host_WaitForStreamBank(void);
+				static uint8_t MS_Host_StreamBlockData(USB_ClassInfo_MS_Host_t* MSInterfaceInfo,
+				                                       MS_CommandBlockWrapper_t* SCSICommandBlock,
+				                                       MS_BlockStreamCallbackPtr_t Callback);
+				static uint8_t MS_Host_StreamBlocks(USB_ClassInfo_MS_Host_t* MSInterfaceInfo, uint8_t LUNIndex,
+				                                    uint32_t BlockAddress, uint32_t Blocks, uint16_t BlockSize,
+				                                    MS_BlockStreamCallbackPtr_t Callback, bool DataIN);
 			#endif
 	#endif
 	
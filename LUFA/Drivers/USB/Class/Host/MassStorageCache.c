@@ -0,0 +1,311 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2009.
+
+  dean [at] fourwalledcubicle [dot] com
+      www.fourwalledcubicle.com
+*/
+
+/*
+  Copyright 2009  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, and distribute this software
+  and its documentation for any purpose and without fee is hereby
+  granted, provided that the above copyright notice appear in all
+  copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#include "../../HighLevel/USBMode.h"
+#if defined(USB_CAN_BE_HOST)
+
+#define INCLUDE_FROM_MS_CACHE_C
+#include "MassStorageCache.h"
+
+/* The block stream callbacks are only given the interface, so the entries being moved by the current transfer are
+   kept here. Only one transfer is in progress at a time. */
+static struct
+{
+	MS_CacheEntry_t* Entries[MS_CACHE_BLOCKS];
+	uint8_t          Entry;
+	uint16_t         Offset;
+} Stream;
+
+void MS_Cache_Init(MS_Cache_t* const Cache, const uint32_t TotalBlocks)
+{
+	memset(&Cache->State, 0x00, sizeof(Cache->State));
+
+	for (uint8_t EntryIndex = 0; EntryIndex < MS_CACHE_BLOCKS; EntryIndex++)
+	  Cache->State.LRUOrder[EntryIndex] = EntryIndex;
+
+	Cache->State.TotalBlocks = TotalBlocks;
+}
+
+uint8_t MS_Cache_ReadBlock(MS_Cache_t* const Cache, const uint32_t BlockAddress, void* const BlockBuffer)
+{
+	MS_CacheEntry_t* Entry      = MS_Cache_FindEntry(Cache, BlockAddress);
+	bool             Sequential = (BlockAddress == Cache->State.NextSequentialBlock);
+	uint8_t          ErrorCode;
+
+	Cache->State.NextSequentialBlock = (BlockAddress + 1);
+
+	if (Entry != NULL)
+	{
+		Cache->State.Stats.ReadHits++;
+
+		if (Entry->ReadAhead)
+		{
+			Cache->State.Stats.ReadAheadHits++;
+			Entry->ReadAhead = false;
+		}
+	}
+	else
+	{
+		MS_CacheEntry_t* FetchEntries[MS_CACHE_READ_AHEAD_BLOCKS + 1];
+		uint8_t          Blocks = 1;
+
+		Cache->State.Stats.ReadMisses++;
+
+		// a sequential miss also fetches the blocks after it, up to the first one already held
+		if (Sequential)
+		{
+			while ((Blocks <= MS_CACHE_READ_AHEAD_BLOCKS) && ((BlockAddress + Blocks) < Cache->State.TotalBlocks) &&
+			       (MS_Cache_FindEntry(Cache, BlockAddress + Blocks) == NULL))
+			{
+				Blocks++;
+			}
+		}
+
+		// entries are allocated last block first, so that the requested block ends up the most recently used
+		for (uint8_t BlockIndex = Blocks; BlockIndex > 0; BlockIndex--)
+		{
+			if ((ErrorCode = MS_Cache_Allocate(Cache, (BlockAddress + BlockIndex - 1),
+			                                   &FetchEntries[BlockIndex - 1])) != PIPE_RWSTREAM_NoError)
+			{
+				return ErrorCode;
+			}
+		}
+
+		for (uint8_t BlockIndex = 0; BlockIndex < Blocks; BlockIndex++)
+		  Stream.Entries[BlockIndex] = FetchEntries[BlockIndex];
+
+		Stream.Entry  = 0;
+		Stream.Offset = 0;
+
+		Cache->State.Stats.ReadCommands++;
+
+		if ((ErrorCode = MS_Host_ReadDeviceBlockStream(Cache->Config.MSInterfaceInfo, Cache->Config.LUNIndex, BlockAddress,
+		                                               Blocks, MS_CACHE_BLOCK_SIZE,
+		                                               MS_Cache_ReadStreamCallback)) != PIPE_RWSTREAM_NoError)
+		{
+			return ErrorCode;
+		}
+
+		for (uint8_t BlockIndex = 0; BlockIndex < Blocks; BlockIndex++)
+		{
+			FetchEntries[BlockIndex]->Valid     = true;
+			FetchEntries[BlockIndex]->ReadAhead = (BlockIndex != 0);
+		}
+
+		Cache->State.Stats.ReadAheadBlocks += (Blocks - 1);
+		Entry = FetchEntries[0];
+	}
+
+	memcpy(BlockBuffer, Entry->Data, MS_CACHE_BLOCK_SIZE);
+	MS_Cache_Touch(Cache, Entry);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t MS_Cache_WriteBlock(MS_Cache_t* const Cache, const uint32_t BlockAddress, const void* const BlockBuffer)
+{
+	MS_CacheEntry_t* Entry = MS_Cache_FindEntry(Cache, BlockAddress);
+	uint8_t          ErrorCode;
+
+	if ((Entry == NULL) && ((ErrorCode = MS_Cache_Allocate(Cache, BlockAddress, &Entry)) != PIPE_RWSTREAM_NoError))
+	  return ErrorCode;
+
+	memcpy(Entry->Data, BlockBuffer, MS_CACHE_BLOCK_SIZE);
+
+	Entry->Valid     = true;
+	Entry->Dirty     = true;
+	Entry->ReadAhead = false;
+	MS_Cache_Touch(Cache, Entry);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t MS_Cache_Flush(MS_Cache_t* const Cache)
+{
+	uint8_t ErrorCode;
+
+	for (uint8_t EntryIndex = 0; EntryIndex < MS_CACHE_BLOCKS; EntryIndex++)
+	{
+		MS_CacheEntry_t* Entry = &Cache->State.Entries[EntryIndex];
+
+		if (Entry->Valid && Entry->Dirty && ((ErrorCode = MS_Cache_WriteBack(Cache, Entry)) != PIPE_RWSTREAM_NoError))
+		  return ErrorCode;
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static MS_CacheEntry_t* MS_Cache_FindEntry(MS_Cache_t* const Cache, const uint32_t BlockAddress)
+{
+	for (uint8_t EntryIndex = 0; EntryIndex < MS_CACHE_BLOCKS; EntryIndex++)
+	{
+		MS_CacheEntry_t* Entry = &Cache->State.Entries[EntryIndex];
+
+		if (Entry->Valid && (Entry->BlockAddress == BlockAddress))
+		  return Entry;
+	}
+
+	return NULL;
+}
+
+static void MS_Cache_Touch(MS_Cache_t* const Cache, MS_CacheEntry_t* const Entry)
+{
+	uint8_t EntryIndex = (Entry - Cache->State.Entries);
+	uint8_t Position   = 0;
+
+	while (Cache->State.LRUOrder[Position] != EntryIndex)
+	  Position++;
+
+	while (Position)
+	{
+		Cache->State.LRUOrder[Position] = Cache->State.LRUOrder[Position - 1];
+		Position--;
+	}
+
+	Cache->State.LRUOrder[0] = EntryIndex;
+}
+
+static uint8_t MS_Cache_WriteBack(MS_Cache_t* const Cache, MS_CacheEntry_t* const Entry)
+{
+	uint32_t         RunStart = Entry->BlockAddress;
+	uint8_t          Blocks   = 0;
+	MS_CacheEntry_t* RunEntry;
+	uint8_t          ErrorCode;
+
+	// the dirty blocks either side of this one are written back in the same command
+	while (RunStart && ((RunEntry = MS_Cache_FindEntry(Cache, RunStart - 1)) != NULL) && RunEntry->Dirty)
+	  RunStart--;
+
+	while ((Blocks < MS_CACHE_BLOCKS) && ((RunEntry = MS_Cache_FindEntry(Cache, RunStart + Blocks)) != NULL) &&
+	       RunEntry->Dirty)
+	{
+		Stream.Entries[Blocks++] = RunEntry;
+	}
+
+	Stream.Entry  = 0;
+	Stream.Offset = 0;
+
+	Cache->State.Stats.WriteCommands++;
+
+	if ((ErrorCode = MS_Host_WriteDeviceBlockStream(Cache->Config.MSInterfaceInfo, Cache->Config.LUNIndex, RunStart,
+	                                                Blocks, MS_CACHE_BLOCK_SIZE,
+	                                                MS_Cache_WriteStreamCallback)) != PIPE_RWSTREAM_NoError)
+	{
+		return ErrorCode;
+	}
+
+	for (uint8_t BlockIndex = 0; BlockIndex < Blocks; BlockIndex++)
+	  Stream.Entries[BlockIndex]->Dirty = false;
+
+	Cache->State.Stats.BlocksWritten += Blocks;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t MS_Cache_Allocate(MS_Cache_t* const Cache, const uint32_t BlockAddress, MS_CacheEntry_t** const Entry)
+{
+	MS_CacheEntry_t* Victim = &Cache->State.Entries[Cache->State.LRUOrder[MS_CACHE_BLOCKS - 1]];
+	uint8_t          ErrorCode;
+
+	if (Victim->Valid && Victim->Dirty && ((ErrorCode = MS_Cache_WriteBack(Cache, Victim)) != PIPE_RWSTREAM_NoError))
+	  return ErrorCode;
+
+	// the entry stays invalid until it is filled, so that it isn't found or written back in the meantime
+	Victim->BlockAddress = BlockAddress;
+	Victim->Valid        = false;
+	Victim->Dirty        = false;
+	Victim->ReadAhead    = false;
+	MS_Cache_Touch(Cache, Victim);
+
+	*Entry = Victim;
+	return PIPE_RWSTREAM_NoError;
+}
+
+static bool MS_Cache_ReadStreamCallback(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint16_t BankBytes)
+{
+	uint16_t BytesRem = BankBytes;
+
+	while (BytesRem)
+	{
+		uint16_t ChunkBytes = (MS_CACHE_BLOCK_SIZE - Stream.Offset);
+
+		if (ChunkBytes > BytesRem)
+		  ChunkBytes = BytesRem;
+
+		if (Pipe_Read_Stream_LE(&Stream.Entries[Stream.Entry]->Data[Stream.Offset], ChunkBytes,
+		                        NO_STREAM_CALLBACK) != PIPE_RWSTREAM_NoError)
+		{
+			return false;
+		}
+
+		BytesRem      -= ChunkBytes;
+		Stream.Offset += ChunkBytes;
+
+		if (Stream.Offset == MS_CACHE_BLOCK_SIZE)
+		{
+			Stream.Offset = 0;
+			Stream.Entry++;
+		}
+	}
+
+	return true;
+}
+
+static bool MS_Cache_WriteStreamCallback(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint16_t BankBytes)
+{
+	uint16_t BytesRem = BankBytes;
+
+	while (BytesRem)
+	{
+		uint16_t ChunkBytes = (MS_CACHE_BLOCK_SIZE - Stream.Offset);
+
+		if (ChunkBytes > BytesRem)
+		  ChunkBytes = BytesRem;
+
+		if (Pipe_Write_Stream_LE(&Stream.Entries[Stream.Entry]->Data[Stream.Offset], ChunkBytes,
+		                         NO_STREAM_CALLBACK) != PIPE_RWSTREAM_NoError)
+		{
+			return false;
+		}
+
+		BytesRem      -= ChunkBytes;
+		Stream.Offset += ChunkBytes;
+
+		if (Stream.Offset == MS_CACHE_BLOCK_SIZE)
+		{
+			Stream.Offset = 0;
+			Stream.Entry++;
+		}
+	}
+
+	return true;
+}
+
+#endif
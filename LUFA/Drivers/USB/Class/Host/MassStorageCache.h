@@ -0,0 +1,209 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2009.
+
+  dean [at] fourwalledcubicle [dot] com
+      www.fourwalledcubicle.com
+*/
+
+/*
+  Copyright 2009  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, and distribute this software
+  and its documentation for any purpose and without fee is hereby
+  granted, provided that the above copyright notice appear in all
+  copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \ingroup Group_USBClassMassStorageHost
+ *  @defgroup Group_USBClassMassStorageCache Mass Storage Host Block Cache
+ *
+ *  \section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LUFA/Drivers/USB/Class/Host/MassStorage.c
+ *    - LUFA/Drivers/USB/Class/Host/MassStorageCache.c
+ *
+ *  \section Module Description
+ *  Block cache for the Mass Storage host class driver. The cache holds a small number of the attached device's blocks
+ *  in RAM, so that filesystem style access (which reads the same FAT and directory blocks over and over) doesn't issue
+ *  a full SCSI command for each access.
+ *
+ *  Blocks are replaced least recently used first. A read which misses directly after the block before it was read
+ *  fetches the following blocks in the same command, and written blocks are held until they are replaced or flushed,
+ *  when each dirty block is written back in one command together with any dirty blocks adjacent to it.
+ *
+ *  @{
+ */
+
+#ifndef __MS_CLASS_HOST_CACHE_H__
+#define __MS_CLASS_HOST_CACHE_H__
+
+	/* Includes: */
+		#include "MassStorage.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor checks and defines: */
+		#if !defined(MS_CACHE_BLOCKS) || defined(__DOXYGEN__)
+			/** Constant indicating the number of device blocks held in each \ref MS_Cache_t cache. More blocks give more
+			 *  hits, but each consumes \ref MS_CACHE_BLOCK_SIZE bytes of RAM. By default this is set to 4 blocks, but this
+			 *  can be overridden by defining MS_CACHE_BLOCKS to another value of 2 or more in the user project makefile,
+			 *  passing the define to the compiler using the -D compiler switch.
+			 */
+			#define MS_CACHE_BLOCKS               4
+		#endif
+
+		#if !defined(MS_CACHE_BLOCK_SIZE) || defined(__DOXYGEN__)
+			/** Constant indicating the size in bytes of each cached block, which must match the block size of the
+			 *  attached device as returned by \ref MS_Host_ReadDeviceCapacity(). By default this is set to 512 bytes,
+			 *  but this can be overridden by defining MS_CACHE_BLOCK_SIZE to another value in the user project makefile,
+			 *  passing the define to the compiler using the -D compiler switch.
+			 */
+			#define MS_CACHE_BLOCK_SIZE           512
+		#endif
+
+		#if !defined(MS_CACHE_READ_AHEAD_BLOCKS) || defined(__DOXYGEN__)
+			/** Constant indicating the number of blocks fetched after a sequential read miss, in the same command as the
+			 *  missed block. By default this is set to 2 blocks, but this can be overridden by defining
+			 *  MS_CACHE_READ_AHEAD_BLOCKS to another value less than \ref MS_CACHE_BLOCKS (or to 0 to disable read-ahead)
+			 *  in the user project makefile, passing the define to the compiler using the -D compiler switch.
+			 */
+			#define MS_CACHE_READ_AHEAD_BLOCKS    2
+		#endif
+
+		#if (MS_CACHE_BLOCKS < 2) || (MS_CACHE_READ_AHEAD_BLOCKS >= MS_CACHE_BLOCKS)
+			#error MS_CACHE_BLOCKS must be at least 2, and larger than MS_CACHE_READ_AHEAD_BLOCKS.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Type Defines: */
+			/** Type define for a single cached device block, held within a \ref MS_Cache_t cache. */
+			typedef struct
+			{
+				uint32_t BlockAddress; /**< Address of the device block held in the entry */
+				bool     Valid; /**< Indicates if the entry holds a device block */
+				bool     Dirty; /**< Indicates if the entry has been written since it was last written back */
+				bool     ReadAhead; /**< Indicates if the entry was read ahead, and hasn't been read by the user yet */
+				uint8_t  Data[MS_CACHE_BLOCK_SIZE]; /**< Contents of the device block */
+			} MS_CacheEntry_t;
+
+			/** Type define for the hit and miss statistics of a \ref MS_Cache_t cache, which are cleared by
+			 *  \ref MS_Cache_Init().
+			 */
+			typedef struct
+			{
+				uint32_t ReadHits; /**< Block reads satisfied from the cache */
+				uint32_t ReadMisses; /**< Block reads which had to be fetched from the device */
+				uint32_t ReadCommands; /**< READ commands issued to the device */
+				uint32_t ReadAheadBlocks; /**< Blocks fetched ahead of a sequential read miss */
+				uint32_t ReadAheadHits; /**< Block reads satisfied by a block which was read ahead */
+				uint32_t WriteCommands; /**< WRITE commands issued to the device */
+				uint32_t BlocksWritten; /**< Dirty blocks written back to the device */
+			} MS_CacheStats_t;
+
+			/** Cache state structure. An instance of this structure should be made within the user application for each
+			 *  cached LUN, and passed to each of the cache functions as the Cache parameter.
+			 */
+			typedef struct
+			{
+				const struct
+				{
+					USB_ClassInfo_MS_Host_t* MSInterfaceInfo; /**< Mass Storage host interface of the attached device */
+					uint8_t                  LUNIndex; /**< LUN index within the device of the cached medium */
+				} Config; /**< Config data for the cache. All elements in this section <b>must</b> be set or the cache
+				           *   will fail to operate correctly.
+				           */
+				struct
+				{
+					MS_CacheEntry_t Entries[MS_CACHE_BLOCKS]; /**< Cached device blocks */
+					uint8_t         LRUOrder[MS_CACHE_BLOCKS]; /**< Indexes of the entries, most recently used first */
+					uint32_t        TotalBlocks; /**< Blocks in the cached medium, so that reads ahead stop at its end */
+					uint32_t        NextSequentialBlock; /**< Block following the one most recently read */
+					MS_CacheStats_t Stats; /**< Hit and miss statistics of the cache */
+				} State; /**< State data for the cache. All elements in this section are set by \ref MS_Cache_Init(). */
+			} MS_Cache_t;
+
+		/* Function Prototypes: */
+			/** Empties a cache and clears its statistics. This should be called once the attached device's capacity has been
+			 *  read, before the cache is first used, and again if the device is detached. Dirty blocks are discarded, so
+			 *  \ref MS_Cache_Flush() should be called first if they are to be kept.
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing the cache configuration and state
+			 *  \param[in] TotalBlocks  Number of blocks in the cached medium, as returned by \ref MS_Host_ReadDeviceCapacity()
+			 */
+			void MS_Cache_Init(MS_Cache_t* const Cache, const uint32_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Reads a block through the cache, fetching it (and, if the read is sequential, the blocks following it) from
+			 *  the device if it isn't held.
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing the cache configuration and state
+			 *  \param[in] BlockAddress  Address of the block to read
+			 *  \param[out] BlockBuffer  Buffer of \ref MS_CACHE_BLOCK_SIZE bytes where the block's contents should be stored
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED
+			 */
+			uint8_t MS_Cache_ReadBlock(MS_Cache_t* const Cache, const uint32_t BlockAddress, void* const BlockBuffer)
+			                           ATTR_NON_NULL_PTR_ARG(1, 3);
+
+			/** Writes a block through the cache. The block is held in the cache until it is replaced or flushed, when it is
+			 *  written back to the device along with any adjacent dirty blocks.
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing the cache configuration and state
+			 *  \param[in] BlockAddress  Address of the block to write
+			 *  \param[in] BlockBuffer  Buffer of \ref MS_CACHE_BLOCK_SIZE bytes holding the block's new contents
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED if a dirty
+			 *          block had to be written back to make room and this failed
+			 */
+			uint8_t MS_Cache_WriteBlock(MS_Cache_t* const Cache, const uint32_t BlockAddress, const void* const BlockBuffer)
+			                            ATTR_NON_NULL_PTR_ARG(1, 3);
+
+			/** Writes all dirty blocks in the cache back to the device. This should be called before the device may be
+			 *  detached, such as at the end of each file written.
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing the cache configuration and state
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum or MS_ERROR_LOGICAL_CMD_FAILED
+			 */
+			uint8_t MS_Cache_Flush(MS_Cache_t* const Cache) ATTR_NON_NULL_PTR_ARG(1);
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Function Prototypes: */
+			#if defined(INCLUDE_FROM_MS_CACHE_C)
+				static MS_CacheEntry_t* MS_Cache_FindEntry(MS_Cache_t* const Cache, const uint32_t BlockAddress);
+				static void MS_Cache_Touch(MS_Cache_t* const Cache, MS_CacheEntry_t* const Entry);
+				static uint8_t MS_Cache_WriteBack(MS_Cache_t* const Cache, MS_CacheEntry_t* const Entry);
+				static uint8_t MS_Cache_Allocate(MS_Cache_t* const Cache, const uint32_t BlockAddress,
+				                                 MS_CacheEntry_t** const Entry);
+				static bool MS_Cache_ReadStreamCallback(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+				                                        const uint16_t BankBytes);
+				static bool MS_Cache_WriteStreamCallback(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+				                                         const uint16_t BankBytes);
+			#endif
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
@@ -37,109 +37,59 @@
 uint8_t SI_Host_ConfigurePipes(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, uint16_t ConfigDescriptorSize,
                               uint8_t* DeviceConfigDescriptor)
 {
-	uint8_t  FoundEndpoints = 0;
+	USB_ConfigIndex_t ConfigIndex;
+	bool              FoundSIInterface = false;
 	
 	memset(&SIInterfaceInfo->State, 0x00, sizeof(SIInterfaceInfo->State));
 	
-	if (DESCRIPTOR_TYPE(DeviceConfigDescriptor) != DTYPE_Configuration)
+	if (USB_GetConfigIndex(&ConfigIndex, ConfigDescriptorSize, DeviceConfigDescriptor) == CONFIGINDEX_InvalidConfigDescriptor)
 	  return SI_ENUMERROR_InvalidConfigDescriptor;
 	
-	if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &DeviceConfigDescriptor,
-	                              DComp_SI_Host_NextSIInterface) != DESCRIPTOR_SEARCH_COMP_Found)
+	for (uint8_t InterfaceIndex = 0; InterfaceIndex < ConfigIndex.TotalInterfaces; InterfaceIndex++)
 	{
-		return SI_ENUMERROR_NoSIInterfaceFound;
-	}
+		USB_ConfigIndex_Interface_t* SIInterface = &ConfigIndex.Interfaces[InterfaceIndex];
 
-	while (FoundEndpoints != (SI_FOUND_EVENTS_IN | SI_FOUND_DATAPIPE_IN | SI_FOUND_DATAPIPE_OUT))
-	{
-		if (USB_GetNextDescriptorComp(&ConfigDescriptorSize, &DeviceConfigDescriptor,
-		                              DComp_SI_Host_NextSIInterfaceEndpoint) != DESCRIPTOR_SEARCH_COMP_Found)
+		if ((SIInterface->Class    != STILL_IMAGE_CLASS)    ||
+		    (SIInterface->SubClass != STILL_IMAGE_SUBCLASS) ||
+		    (SIInterface->Protocol != STILL_IMAGE_PROTOCOL))
 		{
-			return SI_ENUMERROR_EndpointsNotFound;
+			continue;
 		}
-		
-		USB_Descriptor_Endpoint_t* EndpointData = DESCRIPTOR_PCAST(DeviceConfigDescriptor, USB_Descriptor_Endpoint_t);
 
-		if ((EndpointData->Attributes & EP_TYPE_MASK) == EP_TYPE_INTERRUPT)
-		{
-			if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-			{
-				Pipe_ConfigurePipe(SIInterfaceInfo->Config.EventsPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize,
-								   PIPE_BANK_DOUBLE);			
-				SIInterfaceInfo->State.EventsPipeSize = EndpointData->EndpointSize;
-
-				Pipe_SetInterruptPeriod(EndpointData->PollingIntervalMS);
-				
-				FoundEndpoints |= SI_FOUND_EVENTS_IN;
-			}
-		}
-		else
-		{
-			if (EndpointData->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN)
-			{
-				Pipe_ConfigurePipe(SIInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize,
-								   PIPE_BANK_DOUBLE);
-				SIInterfaceInfo->State.DataINPipeSize = EndpointData->EndpointSize;
+		FoundSIInterface = true;
 
-				FoundEndpoints |= SI_FOUND_DATAPIPE_IN;
-			}
-			else
-			{
-				Pipe_ConfigurePipe(SIInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
-								   EndpointData->EndpointAddress, EndpointData->EndpointSize,
-								   PIPE_BANK_DOUBLE);
-				SIInterfaceInfo->State.DataOUTPipeSize = EndpointData->EndpointSize;
+		const USB_ConfigIndex_Endpoint_t* EventsEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, SIInterface,
+		                                                                                 EP_TYPE_INTERRUPT, true);
+		const USB_ConfigIndex_Endpoint_t* DataINEndpoint  = USB_ConfigIndex_FindEndpoint(&ConfigIndex, SIInterface,
+		                                                                                 EP_TYPE_BULK, true);
+		const USB_ConfigIndex_Endpoint_t* DataOUTEndpoint = USB_ConfigIndex_FindEndpoint(&ConfigIndex, SIInterface,
+		                                                                                 EP_TYPE_BULK, false);
 
-				FoundEndpoints |= SI_FOUND_DATAPIPE_OUT;
-			}
-		}
-	}
+		if ((EventsEndpoint == NULL) || (DataINEndpoint == NULL) || (DataOUTEndpoint == NULL))
+		  continue;
 
-	SIInterfaceInfo->State.IsActive = true;
-	return SI_ENUMERROR_NoError;
-}
+		Pipe_ConfigurePipe(SIInterfaceInfo->Config.EventsPipeNumber, EP_TYPE_INTERRUPT, PIPE_TOKEN_IN,
+		                   EventsEndpoint->EndpointAddress, EventsEndpoint->EndpointSize,
+		                   PIPE_BANK_DOUBLE);
+		SIInterfaceInfo->State.EventsPipeSize = EventsEndpoint->EndpointSize;
 
-uint8_t DComp_SI_Host_NextSIInterface(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		USB_Descriptor_Interface_t* CurrentInterface = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                                USB_Descriptor_Interface_t);
+		Pipe_SetInterruptPeriod(EventsEndpoint->PollingIntervalMS);
 
-		if ((CurrentInterface->Class    == STILL_IMAGE_CLASS)    &&
-		    (CurrentInterface->SubClass == STILL_IMAGE_SUBCLASS) &&
-		    (CurrentInterface->Protocol == STILL_IMAGE_PROTOCOL))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	
-	return DESCRIPTOR_SEARCH_NotFound;
-}
+		Pipe_ConfigurePipe(SIInterfaceInfo->Config.DataINPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_IN,
+		                   DataINEndpoint->EndpointAddress, DataINEndpoint->EndpointSize,
+		                   PIPE_BANK_DOUBLE);
+		SIInterfaceInfo->State.DataINPipeSize = DataINEndpoint->EndpointSize;
 
-uint8_t DComp_SI_Host_NextSIInterfaceEndpoint(void* CurrentDescriptor)
-{
-	if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Endpoint)
-	{
-		USB_Descriptor_Endpoint_t* CurrentEndpoint = DESCRIPTOR_PCAST(CurrentDescriptor,
-		                                                              USB_Descriptor_Endpoint_t);
-	
-		uint8_t EndpointType = (CurrentEndpoint->Attributes & EP_TYPE_MASK);
+		Pipe_ConfigurePipe(SIInterfaceInfo->Config.DataOUTPipeNumber, EP_TYPE_BULK, PIPE_TOKEN_OUT,
+		                   DataOUTEndpoint->EndpointAddress, DataOUTEndpoint->EndpointSize,
+		                   PIPE_BANK_DOUBLE);
+		SIInterfaceInfo->State.DataOUTPipeSize = DataOUTEndpoint->EndpointSize;
 
-		if (((EndpointType == EP_TYPE_BULK) || (EndpointType == EP_TYPE_INTERRUPT)) &&
-		    (!(Pipe_IsEndpointBound(CurrentEndpoint->EndpointAddress))))
-		{
-			return DESCRIPTOR_SEARCH_Found;
-		}
-	}
-	else if (DESCRIPTOR_TYPE(CurrentDescriptor) == DTYPE_Interface)
-	{
-		return DESCRIPTOR_SEARCH_Fail;
+		SIInterfaceInfo->State.IsActive = true;
+		return SI_ENUMERROR_NoError;
 	}
 
-	return DESCRIPTOR_SEARCH_NotFound;
+	return (FoundSIInterface) ? SI_ENUMERROR_EndpointsNotFound : SI_ENUMERROR_NoSIInterfaceFound;
 }
 
 void SI_Host_USBTask(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
@@ -265,6 +215,168 @@ uint8_t SImage_Host_ReadData(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, voi
 	return ErrorCode;
 }
 
+uint8_t SImage_Host_GetObject(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, const uint32_t ObjectHandle,
+                              void* ChunkBuffer, const uint16_t ChunkSize, SI_Host_ChunkCallbackPtr_t Callback)
+{
+	if ((USB_HostState != HOST_STATE_Configured) || !(SIInterfaceInfo->State.IsActive))
+	  return HOST_SENDCONTROL_DeviceDisconnect;
+
+	if (!(ChunkSize))
+	  return SI_ERROR_LOGICAL_CMD_FAILED;
+
+	uint8_t  ErrorCode;
+	uint8_t  CallbackResult = STREAMCALLBACK_Continue;
+	uint32_t Params[1]      = {ObjectHandle};
+
+	SI_PIMA_Container_t PIMABlock;
+
+	if ((ErrorCode = SImage_Host_SendCommand(SIInterfaceInfo, PIMA_OPERATION_GETOBJECT, 1, Params)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	if ((ErrorCode = SImage_Host_ReceiveBlockHeader(SIInterfaceInfo, &PIMABlock)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	/* A device which refuses the command sends its response in place of the data container */
+	if ((PIMABlock.Type != CType_DataBlock) || (PIMABlock.DataLength < PIMA_DATA_SIZE(0)))
+	  return SI_ERROR_LOGICAL_CMD_FAILED;
+
+	uint32_t ObjectSize = (PIMABlock.DataLength - PIMA_DATA_SIZE(0));
+	uint32_t Offset     = 0;
+
+	Pipe_SelectPipe(SIInterfaceInfo->Config.DataINPipeNumber);
+	Pipe_Unfreeze();
+
+	while (Offset < ObjectSize)
+	{
+		uint16_t Bytes = ((ObjectSize - Offset) < ChunkSize) ? (ObjectSize - Offset) : ChunkSize;
+
+		if ((ErrorCode = Pipe_Read_Stream_LE(ChunkBuffer, Bytes, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+		{
+			Pipe_Freeze();
+			return ErrorCode;
+		}
+
+		/* Once aborted, the rest of the object is only read to keep the session in step with the device */
+		if (CallbackResult == STREAMCALLBACK_Continue)
+		{
+			Pipe_Freeze();
+			CallbackResult = Callback(Offset, ChunkBuffer, Bytes);
+
+			Pipe_SelectPipe(SIInterfaceInfo->Config.DataINPipeNumber);
+			Pipe_Unfreeze();
+		}
+
+		Offset += Bytes;
+	}
+
+	Pipe_ClearIN();
+
+	/* A container which fills its last packet is ended by a zero length packet */
+	if (!(PIMABlock.DataLength % SIInterfaceInfo->State.DataINPipeSize))
+	{
+		if ((ErrorCode = Pipe_WaitUntilReady()) != PIPE_READYWAIT_NoError)
+		{
+			Pipe_Freeze();
+			return ErrorCode;
+		}
+
+		Pipe_ClearIN();
+	}
+
+	Pipe_Freeze();
+
+	ErrorCode = SImage_Host_ReceiveResponse(SIInterfaceInfo);
+
+	if ((CallbackResult != STREAMCALLBACK_Continue) && (ErrorCode == PIPE_RWSTREAM_NoError))
+	  return PIPE_RWSTREAM_CallbackAborted;
+
+	return ErrorCode;
+}
+
+uint8_t SImage_Host_SendObject(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, const uint32_t ObjectSize,
+                               void* ChunkBuffer, const uint16_t ChunkSize, SI_Host_ChunkCallbackPtr_t Callback)
+{
+	if ((USB_HostState != HOST_STATE_Configured) || !(SIInterfaceInfo->State.IsActive))
+	  return HOST_SENDCONTROL_DeviceDisconnect;
+
+	if (!(ChunkSize))
+	  return SI_ERROR_LOGICAL_CMD_FAILED;
+
+	uint8_t  ErrorCode;
+	uint8_t  CallbackResult = STREAMCALLBACK_Continue;
+	uint32_t Offset         = 0;
+
+	if ((ErrorCode = SImage_Host_SendCommand(SIInterfaceInfo, PIMA_OPERATION_SENDOBJECT, 0, NULL)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	/* The data container shares the command's transaction ID, and its header is sent in the same transfer as the data */
+	SI_PIMA_Container_t PIMABlock = (SI_PIMA_Container_t)
+							{
+								.DataLength    = PIMA_DATA_SIZE(ObjectSize),
+								.Type          = CType_DataBlock,
+								.Code          = PIMA_OPERATION_SENDOBJECT,
+								.TransactionID = (SIInterfaceInfo->State.TransactionID - 1),
+							};
+
+	Pipe_SelectPipe(SIInterfaceInfo->Config.DataOUTPipeNumber);
+	Pipe_Unfreeze();
+
+	if ((ErrorCode = Pipe_Write_Stream_LE(&PIMABlock, PIMA_DATA_SIZE(0), NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+	{
+		Pipe_Freeze();
+		return ErrorCode;
+	}
+
+	while (Offset < ObjectSize)
+	{
+		uint16_t Bytes = ((ObjectSize - Offset) < ChunkSize) ? (ObjectSize - Offset) : ChunkSize;
+
+		Pipe_Freeze();
+		CallbackResult = Callback(Offset, ChunkBuffer, Bytes);
+
+		Pipe_SelectPipe(SIInterfaceInfo->Config.DataOUTPipeNumber);
+		Pipe_Unfreeze();
+
+		if (CallbackResult != STREAMCALLBACK_Continue)
+		  break;
+
+		if ((ErrorCode = Pipe_Write_Stream_LE(ChunkBuffer, Bytes, NO_STREAM_CALLBACK)) != PIPE_RWSTREAM_NoError)
+		{
+			Pipe_Freeze();
+			return ErrorCode;
+		}
+
+		Offset += Bytes;
+	}
+
+	Pipe_ClearOUT();
+
+	/* The data phase must end with a short packet, which is a zero length packet if the last one was full; an aborted
+	   transfer is ended the same way, leaving the device to reject the incomplete object */
+	if (!(PIMA_DATA_SIZE(Offset) % SIInterfaceInfo->State.DataOUTPipeSize))
+	{
+		if ((ErrorCode = Pipe_WaitUntilReady()) != PIPE_READYWAIT_NoError)
+		{
+			Pipe_Freeze();
+			return ErrorCode;
+		}
+
+		Pipe_ClearOUT();
+	}
+
+	Pipe_Freeze();
+
+	ErrorCode = SImage_Host_ReceiveResponse(SIInterfaceInfo);
+
+	if ((CallbackResult != STREAMCALLBACK_Continue) &&
+	    ((ErrorCode == PIPE_RWSTREAM_NoError) || (ErrorCode == SI_ERROR_LOGICAL_CMD_FAILED)))
+	{
+		return PIPE_RWSTREAM_CallbackAborted;
+	}
+
+	return ErrorCode;
+}
+
 bool SImage_Host_IsEventReceived(USB_ClassInfo_SI_Host_t* SIInterfaceInfo)
 {
 	bool IsEventReceived = false;
@@ -316,7 +428,7 @@ uint8_t SImage_Host_OpenSession(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
 	if ((ErrorCode = SImage_Host_ReceiveBlockHeader(SIInterfaceInfo, &PIMABlock)) != PIPE_RWSTREAM_NoError)
 	  return ErrorCode;
 	  
-	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != 0x2001))
+	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != PIMA_RESPONSE_OK))
 	  return SI_ERROR_LOGICAL_CMD_FAILED;
 	  
 	SIInterfaceInfo->State.TransactionID = 0;
@@ -348,7 +460,7 @@ uint8_t SImage_Host_CloseSession(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
 
 	SIInterfaceInfo->State.IsSessionOpen = false;
 
-	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != 0x2001))
+	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != PIMA_RESPONSE_OK))
 	  return SI_ERROR_LOGICAL_CMD_FAILED;
 
 	return PIPE_RWSTREAM_NoError;
@@ -385,7 +497,7 @@ uint8_t SImage_Host_ReceiveResponse(USB_ClassInfo_SI_Host_t* const SIInterfaceIn
 	if ((ErrorCode = SImage_Host_ReceiveBlockHeader(SIInterfaceInfo, &PIMABlock)) != PIPE_RWSTREAM_NoError)
 	  return ErrorCode;
 
-	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != 0x2001))
+	if ((PIMABlock.Type != CType_ResponseBlock) || (PIMABlock.Code != PIMA_RESPONSE_OK))
 	  return SI_ERROR_LOGICAL_CMD_FAILED;
 	  
 	return PIPE_RWSTREAM_NoError;
@@ -38,6 +38,11 @@
  *  \section Module Description
  *  Host Mode USB Class driver framework interface, for the Still Image USB Class driver.
  *
+ *  Objects of any size may be read from or written to the attached device with \ref SImage_Host_GetObject() and
+ *  \ref SImage_Host_SendObject(), which handle the PIMA data container and its packets, and pass the object to or
+ *  from the user application one chunk at a time through a callback function. The data pipe is frozen while the
+ *  callback runs, so that the device is held off until the application is ready for the next chunk.
+ *
  *  @{
  */
 
@@ -59,6 +64,19 @@
 			#define SI_ERROR_LOGICAL_CMD_FAILED              0x80
 
 		/* Type Defines: */
+			/** Type define for a chunk callback function, used by \ref SImage_Host_GetObject() and \ref SImage_Host_SendObject()
+			 *  to pass each chunk of an object to or from the user application. When receiving, the chunk holds the next part of
+			 *  the object; when sending, the callback must fill the chunk with the next part of the object.
+			 *
+			 *  \param[in] Offset  Offset in bytes of the chunk from the start of the object
+			 *  \param[in,out] Chunk  Pointer to the chunk buffer given to the transfer function
+			 *  \param[in] Bytes  Number of bytes of the object in the chunk, which is the chunk buffer's size except for the
+			 *                    last chunk of the object
+			 *
+			 *  \return A value from the \ref StreamCallback_Return_ErrorCodes_t enum
+			 */
+			typedef uint8_t (* const SI_Host_ChunkCallbackPtr_t)(const uint32_t Offset, uint8_t* const Chunk, const uint16_t Bytes);
+
 			typedef struct
 			{
 				const struct
@@ -212,6 +230,42 @@
 			 */
 			uint8_t SImage_Host_ReadData(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, void* Buffer,
 			                             const uint16_t Bytes) ATTR_NON_NULL_PTR_ARG(1, 2);
+
+			/** Reads an object of any size from the attached device with a PIMA GetObject command, passing it to the user
+			 *  application in chunks of the given buffer's size through a callback function. The callback is run with the data
+			 *  pipe frozen, so the device waits while each chunk is processed. If the callback aborts the transfer, the rest of
+			 *  the object is read and discarded so that the session stays in step with the device.
+			 *
+			 *  \param[in,out] SIInterfaceInfo  Pointer to a structure containing a Still Image Class host configuration and state
+			 *  \param[in] ObjectHandle  Device handle of the object to read
+			 *  \param[out] ChunkBuffer  Pointer to a buffer where each chunk of the object is stored before it is passed to the callback
+			 *  \param[in] ChunkSize  Size in bytes of the chunk buffer, which must be non-zero
+			 *  \param[in] Callback  Function to call with each chunk of the object
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum, or \ref SI_ERROR_LOGICAL_CMD_FAILED if the device
+			 *          returned a logical command failure or the chunk size was zero
+			 */
+			uint8_t SImage_Host_GetObject(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, const uint32_t ObjectHandle,
+			                              void* ChunkBuffer, const uint16_t ChunkSize,
+			                              SI_Host_ChunkCallbackPtr_t Callback) ATTR_NON_NULL_PTR_ARG(1, 3, 5);
+
+			/** Writes an object of any size to the attached device with a PIMA SendObject command, taking it from the user
+			 *  application in chunks of the given buffer's size through a callback function. The callback is run with the data
+			 *  pipe frozen. The device must already have been told of the object with a SendObjectInfo command. If the callback
+			 *  aborts the transfer, the data phase is ended early, which the device will answer as an incomplete transfer.
+			 *
+			 *  \param[in,out] SIInterfaceInfo  Pointer to a structure containing a Still Image Class host configuration and state
+			 *  \param[in] ObjectSize  Size in bytes of the object to send
+			 *  \param[out] ChunkBuffer  Pointer to a buffer for the callback to fill with each chunk of the object
+			 *  \param[in] ChunkSize  Size in bytes of the chunk buffer, which must be non-zero
+			 *  \param[in] Callback  Function to call to fill each chunk of the object
+			 *
+			 *  \return A value from the \ref Pipe_Stream_RW_ErrorCodes_t enum, or \ref SI_ERROR_LOGICAL_CMD_FAILED if the device
+			 *          returned a logical command failure or the chunk size was zero
+			 */
+			uint8_t SImage_Host_SendObject(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo, const uint32_t ObjectSize,
+			                               void* ChunkBuffer, const uint16_t ChunkSize,
+			                               SI_Host_ChunkCallbackPtr_t Callback) ATTR_NON_NULL_PTR_ARG(1, 3, 5);
 			
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
@@ -220,17 +274,13 @@
 			#define STILL_IMAGE_SUBCLASS           0x01
 			#define STILL_IMAGE_PROTOCOL           0x01
 
-			#define SI_FOUND_EVENTS_IN             (1 << 0)
-			#define SI_FOUND_DATAPIPE_IN           (1 << 1)
-			#define SI_FOUND_DATAPIPE_OUT          (1 << 2)
-
 			#define COMMAND_DATA_TIMEOUT_MS        5000
+
+			#define PIMA_OPERATION_GETOBJECT       0x1009
+			#define PIMA_OPERATION_SENDOBJECT      0x100D
 		
 		/* Function Prototypes: */
 			#if defined(INCLUDE_FROM_SI_CLASS_HOST_C)
-				static uint8_t DComp_SI_Host_NextSIInterface(void* CurrentDescriptor) ATTR_NON_NULL_PTR_ARG(1);
-				static uint8_t DComp_SI_Host_NextSIInterfaceEndpoint(void* CurrentDescriptor) ATTR_NON_NULL_PTR_ARG(1);
-
 				static uint8_t SImage_Host_SendBlockHeader(USB_ClassInfo_SI_Host_t* SIInterfaceInfo,
 				                                           SI_PIMA_Container_t* PIMAHeader);
 				static uint8_t SImage_Host_ReceiveBlockHeader(USB_ClassInfo_SI_Host_t* SIInterfaceInfo,
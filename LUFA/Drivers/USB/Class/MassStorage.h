@@ -34,7 +34,9 @@
  *  \section Sec_Dependencies Module Source Dependencies
  *  The following files must be built with any user project that uses this module:
  *    - LUFA/Drivers/USB/Class/Device/MassStorage.c
+ *    - LUFA/Drivers/USB/Class/Device/MassStorageDataflash.c (if the Dataflash storage is used, via its own header)
  *    - LUFA/Drivers/USB/Class/Host/MassStorage.c
+ *    - LUFA/Drivers/USB/Class/Host/MassStorageCache.c (if the host block cache is used)
  *
  *  \section Module Description
  *  Mass Storage Class Driver module. This module contains an internal implementation of the USB Audio Class, for both
@@ -59,6 +61,7 @@
 		
 		#if defined(USB_CAN_BE_HOST)
 			#include "Host/MassStorage.h"
+			#include "Host/MassStorageCache.h"
 		#endif
 		
 #endif
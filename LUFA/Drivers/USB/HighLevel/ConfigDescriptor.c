@@ -138,3 +138,97 @@ uint8_t USB_GetNextDescriptorComp(uint16_t* BytesRem, uint8_t** CurrConfigLoc, C
 	
 	return DESCRIPTOR_SEARCH_COMP_EndOfDescriptor;
 }
+
+uint8_t USB_GetConfigIndex(USB_ConfigIndex_t* const Index,
+                           const uint16_t ConfigDescriptorSize,
+                           const uint8_t* const ConfigDescriptorData)
+{
+	USB_ConfigIndex_Interface_t* CurrInterface = NULL;
+	uint16_t                     Offset        = 0;
+
+	Index->TotalInterfaces = 0;
+	Index->TotalEndpoints  = 0;
+
+	if ((ConfigDescriptorSize < sizeof(USB_Descriptor_Configuration_Header_t)) ||
+	    (DESCRIPTOR_TYPE(ConfigDescriptorData) != DTYPE_Configuration))
+	{
+		return CONFIGINDEX_InvalidConfigDescriptor;
+	}
+
+	while ((ConfigDescriptorSize - Offset) >= sizeof(USB_Descriptor_Header_t))
+	{
+		const uint8_t* CurrDescriptor = &ConfigDescriptorData[Offset];
+		uint8_t        CurrSize       = DESCRIPTOR_SIZE(CurrDescriptor);
+
+		if ((CurrSize < sizeof(USB_Descriptor_Header_t)) || (CurrSize > (ConfigDescriptorSize - Offset)))
+		  return CONFIGINDEX_InvalidConfigDescriptor;
+
+		if ((DESCRIPTOR_TYPE(CurrDescriptor) == DTYPE_Interface) && (CurrSize >= sizeof(USB_Descriptor_Interface_t)))
+		{
+			if (Index->TotalInterfaces == CONFIG_INDEX_MAX_INTERFACES)
+			  return CONFIGINDEX_Truncated;
+
+			const USB_Descriptor_Interface_t* InterfaceData = DESCRIPTOR_PCAST(CurrDescriptor, const USB_Descriptor_Interface_t);
+
+			CurrInterface = &Index->Interfaces[Index->TotalInterfaces++];
+			*CurrInterface = (USB_ConfigIndex_Interface_t)
+				{
+					.Offset           = Offset,
+					.InterfaceNumber  = InterfaceData->InterfaceNumber,
+					.AlternateSetting = InterfaceData->AlternateSetting,
+					.Class            = InterfaceData->Class,
+					.SubClass         = InterfaceData->SubClass,
+					.Protocol         = InterfaceData->Protocol,
+					.FirstEndpoint    = Index->TotalEndpoints,
+					.TotalEndpoints   = 0,
+				};
+		}
+		else if ((DESCRIPTOR_TYPE(CurrDescriptor) == DTYPE_Endpoint) && (CurrSize >= sizeof(USB_Descriptor_Endpoint_t)) &&
+		         (CurrInterface != NULL))
+		{
+			if (Index->TotalEndpoints == CONFIG_INDEX_MAX_ENDPOINTS)
+			  return CONFIGINDEX_Truncated;
+
+			const USB_Descriptor_Endpoint_t* EndpointData = DESCRIPTOR_PCAST(CurrDescriptor, const USB_Descriptor_Endpoint_t);
+
+			Index->Endpoints[Index->TotalEndpoints++] = (USB_ConfigIndex_Endpoint_t)
+				{
+					.Offset            = Offset,
+					.EndpointAddress   = EndpointData->EndpointAddress,
+					.Attributes        = EndpointData->Attributes,
+					.EndpointSize      = EndpointData->EndpointSize,
+					.PollingIntervalMS = EndpointData->PollingIntervalMS,
+				};
+
+			CurrInterface->TotalEndpoints++;
+		}
+
+		Offset += CurrSize;
+	}
+
+	return CONFIGINDEX_Successful;
+}
+
+#if defined(USB_CAN_BE_HOST)
+const USB_ConfigIndex_Endpoint_t* USB_ConfigIndex_FindEndpoint(const USB_ConfigIndex_t* const Index,
+                                                               const USB_ConfigIndex_Interface_t* const Interface,
+                                                               const uint8_t Type,
+                                                               const bool DirectionIN)
+{
+	const USB_ConfigIndex_Endpoint_t* CurrEndpoint = &Index->Endpoints[Interface->FirstEndpoint];
+
+	for (uint8_t EndpointsRem = Interface->TotalEndpoints; EndpointsRem; EndpointsRem--, CurrEndpoint++)
+	{
+		if (((CurrEndpoint->Attributes & EP_TYPE_MASK) != Type) ||
+		    (((CurrEndpoint->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN) != 0) != DirectionIN))
+		{
+			continue;
+		}
+
+		if (!(Pipe_IsEndpointBound(CurrEndpoint->EndpointAddress)))
+		  return CurrEndpoint;
+	}
+
+	return NULL;
+}
+#endif
@@ -103,6 +103,24 @@
 			/** Returns the descriptor's size, expressed as the 8-bit value indicating the number of bytes. */
 			#define DESCRIPTOR_SIZE(DescriptorPtr)    DESCRIPTOR_CAST(DescriptorPtr, USB_Descriptor_Header_t).Size
 
+			#if !defined(CONFIG_INDEX_MAX_INTERFACES) || defined(__DOXYGEN__)
+				/** Constant indicating the maximum number of interface descriptors (including alternate settings) which
+				 *  can be stored in a \ref USB_ConfigIndex_t structure by \ref USB_GetConfigIndex(). Any interfaces after
+				 *  this many are left out of the index. This value may be overridden in the user project makefile by
+				 *  passing the CONFIG_INDEX_MAX_INTERFACES token to the compiler via the -D switch.
+				 */
+				#define CONFIG_INDEX_MAX_INTERFACES       6
+			#endif
+
+			#if !defined(CONFIG_INDEX_MAX_ENDPOINTS) || defined(__DOXYGEN__)
+				/** Constant indicating the maximum number of endpoint descriptors which can be stored in a
+				 *  \ref USB_ConfigIndex_t structure by \ref USB_GetConfigIndex(). Any endpoints after this many are left
+				 *  out of the index. This value may be overridden in the user project makefile by passing the
+				 *  CONFIG_INDEX_MAX_ENDPOINTS token to the compiler via the -D switch.
+				 */
+				#define CONFIG_INDEX_MAX_ENDPOINTS        12
+			#endif
+
 		/* Type Defines: */
 			/** Type define for a Configuration Descriptor comparator function (function taking a pointer to an array
 			 *  of type void, returning a uint8_t value).
@@ -111,6 +129,46 @@
 			 */
 			typedef uint8_t (* const ConfigComparatorPtr_t)(void* const);
 
+			/** Type define for an indexed endpoint descriptor, stored in a \ref USB_ConfigIndex_t structure by
+			 *  \ref USB_GetConfigIndex().
+			 */
+			typedef struct
+			{
+				uint16_t Offset; /**< Offset of the endpoint descriptor from the start of the configuration descriptor */
+				uint8_t  EndpointAddress; /**< Address of the endpoint, including the direction mask */
+				uint8_t  Attributes; /**< Endpoint attributes, the type of which can be found by masking with \ref EP_TYPE_MASK */
+				uint16_t EndpointSize; /**< Maximum packet size of the endpoint, in bytes */
+				uint8_t  PollingIntervalMS; /**< Polling interval of the endpoint, for interrupt and isochronous endpoints */
+			} USB_ConfigIndex_Endpoint_t;
+
+			/** Type define for an indexed interface descriptor, stored in a \ref USB_ConfigIndex_t structure by
+			 *  \ref USB_GetConfigIndex(). Each alternate setting of an interface is indexed separately.
+			 */
+			typedef struct
+			{
+				uint16_t Offset; /**< Offset of the interface descriptor from the start of the configuration descriptor */
+				uint8_t  InterfaceNumber; /**< Index of the interface in the configuration */
+				uint8_t  AlternateSetting; /**< Alternate setting of the interface */
+				uint8_t  Class; /**< Interface class ID */
+				uint8_t  SubClass; /**< Interface subclass ID */
+				uint8_t  Protocol; /**< Interface protocol ID */
+				uint8_t  FirstEndpoint; /**< Index of the interface's first endpoint in the index's endpoint table */
+				uint8_t  TotalEndpoints; /**< Number of the interface's endpoints stored in the index's endpoint table */
+			} USB_ConfigIndex_Interface_t;
+
+			/** Type define for an index of a device's configuration descriptor, built by \ref USB_GetConfigIndex(). The
+			 *  index holds the interfaces and endpoints of the configuration in the order they appear in the descriptor,
+			 *  so that a class driver can look through it for the interface and endpoints it needs rather than searching
+			 *  the configuration descriptor again for each one.
+			 */
+			typedef struct
+			{
+				uint8_t                     TotalInterfaces; /**< Number of interfaces stored in the index */
+				uint8_t                     TotalEndpoints; /**< Number of endpoints stored in the index */
+				USB_ConfigIndex_Interface_t Interfaces[CONFIG_INDEX_MAX_INTERFACES]; /**< Indexed interfaces */
+				USB_ConfigIndex_Endpoint_t  Endpoints[CONFIG_INDEX_MAX_ENDPOINTS]; /**< Indexed endpoints */
+			} USB_ConfigIndex_t;
+
 		/* Function Prototypes: */
 			/** Searches for the next descriptor in the given configuration descriptor using a premade comparator
 			 *  function. The routine updates the position and remaining configuration descriptor bytes values
@@ -189,6 +247,17 @@
 				DESCRIPTOR_SEARCH_COMP_Fail            = 1, /**< Comparator function returned Descriptor_Search_Fail. */
 				DESCRIPTOR_SEARCH_COMP_EndOfDescriptor = 2, /**< End of configuration descriptor reached before match found. */
 			};
+
+			/** Enum for return values of \ref USB_GetConfigIndex(). */
+			enum USB_GetConfigIndex_ErrorCodes_t
+			{
+				CONFIGINDEX_Successful                 = 0, /**< The whole configuration descriptor was indexed. */
+				CONFIGINDEX_InvalidConfigDescriptor    = 1, /**< The given data is not a valid configuration descriptor. */
+				CONFIGINDEX_Truncated                  = 2, /**< The index was filled before the end of the configuration
+				                                             *   descriptor was reached. The interfaces and endpoints which
+				                                             *   were indexed are valid.
+				                                             */
+			};
 	
 		/* Function Prototypes: */
 			/** Retrieves the configuration descriptor data from an attached device via a standard request into a buffer,
@@ -248,6 +317,42 @@
 			                                      const uint8_t AfterType)
 			                                      ATTR_NON_NULL_PTR_ARG(1, 2);
 
+			/** Builds an index of the interfaces and endpoints of a configuration descriptor in a single pass through
+			 *  the descriptor, recording each descriptor's offset and the values class drivers need to select an interface
+			 *  and configure its pipes. Endpoints are stored against the interface descriptor they follow; any which
+			 *  come before the first interface descriptor are ignored.
+			 *
+			 * \param[out] Index  Pointer to the index to build
+			 * \param[in] ConfigDescriptorSize  Size of the configuration descriptor, in bytes
+			 * \param[in] ConfigDescriptorData  Pointer to the start of the configuration descriptor
+			 *
+			 * \return A value from the \ref USB_GetConfigIndex_ErrorCodes_t enum
+			 */
+			uint8_t USB_GetConfigIndex(USB_ConfigIndex_t* const Index,
+			                           const uint16_t ConfigDescriptorSize,
+			                           const uint8_t* const ConfigDescriptorData)
+			                           ATTR_NON_NULL_PTR_ARG(1, 3);
+
+			#if defined(USB_CAN_BE_HOST) || defined(__DOXYGEN__)
+				/** Searches an indexed interface for an endpoint of the given type and direction which has not already been
+				 *  bound to a pipe, for use by class drivers when configuring their pipes.
+				 *
+				 *  \note This function is available in USB Host mode only.
+				 *
+				 * \param[in] Index  Pointer to the index built by \ref USB_GetConfigIndex()
+				 * \param[in] Interface  Pointer to the interface in the index whose endpoints are to be searched
+				 * \param[in] Type  Type of the endpoint to search for, an EP_TYPE_* mask
+				 * \param[in] DirectionIN  Set to true to search for an IN endpoint, false for an OUT endpoint
+				 *
+				 * \return Pointer to the first matching endpoint in the index, or NULL if the interface has none
+				 */
+				const USB_ConfigIndex_Endpoint_t* USB_ConfigIndex_FindEndpoint(const USB_ConfigIndex_t* const Index,
+				                                                               const USB_ConfigIndex_Interface_t* const Interface,
+				                                                               const uint8_t Type,
+				                                                               const bool DirectionIN)
+				                                                               ATTR_NON_NULL_PTR_ARG(1, 2);
+			#endif
+
 		/* Inline Functions: */
 			/** Skips over the current sub-descriptor inside the configuration descriptor, so that the pointer then
 			    points to the next sub-descriptor. The bytes remaining value is automatically decremented.
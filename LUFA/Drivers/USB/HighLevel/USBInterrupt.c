@@ -229,14 +229,39 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 	#endif
 }
 
-#if defined(INTERRUPT_CONTROL_ENDPOINT)
+#if defined(INTERRUPT_CONTROL_ENDPOINT) || defined(INTERRUPT_DATA_ENDPOINTS)
 ISR(USB_COM_vect, ISR_BLOCK)
 {
 	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
 
+	#if defined(INTERRUPT_DATA_ENDPOINTS) && defined(USB_CAN_BE_DEVICE)
+	uint8_t EndpointInterrupts = Endpoint_GetEndpointInterrupts();
+
+	#if defined(INTERRUPT_CONTROL_ENDPOINT)
+	EndpointInterrupts &= ~(1 << ENDPOINT_CONTROLEP);
+	#endif
+
+	for (uint8_t EPNum = 0; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++)
+	{
+		if (!(EndpointInterrupts & (1 << EPNum)))
+		  continue;
+
+		Endpoint_SelectEndpoint(EPNum);
+
+		EndpointCallbackPtr_t Callback = Endpoint_Callbacks[EPNum];
+
+		if (Callback != NULL)
+		  Callback();
+		else
+		  Endpoint_DisarmCallback();
+	}
+	#endif
+
+	#if defined(INTERRUPT_CONTROL_ENDPOINT)
 	USB_USBTask();
 
 	USB_INT_Clear(USB_INT_RXSTPI);
+	#endif
 	
 	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
 }
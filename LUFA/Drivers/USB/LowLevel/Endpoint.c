@@ -32,6 +32,8 @@
 
 #if defined(USB_CAN_BE_DEVICE)
 
+#include <util/atomic.h>
+
 #define  INCLUDE_FROM_ENDPOINT_C
 #include "Endpoint.h"
 
@@ -39,6 +41,10 @@
 uint8_t USB_ControlEndpointSize = ENDPOINT_CONTROLEP_DEFAULT_SIZE;
 #endif
 
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+volatile EndpointCallbackPtr_t Endpoint_Callbacks[ENDPOINT_TOTAL_ENDPOINTS];
+#endif
+
 uint8_t Endpoint_BytesToEPSizeMaskDynamic(const uint16_t Size)
 {
 	return Endpoint_BytesToEPSizeMask(Size);
@@ -71,6 +77,16 @@ void Endpoint_ClearEndpoints(void)
 	}
 }
 
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+void Endpoint_SetCallback(const uint8_t EndpointNumber, const EndpointCallbackPtr_t Callback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Endpoint_Callbacks[EndpointNumber] = Callback;
+	}
+}
+#endif
+
 void Endpoint_ClearStatusStage(void)
 {
 	if (USB_ControlRequest.bmRequestType & REQDIR_DEVICETOHOST)
@@ -144,45 +160,32 @@ uint8_t Endpoint_Discard_Stream(uint16_t Length
 	  return ErrorCode;
 
 	#if defined(FAST_STREAM_TRANSFERS)
-	uint8_t BytesRemToAlignment = (Endpoint_BytesInEndpoint() & 0x07);
-
-	if (Length >= 8)
+	while (Length)
 	{
-		Length -= BytesRemToAlignment;
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			Endpoint_ClearOUT();
 
-		switch (BytesRemToAlignment)
+			#if !defined(NO_STREAM_CALLBACKS)
+			if ((Callback != NULL) && (Callback() == STREAMCALLBACK_Abort))
+			  return ENDPOINT_RWSTREAM_CallbackAborted;
+			#endif
+
+			if ((ErrorCode = Endpoint_WaitUntilReady()))
+			  return ErrorCode;
+		}
+		else
 		{
-			default:
-				do
-				{
-					if (!(Endpoint_IsReadWriteAllowed()))
-					{
-						Endpoint_ClearOUT();
-
-						#if !defined(NO_STREAM_CALLBACKS)
-						if ((Callback != NULL) && (Callback() == STREAMCALLBACK_Abort))
-						  return ENDPOINT_RWSTREAM_CallbackAborted;
-						#endif
-
-						if ((ErrorCode = Endpoint_WaitUntilReady()))
-						  return ErrorCode;
-					}
-
-					Length -= 8;
-					
-					Endpoint_Discard_Byte();
-			case 7: Endpoint_Discard_Byte();
-			case 6: Endpoint_Discard_Byte();
-			case 5: Endpoint_Discard_Byte();
-			case 4: Endpoint_Discard_Byte();
-			case 3: Endpoint_Discard_Byte();
-			case 2: Endpoint_Discard_Byte();
-			case 1:	Endpoint_Discard_Byte();
-				} while (Length >= 8);	
+			uint16_t BytesInBank     = Endpoint_BytesInEndpoint();
+			uint16_t BytesToTransfer = (Length < BytesInBank) ? Length : BytesInBank;
+
+			Length -= BytesToTransfer;
+
+			while (BytesToTransfer--)
+			  Endpoint_Discard_Byte();
 		}
 	}
-	#endif
-
+	#else
 	while (Length)
 	{
 		if (!(Endpoint_IsReadWriteAllowed()))
@@ -203,6 +206,7 @@ uint8_t Endpoint_Discard_Stream(uint16_t Length
 			Length--;
 		}
 	}
+	#endif
 	
 	return ENDPOINT_RWSTREAM_NoError;
 }
@@ -210,60 +214,70 @@ uint8_t Endpoint_Discard_Stream(uint16_t Length
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_LE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(*(BufferPtr++))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_PStream_LE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(pgm_read_byte(BufferPtr++))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_EStream_LE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(eeprom_read_byte(BufferPtr++))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_BE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            Length - 1
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(*(BufferPtr--))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_EStream_BE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            Length - 1
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(eeprom_read_byte(BufferPtr--))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_PStream_BE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            Length - 1
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(pgm_read_byte(BufferPtr--))
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_LE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     Endpoint_BytesInEndpoint()
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *(BufferPtr++) = Endpoint_Read_Byte()
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_LE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     Endpoint_BytesInEndpoint()
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_write_byte(BufferPtr++, Endpoint_Read_Byte())
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_BE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            Length - 1
+#define  TEMPLATE_BANK_BYTES()                     Endpoint_BytesInEndpoint()
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *(BufferPtr--) = Endpoint_Read_Byte()
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_BE
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            Length - 1
+#define  TEMPLATE_BANK_BYTES()                     Endpoint_BytesInEndpoint()
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_write_byte(BufferPtr--, Endpoint_Read_Byte())
 #include "Template/Template_Endpoint_RW.c"
 
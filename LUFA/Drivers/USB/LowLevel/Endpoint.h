@@ -156,6 +156,21 @@
 			#else
 				#define ENDPOINT_TOTAL_ENDPOINTS              1
 			#endif
+
+			/** Interrupt mask for \ref Endpoint_ArmCallback(), to run the endpoint's callback when a SETUP packet
+			 *  is received on a CONTROL type endpoint.
+			 */
+			#define ENDPOINT_INT_SETUP                    (1 << RXSTPE)
+
+			/** Interrupt mask for \ref Endpoint_ArmCallback(), to run the endpoint's callback when an IN endpoint
+			 *  has a bank free for the next packet.
+			 */
+			#define ENDPOINT_INT_IN                       (1 << TXINE)
+
+			/** Interrupt mask for \ref Endpoint_ArmCallback(), to run the endpoint's callback when an OUT endpoint
+			 *  has received a packet.
+			 */
+			#define ENDPOINT_INT_OUT                      (1 << RXOUTE)
 			
 		/* Pseudo-Function Macros: */
 			#if defined(__DOXYGEN__)
@@ -248,6 +263,19 @@
 				 *  \return Boolean true if the specified endpoint has interrupted, false otherwise
 				 */
 				static inline bool Endpoint_HasEndpointInterrupted(uint8_t EndpointNumber);
+
+				/** Enables the given interrupts on the currently selected endpoint, so that the endpoint's callback
+				 *  (see \ref Endpoint_SetCallback()) is run from the USB_COM interrupt when any of them occur. The
+				 *  interrupts are level triggered, and fire for as long as their condition holds - the callback must
+				 *  either clear the condition (for example by sending or acknowledging a packet) or disarm them via
+				 *  \ref Endpoint_DisarmCallback().
+				 *
+				 *  \param[in] InterruptMask  Mask of ENDPOINT_INT_* masks, indicating which interrupts to enable
+				 */
+				static inline void Endpoint_ArmCallback(uint8_t InterruptMask);
+
+				/** Disables all the interrupts which run the currently selected endpoint's callback. */
+				static inline void Endpoint_DisarmCallback(void);
 				
 				/** Determines if the selected IN endpoint is ready for a new packet.
 				 *
@@ -373,6 +401,11 @@
 				#define Endpoint_GetEndpointInterrupts()      UEINT
 
 				#define Endpoint_HasEndpointInterrupted(n)    ((UEINT & (1 << n)) ? true : false)
+
+				#define Endpoint_ArmCallback(mask)            MACROS{ UEIENX |= (mask); }MACROE
+
+				#define Endpoint_DisarmCallback()             MACROS{ UEIENX &= ~(ENDPOINT_INT_SETUP | ENDPOINT_INT_IN | \
+				                                                                  ENDPOINT_INT_OUT); }MACROE
 				
 				#define Endpoint_IsINReady()                  ((UEINTX & (1 << TXINI))  ? true : false)
 				
@@ -464,6 +497,14 @@
 				                                            */
 			};
 
+		/* Type Defines: */
+			#if defined(INTERRUPT_DATA_ENDPOINTS) || defined(__DOXYGEN__)
+				/** Type define for an endpoint callback, run from the USB_COM interrupt with its endpoint selected
+				 *  when one of the endpoint's armed interrupts occurs. See \ref Endpoint_SetCallback().
+				 */
+				typedef void (*EndpointCallbackPtr_t)(void);
+			#endif
+
 		/* Inline Functions: */
 			/** Reads one byte from the currently selected endpoint's bank, for OUT direction endpoints.
 			 *
@@ -735,6 +776,27 @@
 			bool Endpoint_ConfigureEndpoint(const uint8_t  Number, const uint8_t Type, const uint8_t Direction,
 			                                const uint16_t Size, const uint8_t Banks);
 
+			#if defined(INTERRUPT_DATA_ENDPOINTS) || defined(__DOXYGEN__)
+				/** Sets the callback for the given endpoint, which is run from the USB_COM interrupt whenever one of
+				 *  the interrupts armed on the endpoint via \ref Endpoint_ArmCallback() occurs. This allows endpoints
+				 *  to be serviced as soon as the host sends or collects a packet, rather than by polling them from the
+				 *  main loop. The callback runs with the endpoint selected, and the previously selected endpoint is
+				 *  restored once it returns.
+				 *
+				 *  Endpoints whose interrupts occur without a callback set have their interrupts disarmed. If the
+				 *  INTERRUPT_CONTROL_ENDPOINT token is also defined the control endpoint is always handled by the
+				 *  library, and its callback is never run.
+				 *
+				 *  \note This is only available if the INTERRUPT_DATA_ENDPOINTS token is passed to the compiler
+				 *        via the -D option. Callbacks are kept across bus resets and configuration changes, but the
+				 *        endpoint interrupts are not; they must be armed again once the endpoints are configured.
+				 *
+				 *  \param[in] EndpointNumber  Endpoint number whose callback is to be set
+				 *  \param[in] Callback        Routine to run when the endpoint interrupts, or NULL for none
+				 */
+				void Endpoint_SetCallback(const uint8_t EndpointNumber, const EndpointCallbackPtr_t Callback);
+			#endif
+
 			/** Spinloops until the currently selected non-control endpoint is ready for the next packet of data
 			 *  to be read or written to it.
 			 *
@@ -1153,6 +1215,7 @@
 		/* Macros: */
 			#define Endpoint_AllocateMemory()              MACROS{ UECFG1X |=  (1 << ALLOC); }MACROE
 			#define Endpoint_DeallocateMemory()            MACROS{ UECFG1X &= ~(1 << ALLOC); }MACROE
+			#define Endpoint_GetBankSize()                 (8 << ((UECFG1X >> EPSIZE0) & 0x07))
 			
 			#define _ENDPOINT_GET_MAXSIZE(n)               _ENDPOINT_GET_MAXSIZE2(ENDPOINT_DETAILS_EP ## n)
 			#define _ENDPOINT_GET_MAXSIZE2(details)        _ENDPOINT_GET_MAXSIZE3(details)
@@ -1186,6 +1249,11 @@
 			                                                 Endpoint_BytesToEPSizeMask(Size) :  \
 			                                                 Endpoint_BytesToEPSizeMaskDynamic(Size))))
 													
+		/* External Variables: */
+			#if defined(INTERRUPT_DATA_ENDPOINTS)
+				extern volatile EndpointCallbackPtr_t Endpoint_Callbacks[ENDPOINT_TOTAL_ENDPOINTS];
+			#endif
+
 		/* Function Prototypes: */
 			void    Endpoint_ClearEndpoints(void);
 			uint8_t Endpoint_BytesToEPSizeMaskDynamic(const uint16_t Size);
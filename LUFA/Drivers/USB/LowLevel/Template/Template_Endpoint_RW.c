@@ -7,45 +7,47 @@ uint8_t TEMPLATE_FUNC_NAME (void* Buffer, uint16_t Length _CALLBACK_PARAM)
 	  return ErrorCode;
 
 	#if defined(FAST_STREAM_TRANSFERS)
-	uint8_t BytesRemToAlignment = (Endpoint_BytesInEndpoint() & 0x07);
-
-	if (Length >= 8)
+	while (Length)
 	{
-		Length -= BytesRemToAlignment;
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			TEMPLATE_CLEAR_ENDPOINT();
+
+			#if !defined(NO_STREAM_CALLBACKS)
+			if ((Callback != NULL) && (Callback() == STREAMCALLBACK_Abort))
+			  return ENDPOINT_RWSTREAM_CallbackAborted;
+			#endif
 
-		switch (BytesRemToAlignment)
+			if ((ErrorCode = Endpoint_WaitUntilReady()))
+			  return ErrorCode;
+		}
+		else
 		{
-			default:
-				do
-				{
-					if (!(Endpoint_IsReadWriteAllowed()))
-					{
-						TEMPLATE_CLEAR_ENDPOINT();
+			/* Move as much as the bank can take (or holds) in one go, without re-checking the bank */
+			uint16_t BytesInBank     = TEMPLATE_BANK_BYTES();
+			uint16_t BytesToTransfer = (Length < BytesInBank) ? Length : BytesInBank;
 
-						#if !defined(NO_STREAM_CALLBACKS)
-						if ((Callback != NULL) && (Callback() == STREAMCALLBACK_Abort))
-						  return ENDPOINT_RWSTREAM_CallbackAborted;
-						#endif
+			Length -= BytesToTransfer;
 
-						if ((ErrorCode = Endpoint_WaitUntilReady()))
-						  return ErrorCode;
-					}
+			while (BytesToTransfer >= 8)
+			{
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
+				TEMPLATE_TRANSFER_BYTE(DataStream);
 
-					Length -= 8;
-					
-					TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 7: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 6: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 5: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 4: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 3: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 2: TEMPLATE_TRANSFER_BYTE(DataStream);
-			case 1:	TEMPLATE_TRANSFER_BYTE(DataStream);
-				} while (Length >= 8);	
+				BytesToTransfer -= 8;
+			}
+
+			while (BytesToTransfer--)
+			  TEMPLATE_TRANSFER_BYTE(DataStream);
 		}
 	}
-	#endif
-
+	#else
 	while (Length)
 	{
 		if (!(Endpoint_IsReadWriteAllowed()))
@@ -66,6 +68,7 @@ uint8_t TEMPLATE_FUNC_NAME (void* Buffer, uint16_t Length _CALLBACK_PARAM)
 			Length--;
 		}
 	}
+	#endif
 
 	return ENDPOINT_RWSTREAM_NoError;
 }
@@ -73,4 +76,5 @@ uint8_t TEMPLATE_FUNC_NAME (void* Buffer, uint16_t Length _CALLBACK_PARAM)
 #undef TEMPLATE_FUNC_NAME
 #undef TEMPLATE_TRANSFER_BYTE
 #undef TEMPLATE_CLEAR_ENDPOINT
-#undef TEMPLATE_BUFFER_OFFSET
\ No newline at end of file
+#undef TEMPLATE_BUFFER_OFFSET
+#undef TEMPLATE_BANK_BYTES
\ No newline at end of file
@@ -80,11 +80,17 @@ static void USB_DeviceTask(void)
 	
 		Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
 
+		Endpoint_Control_Task();
+
 		if (Endpoint_IsSetupReceived())
 		  USB_Device_ProcessControlPacket();
 		  
 		Endpoint_SelectEndpoint(PrevEndpoint);
 	}
+	else if (Endpoint_Control_IsBusy())
+	{
+		Endpoint_Control_Task();
+	}
 }
 #endif
 
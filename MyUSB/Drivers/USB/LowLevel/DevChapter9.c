@@ -176,8 +176,6 @@ static void USB_Device_GetDescriptor(void)
 	void*    DescriptorPointer;
 	uint16_t DescriptorSize;
 	
-	bool     SendZLP;
-	
 	if (!(USB_GetDescriptor(wValue, wIndex, &DescriptorPointer, &DescriptorSize)))
 	  return;
 	
@@ -185,43 +183,15 @@ static void USB_Device_GetDescriptor(void)
 	
 	if (wLength > DescriptorSize)
 	  wLength = DescriptorSize;
-	  
-	SendZLP = !(wLength % USB_ControlEndpointSize);
-	
-	while (wLength && (!(Endpoint_IsSetupOUTReceived())))
-	{
-		while (!(Endpoint_IsSetupINReady()));
-		
-		while (wLength && (Endpoint_BytesInEndpoint() < USB_ControlEndpointSize))
-		{
-			#if defined(USE_RAM_DESCRIPTORS)
-			Endpoint_Write_Byte(*((uint8_t*)DescriptorPointer++));
-			#elif defined (USE_EEPROM_DESCRIPTORS)
-			Endpoint_Write_Byte(eeprom_read_byte(DescriptorPointer++));			
-			#else
-			Endpoint_Write_Byte(pgm_read_byte(DescriptorPointer++));
-			#endif
-			
-			wLength--;
-		}
-		
-		Endpoint_ClearSetupIN();
-	}
 	
-	if (Endpoint_IsSetupOUTReceived())
-	{
-		Endpoint_ClearSetupOUT();
-		return;
-	}
-	
-	if (SendZLP)
-	{
-		while (!(Endpoint_IsSetupINReady()));
-		Endpoint_ClearSetupIN();
-	}
-
-	while (!(Endpoint_IsSetupOUTReceived()));
-	Endpoint_ClearSetupOUT();
+	/* Long descriptors take several packets, which are sent by Endpoint_Control_Task() as the host asks for them */
+	#if defined(USE_RAM_DESCRIPTORS)
+	Endpoint_Write_Control_Async(DescriptorPointer, wLength, ENDPOINT_MEMSPACE_RAM, NULL);
+	#elif defined (USE_EEPROM_DESCRIPTORS)
+	Endpoint_Write_Control_Async(DescriptorPointer, wLength, ENDPOINT_MEMSPACE_EEPROM, NULL);
+	#else
+	Endpoint_Write_Control_Async(DescriptorPointer, wLength, ENDPOINT_MEMSPACE_PGM, NULL);
+	#endif
 }
 
 static void USB_Device_GetStatus(const uint8_t bmRequestType)
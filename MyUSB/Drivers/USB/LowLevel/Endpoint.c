@@ -35,6 +35,16 @@
 
 uint8_t USB_ControlEndpointSize = ENDPOINT_CONTROLEP_DEFAULT_SIZE;
 
+static struct
+{
+	volatile uint8_t              State;
+	uint8_t                       MemorySpace;
+	bool                          SendZLP;
+	uint8_t*                      DataStream;
+	uint16_t                      Length;
+	Endpoint_ControlCallbackPtr_t Callback;
+} Endpoint_ControlAsync;
+
 void Endpoint_ConfigureEndpoint_P(const uint8_t  EndpointNum,
                                   const uint16_t EndpointSize,
                                   const uint8_t  UECFG0Xdata,
@@ -368,4 +378,147 @@ uint8_t Endpoint_Read_Control_Stream_BE(void* Buffer, uint16_t Length)
 	return ENDPOINT_RWCSTREAM_ERROR_NoError;
 }
 
+void Endpoint_Write_Control_Async(const void* Buffer, uint16_t Length, const uint8_t MemorySpace,
+                                  Endpoint_ControlCallbackPtr_t Callback)
+{
+	Endpoint_ControlAsync.DataStream  = (uint8_t*)Buffer;
+	Endpoint_ControlAsync.Length      = Length;
+	Endpoint_ControlAsync.MemorySpace = MemorySpace;
+	Endpoint_ControlAsync.SendZLP     = true;
+	Endpoint_ControlAsync.Callback    = Callback;
+	Endpoint_ControlAsync.State       = ENDPOINT_CONTROLSTATE_DataIN;
+	
+	Endpoint_Control_Task();
+}
+
+void Endpoint_Read_Control_Async(void* Buffer, uint16_t Length, Endpoint_ControlCallbackPtr_t Callback)
+{
+	Endpoint_ControlAsync.DataStream  = (uint8_t*)Buffer;
+	Endpoint_ControlAsync.Length      = Length;
+	Endpoint_ControlAsync.Callback    = Callback;
+	Endpoint_ControlAsync.State       = (Length) ? ENDPOINT_CONTROLSTATE_DataOUT : ENDPOINT_CONTROLSTATE_StatusIN;
+
+	Endpoint_Control_Task();
+}
+
+bool Endpoint_Control_IsBusy(void)
+{
+	return (Endpoint_ControlAsync.State != ENDPOINT_CONTROLSTATE_Idle);
+}
+
+void Endpoint_Control_Abort(void)
+{
+	if (Endpoint_ControlAsync.State != ENDPOINT_CONTROLSTATE_Idle)
+	  Endpoint_ControlAsync.State = ENDPOINT_CONTROLSTATE_Aborted;
+}
+
+static void Endpoint_Control_Complete(const uint8_t ErrorCode)
+{
+	Endpoint_ControlCallbackPtr_t Callback = Endpoint_ControlAsync.Callback;
+
+	Endpoint_ControlAsync.State = ENDPOINT_CONTROLSTATE_Idle;
+	
+	if (Callback != NULL)
+	  Callback(ErrorCode);
+}
+
+static void Endpoint_Control_WritePacket(void)
+{
+	uint8_t  PacketLength = 0;
+	uint8_t* DataStream   = Endpoint_ControlAsync.DataStream;
+	
+	while (Endpoint_ControlAsync.Length && (PacketLength < USB_ControlEndpointSize))
+	{
+		switch (Endpoint_ControlAsync.MemorySpace)
+		{
+			case ENDPOINT_MEMSPACE_PGM:
+				Endpoint_Write_Byte(pgm_read_byte(DataStream++));
+				break;
+			case ENDPOINT_MEMSPACE_EEPROM:
+				Endpoint_Write_Byte(eeprom_read_byte(DataStream++));
+				break;
+			default:
+				Endpoint_Write_Byte(*(DataStream++));
+				break;
+		}
+		
+		PacketLength++;
+		Endpoint_ControlAsync.Length--;
+	}
+	
+	Endpoint_ControlAsync.DataStream = DataStream;
+	Endpoint_ControlAsync.SendZLP    = (PacketLength == USB_ControlEndpointSize);
+
+	Endpoint_ClearSetupIN();
+}
+
+void Endpoint_Control_Task(void)
+{
+	if (Endpoint_ControlAsync.State == ENDPOINT_CONTROLSTATE_Idle)
+	  return;
+
+	if (!(USB_IsConnected) || (Endpoint_ControlAsync.State == ENDPOINT_CONTROLSTATE_Aborted))
+	{
+		Endpoint_Control_Complete(ENDPOINT_RWCSTREAM_ERROR_DeviceDisconnected);
+		return;
+	}
+	
+	if (Endpoint_IsSetupReceived())
+	{
+		Endpoint_Control_Complete(ENDPOINT_RWCSTREAM_ERROR_HostAborted);
+		return;
+	}
+	
+	switch (Endpoint_ControlAsync.State)
+	{
+		case ENDPOINT_CONTROLSTATE_DataIN:
+			if (Endpoint_IsSetupOUTReceived())
+			{
+				Endpoint_ClearSetupOUT();
+				Endpoint_Control_Complete(ENDPOINT_RWCSTREAM_ERROR_HostAborted);
+			}
+			else if (Endpoint_IsSetupINReady())
+			{
+				Endpoint_Control_WritePacket();
+
+				if (!(Endpoint_ControlAsync.Length) && !(Endpoint_ControlAsync.SendZLP))
+				  Endpoint_ControlAsync.State = ENDPOINT_CONTROLSTATE_StatusOUT;
+			}
+
+			break;
+		case ENDPOINT_CONTROLSTATE_StatusOUT:
+			if (Endpoint_IsSetupOUTReceived())
+			{
+				Endpoint_ClearSetupOUT();
+				Endpoint_Control_Complete(ENDPOINT_RWCSTREAM_ERROR_NoError);
+			}
+			
+			break;
+		case ENDPOINT_CONTROLSTATE_DataOUT:
+			if (Endpoint_IsSetupOUTReceived())
+			{
+				while (Endpoint_ControlAsync.Length && Endpoint_BytesInEndpoint())
+				{
+					*(Endpoint_ControlAsync.DataStream++) = Endpoint_Read_Byte();
+					Endpoint_ControlAsync.Length--;
+				}
+				
+				Endpoint_ClearSetupOUT();
+				
+				if (!(Endpoint_ControlAsync.Length))
+				  Endpoint_ControlAsync.State = ENDPOINT_CONTROLSTATE_StatusIN;
+			}
+			
+			break;
+		case ENDPOINT_CONTROLSTATE_StatusIN:
+			if (Endpoint_IsSetupINReady())
+			{
+				Endpoint_ClearSetupIN();
+				Endpoint_Control_Complete(ENDPOINT_RWCSTREAM_ERROR_NoError);
+			}
+			
+			break;
+	}
+}
+
 #endif
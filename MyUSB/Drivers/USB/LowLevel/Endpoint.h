@@ -40,6 +40,8 @@
 
 	/* Includes: */
 		#include <avr/io.h>
+		#include <avr/pgmspace.h>
+		#include <avr/eeprom.h>
 		#include <stdbool.h>
 
 		#include "../../../Common/Common.h"
@@ -324,8 +326,29 @@
 			{
 				ENDPOINT_RWCSTREAM_ERROR_NoError            = 0, /**< Command completed successfully, no error. */
 				ENDPOINT_RWCSTREAM_ERROR_HostAborted        = 1, /**< The aborted the transfer prematurely. */
+				ENDPOINT_RWCSTREAM_ERROR_DeviceDisconnected = 2, /**< Device was disconnected from the host, or the
+				                                                  *   bus was reset, during an asynchronous transfer.
+				                                                  */
 			};
 
+			/** Enum for the memory space an asynchronous control transfer's data is read from, for the
+			 *  Endpoint_Write_Control_Async() function.
+			 */
+			enum Endpoint_ControlAsync_MemorySpaces_t
+			{
+				ENDPOINT_MEMSPACE_RAM    = 0, /**< Data is read from RAM. */
+				ENDPOINT_MEMSPACE_PGM    = 1, /**< Data is read from FLASH via pgm_read_byte(). */
+				ENDPOINT_MEMSPACE_EEPROM = 2, /**< Data is read from EEPROM via eeprom_read_byte(). */
+			};
+
+		/* Type Defines: */
+			/** Type define for the completion callback of an asynchronous control transfer. The callback is
+			 *  passed a value from the Endpoint_ControlStream_RW_ErrorCodes_t enum, and is run from
+			 *  Endpoint_Control_Task(). It is run with the control endpoint selected, unless the device has been
+			 *  disconnected.
+			 */
+			typedef void (*Endpoint_ControlCallbackPtr_t)(const uint8_t ErrorCode);
+
 		/* Inline Functions: */
 			/** Reads one byte from the currently selected endpoint's bank, for OUT direction endpoints. */
 			static inline uint8_t Endpoint_Read_Byte(void) ATTR_WARN_UNUSED_RESULT;
@@ -684,6 +707,52 @@
 			 */
 			uint8_t Endpoint_Read_Control_Stream_BE(void* Buffer, uint16_t Length)  ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Starts writing the given number of bytes to the CONTROL type endpoint from the given buffer in little
+			 *  endian, without waiting for the transfer to finish. Each later call to Endpoint_Control_Task() sends
+			 *  the next packet once the host is ready for it, and once the data stage is complete (with a zero length
+			 *  packet if needed) the host OUT acknowedgement is cleared and the callback is run. The setup request
+			 *  should be cleared via Endpoint_ClearSetupReceived() before the transfer is started.
+			 *
+			 *  \note This routine should only be used on CONTROL type endpoints.
+			 *
+			 *  \warning The buffer must remain valid until the callback is run, as it is read as each packet is sent.
+			 *
+			 *  \param Buffer       Pointer to the source data buffer to read from.
+			 *  \param Length       Number of bytes to send via the control endpoint.
+			 *  \param MemorySpace  A value from the Endpoint_ControlAsync_MemorySpaces_t enum, giving the memory the
+			 *                      buffer is in.
+			 *  \param Callback     Routine to run when the transfer completes or is aborted, NULL if no callback.
+			 */
+			void Endpoint_Write_Control_Async(const void* Buffer, uint16_t Length, const uint8_t MemorySpace,
+			                                  Endpoint_ControlCallbackPtr_t Callback);
+
+			/** Starts reading the given number of bytes from the CONTROL type endpoint into the given buffer in little
+			 *  endian, without waiting for the transfer to finish. Each later call to Endpoint_Control_Task() reads
+			 *  the next packet once the host has sent it, and once the data stage is complete the device IN
+			 *  acknowedgement is sent and the callback is run. The setup request should be cleared via
+			 *  Endpoint_ClearSetupReceived() before the transfer is started.
+			 *
+			 *  \note This routine should only be used on CONTROL type endpoints.
+			 *
+			 *  \warning The buffer must remain valid until the callback is run, and only holds the complete data
+			 *           once the callback is passed ENDPOINT_RWCSTREAM_ERROR_NoError.
+			 *
+			 *  \param Buffer    Pointer to the destination data buffer to write to.
+			 *  \param Length    Number of bytes to read from the control endpoint.
+			 *  \param Callback  Routine to run when the transfer completes or is aborted, NULL if no callback.
+			 */
+			void Endpoint_Read_Control_Async(void* Buffer, uint16_t Length, Endpoint_ControlCallbackPtr_t Callback);
+
+			/** Advances the asynchronous control transfer in progress (if any) by at most one packet, without
+			 *  blocking. This should be called regularly with the control endpoint selected, and before any newly
+			 *  received setup request is processed; a new setup request aborts the transfer in progress. It is called
+			 *  by the library's USB management task, and may also be called from the USB endpoint interrupt.
+			 */
+			void Endpoint_Control_Task(void);
+
+			/** Returns true if an asynchronous control transfer is in progress, false otherwise. */
+			bool Endpoint_Control_IsBusy(void) ATTR_WARN_UNUSED_RESULT;
+
 		/* Function Aliases: */
 			/** Alias for Endpoint_Discard_Byte().
 			 */
@@ -751,6 +820,17 @@
 			#define Endpoint_AllocateMemory()          MACROS{ UECFG1X |=  (1 << ALLOC);                  }MACROE
 			#define Endpoint_DeallocateMemory()        MACROS{ UECFG1X &= ~(1 << ALLOC);                  }MACROE
 
+		/* Enums: */
+			enum Endpoint_ControlAsync_States_t
+			{
+				ENDPOINT_CONTROLSTATE_Idle      = 0,
+				ENDPOINT_CONTROLSTATE_DataIN    = 1,
+				ENDPOINT_CONTROLSTATE_StatusOUT = 2,
+				ENDPOINT_CONTROLSTATE_DataOUT   = 3,
+				ENDPOINT_CONTROLSTATE_StatusIN  = 4,
+				ENDPOINT_CONTROLSTATE_Aborted   = 5,
+			};
+
 		/* Inline Functions: */
 			static inline uint8_t Endpoint_BytesToEPSizeMask(uint16_t Bytes)
 			                                                 ATTR_WARN_UNUSED_RESULT ATTR_CONST;
@@ -779,6 +859,7 @@
 
 		/* Function Prototypes: */
 			void Endpoint_ClearEndpoints(void);
+			void Endpoint_Control_Abort(void);
 			void Endpoint_ConfigureEndpoint_P(const uint8_t  EndpointNum,
 			                                  const uint16_t EndpointSize,
 			                                  const uint8_t  UECFG0Xdata,
@@ -59,9 +59,9 @@ USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
 	.Header                 = {.Size = sizeof(USB_Descriptor_Device_t), .Type = DTYPE_Device},
 		
 	.USBSpecification       = VERSION_BCD(01.10),
-	.Class                  = 0x02,
-	.SubClass               = 0x00,
-	.Protocol               = 0x00,
+	.Class                  = 0xEF,
+	.SubClass               = 0x02,
+	.Protocol               = 0x01,
 				
 	.Endpoint0Size          = FIXED_CONTROL_ENDPOINT_SIZE,
 		
@@ -88,7 +88,7 @@ USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.Header                 = {.Size = sizeof(USB_Descriptor_Configuration_Header_t), .Type = DTYPE_Configuration},
 
 			.TotalConfigurationSize = sizeof(USB_Descriptor_Configuration_t),
-			.TotalInterfaces        = 2,
+			.TotalInterfaces        = 5,
 				
 			.ConfigurationNumber    = 1,
 			.ConfigurationStrIndex  = NO_DESCRIPTOR,
@@ -97,6 +97,20 @@ USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			
 			.MaxPowerConsumption    = USB_CONFIG_POWER_MA(100)
 		},
+
+	.IAD = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
+
+			.FirstInterfaceIndex    = 0,
+			.TotalInterfaces        = 2,
+
+			.Class                  = 0x02,
+			.SubClass               = 0x02,
+			.Protocol               = 0x01,
+
+			.IADStrIndex            = 0x03
+		},
 		
 	.CCI_Interface = 
 		{
@@ -111,7 +125,7 @@ USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.SubClass               = 0x02,
 			.Protocol               = 0x01,
 				
-			.InterfaceStrIndex      = NO_DESCRIPTOR
+			.InterfaceStrIndex      = 0x03
 		},
 
 	.CDC_Functional_IntHeader = 
@@ -190,6 +204,130 @@ USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
 			.EndpointSize           = CDC_TXRX_EPSIZE,
 			.PollingIntervalMS      = 0x00
+		},
+
+	.Telemetry_Interface = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber        = TELEMETRY_INTERFACE_NUMBER,
+			.AlternateSetting       = 0,
+			
+			.TotalEndpoints         = 0,
+				
+			.Class                  = 0xFF,
+			.SubClass               = 0x00,
+			.Protocol               = 0x00,
+				
+			.InterfaceStrIndex      = NO_DESCRIPTOR
+		},
+
+	.Command_IAD = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
+
+			.FirstInterfaceIndex    = COMMAND_CCI_INTERFACE_NUMBER,
+			.TotalInterfaces        = 2,
+
+			.Class                  = 0x02,
+			.SubClass               = 0x02,
+			.Protocol               = 0x01,
+
+			.IADStrIndex            = 0x04
+		},
+
+	.Command_CCI_Interface = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber        = COMMAND_CCI_INTERFACE_NUMBER,
+			.AlternateSetting       = 0,
+			
+			.TotalEndpoints         = 1,
+				
+			.Class                  = 0x02,
+			.SubClass               = 0x02,
+			.Protocol               = 0x01,
+				
+			.InterfaceStrIndex      = 0x04
+		},
+
+	.Command_Functional_IntHeader = 
+		{
+			.Header                 = {.Size = sizeof(CDC_FUNCTIONAL_DESCRIPTOR(2)), .Type = 0x24},
+			.SubType                = 0x00,
+			
+			.Data                   = {0x01, 0x10}
+		},
+
+	.Command_Functional_CallManagement = 
+		{
+			.Header                 = {.Size = sizeof(CDC_FUNCTIONAL_DESCRIPTOR(2)), .Type = 0x24},
+			.SubType                = 0x01,
+			
+			.Data                   = {0x03, COMMAND_DCI_INTERFACE_NUMBER}
+		},
+
+	.Command_Functional_AbstractControlManagement = 
+		{
+			.Header                 = {.Size = sizeof(CDC_FUNCTIONAL_DESCRIPTOR(1)), .Type = 0x24},
+			.SubType                = 0x02,
+			
+			.Data                   = {0x06}
+		},
+		
+	.Command_Functional_Union = 
+		{
+			.Header                 = {.Size = sizeof(CDC_FUNCTIONAL_DESCRIPTOR(2)), .Type = 0x24},
+			.SubType                = 0x06,
+			
+			.Data                   = {COMMAND_CCI_INTERFACE_NUMBER, COMMAND_DCI_INTERFACE_NUMBER}
+		},
+
+	.Command_ManagementEndpoint = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+										 
+			.EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | CMD_NOTIFICATION_EPNUM),
+			.Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize           = CDC_NOTIFICATION_EPSIZE,
+			.PollingIntervalMS      = 0xFF
+		},
+
+	.Command_DCI_Interface = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber        = COMMAND_DCI_INTERFACE_NUMBER,
+			.AlternateSetting       = 0,
+			
+			.TotalEndpoints         = 2,
+				
+			.Class                  = 0x0A,
+			.SubClass               = 0x00,
+			.Protocol               = 0x00,
+				
+			.InterfaceStrIndex      = NO_DESCRIPTOR
+		},
+
+	.Command_DataOutEndpoint = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+										 
+			.EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_OUT | CMD_RX_EPNUM),
+			.Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize           = CDC_TXRX_EPSIZE,
+			.PollingIntervalMS      = 0x00
+		},
+		
+	.Command_DataInEndpoint = 
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+										 
+			.EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | CMD_TX_EPNUM),
+			.Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize           = CDC_TXRX_EPSIZE,
+			.PollingIntervalMS      = 0x00
 		}
 };
 
@@ -226,6 +364,24 @@ USB_Descriptor_String_t PROGMEM ProductString =
 	.UnicodeString          = L"Power & LCD Control & Watchdog"
 };
 
+/** Console port descriptor string. This names the CDC function which bridges the Beagleboard serial console, so
+ *  that the two virtual serial ports can be told apart on the host.
+ */
+USB_Descriptor_String_t PROGMEM ConsoleString =
+{
+	.Header                 = {.Size = USB_STRING_LEN(14), .Type = DTYPE_String},
+		
+	.UnicodeString          = L"Beagle Console"
+};
+
+/** Command port descriptor string. This names the CDC function which takes AVR commands. */
+USB_Descriptor_String_t PROGMEM CommandString =
+{
+	.Header                 = {.Size = USB_STRING_LEN(12), .Type = DTYPE_String},
+		
+	.UnicodeString          = L"AVR Commands"
+};
+
 /** This function is called by the library when in device mode, and must be overridden (see library "USB Descriptors"
  *  documentation) by the application code so that the address and size of a requested descriptor can be given
  *  to the USB library. When the device receives a Get Descriptor request on the control endpoint, this function
@@ -265,6 +421,14 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue, const uint8_t wIndex,
 					Address = (void*)&ProductString;
 					Size    = pgm_read_byte(&ProductString.Header.Size);
 					break;
+				case 0x03: 
+					Address = (void*)&ConsoleString;
+					Size    = pgm_read_byte(&ConsoleString.Header.Size);
+					break;
+				case 0x04: 
+					Address = (void*)&CommandString;
+					Size    = pgm_read_byte(&CommandString.Header.Size);
+					break;
 			}
 			
 			break;
@@ -57,21 +57,48 @@
 		          uint8_t                 Data[DataSize];  \
 		     }
 			 
-		/** Endpoint number of the CDC device-to-host notification IN endpoint. */
+		/** Endpoint number of the console CDC device-to-host notification IN endpoint. */
 		#define CDC_NOTIFICATION_EPNUM         2
 
-		/** Endpoint number of the CDC device-to-host data IN endpoint. */
+		/** Endpoint number of the console CDC device-to-host data IN endpoint. */
 		#define CDC_TX_EPNUM                   3	
 
-		/** Endpoint number of the CDC host-to-device data OUT endpoint. */
+		/** Endpoint number of the console CDC host-to-device data OUT endpoint. */
 		#define CDC_RX_EPNUM                   4	
 
-		/** Size in bytes of the CDC device-to-host notification IN endpoint. */
+		/** Endpoint number of the command CDC device-to-host notification IN endpoint. */
+		#define CMD_NOTIFICATION_EPNUM         5
+
+		/** Endpoint number of the command CDC device-to-host data IN endpoint. */
+		#define CMD_TX_EPNUM                   6
+
+		/** Endpoint number of the command CDC host-to-device data OUT endpoint. */
+		#define CMD_RX_EPNUM                   1
+
+		/** Size in bytes of the CDC device-to-host notification IN endpoints. */
 		#define CDC_NOTIFICATION_EPSIZE        8
 
 		/** Size in bytes of the CDC data IN and OUT endpoints. */
 		#define CDC_TXRX_EPSIZE                16	
 
+		/** Banking mode of the CDC data IN and OUT endpoints. With two banks, the USB controller can send or
+		 *  receive one packet while the firmware fills or empties the other.
+		 */
+		#define CDC_TXRX_EPBANKS               ENDPOINT_BANK_DOUBLE
+
+		/** Interface number of the vendor specific telemetry interface. This has no endpoints of its own;
+		 *  the host reads the status report and sends commands with vendor requests on the control endpoint.
+		 */
+		#define TELEMETRY_INTERFACE_NUMBER     2
+
+		/** Interface number of the command CDC communications interface. The command port's interfaces come
+		 *  after the telemetry interface, so that it keeps the interface number host tools already use.
+		 */
+		#define COMMAND_CCI_INTERFACE_NUMBER   3
+
+		/** Interface number of the command CDC data interface. */
+		#define COMMAND_DCI_INTERFACE_NUMBER   4
+
 	/* Type Defines: */
 		/** Type define for the device configuration descriptor structure. This must be defined in the
 		 *  application code, as the configuration descriptor contains several sub-descriptors which
@@ -80,6 +107,7 @@
 		typedef struct
 		{
 			USB_Descriptor_Configuration_Header_t    Config;
+			USB_Descriptor_Interface_Association_t   IAD;
 			USB_Descriptor_Interface_t               CCI_Interface;
 			CDC_FUNCTIONAL_DESCRIPTOR(2)             CDC_Functional_IntHeader;
 			CDC_FUNCTIONAL_DESCRIPTOR(2)             CDC_Functional_CallManagement;
@@ -89,6 +117,17 @@
 			USB_Descriptor_Interface_t               DCI_Interface;
 			USB_Descriptor_Endpoint_t                DataOutEndpoint;
 			USB_Descriptor_Endpoint_t                DataInEndpoint;
+			USB_Descriptor_Interface_t               Telemetry_Interface;
+			USB_Descriptor_Interface_Association_t   Command_IAD;
+			USB_Descriptor_Interface_t               Command_CCI_Interface;
+			CDC_FUNCTIONAL_DESCRIPTOR(2)             Command_Functional_IntHeader;
+			CDC_FUNCTIONAL_DESCRIPTOR(2)             Command_Functional_CallManagement;
+			CDC_FUNCTIONAL_DESCRIPTOR(1)             Command_Functional_AbstractControlManagement;
+			CDC_FUNCTIONAL_DESCRIPTOR(2)             Command_Functional_Union;
+			USB_Descriptor_Endpoint_t                Command_ManagementEndpoint;
+			USB_Descriptor_Interface_t               Command_DCI_Interface;
+			USB_Descriptor_Endpoint_t                Command_DataOutEndpoint;
+			USB_Descriptor_Endpoint_t                Command_DataInEndpoint;
 		} USB_Descriptor_Configuration_t;
 
 	/* Function Prototypes: */
@@ -0,0 +1,499 @@
+/** \file
+ *
+ *  Host test for the receive buffer of the LUFA CDC host class driver (CDC.c). The driver is built
+ *  against a simulated data IN pipe, fed from a queue of packets sent by a mock device, and data read
+ *  back through CDC_Host_ReceiveData() and CDC_Host_PeekData() is checked against the bytes sent.
+ *
+ *  The tests cover data wrapping around the end of the buffer, a packet which is held in the pipe
+ *  while the buffer is too full for it and taken once the application makes room, zero length
+ *  packets, peeking without consuming, and CDC_Host_ConfigurePipes() refusing a buffer smaller than
+ *  the device's data IN endpoint.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <LUFA/Common/Common.h>
+
+/** Bytes in each packet of the device's data IN endpoint. */
+#define PIPE_BANK_SIZE          64
+
+/** Packets the mock device can have waiting to be sent. */
+#define DEVICE_QUEUE_SIZE       8
+
+/** Size of the receive buffer given to the driver, which isn't a multiple of the packet size so that
+ *  packets are split across the end of the buffer.
+ */
+#define BUFFER_SIZE             100
+
+/** Pipe numbers given to the driver. */
+#define DATA_IN_PIPE            1
+#define DATA_OUT_PIPE           2
+#define NOTIFICATION_PIPE       3
+
+/** Bytes sent by the mock device in the wrap-around test. */
+#define WRAP_TEST_BYTES         5000
+
+
+/* Stand-ins for the parts of the LUFA USB driver used by CDC.c. Its includes of the USB driver headers
+   are skipped by defining their include guards. */
+#define __USBMODE_H__
+#define __USB_H__
+#define USB_CAN_BE_HOST
+
+#define ATTR_WEAK                           __attribute__ ((weak))
+#define ATTR_ALIAS(Func)                    __attribute__ ((alias (#Func)))
+
+#define NO_STREAM_CALLBACK                  NULL
+
+#define REQDIR_HOSTTODEVICE                 (0 << 7)
+#define REQDIR_DEVICETOHOST                 (1 << 7)
+#define REQTYPE_CLASS                       (1 << 5)
+#define REQREC_INTERFACE                    (1 << 0)
+
+#define EP_TYPE_MASK                        0x03
+#define EP_TYPE_BULK                        0x02
+#define EP_TYPE_INTERRUPT                   0x03
+#define ENDPOINT_DESCRIPTOR_DIR_IN          0x80
+
+#define PIPE_CONTROLPIPE                    0
+#define PIPE_TOKEN_IN                       0x10
+#define PIPE_TOKEN_OUT                      0x20
+#define PIPE_BANK_SINGLE                    0x00
+
+#define DTYPE_Interface                     0x04
+#define DESCRIPTOR_TYPE(DescriptorPtr)      (((const USB_Descriptor_Header_t*)(DescriptorPtr))->Type)
+#define DESCRIPTOR_SIZE(DescriptorPtr)      (((const USB_Descriptor_Header_t*)(DescriptorPtr))->Size)
+
+#define CONFIGINDEX_Successful              0
+#define CONFIGINDEX_InvalidConfigDescriptor 1
+
+enum Pipe_WaitUntilReady_ErrorCodes_t
+{
+	PIPE_READYWAIT_NoError = 0,
+};
+
+enum Pipe_Stream_RW_ErrorCodes_t
+{
+	PIPE_RWSTREAM_NoError = 0,
+};
+
+enum USB_Host_States_t
+{
+	HOST_STATE_Unattached = 0,
+	HOST_STATE_Configured = 1,
+};
+
+typedef struct
+{
+	uint8_t  bmRequestType;
+	uint8_t  bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} USB_Request_Header_t;
+
+typedef struct
+{
+	uint8_t Size;
+	uint8_t Type;
+} USB_Descriptor_Header_t;
+
+typedef struct
+{
+	uint8_t  EndpointAddress;
+	uint8_t  Attributes;
+	uint16_t EndpointSize;
+	uint8_t  PollingIntervalMS;
+} USB_ConfigIndex_Endpoint_t;
+
+typedef struct
+{
+	uint16_t Offset;
+	uint8_t  InterfaceNumber;
+	uint8_t  AlternateSetting;
+	uint8_t  Class;
+	uint8_t  SubClass;
+	uint8_t  Protocol;
+	uint8_t  FirstEndpoint;
+	uint8_t  TotalEndpoints;
+} USB_ConfigIndex_Interface_t;
+
+typedef struct
+{
+	uint8_t                     TotalInterfaces;
+	USB_ConfigIndex_Interface_t Interfaces[2];
+	USB_ConfigIndex_Endpoint_t  Endpoints[3];
+} USB_ConfigIndex_t;
+
+static uint8_t              USB_HostState = HOST_STATE_Configured;
+static USB_Request_Header_t USB_ControlRequest;
+
+
+/** Configuration descriptor of the mock device: a CDC-ACM control interface, whose Union functional
+ *  descriptor names interface 1 as its data interface, and the data interface with 64 byte bulk endpoints.
+ */
+static uint8_t ConfigDescriptor[] =
+	{
+		0x09, 0x02, 53, 0x00, 0x02, 0x01, 0x00, 0x80, 0x32,
+		0x09, 0x04, 0x00, 0x00, 0x01, 0x02, 0x02, 0x01, 0x00,
+		0x05, 0x24, 0x06, 0x00, 0x01,
+		0x07, 0x05, 0x83, 0x03, 0x08, 0x00, 0xFF,
+		0x09, 0x04, 0x01, 0x00, 0x02, 0x0A, 0x00, 0x00, 0x00,
+		0x07, 0x05, 0x81, 0x02, PIPE_BANK_SIZE, 0x00, 0x00,
+		0x07, 0x05, 0x02, 0x02, PIPE_BANK_SIZE, 0x00, 0x00,
+	};
+
+/** Index of ConfigDescriptor, as USB_GetConfigIndex() would build it. */
+static const USB_ConfigIndex_t DeviceConfigIndex =
+	{
+		.TotalInterfaces = 2,
+		.Interfaces =
+			{
+				{ .Offset = 9,  .InterfaceNumber = 0, .Class = 0x02, .SubClass = 0x02, .Protocol = 0x01,
+				  .FirstEndpoint = 0, .TotalEndpoints = 1 },
+				{ .Offset = 30, .InterfaceNumber = 1, .Class = 0x0A, .SubClass = 0x00, .Protocol = 0x00,
+				  .FirstEndpoint = 1, .TotalEndpoints = 2 },
+			},
+		.Endpoints =
+			{
+				{ .EndpointAddress = 0x83, .Attributes = EP_TYPE_INTERRUPT, .EndpointSize = 8, .PollingIntervalMS = 0xFF },
+				{ .EndpointAddress = 0x81, .Attributes = EP_TYPE_BULK, .EndpointSize = PIPE_BANK_SIZE },
+				{ .EndpointAddress = 0x02, .Attributes = EP_TYPE_BULK, .EndpointSize = PIPE_BANK_SIZE },
+			},
+	};
+
+
+/** Packet held in the pipe bank or queued by the mock device. */
+typedef struct
+{
+	uint8_t  Data[PIPE_BANK_SIZE];
+	uint16_t Length;
+	uint16_t Position; /**< Next byte for the driver to read */
+} Packet_t;
+
+/** State of the simulated data IN pipe, and of the mock device sending to it. */
+static struct
+{
+	uint8_t  Selected;
+	bool     INFrozen;
+	bool     INHeld; /**< Set while a packet is held in the pipe bank */
+	Packet_t INBank;
+
+	Packet_t Queue[DEVICE_QUEUE_SIZE]; /**< Packets waiting to be sent by the device, oldest first */
+	uint8_t  QueueFirst;
+	uint8_t  Queued;
+	uint32_t BytesSent; /**< Bytes of the test pattern queued so far */
+	uint32_t ClearErrors; /**< Set if the driver cleared the bank while nothing was held, or before it was read */
+} Pipes;
+
+static int Failures = 0;
+
+
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+/** Byte of the test pattern at a given offset of the data sent by the device. */
+static uint8_t Pattern(const uint32_t Offset)
+{
+	return (uint8_t)(Offset ^ (Offset >> 8) ^ 0x5A);
+}
+
+
+/** Move the device's next packet into the pipe bank, if the pipe is unfrozen and the bank is free. */
+static void Pipes_Update(void)
+{
+	if (Pipes.INHeld || Pipes.INFrozen || !(Pipes.Queued))
+	  return;
+
+	Pipes.INBank     = Pipes.Queue[Pipes.QueueFirst];
+	Pipes.INHeld     = true;
+	Pipes.QueueFirst = ((Pipes.QueueFirst + 1) % DEVICE_QUEUE_SIZE);
+	Pipes.Queued--;
+}
+
+/** Queue a packet of the next bytes of the test pattern for the device to send. */
+static void Device_Send(const uint16_t Length)
+{
+	Packet_t* Packet = &Pipes.Queue[(Pipes.QueueFirst + Pipes.Queued) % DEVICE_QUEUE_SIZE];
+
+	if ((Length > PIPE_BANK_SIZE) || (Pipes.Queued == DEVICE_QUEUE_SIZE))
+	  abort();
+
+	for (uint16_t i = 0; i < Length; i++)
+	  Packet->Data[i] = Pattern(Pipes.BytesSent++);
+
+	Packet->Length   = Length;
+	Packet->Position = 0;
+	Pipes.Queued++;
+
+	Pipes_Update();
+}
+
+/** Bytes of the packet in the pipe bank not yet read by the driver. */
+static uint16_t Pipe_BytesInPipe(void)
+{
+	if ((Pipes.Selected != DATA_IN_PIPE) || !(Pipes.INHeld))
+	  return 0;
+
+	return (Pipes.INBank.Length - Pipes.INBank.Position);
+}
+
+static bool Pipe_IsINReceived(void)
+{
+	return ((Pipes.Selected == DATA_IN_PIPE) && Pipes.INHeld);
+}
+
+static void Pipe_ClearIN(void)
+{
+	if ((Pipes.Selected != DATA_IN_PIPE) || !(Pipes.INHeld) || Pipe_BytesInPipe())
+	{
+		Pipes.ClearErrors++;
+		return;
+	}
+
+	Pipes.INHeld = false;
+	Pipes_Update();
+}
+
+static void Pipe_SetFrozen(const bool Frozen)
+{
+	if (Pipes.Selected != DATA_IN_PIPE)
+	  return;
+
+	Pipes.INFrozen = Frozen;
+	Pipes_Update();
+}
+
+static uint8_t Pipe_Read_Byte(void)
+{
+	return Pipes.INBank.Data[Pipes.INBank.Position++];
+}
+
+static uint8_t Pipe_Read_Stream_LE(void* Buffer, uint16_t Length, void* Callback)
+{
+	uint8_t* DataStream = (uint8_t*)Buffer;
+
+	while (Length--)
+	{
+		if (!(Pipe_BytesInPipe()))
+		{
+			Pipes.ClearErrors++;
+			return PIPE_RWSTREAM_NoError;
+		}
+
+		*(DataStream++) = Pipe_Read_Byte();
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t Pipe_Write_Stream_LE(const void* Buffer, uint16_t Length, void* Callback)
+{
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t USB_Host_SendControlRequest(void* Buffer)
+{
+	return 0;
+}
+
+static uint8_t USB_GetConfigIndex(USB_ConfigIndex_t* const Index, const uint16_t Size, const uint8_t* const Descriptor)
+{
+	*Index = DeviceConfigIndex;
+
+	return CONFIGINDEX_Successful;
+}
+
+static const USB_ConfigIndex_Endpoint_t* USB_ConfigIndex_FindEndpoint(const USB_ConfigIndex_t* const Index,
+                                                                      const USB_ConfigIndex_Interface_t* const Interface,
+                                                                      const uint8_t Type, const bool DirectionIN)
+{
+	for (uint8_t EndpointIndex = Interface->FirstEndpoint;
+	     EndpointIndex < (Interface->FirstEndpoint + Interface->TotalEndpoints); EndpointIndex++)
+	{
+		const USB_ConfigIndex_Endpoint_t* Endpoint = &Index->Endpoints[EndpointIndex];
+
+		if (((Endpoint->Attributes & EP_TYPE_MASK) == Type) &&
+		    (((Endpoint->EndpointAddress & ENDPOINT_DESCRIPTOR_DIR_IN) != 0) == DirectionIN))
+		{
+			return Endpoint;
+		}
+	}
+
+	return NULL;
+}
+
+#define Pipe_SelectPipe(Number)             do { Pipes.Selected = (Number); } while (0)
+#define Pipe_Freeze()                       Pipe_SetFrozen(true)
+#define Pipe_Unfreeze()                     Pipe_SetFrozen(false)
+#define Pipe_IsReadWriteAllowed()           true
+#define Pipe_ClearOUT()                     do { } while (0)
+#define Pipe_WaitUntilReady()               PIPE_READYWAIT_NoError
+#define Pipe_Write_Byte(Byte)               do { } while (0)
+#define Pipe_ConfigurePipe(...)             do { } while (0)
+#define Pipe_SetInterruptPeriod(Interval)   do { } while (0)
+
+#include "LUFA/Drivers/USB/Class/Host/CDC.c"
+
+
+/** Receive buffer and interface under test. */
+static uint8_t DataINBuffer[BUFFER_SIZE];
+
+static USB_ClassInfo_CDC_Host_t CDCInterface =
+	{
+		.Config =
+			{
+				.DataINPipeNumber       = DATA_IN_PIPE,
+				.DataOUTPipeNumber      = DATA_OUT_PIPE,
+				.NotificationPipeNumber = NOTIFICATION_PIPE,
+
+				.DataINBuffer           = DataINBuffer,
+				.DataINBufferSize       = BUFFER_SIZE,
+			},
+	};
+
+/** Offset in the test pattern of the next byte the application should receive. */
+static uint32_t BytesReceived;
+
+
+/** Empty the pipe and the device's queue, and configure the interface again. */
+static bool Restart(void)
+{
+	memset(&Pipes, 0x00, sizeof(Pipes));
+	Pipes.INFrozen = true;
+	BytesReceived  = 0;
+
+	return ((CDC_Host_ConfigurePipes(&CDCInterface, sizeof(ConfigDescriptor), ConfigDescriptor) == CDC_ENUMERROR_NoError) &&
+	        CDCInterface.State.IsActive);
+}
+
+/** Receive up to the given number of bytes, and check them against the test pattern. */
+static bool ReceiveAndCompare(const uint16_t Length, uint16_t* const Received)
+{
+	uint8_t Buffer[BUFFER_SIZE];
+
+	*Received = CDC_Host_ReceiveData(&CDCInterface, Buffer, Length);
+
+	for (uint16_t i = 0; i < *Received; i++)
+	{
+		if (Buffer[i] != Pattern(BytesReceived++))
+		  return false;
+	}
+
+	return true;
+}
+
+
+int main(void)
+{
+	bool     Passed;
+	uint16_t Received;
+
+	Passed = Restart() && (CDCInterface.State.ControlInterfaceNumber == 0) &&
+	         (CDCInterface.State.DataINPipeSize == PIPE_BANK_SIZE);
+	Check(Passed, "interfaces paired through the Union functional descriptor");
+
+	/* Packets of varying length are sent and read back in reads of another varying length, so that both
+	   the packets written into the buffer and the reads out of it are split across its end */
+	Passed = Restart();
+
+	bool Wrapped = false;
+
+	while ((BytesReceived < WRAP_TEST_BYTES) && Passed)
+	{
+		while ((Pipes.Queued < (DEVICE_QUEUE_SIZE - 1)) && (Pipes.BytesSent < WRAP_TEST_BYTES))
+		{
+			uint32_t Remaining = (WRAP_TEST_BYTES - Pipes.BytesSent);
+			uint16_t Length    = (1 + (rand() % PIPE_BANK_SIZE));
+
+			Device_Send((Length < Remaining) ? Length : Remaining);
+		}
+
+		uint16_t PrevStart = CDCInterface.State.DataINBufferStart;
+
+		Passed &= ReceiveAndCompare(1 + (rand() % 48), &Received);
+		Passed &= (CDCInterface.State.DataINBufferCount <= BUFFER_SIZE);
+
+		if (CDCInterface.State.DataINBufferStart < PrevStart)
+		  Wrapped = true;
+	}
+
+	Check(Passed && Wrapped && (BytesReceived == WRAP_TEST_BYTES) && !(Pipes.ClearErrors),
+	      "data wrapping around the end of the buffer is received in order");
+
+	/* Two full packets are sent to a buffer which only has room for one; the second must wait in the pipe
+	   until enough of the first has been read */
+	Passed = Restart();
+
+	Device_Send(PIPE_BANK_SIZE);
+	Device_Send(PIPE_BANK_SIZE);
+
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == PIPE_BANK_SIZE);
+	Passed &= (Pipes.INHeld && !(Pipes.INBank.Position) && (Pipes.INBank.Length == PIPE_BANK_SIZE));
+	Passed &= ReceiveAndCompare(20, &Received) && (Received == 20);
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == (PIPE_BANK_SIZE - 20)) && Pipes.INHeld;
+	Passed &= ReceiveAndCompare(10, &Received) && (Received == 10);
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == ((2 * PIPE_BANK_SIZE) - 30)) && !(Pipes.INHeld);
+	Passed &= ReceiveAndCompare(BUFFER_SIZE, &Received) && (Received == ((2 * PIPE_BANK_SIZE) - 30));
+	Check(Passed && !(Pipes.ClearErrors), "a packet is held in the pipe until the buffer has room for it");
+
+	/* A zero length packet is cleared from the pipe without adding to the buffer, even when it is full */
+	Passed = Restart();
+
+	Device_Send(0);
+	Device_Send(10);
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == 10) && !(Pipes.INHeld);
+
+	Device_Send(PIPE_BANK_SIZE);
+	Device_Send(BUFFER_SIZE - 10 - PIPE_BANK_SIZE);
+	Device_Send(0);
+	Device_Send(5);
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == BUFFER_SIZE) && Pipes.INHeld && (Pipes.INBank.Length == 5);
+	Passed &= ReceiveAndCompare(BUFFER_SIZE, &Received) && (Received == BUFFER_SIZE);
+	Passed &= ReceiveAndCompare(BUFFER_SIZE, &Received) && (Received == 5);
+	Check(Passed && !(Pipes.ClearErrors), "zero length packets are cleared without adding data");
+
+	/* Peeking returns the oldest data without removing it from the buffer */
+	Passed = Restart();
+
+	uint8_t Peeked[2][16];
+
+	Device_Send(PIPE_BANK_SIZE);
+	Passed &= (CDC_Host_PeekData(&CDCInterface, Peeked[0], sizeof(Peeked[0])) == sizeof(Peeked[0]));
+	Passed &= (CDC_Host_PeekData(&CDCInterface, Peeked[1], sizeof(Peeked[1])) == sizeof(Peeked[1]));
+	Passed &= !(memcmp(Peeked[0], Peeked[1], sizeof(Peeked[0]))) && (Peeked[0][0] == Pattern(0));
+	Passed &= (CDC_Host_BytesReceived(&CDCInterface) == PIPE_BANK_SIZE);
+	Passed &= ReceiveAndCompare(PIPE_BANK_SIZE, &Received) && (Received == PIPE_BANK_SIZE);
+	Check(Passed && !(Pipes.ClearErrors), "peeking does not consume data");
+
+	/* A buffer smaller than the data IN endpoint could never take a full packet, so setup refuses it */
+	uint8_t SmallBuffer[PIPE_BANK_SIZE - 1];
+
+	USB_ClassInfo_CDC_Host_t SmallInterface =
+		{
+			.Config =
+				{
+					.DataINPipeNumber       = DATA_IN_PIPE,
+					.DataOUTPipeNumber      = DATA_OUT_PIPE,
+					.NotificationPipeNumber = NOTIFICATION_PIPE,
+
+					.DataINBuffer           = SmallBuffer,
+					.DataINBufferSize       = sizeof(SmallBuffer),
+				},
+		};
+
+	Passed  = (CDC_Host_ConfigurePipes(&SmallInterface, sizeof(ConfigDescriptor), ConfigDescriptor) == CDC_ENUMERROR_BufferTooSmall);
+	Passed &= !(SmallInterface.State.IsActive);
+	Check(Passed, "a buffer smaller than the data IN endpoint is refused");
+
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	return (Failures) ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+/** \file
+ *
+ *  Benchmark for the LUFA HID report parser (HIDParser.c). Each report descriptor in the corpus (HIDCorpus by
+ *  default, or the files named on the command line) is parsed with USB_ProcessHIDReport() and with
+ *  USB_StreamHIDReport(), and its largest input report is then decoded item by item with
+ *  USB_GetHIDReportItemInfo() and all at once with a compiled extraction plan.
+ *
+ *  The parser is built with -fsanitize-coverage=trace-pc, and each basic block it runs is charged the
+ *  same estimated AVR cycles as in the firmware tests (see Mock.h). Host times are also given, for
+ *  tracking the parser's performance from one build to the next.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <time.h>
+
+#include "LUFA/Drivers/USB/Class/Host/HIDParser.h"
+#include "Mock.h"
+
+/** Number of times each operation is repeated for the host timings. */
+#define HOST_REPEATS    10000
+
+/** Estimated AVR cycles spent in the parser. */
+static uint64_t Cycles;
+
+/** Called by the compiler at the start of every basic block of the parser. */
+void __sanitizer_cov_trace_pc(void) __attribute__ ((no_sanitize_coverage));
+void __sanitizer_cov_trace_pc(void)
+{
+	Cycles += MOCK_CYCLES_PER_BLOCK;
+}
+
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_Attributes_t* CurrentItemAttributes) __attribute__ ((no_sanitize_coverage));
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_Attributes_t* CurrentItemAttributes)
+{
+	return true;
+}
+
+static bool IgnoreStreamedItem(const HID_ReportItem_t* const ReportItem) __attribute__ ((no_sanitize_coverage));
+static bool IgnoreStreamedItem(const HID_ReportItem_t* const ReportItem)
+{
+	return true;
+}
+
+
+/** Returns the host time in nanoseconds. */
+static uint64_t HostNanoseconds(void) __attribute__ ((no_sanitize_coverage));
+static uint64_t HostNanoseconds(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return ((uint64_t)Now.tv_sec * 1000000000ULL) + Now.tv_nsec;
+}
+
+
+/** Find the input report with the most items, and the number of items in it. */
+static uint8_t LargestInputReport(const HID_ReportInfo_t* const ParserData, uint8_t* const TotalItems) __attribute__ ((no_sanitize_coverage));
+static uint8_t LargestInputReport(const HID_ReportInfo_t* const ParserData, uint8_t* const TotalItems)
+{
+	uint8_t ReportID = 0;
+
+	*TotalItems = 0;
+
+	for (uint8_t i = 0; i < ParserData->TotalReportItems; i++)
+	{
+		uint8_t Items = 0;
+
+		for (uint8_t j = 0; j < ParserData->TotalReportItems; j++)
+		{
+			if ((ParserData->ReportItems[j].ItemType == REPORT_ITEM_TYPE_In) &&
+			    (ParserData->ReportItems[j].ReportID == ParserData->ReportItems[i].ReportID))
+			{
+				Items++;
+			}
+		}
+
+		if (Items > *TotalItems)
+		{
+			*TotalItems = Items;
+			ReportID    = ParserData->ReportItems[i].ReportID;
+		}
+	}
+
+	return ReportID;
+}
+
+
+/** Benchmark the parser on one report descriptor. */
+static void Benchmark(const char* Path) __attribute__ ((no_sanitize_coverage));
+static void Benchmark(const char* Path)
+{
+	static HID_ReportInfo_t ParserData;
+	static uint8_t          Descriptor[4096];
+	static uint8_t          Report[1 + 8192];
+	HID_ReportPlan_t        Plan;
+	FILE*                   File = fopen(Path, "rb");
+
+	if (File == NULL)
+	{
+		perror(Path);
+		exit(1);
+	}
+
+	uint16_t Size = fread(Descriptor, 1, sizeof(Descriptor), File);
+	fclose(File);
+
+	const char* Name = strrchr(Path, '/');
+	Name = (Name) ? (Name + 1) : Path;
+
+	Cycles = 0;
+	uint8_t  ErrorCode   = USB_ProcessHIDReport(Descriptor, Size, &ParserData);
+	uint64_t ParseCycles = Cycles;
+
+	Cycles = 0;
+	USB_StreamHIDReport(Descriptor, Size, IgnoreStreamedItem);
+	uint64_t StreamCycles = Cycles;
+
+	// descriptors too big for the parser's tables can still be streamed
+	if (ErrorCode != HID_PARSE_Successful)
+	{
+		printf("  %-14s %5u error %-2u        %8llu\n", Name, Size, ErrorCode, (unsigned long long)StreamCycles);
+		return;
+	}
+
+	uint64_t Start = HostNanoseconds();
+	for (uint32_t i = 0; i < HOST_REPEATS; i++)
+	  USB_ProcessHIDReport(Descriptor, Size, &ParserData);
+	double ParseNs = (double)(HostNanoseconds() - Start) / HOST_REPEATS;
+
+	uint8_t TotalItems;
+	uint8_t ReportID = LargestInputReport(&ParserData, &TotalItems);
+
+	for (uint32_t i = 0; i < sizeof(Report); i++)
+	  Report[i] = (uint8_t)(i * 37);
+	Report[0] = ReportID;
+
+	Cycles = 0;
+	for (uint8_t i = 0; i < ParserData.TotalReportItems; i++)
+	{
+		if ((ParserData.ReportItems[i].ItemType == REPORT_ITEM_TYPE_In) && (ParserData.ReportItems[i].ReportID == ReportID))
+		  USB_GetHIDReportItemInfo(Report, &ParserData.ReportItems[i]);
+	}
+	uint64_t ItemCycles = Cycles;
+
+	USB_CompileHIDReportPlan(&ParserData, ReportID, REPORT_ITEM_TYPE_In, &Plan);
+
+	Cycles = 0;
+	USB_ExecuteHIDReportPlan(Report, &Plan);
+	uint64_t PlanCycles = Cycles;
+
+	printf("  %-14s %5u %5u %8llu %8llu %9.0f %5u %8llu %8llu\n", Name, Size, ParserData.TotalReportItems,
+	       (unsigned long long)ParseCycles, (unsigned long long)StreamCycles, ParseNs, TotalItems,
+	       (unsigned long long)ItemCycles, (unsigned long long)PlanCycles);
+}
+
+
+int main(int argc, char* argv[]) __attribute__ ((no_sanitize_coverage));
+int main(int argc, char* argv[])
+{
+	const char* Corpus = (argc > 1) ? NULL : "HIDCorpus";
+
+	printf("HID report descriptors, estimated AVR cycles to parse and host ns per USB_ProcessHIDReport(),\n");
+	printf("then estimated AVR cycles to decode the largest input report item by item and with a plan:\n");
+	printf("  descriptor      size items  process   stream   host ns     in  by item  by plan\n");
+
+	if (Corpus == NULL)
+	{
+		for (int Arg = 1; Arg < argc; Arg++)
+		  Benchmark(argv[Arg]);
+
+		return 0;
+	}
+
+	DIR* Dir = opendir(Corpus);
+
+	if (Dir == NULL)
+	{
+		perror(Corpus);
+		return 1;
+	}
+
+	struct dirent* Entry;
+
+	while ((Entry = readdir(Dir)) != NULL)
+	{
+		char Path[1024];
+
+		if (Entry->d_name[0] == '.')
+		  continue;
+
+		snprintf(Path, sizeof(Path), "%s/%s", Corpus, Entry->d_name);
+		Benchmark(Path);
+	}
+
+	closedir(Dir);
+	return 0;
+}
@@ -0,0 +1,197 @@
+/** \file
+ *
+ *  Fuzzing harness for the LUFA HID report parser (HIDParser.c). Each input is taken as a HID report
+ *  descriptor, and parsed with both USB_ProcessHIDReport() and USB_StreamHIDReport(), whose results and
+ *  report items are checked against each other. If it parses, a report of the largest size the descriptor
+ *  describes is decoded with USB_GetHIDReportItemInfo() and with a compiled extraction plan, and the two
+ *  are checked against each other.
+ *
+ *  Built with LIBFUZZER defined (and clang's -fsanitize=fuzzer), this is a libFuzzer target. Otherwise
+ *  it has a main() which runs each file, or each file in each directory, named on the command line
+ *  through the same entry point. That is used to replay the corpus in HIDCorpus (and any crashes) under
+ *  the address and undefined behaviour sanitizers, and as an AFL target (HIDFuzz @@).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+
+#include "LUFA/Drivers/USB/Class/Host/HIDParser.h"
+
+/** Bytes of report data past the end of the largest report, for items which the parser places
+ *  part way over the end of their report when a report's bit count wraps around.
+ */
+#define REPORT_SLACK_BYTES    32
+
+/** Number of non-constant report items passed to the streaming parser's callback, which should match the
+ *  number USB_ProcessHIDReport() stores.
+ */
+static uint32_t StreamedItems;
+
+
+/** Stores every item with USB_ProcessHIDReport(), so that as much of the parser as possible is run. */
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_Attributes_t* CurrentItemAttributes)
+{
+	return true;
+}
+
+
+static bool CountStreamedItem(const HID_ReportItem_t* const ReportItem)
+{
+	if (!(ReportItem->ItemFlags & IOF_CONSTANT))
+	  StreamedItems++;
+
+	return true;
+}
+
+
+/** Check the streaming parser's result against USB_ProcessHIDReport()'s, and abort if they disagree. The
+ *  streaming parser stores no items and frees each collection as it ends, so it runs on past the point where
+ *  USB_ProcessHIDReport() runs out of items or collections; any other error should stop both in the same place.
+ */
+static void CheckStreamedReport(const HID_ReportInfo_t* const ParserData, const uint8_t ProcessResult,
+                                const uint8_t StreamResult)
+{
+	switch (ProcessResult)
+	{
+		case HID_PARSE_InsufficientReportItems:
+		case HID_PARSE_InsufficientCollectionPaths:
+			return;
+		case HID_PARSE_Successful:
+		case HID_PARSE_NoUnfilteredReportItems:
+			if ((StreamResult == HID_PARSE_Successful) && (StreamedItems == ParserData->TotalReportItems))
+			  return;
+
+			break;
+		default:
+			if (StreamResult == ProcessResult)
+			  return;
+
+			break;
+	}
+
+	fprintf(stderr, "USB_ProcessHIDReport() returned %u with %u items, USB_StreamHIDReport() %u with %u items\n",
+	        ProcessResult, ParserData->TotalReportItems, StreamResult, StreamedItems);
+	abort();
+}
+
+
+/** Decode a report made from the input bytes with each item's USB_GetHIDReportItemInfo() and with each
+ *  report's extraction plan, and abort if they disagree.
+ */
+static void CheckReports(HID_ReportInfo_t* const ParserData, const uint8_t* Data, const size_t Size)
+{
+	static uint8_t   Report[1 + (65536 / 8) + REPORT_SLACK_BYTES];
+	static uint32_t  Values[HID_MAX_REPORTITEMS];
+	HID_ReportPlan_t Plan;
+
+	uint32_t ReportBytes = (1 + ((ParserData->LargestReportSizeBits + 7) / 8) + REPORT_SLACK_BYTES);
+
+	for (uint32_t i = 0; i < ReportBytes; i++)
+	  Report[i] = (Size) ? Data[i % Size] : 0;
+
+	for (uint8_t ItemIndex = 0; ItemIndex < ParserData->TotalReportItems; ItemIndex++)
+	{
+		HID_ReportItem_t* ReportItem = &ParserData->ReportItems[ItemIndex];
+
+		Report[0] = ReportItem->ReportID;
+
+		USB_GetHIDReportItemInfo(Report, ReportItem);
+		Values[ItemIndex] = ReportItem->Value;
+
+		if (!(USB_CompileHIDReportPlan(ParserData, ReportItem->ReportID, ReportItem->ItemType, &Plan)))
+		  abort();
+
+		ReportItem->Value = ~Values[ItemIndex];
+		USB_ExecuteHIDReportPlan(Report, &Plan);
+
+		if (ReportItem->Value != Values[ItemIndex])
+		{
+			fprintf(stderr, "Plan decoded item %u (offset %u, %u bits) as %08X, USB_GetHIDReportItemInfo() as %08X\n",
+			        ItemIndex, ReportItem->BitOffset, ReportItem->Attributes.BitSize, ReportItem->Value, Values[ItemIndex]);
+			abort();
+		}
+	}
+}
+
+
+int LLVMFuzzerTestOneInput(const uint8_t* Data, size_t Size)
+{
+	static HID_ReportInfo_t ParserData;
+
+	if (Size > UINT16_MAX)
+	  return 0;
+
+	// the parser is given a copy of exactly the input's size, so that any read past its end is caught
+	uint8_t* Descriptor = malloc(Size ? Size : 1);
+	memcpy(Descriptor, Data, Size);
+
+	uint8_t ProcessResult = USB_ProcessHIDReport(Descriptor, Size, &ParserData);
+
+	StreamedItems = 0;
+	CheckStreamedReport(&ParserData, ProcessResult, USB_StreamHIDReport(Descriptor, Size, CountStreamedItem));
+
+	if (ProcessResult == HID_PARSE_Successful)
+	  CheckReports(&ParserData, Data, Size);
+
+	free(Descriptor);
+	return 0;
+}
+
+
+#if !defined(LIBFUZZER)
+/** Run one file through the fuzzing entry point. */
+static void RunFile(const char* Path, uint32_t* const Inputs)
+{
+	static uint8_t Data[65536];
+	FILE*          File = fopen(Path, "rb");
+
+	if (File == NULL)
+	{
+		perror(Path);
+		exit(1);
+	}
+
+	size_t Size = fread(Data, 1, sizeof(Data), File);
+	fclose(File);
+
+	LLVMFuzzerTestOneInput(Data, Size);
+	(*Inputs)++;
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t Inputs = 0;
+
+	for (int Arg = 1; Arg < argc; Arg++)
+	{
+		DIR* Dir = opendir(argv[Arg]);
+
+		if (Dir == NULL)
+		{
+			RunFile(argv[Arg], &Inputs);
+			continue;
+		}
+
+		struct dirent* Entry;
+
+		while ((Entry = readdir(Dir)) != NULL)
+		{
+			char Path[1024];
+
+			if (Entry->d_name[0] == '.')
+			  continue;
+
+			snprintf(Path, sizeof(Path), "%s/%s", argv[Arg], Entry->d_name);
+			RunFile(Path, &Inputs);
+		}
+
+		closedir(Dir);
+	}
+
+	printf("HID parser: %u inputs run\n", Inputs);
+	return 0;
+}
+#endif
@@ -0,0 +1,240 @@
+/** \file
+ *
+ *  Host test harness for the USBtoSerial firmware. This runs the firmware against the mocks in
+ *  Mock.c, and checks the console bridge, the AVR commands and the telemetry interface from the
+ *  host's side of the USB cable (and the Beagleboard's side of the USART). It also measures the
+ *  throughput of the console bridge each way, and reports the worst case time spent in each ISR.
+ *
+ *  All times are estimates (see Mock.h), so the figures are for comparing one build of the firmware
+ *  with another, rather than a substitute for measuring the board.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../USBtoSerial.h"
+#include "Mock.h"
+
+/** Cycles in one second of simulated time. */
+#define SECONDS(s)         ((uint64_t)((s) * F_CPU))
+
+/** Bytes sent through the console bridge by the throughput tests. */
+#define THROUGHPUT_BYTES   4096
+
+/** Number of tests which have failed. */
+static int Failures = 0;
+
+
+/** Report the result of a test. */
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+
+/** Send a line to the command port, run the firmware until it has been dealt with, and collect the
+ *  reply (if any) as a string.
+ */
+static void Command(const char* Line, char* Reply, const uint32_t ReplySize)
+{
+	Mock_HostSend(CMD_RX_EPNUM, Line, strlen(Line));
+	Mock_HostSend(CMD_RX_EPNUM, "\r\n", 2);
+	Mock_RunFor(SECONDS(0.05));
+
+	uint32_t Length = Mock_HostReceive(CMD_TX_EPNUM, Reply, ReplySize - 1);
+	Reply[Length] = '\0';
+}
+
+
+/** Returns true if the power port pin is on (the power port is active low). */
+static bool PinIsOn(const uint8_t Pin)
+{
+	return !(PORTC & (1 << Pin));
+}
+
+
+/** Send data from the host through the console to the Beagleboard, and check it arrives intact. */
+static void TestHostToBeagle(void)
+{
+	static uint8_t Sent[THROUGHPUT_BYTES], Received[THROUGHPUT_BYTES + 1];
+	uint32_t       Length = 0;
+
+	for (uint32_t i = 0; i < THROUGHPUT_BYTES; i++)
+	  Sent[i] = (uint8_t)(i * 7 + (i >> 8));
+
+	uint64_t Start = Mock_Cycles;
+
+	Mock_HostSend(CDC_RX_EPNUM, Sent, THROUGHPUT_BYTES);
+
+	while (Length < THROUGHPUT_BYTES && (Mock_Cycles - Start) < SECONDS(5))
+	{
+		Mock_RunLoop(1);
+		Length += Mock_BeagleReceive(&Received[Length], sizeof(Received) - Length);
+	}
+
+	uint64_t Cycles = Mock_Cycles - Start;
+
+	printf("Host to Beagle: %u bytes in %.1f ms, %.0f bytes/s\n", Length, Cycles * 1000.0 / F_CPU,
+	       Length * (double)F_CPU / Cycles);
+
+	Check((Length == THROUGHPUT_BYTES) && !memcmp(Sent, Received, THROUGHPUT_BYTES),
+	      "console data from the host reaches the Beagle intact");
+}
+
+
+/** Send data from the Beagleboard through the console to the host, and check it arrives intact. */
+static void TestBeagleToHost(void)
+{
+	static uint8_t Sent[THROUGHPUT_BYTES], Received[THROUGHPUT_BYTES + 1];
+	uint32_t       Length = 0;
+
+	for (uint32_t i = 0; i < THROUGHPUT_BYTES; i++)
+	  Sent[i] = (uint8_t)(i * 13 + (i >> 8));
+
+	uint64_t Start = Mock_Cycles;
+
+	Mock_BeagleSend(Sent, THROUGHPUT_BYTES);
+
+	while (Length < THROUGHPUT_BYTES && (Mock_Cycles - Start) < SECONDS(5))
+	{
+		Mock_RunLoop(1);
+		Length += Mock_HostReceive(CDC_TX_EPNUM, &Received[Length], sizeof(Received) - Length);
+	}
+
+	uint64_t Cycles = Mock_Cycles - Start;
+
+	printf("Beagle to host: %u bytes in %.1f ms, %.0f bytes/s\n", Length, Cycles * 1000.0 / F_CPU,
+	       Length * (double)F_CPU / Cycles);
+
+	Check((Length == THROUGHPUT_BYTES) && !memcmp(Sent, Received, THROUGHPUT_BYTES),
+	      "console data from the Beagle reaches the host intact");
+}
+
+
+/** Check the AVR commands on the command port. */
+static void TestCommands(void)
+{
+	char Reply[1024];
+
+	Command("power off 3", Reply, sizeof(Reply));
+	Check(!PinIsOn(5) && strstr(Reply, "Turned off pin[5] sw3"), "power off 3 turns off pin 5");
+
+	Command("avr://power on 3", Reply, sizeof(Reply));
+	Check(PinIsOn(5) && strstr(Reply, "Turned on pin[5] sw3"), "avr:// prefix is accepted on the command port");
+
+	Command("power off 3 2", Reply, sizeof(Reply));
+	Check(PinIsOn(5) && strstr(Reply, "in (2) seconds"), "power off 3 2 is scheduled");
+	Mock_RunFor(SECONDS(1.9));
+	Check(PinIsOn(5), "scheduled power off waits for its delay");
+	Mock_RunFor(SECONDS(0.2));
+	Check(!PinIsOn(5), "scheduled power off happens after its delay");
+
+	Command("cycle 3 1 2", Reply, sizeof(Reply));
+	Check(PinIsOn(5) && strstr(Reply, "Cycling pin[5] sw3"), "cycle 3 1 2 turns pin 5 on");
+	Mock_RunFor(SECONDS(1.1));
+	Check(!PinIsOn(5), "cycle turns the pin off after its on time");
+	Mock_RunFor(SECONDS(2));
+	Check(PinIsOn(5), "cycle turns the pin on again after its off time");
+	Command("cycle 3", Reply, sizeof(Reply));
+	Check(strstr(Reply, "Stopped cycling pin[5]") != NULL, "cycle 3 stops the cycle");
+
+	Command("lcd hello", Reply, sizeof(Reply));
+	Check(!strcmp(Mock_LCDLine(1), "hello") && strstr(Reply, "Sent to LCD: 'hello'"), "lcd puts a line on the LCD");
+
+	Command("watchdog disable", Reply, sizeof(Reply));
+	Check(!strcmp(Mock_LCDLine(1), "Beagle Watchdog disabled"), "watchdog disable");
+
+	Command("frobnicate", Reply, sizeof(Reply));
+	Check(strstr(Reply, "Got unknown AVR command 'frobnicate'") != NULL, "unknown commands are reported");
+
+	Command("journal 4", Reply, sizeof(Reply));
+	Mock_RunFor(SECONDS(0.1));
+	uint32_t Length = strlen(Reply);
+	Length += Mock_HostReceive(CMD_TX_EPNUM, &Reply[Length], sizeof(Reply) - Length - 1);
+	Reply[Length] = '\0';
+	Check(strstr(Reply, "AVR event journal") && strstr(Reply, "power off, pin 5"), "journal reports recent events");
+
+	Command("stats", Reply, sizeof(Reply));
+	Check(strstr(Reply, "Bridge bytes: to beagle (4096) to host (4096)") != NULL, "stats counts bridge bytes");
+	printf("%s", Reply);
+}
+
+
+/** Check that AVR commands sent down the console are passed to the Beagle rather than carried out. */
+static void TestConsoleTransparency(void)
+{
+	const char* Line = "avr://power off 1\r\n";
+	char        Received[64];
+
+	Mock_HostSend(CDC_RX_EPNUM, Line, strlen(Line));
+	Mock_RunFor(SECONDS(0.05));
+
+	uint32_t Length = Mock_BeagleReceive(Received, sizeof(Received) - 1);
+	Received[Length] = '\0';
+
+	Check(PinIsOn(7) && !strcmp(Received, Line), "console passes avr:// lines through untouched");
+}
+
+
+/** Check the telemetry interface's status report, and that unknown requests are stalled. */
+static void TestTelemetry(void)
+{
+	USB_Request_Header_t Request =
+		{
+			.bmRequestType = (REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_INTERFACE),
+			.bRequest      = REQ_GetTelemetryReport,
+			.wValue        = 0,
+			.wIndex        = TELEMETRY_INTERFACE_NUMBER,
+			.wLength       = sizeof(Telemetry_Report_t),
+		};
+	Telemetry_Report_t Report;
+	uint16_t           Length = sizeof(Report);
+
+	bool Handled = Mock_HostControl(&Request, &Report, &Length);
+	Check(Handled && (Length == sizeof(Report)) && (Report.Version == TELEMETRY_REPORT_VERSION)
+	      && (Report.PowerState & (1 << 5)) && !(Report.Flags & TELEMETRY_FLAG_WATCHDOG),
+	      "telemetry report reflects the power and watchdog state");
+
+	Request.bRequest = 0x7F;
+	Length           = sizeof(Report);
+	Check(!Mock_HostControl(&Request, &Report, &Length), "unknown telemetry requests are stalled");
+}
+
+
+/** Check that the main loop sleeps when there is nothing to do. */
+static void TestIdle(void)
+{
+	uint32_t Sleeps = Mock_SleepCount;
+
+	Mock_RunFor(SECONDS(1));
+
+	printf("Idle: slept %u times in 1 s\n", Mock_SleepCount - Sleeps);
+	Check((Mock_SleepCount - Sleeps) >= TIMERWHEEL_TICK_HZ, "main loop sleeps between timer ticks when idle");
+}
+
+
+int main(void)
+{
+	Mock_Start();
+	Mock_HostConnect();
+	Mock_RunFor(SECONDS(0.1));
+
+	TestHostToBeagle();
+	TestBeagleToHost();
+	TestCommands();
+	TestConsoleTransparency();
+	TestTelemetry();
+	TestIdle();
+
+	Check(!(Mock_ResetRequested), "firmware didn't reset itself");
+
+	Mock_ReportISRs();
+	printf("EEPROM writes: %u\n", Mock_EEPROMWrites);
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	return (Failures) ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/** \file
+ *
+ *  Host test for the LUFA Mass Storage host block cache (MassStorageCache.c). The cache is built against
+ *  a simulated drive held in RAM, whose READ and WRITE commands move their data one 64 byte pipe bank at
+ *  a time through the cache's block stream callbacks, as MS_Host_ReadDeviceBlockStream() and
+ *  MS_Host_WriteDeviceBlockStream() would. A reference image is updated alongside every write through
+ *  the cache, and each block read through the cache (and the drive's contents, once flushed) is checked
+ *  against it.
+ *
+ *  Besides a long random mix of reads and writes, the tests check the commands the cache issues for
+ *  sequential access: reads should fetch MS_CACHE_READ_AHEAD_BLOCKS following blocks in the same
+ *  command (without running past the end of the medium), and adjacent dirty blocks should be written
+ *  back together.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Stand-ins for the parts of the LUFA USB driver used by MassStorageCache.c. Its includes of the real
+   driver headers are skipped by defining their include guards, and the mock Mass Storage header is
+   used in their place. */
+#define __USBMODE_H__
+#define __MS_CLASS_HOST_H__
+#define USB_CAN_BE_HOST
+
+#include <LUFA/Drivers/USB/Class/MassStorage.h>
+
+#include "../../LUFA/Drivers/USB/Class/Host/MassStorageCache.c"
+
+/** Blocks in the simulated drive. */
+#define DISK_BLOCKS             64
+
+/** Bytes in each bank of the simulated data pipe. */
+#define PIPE_BANK_SIZE          64
+
+/** Blocks at the start of the drive which the random mix favours, as a filesystem does its FAT. */
+#define HOT_BLOCKS              8
+
+/** Blocks read in the sequential read test. The first read isn't known to be sequential, so each of the
+ *  others should be fetched with MS_CACHE_READ_AHEAD_BLOCKS blocks after it, in 10 commands.
+ */
+#define SEQUENTIAL_BLOCKS       (1 + (10 * (MS_CACHE_READ_AHEAD_BLOCKS + 1)))
+
+/** Reads and writes in the random mix. */
+#define RANDOM_OPERATIONS       200000
+
+/** Number of tests which have failed. */
+static int Failures = 0;
+
+/** Contents of the simulated drive, and what it should hold once the cache is flushed. */
+static uint8_t Disk[DISK_BLOCKS][MS_CACHE_BLOCK_SIZE];
+static uint8_t Reference[DISK_BLOCKS][MS_CACHE_BLOCK_SIZE];
+
+/** State of the simulated drive. */
+static struct
+{
+	uint8_t* Cursor; /**< Next byte of the drive to be moved through the pipe by the command in progress */
+	uint32_t BankBytesRem; /**< Bytes of the current pipe bank not yet moved by the callback */
+	uint32_t ReadCommands;
+	uint32_t WriteCommands;
+	bool     OutOfRange; /**< Set if a command addressed blocks beyond the end of the drive */
+	bool     FailNextCommand; /**< Set to make the next command fail */
+} Drive;
+
+/** Cache under test, and the interface it is given (which is only passed through to the mocks). */
+static USB_ClassInfo_MS_Host_t MSInterface;
+static MS_Cache_t Cache = { .Config = { .MSInterfaceInfo = &MSInterface, .LUNIndex = 0 } };
+
+
+/** Report the result of a test. */
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+
+/** Run a command's data stage through the cache's callback, one pipe bank at a time. */
+static uint8_t RunCommand(const uint32_t BlockAddress, const uint32_t Blocks, MS_BlockStreamCallbackPtr_t Callback)
+{
+	uint32_t BytesRem = (Blocks * MS_CACHE_BLOCK_SIZE);
+
+	if (!(Blocks) || ((BlockAddress + Blocks) > DISK_BLOCKS))
+	{
+		Drive.OutOfRange = true;
+		return MS_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	if (Drive.FailNextCommand)
+	{
+		Drive.FailNextCommand = false;
+		return MS_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	Drive.Cursor = Disk[BlockAddress];
+
+	while (BytesRem)
+	{
+		uint16_t BankBytes = (BytesRem < PIPE_BANK_SIZE) ? BytesRem : PIPE_BANK_SIZE;
+
+		Drive.BankBytesRem = BankBytes;
+
+		// the callback must move exactly the bank's bytes
+		if (!(Callback(&MSInterface, BankBytes)) || Drive.BankBytesRem)
+		  return PIPE_RWSTREAM_CallbackAborted;
+
+		BytesRem -= BankBytes;
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t MS_Host_ReadDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                      const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+                                      MS_BlockStreamCallbackPtr_t Callback)
+{
+	Drive.ReadCommands++;
+
+	return RunCommand(BlockAddress, Blocks, Callback);
+}
+
+uint8_t MS_Host_WriteDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                       const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+                                       MS_BlockStreamCallbackPtr_t Callback)
+{
+	Drive.WriteCommands++;
+
+	return RunCommand(BlockAddress, Blocks, Callback);
+}
+
+uint8_t Pipe_Read_Stream_LE(void* Buffer, uint16_t Length, void* Callback)
+{
+	if (Length > Drive.BankBytesRem)
+	  return PIPE_RWSTREAM_CallbackAborted;
+
+	memcpy(Buffer, Drive.Cursor, Length);
+	Drive.Cursor       += Length;
+	Drive.BankBytesRem -= Length;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t Pipe_Write_Stream_LE(const void* Buffer, uint16_t Length, void* Callback)
+{
+	if (Length > Drive.BankBytesRem)
+	  return PIPE_RWSTREAM_CallbackAborted;
+
+	memcpy(Drive.Cursor, Buffer, Length);
+	Drive.Cursor       += Length;
+	Drive.BankBytesRem -= Length;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+
+/** Fill a block with new random contents. */
+static void RandomBlock(uint8_t* Block)
+{
+	for (uint16_t i = 0; i < MS_CACHE_BLOCK_SIZE; i++)
+	  Block[i] = rand();
+}
+
+/** Read a block through the cache, and check it against the reference image. */
+static bool ReadAndCompare(const uint32_t BlockAddress)
+{
+	uint8_t Block[MS_CACHE_BLOCK_SIZE];
+
+	return ((MS_Cache_ReadBlock(&Cache, BlockAddress, Block) == PIPE_RWSTREAM_NoError) &&
+	        !(memcmp(Block, Reference[BlockAddress], MS_CACHE_BLOCK_SIZE)));
+}
+
+/** Write new contents to a block through the cache, and to the reference image. */
+static bool WriteRandom(const uint32_t BlockAddress)
+{
+	RandomBlock(Reference[BlockAddress]);
+
+	return (MS_Cache_WriteBlock(&Cache, BlockAddress, Reference[BlockAddress]) == PIPE_RWSTREAM_NoError);
+}
+
+/** Empty the cache, and reset the drive's command counts. */
+static void Restart(void)
+{
+	MS_Cache_Init(&Cache, DISK_BLOCKS);
+
+	Drive.ReadCommands  = 0;
+	Drive.WriteCommands = 0;
+}
+
+
+int main(void)
+{
+	bool Passed;
+
+	srand(1);
+
+	for (uint32_t BlockAddress = 0; BlockAddress < DISK_BLOCKS; BlockAddress++)
+	{
+		RandomBlock(Disk[BlockAddress]);
+		memcpy(Reference[BlockAddress], Disk[BlockAddress], MS_CACHE_BLOCK_SIZE);
+	}
+
+	Restart();
+	Passed = true;
+
+	for (uint32_t BlockAddress = 10; BlockAddress < (10 + SEQUENTIAL_BLOCKS); BlockAddress++)
+	  Passed &= ReadAndCompare(BlockAddress);
+
+	printf("sequential read of %u blocks: %u READ commands, %u blocks read ahead\n", SEQUENTIAL_BLOCKS,
+	       (unsigned)Drive.ReadCommands, (unsigned)Cache.State.Stats.ReadAheadBlocks);
+	Check(Passed && (Drive.ReadCommands == 11) &&
+	      (Cache.State.Stats.ReadAheadHits == Cache.State.Stats.ReadAheadBlocks),
+	      "sequential reads fetch the following blocks in the same command");
+
+	Passed = true;
+
+	for (uint32_t BlockAddress = (DISK_BLOCKS - 4); BlockAddress < DISK_BLOCKS; BlockAddress++)
+	  Passed &= ReadAndCompare(BlockAddress);
+
+	Check(Passed && !(Drive.OutOfRange), "read-ahead stops at the end of the medium");
+
+	Restart();
+	Passed = true;
+
+	for (uint32_t BlockAddress = 0; BlockAddress < 32; BlockAddress++)
+	  Passed &= WriteRandom(BlockAddress);
+
+	Passed &= (MS_Cache_Flush(&Cache) == PIPE_RWSTREAM_NoError);
+
+	printf("sequential write of 32 blocks: %u WRITE commands\n", (unsigned)Drive.WriteCommands);
+	Check(Passed && !(memcmp(Disk, Reference, sizeof(Disk))) && (Drive.WriteCommands == (32 / MS_CACHE_BLOCKS)),
+	      "adjacent dirty blocks are written back in one command");
+
+	Restart();
+	Passed = WriteRandom(50) && ReadAndCompare(50) && memcmp(Disk[50], Reference[50], MS_CACHE_BLOCK_SIZE) &&
+	         !(Drive.WriteCommands) && !(Drive.ReadCommands);
+	Passed &= (MS_Cache_Flush(&Cache) == PIPE_RWSTREAM_NoError) && !(memcmp(Disk[50], Reference[50], MS_CACHE_BLOCK_SIZE));
+	Check(Passed, "writes are held in the cache until flushed");
+
+	Passed = WriteRandom(51);
+	Drive.FailNextCommand = true;
+	Passed &= (MS_Cache_Flush(&Cache) == MS_ERROR_LOGICAL_CMD_FAILED);
+	Passed &= (MS_Cache_Flush(&Cache) == PIPE_RWSTREAM_NoError) && !(memcmp(Disk, Reference, sizeof(Disk)));
+	Check(Passed, "a block whose write-back fails stays dirty");
+
+	Restart();
+	Passed = true;
+
+	for (uint32_t Operation = 0; Operation < RANDOM_OPERATIONS; Operation++)
+	{
+		uint32_t BlockAddress = (rand() % 3) ? (rand() % HOT_BLOCKS) : (rand() % DISK_BLOCKS);
+
+		if (rand() & 1)
+		  Passed &= ReadAndCompare(BlockAddress);
+		else
+		  Passed &= WriteRandom(BlockAddress);
+
+		if (!(rand() % 1000))
+		  Passed &= (MS_Cache_Flush(&Cache) == PIPE_RWSTREAM_NoError);
+	}
+
+	Passed &= (MS_Cache_Flush(&Cache) == PIPE_RWSTREAM_NoError);
+
+	printf("random mix: %u hits, %u misses, %u READ commands, %u WRITE commands (%u blocks)\n",
+	       (unsigned)Cache.State.Stats.ReadHits, (unsigned)Cache.State.Stats.ReadMisses, (unsigned)Drive.ReadCommands,
+	       (unsigned)Drive.WriteCommands, (unsigned)Cache.State.Stats.BlocksWritten);
+	Check(Passed && !(memcmp(Disk, Reference, sizeof(Disk))) && !(Drive.OutOfRange),
+	      "random reads and writes match the reference image");
+
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	return (Failures) ? 1 : 0;
+}
@@ -0,0 +1,820 @@
+/** \file
+ *
+ *  Host stand-ins for the AVR registers, the LUFA USB and USART drivers, the EEPROM, the watchdog and
+ *  the LCD, used to run the USBtoSerial firmware under the host test harness. See Mock.h for an
+ *  overview.
+ */
+
+#define _GNU_SOURCE
+#include <ucontext.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <LUFA/Drivers/Peripheral/Serial.h>
+
+#include "../Lib/lcd.h"
+#include "Mock.h"
+
+/** Largest endpoint bank which can be simulated. */
+#define MOCK_MAX_EPSIZE    256
+
+/** Longest control request data stage which can be simulated. */
+#define MOCK_MAX_CONTROL   256
+
+/** Most ISRs the duration report can keep track of. */
+#define MOCK_MAX_ISRS      8
+
+/** Size of the stack the firmware runs on. */
+#define MOCK_STACK_SIZE    (256 * 1024)
+
+/** Cycles between Timer0 compare matches, as set up by TimerWheel_Init(). */
+#define MOCK_TIMER0_CYCLES ((uint32_t)256 * (OCR0A + 1))
+
+/** Cycles an EEPROM byte write takes (3.4ms). */
+#define MOCK_EEPROM_CYCLES ((uint64_t)F_CPU * 34 / 10000)
+
+/** Type define for a byte FIFO, one side of a simulated connection. */
+typedef struct
+{
+	uint8_t  Data[MOCK_FIFO_SIZE];
+	uint32_t In;
+	uint32_t Out;
+} Mock_FIFO_t;
+
+/** Type define for the state of a simulated endpoint. */
+typedef struct
+{
+	bool        Configured;
+	uint8_t     Direction;
+	uint16_t    Size;
+	uint8_t     Bank[MOCK_MAX_EPSIZE];
+	uint16_t    BankLength;
+	uint16_t    BankPosition;
+	bool        BankFull; /**< OUT: holds a packet from the host, IN: holds a packet the host hasn't taken */
+	bool        HostPaused; /**< IN: the host isn't collecting packets */
+	Mock_FIFO_t Host; /**< OUT: bytes the host has still to send, IN: bytes the host has received */
+} Mock_Endpoint_t;
+
+/** Type define for the record of one ISR's durations. */
+typedef struct
+{
+	void      (*Vector)(void);
+	const char* Name;
+	uint32_t    Calls;
+	uint32_t    MaxCycles;
+	uint64_t    TotalCycles;
+} Mock_ISRStats_t;
+
+/* Registers: */
+volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF;
+volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF;
+volatile uint8_t UCSR1A, UCSR1B, UCSR1C, UDR1;
+volatile uint8_t MCUSR, SREG, EECR;
+volatile uint8_t TCCR0A, TCCR0B, OCR0A, TIMSK0, TCNT0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t OCR1A;
+volatile uint8_t TCCR3A, TCCR3B, TIMSK3;
+volatile uint16_t OCR3A, TCNT3;
+volatile uint8_t UENUM;
+volatile uint8_t Mock_EndpointIEN[ENDPOINT_TOTAL_ENDPOINTS];
+
+/* LUFA globals: */
+volatile uint8_t     USB_DeviceState;
+USB_Request_Header_t USB_ControlRequest;
+
+/* Harness globals: */
+uint64_t Mock_Cycles;
+bool     Mock_ResetRequested;
+uint32_t Mock_SleepCount;
+uint32_t Mock_EEPROMWrites;
+uint32_t Mock_ControlStalls;
+
+static Mock_Endpoint_t Endpoints[ENDPOINT_TOTAL_ENDPOINTS];
+static EndpointCallbackPtr_t EndpointCallbacks[ENDPOINT_TOTAL_ENDPOINTS];
+static Mock_FIFO_t     BeagleTx, BeagleRx;
+static uint64_t        NextTimer0, NextBeagleByte, SerialFreeAt, EEPROMFreeAt;
+
+static bool            SetupPending;
+static uint8_t         ControlData[MOCK_MAX_CONTROL];
+static uint16_t        ControlLength;
+
+static char            LCDLines[LCD_LINES][LCD_DISP_LENGTH + 1];
+
+static Mock_ISRStats_t ISRStats[MOCK_MAX_ISRS];
+
+static ucontext_t      HarnessContext, FirmwareContext;
+static char*           FirmwareStack;
+
+/* Firmware functions called by the mocks: */
+int  Firmware_main(void);
+void EVENT_USB_Device_Connect(void);
+void EVENT_USB_Device_ConfigurationChanged(void);
+void EVENT_USB_Device_UnhandledControlRequest(void);
+
+
+/** Called by the compiler at the start of every basic block of firmware code. */
+void __sanitizer_cov_trace_pc(void)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_BLOCK;
+}
+
+
+static uint32_t FIFO_Count(const Mock_FIFO_t* FIFO)
+{
+	return FIFO->In - FIFO->Out;
+}
+
+static void FIFO_Put(Mock_FIFO_t* FIFO, const uint8_t Byte)
+{
+	if (FIFO_Count(FIFO) == MOCK_FIFO_SIZE)
+	{
+		fprintf(stderr, "Mock: FIFO overflow\n");
+		exit(2);
+	}
+
+	FIFO->Data[FIFO->In++ & (MOCK_FIFO_SIZE - 1)] = Byte;
+}
+
+static uint8_t FIFO_Get(Mock_FIFO_t* FIFO)
+{
+	return FIFO->Data[FIFO->Out++ & (MOCK_FIFO_SIZE - 1)];
+}
+
+
+/** Run an ISR as the hardware would, with interrupts disabled, and record how long it took. */
+static void Mock_FireISR(void (*Vector)(void), const char* Name)
+{
+	Mock_ISRStats_t* Stats = NULL;
+
+	for (uint8_t i = 0; i < MOCK_MAX_ISRS; i++)
+	{
+		if ((ISRStats[i].Vector == Vector) || !(ISRStats[i].Vector))
+		{
+			Stats         = &ISRStats[i];
+			Stats->Vector = Vector;
+			Stats->Name   = Name;
+			break;
+		}
+	}
+
+	uint8_t  SavedSREG = SREG;
+	uint64_t Start     = Mock_Cycles;
+
+	SREG &= ~0x80;
+	Vector();
+	SREG = SavedSREG;
+
+	Mock_Cycles += MOCK_CYCLES_PER_ISR;
+
+	uint32_t Cycles = (uint32_t)(Mock_Cycles - Start);
+
+	Stats->Calls++;
+	Stats->TotalCycles += Cycles;
+	if (Cycles > Stats->MaxCycles)
+	  Stats->MaxCycles = Cycles;
+}
+
+
+/** Returns true if an OUT endpoint has (or can be given) a packet from the host. */
+static bool Mock_OUTAvailable(const Mock_Endpoint_t* Endpoint)
+{
+	return Endpoint->BankFull || FIFO_Count(&Endpoint->Host);
+}
+
+
+/** Fire any interrupts which are due at the current simulated time, if interrupts are enabled. */
+static void Mock_Advance(void)
+{
+	if (!(SREG & 0x80))
+	  return;
+
+	if (Mock_Cycles >= SerialFreeAt)
+	  UCSR1A |= (1 << UDRE1);
+
+	while ((TIMSK0 & (1 << OCIE0A)) && (NextTimer0 <= Mock_Cycles))
+	{
+		NextTimer0 += MOCK_TIMER0_CYCLES;
+		Mock_FireISR(TIMER0_COMPA_vect, "TIMER0_COMPA");
+	}
+
+	while (FIFO_Count(&BeagleTx) && (NextBeagleByte <= Mock_Cycles))
+	{
+		UDR1 = FIFO_Get(&BeagleTx);
+		NextBeagleByte += MOCK_CYCLES_PER_SERIAL_BYTE;
+
+		if (UCSR1B & (1 << RXCIE1))
+		  Mock_FireISR(USART1_RX_vect, "USART1_RX");
+	}
+
+	if ((UCSR1B & (1 << UDRIE1)) && (UCSR1A & (1 << UDRE1)))
+	  Mock_FireISR(USART1_UDRE_vect, "USART1_UDRE");
+
+	if (Endpoint_GetEndpointInterrupts())
+	  Mock_FireISR(USB_COM_vect, "USB_COM");
+}
+
+
+/** Hand control back to the harness, at the end of a main loop pass. */
+static void Mock_Yield(void)
+{
+	swapcontext(&FirmwareContext, &HarnessContext);
+}
+
+
+/** Start the firmware, and run it up to the end of its first main loop pass. */
+void Mock_Start(void)
+{
+	memset(Endpoints, 0, sizeof(Endpoints));
+	memset(ISRStats, 0, sizeof(ISRStats));
+
+	Mock_Cycles    = 0;
+	NextTimer0     = 0;
+	NextBeagleByte = 0;
+	SerialFreeAt   = 0;
+	EEPROMFreeAt   = 0;
+	UCSR1A         = (1 << UDRE1);
+	MCUSR          = (1 << PORF);
+
+	FirmwareStack = malloc(MOCK_STACK_SIZE);
+
+	getcontext(&FirmwareContext);
+	FirmwareContext.uc_stack.ss_sp   = FirmwareStack;
+	FirmwareContext.uc_stack.ss_size = MOCK_STACK_SIZE;
+	FirmwareContext.uc_link          = &HarnessContext;
+	makecontext(&FirmwareContext, (void (*)(void))Firmware_main, 0);
+
+	swapcontext(&HarnessContext, &FirmwareContext);
+}
+
+
+/** Run the given number of main loop passes (fewer if the firmware resets itself). */
+void Mock_RunLoop(const uint32_t Passes)
+{
+	for (uint32_t i = 0; (i < Passes) && !(Mock_ResetRequested); i++)
+	{
+		Mock_Advance();
+		swapcontext(&HarnessContext, &FirmwareContext);
+	}
+}
+
+
+/** Run the main loop until the given number of cycles of simulated time have passed. */
+void Mock_RunFor(const uint64_t Cycles)
+{
+	uint64_t End = Mock_Cycles + Cycles;
+
+	while ((Mock_Cycles < End) && !(Mock_ResetRequested))
+	  Mock_RunLoop(1);
+}
+
+
+/** Attach to the host, which then enumerates and configures the device. */
+void Mock_HostConnect(void)
+{
+	USB_DeviceState = DEVICE_STATE_Powered;
+	EVENT_USB_Device_Connect();
+
+	USB_DeviceState = DEVICE_STATE_Configured;
+	EVENT_USB_Device_ConfigurationChanged();
+}
+
+
+/** Queue data for the host to send on an OUT endpoint. */
+void Mock_HostSend(const uint8_t EPNum, const void* Data, const uint16_t Length)
+{
+	for (uint16_t i = 0; i < Length; i++)
+	  FIFO_Put(&Endpoints[EPNum].Host, ((const uint8_t*)Data)[i]);
+}
+
+
+/** Take data the host has received on an IN endpoint, returning how many bytes were taken. */
+uint32_t Mock_HostReceive(const uint8_t EPNum, void* Buffer, const uint32_t Length)
+{
+	uint32_t Count = 0;
+
+	while ((Count < Length) && FIFO_Count(&Endpoints[EPNum].Host))
+	  ((uint8_t*)Buffer)[Count++] = FIFO_Get(&Endpoints[EPNum].Host);
+
+	return Count;
+}
+
+
+/** Returns the number of bytes waiting in an endpoint's host side FIFO. */
+uint32_t Mock_HostPending(const uint8_t EPNum)
+{
+	return FIFO_Count(&Endpoints[EPNum].Host);
+}
+
+
+/** Stop or restart the host collecting packets from an IN endpoint, as if no program had it open. */
+void Mock_HostPauseIN(const uint8_t EPNum, const bool Paused)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[EPNum];
+
+	Endpoint->HostPaused = Paused;
+
+	if (!(Paused) && Endpoint->BankFull)
+	{
+		for (uint16_t i = 0; i < Endpoint->BankLength; i++)
+		  FIFO_Put(&Endpoint->Host, Endpoint->Bank[i]);
+
+		Endpoint->BankFull   = false;
+		Endpoint->BankLength = 0;
+	}
+}
+
+
+/** Send a control request from the host and run the main loop until it has been handled. For a
+ *  device-to-host request, Length gives the space in Data and returns the bytes sent back. Returns
+ *  false if the request was stalled.
+ */
+bool Mock_HostControl(const USB_Request_Header_t* const Request, void* const Data, uint16_t* const Length)
+{
+	USB_ControlRequest = *Request;
+	SetupPending       = true;
+	ControlLength      = 0;
+
+	if (!(Request->bmRequestType & REQDIR_DEVICETOHOST) && Request->wLength)
+	{
+		memcpy(ControlData, Data, Request->wLength);
+		ControlLength = Request->wLength;
+	}
+
+	uint32_t Stalls = Mock_ControlStalls;
+
+	for (uint8_t Pass = 0; SetupPending && (Pass < 10); Pass++)
+	  Mock_RunLoop(1);
+
+	if (Request->bmRequestType & REQDIR_DEVICETOHOST)
+	{
+		if (ControlLength > *Length)
+		  ControlLength = *Length;
+
+		memcpy(Data, ControlData, ControlLength);
+		*Length = ControlLength;
+	}
+
+	return !(SetupPending) && (Stalls == Mock_ControlStalls);
+}
+
+
+/** Queue data for the Beagle to send down the USART, one byte every MOCK_CYCLES_PER_SERIAL_BYTE. */
+void Mock_BeagleSend(const void* Data, const uint16_t Length)
+{
+	if (!(FIFO_Count(&BeagleTx)) && (NextBeagleByte < Mock_Cycles))
+	  NextBeagleByte = Mock_Cycles;
+
+	for (uint16_t i = 0; i < Length; i++)
+	  FIFO_Put(&BeagleTx, ((const uint8_t*)Data)[i]);
+}
+
+
+/** Take data the Beagle has received from the USART, returning how many bytes were taken. */
+uint32_t Mock_BeagleReceive(void* Buffer, const uint32_t Length)
+{
+	uint32_t Count = 0;
+
+	while ((Count < Length) && FIFO_Count(&BeagleRx))
+	  ((uint8_t*)Buffer)[Count++] = FIFO_Get(&BeagleRx);
+
+	return Count;
+}
+
+
+/** Returns the text on one line of the (simulated) LCD framebuffer. */
+const char* Mock_LCDLine(const uint8_t Line)
+{
+	return LCDLines[Line];
+}
+
+
+/** Print the number of calls and the worst case and average durations of each ISR fired. */
+void Mock_ReportISRs(void)
+{
+	printf("ISR durations (estimated cycles at %lu MHz):\n", (unsigned long)(F_CPU / 1000000));
+
+	for (uint8_t i = 0; (i < MOCK_MAX_ISRS) && ISRStats[i].Vector; i++)
+	{
+		printf("  %-14s calls %8u  max %5u  avg %5u\n", ISRStats[i].Name, ISRStats[i].Calls,
+		       ISRStats[i].MaxCycles, (uint32_t)(ISRStats[i].TotalCycles / ISRStats[i].Calls));
+	}
+}
+
+
+/* AVR library stand-ins: */
+
+void Mock_WatchdogReset(void)
+{
+	Mock_Yield();
+}
+
+void Mock_WatchdogEnable(int Timeout)
+{
+	// the firmware only sets a short timeout to reset itself, after which it spins
+	if (Timeout == WDTO_15MS)
+	{
+		Mock_ResetRequested = true;
+
+		for (;;)
+		  Mock_Yield();
+	}
+}
+
+void Mock_SleepCPU(void)
+{
+	uint64_t Wake = UINT64_MAX;
+
+	Mock_SleepCount++;
+
+	if (Endpoint_GetEndpointInterrupts())
+	  Wake = Mock_Cycles;
+	if (TIMSK0 & (1 << OCIE0A))
+	  Wake = (NextTimer0 < Wake) ? NextTimer0 : Wake;
+	if ((UCSR1B & (1 << RXCIE1)) && FIFO_Count(&BeagleTx))
+	  Wake = (NextBeagleByte < Wake) ? NextBeagleByte : Wake;
+	if (UCSR1B & (1 << UDRIE1))
+	  Wake = (SerialFreeAt < Wake) ? SerialFreeAt : Wake;
+
+	// with no wake up source, the AVR would sleep forever; just let the harness carry on
+	if (Wake == UINT64_MAX)
+	  return;
+
+	if (Wake > Mock_Cycles)
+	  Mock_Cycles = Wake;
+
+	Mock_Advance();
+}
+
+int Mock_EEPROMIsReady(void)
+{
+	return (Mock_Cycles >= EEPROMFreeAt);
+}
+
+uint8_t eeprom_read_byte(const uint8_t* Address)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+	return *Address;
+}
+
+void eeprom_write_byte(uint8_t* Address, uint8_t Value)
+{
+	// the real thing waits for the previous write to finish
+	if (Mock_Cycles < EEPROMFreeAt)
+	  Mock_Cycles = EEPROMFreeAt;
+
+	*Address     = Value;
+	EEPROMFreeAt = Mock_Cycles + MOCK_EEPROM_CYCLES;
+	Mock_EEPROMWrites++;
+}
+
+void eeprom_read_block(void* Destination, const void* Source, size_t Length)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS * Length;
+	memcpy(Destination, Source, Length);
+}
+
+
+/* C library stand-ins, to charge for the time they would take on the AVR: */
+
+int Mock_vsnprintf(char* String, size_t Size, const char* Format, va_list Arguments)
+{
+	int Length = vsnprintf(String, Size, Format, Arguments);
+
+	// avr-libc's vfprintf costs roughly this much per character of output
+	Mock_Cycles += 200 + (40 * (uint32_t)Length);
+	return Length;
+}
+
+int Mock_strncmp(const char* String1, const char* String2, size_t Length)
+{
+	size_t i;
+
+	for (i = 0; (i < Length) && String1[i] && (String1[i] == String2[i]); i++);
+
+	Mock_Cycles += 4 * (i + 1);
+	return (i == Length) ? 0 : ((unsigned char)String1[i] - (unsigned char)String2[i]);
+}
+
+
+/* USART driver stand-ins: */
+
+void Serial_Init(const uint32_t BaudRate, const bool DoubleSpeed)
+{
+	UCSR1B = ((1 << 4) | (1 << 3)); // RXEN1 | TXEN1
+}
+
+void Serial_TxByte(const char DataByte)
+{
+	// busy wait for the data register, which lets interrupts in
+	while (Mock_Cycles < SerialFreeAt)
+	{
+		Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+		Mock_Advance();
+	}
+
+	FIFO_Put(&BeagleRx, DataByte);
+	SerialFreeAt = Mock_Cycles + MOCK_CYCLES_PER_SERIAL_BYTE;
+	UCSR1A &= ~(1 << UDRE1);
+}
+
+
+/* LCD driver stand-ins, keeping the framebuffer as text: */
+
+void lcd_init(uint8_t dispAttr)
+{
+}
+
+void lcd_fb_clear(void)
+{
+	memset(LCDLines, 0, sizeof(LCDLines));
+}
+
+void lcd_fb_puts_line(uint8_t y, const char* s)
+{
+	strncpy(LCDLines[y], s, LCD_DISP_LENGTH);
+	LCDLines[y][strcspn(LCDLines[y], "\n")] = '\0';
+}
+
+void lcd_fb_scroll(void)
+{
+	for (uint8_t y = 1; y < LCD_LINES; y++)
+	  memcpy(LCDLines[y - 1], LCDLines[y], sizeof(LCDLines[y]));
+
+	memset(LCDLines[LCD_LINES - 1], 0, sizeof(LCDLines[0]));
+}
+
+uint8_t lcd_fb_refresh(void)
+{
+	return 0;
+}
+
+
+/* USB driver stand-ins: */
+
+void USB_Init(void)
+{
+	USB_DeviceState = DEVICE_STATE_Unattached;
+	sei();
+}
+
+/** Process a control request from the host, as the library's device task does for the requests it
+ *  doesn't handle itself. A request the firmware leaves unacknowledged is stalled.
+ */
+void USB_USBTask(void)
+{
+	if (!(SetupPending))
+	  return;
+
+	uint8_t PrevSelectedEndpoint = UENUM;
+
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+	EVENT_USB_Device_UnhandledControlRequest();
+
+	if (Endpoint_IsSETUPReceived())
+	{
+		Endpoint_StallTransaction();
+		Endpoint_ClearSETUP();
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+
+void Endpoint_SelectEndpoint(const uint8_t EndpointNumber)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+	UENUM = EndpointNumber;
+}
+
+uint8_t Endpoint_GetCurrentEndpoint(void)
+{
+	return UENUM;
+}
+
+void Endpoint_SetCallback(const uint8_t EndpointNumber, const EndpointCallbackPtr_t Callback)
+{
+	EndpointCallbacks[EndpointNumber] = Callback;
+}
+
+/** The library's USB_COM ISR, as built with INTERRUPT_DATA_ENDPOINTS: runs the callback of each endpoint
+ *  which has interrupted, or disarms the endpoint if it has none.
+ */
+ISR(USB_COM_vect, ISR_BLOCK)
+{
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	uint8_t EndpointInterrupts   = Endpoint_GetEndpointInterrupts();
+
+	for (uint8_t EPNum = 0; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++)
+	{
+		if (!(EndpointInterrupts & (1 << EPNum)))
+		  continue;
+
+		Endpoint_SelectEndpoint(EPNum);
+
+		if (EndpointCallbacks[EPNum] != NULL)
+		  EndpointCallbacks[EPNum]();
+		else
+		  Endpoint_DisarmCallback();
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+
+uint8_t Endpoint_GetEndpointInterrupts(void)
+{
+	uint8_t Interrupts = 0;
+
+	for (uint8_t EPNum = 0; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++)
+	{
+		Mock_Endpoint_t* Endpoint = &Endpoints[EPNum];
+		uint8_t          Enabled  = Mock_EndpointIEN[EPNum];
+
+		if (((Enabled & (1 << RXSTPE)) && (EPNum == ENDPOINT_CONTROLEP) && SetupPending)
+		 || ((Enabled & (1 << RXOUTE)) && (Endpoint->Direction == ENDPOINT_DIR_OUT) && Mock_OUTAvailable(Endpoint))
+		 || ((Enabled & (1 << TXINE))  && (Endpoint->Direction == ENDPOINT_DIR_IN)  && !(Endpoint->BankFull)))
+		{
+			Interrupts |= (1 << EPNum);
+		}
+	}
+
+	return Interrupts;
+}
+
+bool Endpoint_ConfigureEndpoint(const uint8_t Number, const uint8_t Type, const uint8_t Direction,
+                                const uint16_t Size, const uint8_t Banks)
+{
+	if ((Number >= ENDPOINT_TOTAL_ENDPOINTS) || (Size > MOCK_MAX_EPSIZE))
+	  return false;
+
+	Endpoints[Number].Configured = true;
+	Endpoints[Number].Direction  = Direction;
+	Endpoints[Number].Size       = Size;
+	return true;
+}
+
+uint16_t Endpoint_BytesInEndpoint(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Endpoint->Direction == ENDPOINT_DIR_OUT)
+	  return Endpoint->BankLength - Endpoint->BankPosition;
+	else
+	  return Endpoint->BankLength;
+}
+
+bool Endpoint_IsReadWriteAllowed(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Endpoint->Direction == ENDPOINT_DIR_OUT)
+	  return (Endpoint->BankPosition < Endpoint->BankLength);
+	else
+	  return !(Endpoint->BankFull) && (Endpoint->BankLength < Endpoint->Size);
+}
+
+bool Endpoint_IsINReady(void)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+	return !(Endpoints[UENUM].BankFull);
+}
+
+/** The host sends its next packet as soon as the bank is free, so this is where OUT packets arrive. */
+bool Endpoint_IsOUTReceived(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (!(Endpoint->BankFull) && FIFO_Count(&Endpoint->Host))
+	{
+		Endpoint->BankLength   = 0;
+		Endpoint->BankPosition = 0;
+
+		while ((Endpoint->BankLength < Endpoint->Size) && FIFO_Count(&Endpoint->Host))
+		  Endpoint->Bank[Endpoint->BankLength++] = FIFO_Get(&Endpoint->Host);
+
+		Endpoint->BankFull = true;
+	}
+
+	return Endpoint->BankFull;
+}
+
+bool Endpoint_IsSETUPReceived(void)
+{
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+	return (UENUM == ENDPOINT_CONTROLEP) && SetupPending;
+}
+
+void Endpoint_ClearSETUP(void)
+{
+	SetupPending = false;
+}
+
+void Endpoint_ClearIN(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if ((UENUM == ENDPOINT_CONTROLEP) || Endpoint->BankFull)
+	  return;
+
+	if (Endpoint->HostPaused)
+	{
+		Endpoint->BankFull = true;
+		return;
+	}
+
+	for (uint16_t i = 0; i < Endpoint->BankLength; i++)
+	  FIFO_Put(&Endpoint->Host, Endpoint->Bank[i]);
+
+	Endpoint->BankLength = 0;
+}
+
+void Endpoint_ClearOUT(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (UENUM == ENDPOINT_CONTROLEP)
+	  return;
+
+	Endpoint->BankFull     = false;
+	Endpoint->BankLength   = 0;
+	Endpoint->BankPosition = 0;
+}
+
+void Endpoint_ClearStatusStage(void)
+{
+}
+
+void Endpoint_StallTransaction(void)
+{
+	Mock_ControlStalls++;
+}
+
+uint8_t Endpoint_Read_Byte(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+	return Endpoint->Bank[Endpoint->BankPosition++];
+}
+
+void Endpoint_Write_Byte(const uint8_t Byte)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Endpoint->BankLength < MOCK_MAX_EPSIZE)
+	  Endpoint->Bank[Endpoint->BankLength++] = Byte;
+}
+
+/** The real driver polls for up to USB_STREAM_TIMEOUT_MS; here the host has either collected the
+ *  packet already or (if paused) isn't going to.
+ */
+uint8_t Endpoint_WaitUntilReady(void)
+{
+	Mock_Endpoint_t* Endpoint = &Endpoints[UENUM];
+
+	if (Endpoint->Direction == ENDPOINT_DIR_IN)
+	  return (Endpoint->BankFull) ? ENDPOINT_READYWAIT_Timeout : ENDPOINT_READYWAIT_NoError;
+	else
+	  return (Endpoint_IsOUTReceived()) ? ENDPOINT_READYWAIT_NoError : ENDPOINT_READYWAIT_Timeout;
+}
+
+uint8_t Endpoint_Write_Control_Stream_LE(const void* Buffer, uint16_t Length)
+{
+	if (Length > USB_ControlRequest.wLength)
+	  Length = USB_ControlRequest.wLength;
+	if (Length > MOCK_MAX_CONTROL)
+	  Length = MOCK_MAX_CONTROL;
+
+	memcpy(ControlData, Buffer, Length);
+	ControlLength = Length;
+	Mock_Cycles  += MOCK_CYCLES_PER_ACCESS * Length;
+	return ENDPOINT_READYWAIT_NoError;
+}
+
+uint8_t Endpoint_Read_Control_Stream_LE(void* Buffer, uint16_t Length)
+{
+	if (Length > ControlLength)
+	  Length = ControlLength;
+
+	memcpy(Buffer, ControlData, Length);
+	Mock_Cycles += MOCK_CYCLES_PER_ACCESS * Length;
+	return ENDPOINT_READYWAIT_NoError;
+}
@@ -0,0 +1,67 @@
+/** \file
+ *
+ *  Header file for Mock.c.
+ *
+ *  Mock.c stands in for the AVR and the LUFA library, so that the USBtoSerial firmware can be built
+ *  and run on a Linux host. The firmware runs in a context of its own, and each pass of its main loop
+ *  (which ends at wdt_reset()) hands control back to the harness. Time is kept as a count of AVR
+ *  cycles: each basic block of firmware code executed is charged an estimated cost, as is each
+ *  mocked hardware access, and sleeping skips ahead to the next interrupt. The USART runs at its
+ *  real byte rate and Timer0 ticks from the same clock, so throughput figures are comparable to the
+ *  board, if not exact.
+ */
+
+#ifndef _MOCK_H_
+#define _MOCK_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Macros: */
+		/** Estimated AVR cycles for each basic block of firmware code executed. */
+		#define MOCK_CYCLES_PER_BLOCK     6
+
+		/** Estimated AVR cycles for each mocked hardware access (the LUFA endpoint macros, etc). */
+		#define MOCK_CYCLES_PER_ACCESS    2
+
+		/** Estimated AVR cycles to enter and leave an ISR which calls other functions (vector jump,
+		 *  saving and restoring the call-clobbered registers, and reti).
+		 */
+		#define MOCK_CYCLES_PER_ISR       60
+
+		/** AVR cycles to send or receive one byte on the USART (10 bits at 115200 baud). */
+		#define MOCK_CYCLES_PER_SERIAL_BYTE  ((uint32_t)(F_CPU * 10 / 115200))
+
+		/** Bytes each host or Beagle side FIFO can hold. Must be a power of two. */
+		#define MOCK_FIFO_SIZE            65536
+
+	/* External Variables: */
+		extern bool     Mock_ResetRequested;
+		extern uint32_t Mock_SleepCount;
+		extern uint32_t Mock_EEPROMWrites;
+		extern uint32_t Mock_ControlStalls;
+
+	/* Function Prototypes: */
+		void        Mock_Start(void);
+		void        Mock_RunLoop(const uint32_t Passes);
+		void        Mock_RunFor(const uint64_t Cycles);
+
+		void        Mock_HostConnect(void);
+		void        Mock_HostSend(const uint8_t EPNum, const void* Data, const uint16_t Length);
+		uint32_t    Mock_HostReceive(const uint8_t EPNum, void* Buffer, const uint32_t Length);
+		uint32_t    Mock_HostPending(const uint8_t EPNum);
+		void        Mock_HostPauseIN(const uint8_t EPNum, const bool Paused);
+		bool        Mock_HostControl(const USB_Request_Header_t* const Request, void* const Data,
+		                             uint16_t* const Length);
+
+		void        Mock_BeagleSend(const void* Data, const uint16_t Length);
+		uint32_t    Mock_BeagleReceive(void* Buffer, const uint32_t Length);
+
+		const char* Mock_LCDLine(const uint8_t Line);
+
+		void        Mock_ReportISRs(void);
+
+#endif
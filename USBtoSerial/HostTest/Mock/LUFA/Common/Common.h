@@ -0,0 +1,23 @@
+/** \file
+ *
+ *  Host build stand-in for the LUFA common header.
+ */
+
+#ifndef _MOCK_LUFA_COMMON_H_
+#define _MOCK_LUFA_COMMON_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <stdio.h>
+
+	/* Macros: */
+		#define MACROS                    do
+		#define MACROE                    while (0)
+
+		#define ATTR_WARN_UNUSED_RESULT   __attribute__ ((warn_unused_result))
+		#define ATTR_NON_NULL_PTR_ARG(...)  __attribute__ ((nonnull (__VA_ARGS__)))
+		#define ATTR_ALWAYS_INLINE        __attribute__ ((always_inline))
+		#define ATTR_PACKED               __attribute__ ((packed))
+
+#endif
@@ -0,0 +1,19 @@
+/** \file
+ *
+ *  Host build stand-in for the LUFA USART driver. Transmitted bytes are captured by Mock.c.
+ */
+
+#ifndef _MOCK_SERIAL_H_
+#define _MOCK_SERIAL_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Function Prototypes: */
+		void Serial_Init(const uint32_t BaudRate, const bool DoubleSpeed);
+		void Serial_TxByte(const char DataByte);
+
+	/* Macros: */
+		#define Serial_IsCharReceived()   ((UCSR1A & (1 << RXC1)) ? true : false)
+
+#endif
@@ -0,0 +1,58 @@
+/** \file
+ *
+ *  Host build stand-in for the LUFA Mass Storage class driver. Only the host mode parts used by the
+ *  recorder and the block cache are provided; RecorderTest.c and MSCacheTest.c implement them against
+ *  their simulated drives.
+ */
+
+#ifndef _MOCK_MASS_STORAGE_H_
+#define _MOCK_MASS_STORAGE_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <stddef.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		#define NO_STREAM_CALLBACK                NULL
+
+		#define MS_ERROR_LOGICAL_CMD_FAILED       0x80
+
+	/* Enums: */
+		enum Pipe_Stream_RW_ErrorCodes_t
+		{
+			PIPE_RWSTREAM_NoError            = 0,
+			PIPE_RWSTREAM_PipeStalled        = 1,
+			PIPE_RWSTREAM_DeviceDisconnected = 2,
+			PIPE_RWSTREAM_Timeout            = 3,
+			PIPE_RWSTREAM_CallbackAborted    = 4,
+		};
+
+	/* Type Defines: */
+		typedef struct
+		{
+			uint8_t MaxLUNIndex;
+		} USB_ClassInfo_MS_Host_t;
+
+		typedef bool (* const MS_BlockStreamCallbackPtr_t)(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+		                                                   const uint16_t BankBytes);
+
+	/* Function Prototypes: */
+		uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+		                                 const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
+		                                 void* BlockBuffer);
+		uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+		                                  const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
+		                                  void* BlockBuffer);
+		uint8_t MS_Host_ReadDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+		                                      const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+		                                      MS_BlockStreamCallbackPtr_t Callback);
+		uint8_t MS_Host_WriteDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+		                                       const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+		                                       MS_BlockStreamCallbackPtr_t Callback);
+		uint8_t Pipe_Read_Stream_LE(void* Buffer, uint16_t Length, void* Callback);
+		uint8_t Pipe_Write_Stream_LE(const void* Buffer, uint16_t Length, void* Callback);
+
+#endif
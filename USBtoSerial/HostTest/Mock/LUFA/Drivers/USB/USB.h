@@ -0,0 +1,216 @@
+/** \file
+ *
+ *  Host build stand-in for the LUFA USB driver. Only the parts used by the USBtoSerial firmware are
+ *  provided. Endpoints are simulated by Mock.c, which also exposes a "host side" API so the harness
+ *  can send and collect packets.
+ */
+
+#ifndef _MOCK_USB_H_
+#define _MOCK_USB_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <stddef.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		#define NO_DESCRIPTOR                     0
+		#define USE_INTERNAL_SERIAL               0xDC
+		#define FIXED_CONTROL_ENDPOINT_SIZE       8
+		#define FIXED_NUM_CONFIGURATIONS          1
+
+		#define VERSION_BCD(x)                    ((((int)(x) / 10) << 12) | (((int)(x) % 10) << 8) | \
+		                                           (((int)((x) * 10) % 10) << 4) | ((int)((x) * 100) % 10))
+		#define USB_CONFIG_POWER_MA(mA)           ((mA) >> 1)
+		#define USB_STRING_LEN(str)               (sizeof(USB_Descriptor_Header_t) + ((str) << 1))
+		#define LANGUAGE_ID_ENG                   0x0409
+
+		#define USB_CONFIG_ATTR_BUSPOWERED        0x80
+		#define USB_CONFIG_ATTR_SELFPOWERED       0x40
+
+		#define ENDPOINT_DESCRIPTOR_DIR_IN        0x80
+		#define ENDPOINT_DESCRIPTOR_DIR_OUT       0x00
+		#define ENDPOINT_ATTR_NO_SYNC             (0 << 2)
+		#define ENDPOINT_USAGE_DATA               (0 << 4)
+
+		#define EP_TYPE_CONTROL                   0x00
+		#define EP_TYPE_ISOCHRONOUS               0x01
+		#define EP_TYPE_BULK                      0x02
+		#define EP_TYPE_INTERRUPT                 0x03
+
+		#define ENDPOINT_DIR_OUT                  0x00
+		#define ENDPOINT_DIR_IN                   0x01
+		#define ENDPOINT_BANK_SINGLE              (0 << 2)
+		#define ENDPOINT_BANK_DOUBLE              (1 << 2)
+		#define ENDPOINT_CONTROLEP                0
+		#define ENDPOINT_TOTAL_ENDPOINTS          7
+
+		#define ENDPOINT_INT_SETUP                (1 << RXSTPE)
+		#define ENDPOINT_INT_IN                   (1 << TXINE)
+		#define ENDPOINT_INT_OUT                  (1 << RXOUTE)
+
+		#define Endpoint_ArmCallback(mask)        do { UEIENX |= (mask); } while (0)
+		#define Endpoint_DisarmCallback()         do { UEIENX &= ~(ENDPOINT_INT_SETUP | ENDPOINT_INT_IN | \
+		                                                           ENDPOINT_INT_OUT); } while (0)
+
+		#define REQDIR_HOSTTODEVICE               (0 << 7)
+		#define REQDIR_DEVICETOHOST               (1 << 7)
+		#define REQTYPE_STANDARD                  (0 << 5)
+		#define REQTYPE_CLASS                     (1 << 5)
+		#define REQTYPE_VENDOR                    (2 << 5)
+		#define CONTROL_REQTYPE_DIRECTION         0x80
+		#define CONTROL_REQTYPE_TYPE              0x60
+		#define CONTROL_REQTYPE_RECIPIENT         0x1F
+		#define REQREC_DEVICE                     (0 << 0)
+		#define REQREC_INTERFACE                  (1 << 0)
+		#define REQREC_ENDPOINT                   (2 << 0)
+
+	/* Type Defines: */
+		typedef struct
+		{
+			uint8_t  bmRequestType;
+			uint8_t  bRequest;
+			uint16_t wValue;
+			uint16_t wIndex;
+			uint16_t wLength;
+		} USB_Request_Header_t;
+
+		typedef struct
+		{
+			uint8_t Size;
+			uint8_t Type;
+		} USB_Descriptor_Header_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			uint16_t USBSpecification;
+			uint8_t  Class;
+			uint8_t  SubClass;
+			uint8_t  Protocol;
+			uint8_t  Endpoint0Size;
+			uint16_t VendorID;
+			uint16_t ProductID;
+			uint16_t ReleaseNumber;
+			uint8_t  ManufacturerStrIndex;
+			uint8_t  ProductStrIndex;
+			uint8_t  SerialNumStrIndex;
+			uint8_t  NumberOfConfigurations;
+		} USB_Descriptor_Device_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			uint16_t TotalConfigurationSize;
+			uint8_t  TotalInterfaces;
+			uint8_t  ConfigurationNumber;
+			uint8_t  ConfigurationStrIndex;
+			uint8_t  ConfigAttributes;
+			uint8_t  MaxPowerConsumption;
+		} USB_Descriptor_Configuration_Header_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			uint8_t InterfaceNumber;
+			uint8_t AlternateSetting;
+			uint8_t TotalEndpoints;
+			uint8_t Class;
+			uint8_t SubClass;
+			uint8_t Protocol;
+			uint8_t InterfaceStrIndex;
+		} USB_Descriptor_Interface_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			uint8_t FirstInterfaceIndex;
+			uint8_t TotalInterfaces;
+			uint8_t Class;
+			uint8_t SubClass;
+			uint8_t Protocol;
+			uint8_t IADStrIndex;
+		} USB_Descriptor_Interface_Association_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			uint8_t  EndpointAddress;
+			uint8_t  Attributes;
+			uint16_t EndpointSize;
+			uint8_t  PollingIntervalMS;
+		} USB_Descriptor_Endpoint_t;
+
+		typedef struct
+		{
+			USB_Descriptor_Header_t Header;
+			wchar_t UnicodeString[];
+		} USB_Descriptor_String_t;
+
+	/* Enums: */
+		enum USB_DescriptorTypes_t
+		{
+			DTYPE_Device               = 0x01,
+			DTYPE_Configuration        = 0x02,
+			DTYPE_String               = 0x03,
+			DTYPE_Interface            = 0x04,
+			DTYPE_Endpoint             = 0x05,
+			DTYPE_InterfaceAssociation = 0x0B,
+		};
+
+		enum USB_Device_States_t
+		{
+			DEVICE_STATE_Unattached = 0,
+			DEVICE_STATE_Powered    = 1,
+			DEVICE_STATE_Default    = 2,
+			DEVICE_STATE_Addressed  = 3,
+			DEVICE_STATE_Configured = 4,
+			DEVICE_STATE_Suspended  = 5,
+		};
+
+		enum Endpoint_WaitUntilReady_ErrorCodes_t
+		{
+			ENDPOINT_READYWAIT_NoError     = 0,
+			ENDPOINT_READYWAIT_EndpointStalled = 1,
+			ENDPOINT_READYWAIT_DeviceDisconnected = 2,
+			ENDPOINT_READYWAIT_Timeout     = 3,
+		};
+
+	/* Type Defines: */
+		typedef void (*EndpointCallbackPtr_t)(void);
+
+	/* External Variables: */
+		extern volatile uint8_t      USB_DeviceState;
+		extern USB_Request_Header_t  USB_ControlRequest;
+
+	/* Function Prototypes: */
+		void     USB_Init(void);
+		void     USB_USBTask(void);
+
+		void     Endpoint_SelectEndpoint(const uint8_t EndpointNumber);
+		uint8_t  Endpoint_GetCurrentEndpoint(void);
+		uint8_t  Endpoint_GetEndpointInterrupts(void);
+		void     Endpoint_SetCallback(const uint8_t EndpointNumber, const EndpointCallbackPtr_t Callback);
+		bool     Endpoint_ConfigureEndpoint(const uint8_t Number, const uint8_t Type, const uint8_t Direction,
+		                                    const uint16_t Size, const uint8_t Banks);
+		uint16_t Endpoint_BytesInEndpoint(void);
+		bool     Endpoint_IsReadWriteAllowed(void);
+		bool     Endpoint_IsINReady(void);
+		bool     Endpoint_IsOUTReceived(void);
+		bool     Endpoint_IsSETUPReceived(void);
+		void     Endpoint_ClearSETUP(void);
+		void     Endpoint_ClearIN(void);
+		void     Endpoint_ClearOUT(void);
+		void     Endpoint_ClearStatusStage(void);
+		void     Endpoint_StallTransaction(void);
+		uint8_t  Endpoint_Read_Byte(void);
+		void     Endpoint_Write_Byte(const uint8_t Byte);
+		uint8_t  Endpoint_WaitUntilReady(void);
+		uint8_t  Endpoint_Write_Control_Stream_LE(const void* Buffer, uint16_t Length);
+		uint8_t  Endpoint_Read_Control_Stream_LE(void* Buffer, uint16_t Length);
+
+		uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue, const uint8_t wIndex, void** const DescriptorAddress);
+
+#endif
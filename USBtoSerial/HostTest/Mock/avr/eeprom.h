@@ -0,0 +1,24 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/eeprom.h>. EEMEM variables live in ordinary memory; writes are
+ *  counted per byte by Mock.c so the harness can check wear levelling.
+ */
+
+#ifndef _MOCK_AVR_EEPROM_H_
+#define _MOCK_AVR_EEPROM_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stddef.h>
+
+	/* Macros: */
+		#define EEMEM
+		#define eeprom_is_ready()    Mock_EEPROMIsReady()
+
+	/* Function Prototypes: */
+		int     Mock_EEPROMIsReady(void);
+		uint8_t eeprom_read_byte(const uint8_t* Address);
+		void    eeprom_write_byte(uint8_t* Address, uint8_t Value);
+		void    eeprom_read_block(void* Destination, const void* Source, size_t Length);
+
+#endif
@@ -0,0 +1,32 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/interrupt.h>. ISRs become ordinary functions named after their
+ *  vectors, so the harness can "fire" an interrupt by calling it.
+ */
+
+#ifndef _MOCK_AVR_INTERRUPT_H_
+#define _MOCK_AVR_INTERRUPT_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Macros: */
+		#define ISR_BLOCK
+		#define ISR_NOBLOCK
+		#define ISR(vector, ...)     void vector(void); void vector(void)
+
+		#define sei()                MACROS{ SREG |=  0x80; }MACROE
+		#define cli()                MACROS{ SREG &= ~0x80; }MACROE
+
+		#define MACROS               do
+		#define MACROE               while (0)
+
+	/* Function Prototypes: */
+		void TIMER0_COMPA_vect(void);
+		void TIMER1_COMPA_vect(void);
+		void TIMER3_COMPA_vect(void);
+		void USART1_RX_vect(void);
+		void USART1_UDRE_vect(void);
+		void USB_COM_vect(void);
+
+#endif
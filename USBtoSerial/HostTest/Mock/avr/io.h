@@ -0,0 +1,80 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/io.h>. The registers used by the firmware are plain
+ *  variables, defined in Mock.c, so the harness can inspect and drive them.
+ */
+
+#ifndef _MOCK_AVR_IO_H_
+#define _MOCK_AVR_IO_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+
+	/* Macros: */
+		#define _BV(bit)        (1 << (bit))
+
+		/* USART1 */
+		#define RXCIE1          7
+		#define TXCIE1          6
+		#define UDRIE1          5
+		#define RXC1            7
+		#define UDRE1           5
+
+		/* Timers */
+		#define WGM01           1
+		#define CS00            0
+		#define CS01            1
+		#define CS02            2
+		#define OCIE0A          1
+		#define WGM12           3
+		#define CS10            0
+		#define CS11            1
+		#define CS12            2
+		#define OCIE1A          1
+		#define WGM32           3
+		#define CS30            0
+		#define CS31            1
+		#define CS32            2
+		#define OCIE3A          1
+
+		/* Reset flags */
+		#define PORF            0
+		#define EXTRF           1
+		#define BORF            2
+		#define WDRF            3
+		#define JTRF            4
+
+		/* EEPROM */
+		#define EEPE            1
+
+		/* USB endpoint interrupts */
+		#define TXINE           0
+		#define RXOUTE          2
+		#define RXSTPE          3
+
+		#define E2END           0x0FFF
+
+	/* External Variables: */
+		extern volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+		extern volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF;
+		extern volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF;
+		extern volatile uint8_t UCSR1A, UCSR1B, UCSR1C, UDR1;
+		extern volatile uint8_t MCUSR, SREG, EECR;
+		extern volatile uint8_t TCCR0A, TCCR0B, OCR0A, TIMSK0, TCNT0;
+		extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+		extern volatile uint16_t OCR1A;
+		extern volatile uint8_t TCCR3A, TCCR3B, TIMSK3;
+		extern volatile uint16_t OCR3A, TCNT3;
+		extern volatile uint8_t UENUM;
+		extern volatile uint8_t Mock_EndpointIEN[];
+		extern uint64_t Mock_Cycles;
+
+	/* Macros: */
+		/** Each endpoint has its own interrupt enable register, selected by UENUM. */
+		#define UEIENX          Mock_EndpointIEN[UENUM]
+
+		/** Timer1 free runs at F_CPU/8 from the simulated clock, as set up by MEASURE_WAKE_LATENCY. */
+		#define TCNT1           ((uint16_t)(Mock_Cycles >> 3))
+
+#endif
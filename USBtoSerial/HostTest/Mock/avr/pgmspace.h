@@ -0,0 +1,17 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/pgmspace.h>. There is only one address space on the host.
+ */
+
+#ifndef _MOCK_AVR_PGMSPACE_H_
+#define _MOCK_AVR_PGMSPACE_H_
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Macros: */
+		#define PROGMEM
+		#define PSTR(s)              (s)
+		#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+
+#endif
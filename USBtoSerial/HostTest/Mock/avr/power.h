@@ -0,0 +1,13 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/power.h>.
+ */
+
+#ifndef _MOCK_AVR_POWER_H_
+#define _MOCK_AVR_POWER_H_
+
+	/* Macros: */
+		#define clock_div_1               0
+		#define clock_prescale_set(div)   ((void)(div))
+
+#endif
@@ -0,0 +1,24 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/sleep.h>. Sleeping just records that the firmware tried to, so the
+ *  harness can check that the main loop only idles when there is no work pending.
+ */
+
+#ifndef _MOCK_AVR_SLEEP_H_
+#define _MOCK_AVR_SLEEP_H_
+
+	/* Includes: */
+		#include <avr/interrupt.h>
+
+	/* Macros: */
+		#define SLEEP_MODE_IDLE      0
+
+		#define set_sleep_mode(mode) MACROS{ (void)(mode); }MACROE
+		#define sleep_enable()       MACROS{ }MACROE
+		#define sleep_disable()      MACROS{ }MACROE
+		#define sleep_cpu()          Mock_SleepCPU()
+
+	/* Function Prototypes: */
+		void Mock_SleepCPU(void);
+
+#endif
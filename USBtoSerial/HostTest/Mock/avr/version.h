@@ -0,0 +1,12 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/version.h>, for the LUFA library sources built by the harnesses.
+ */
+
+#ifndef _MOCK_AVR_VERSION_H_
+#define _MOCK_AVR_VERSION_H_
+
+	/* Macros: */
+		#define __AVR_LIBC_VERSION__    10604UL
+
+#endif
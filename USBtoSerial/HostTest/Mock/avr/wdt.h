@@ -0,0 +1,20 @@
+/** \file
+ *
+ *  Host build stand-in for <avr/wdt.h>.
+ */
+
+#ifndef _MOCK_AVR_WDT_H_
+#define _MOCK_AVR_WDT_H_
+
+	/* Macros: */
+		#define WDTO_15MS            0
+		#define WDTO_8S              9
+
+		#define wdt_reset()          Mock_WatchdogReset()
+		#define wdt_enable(timeout)  Mock_WatchdogEnable(timeout)
+
+	/* Function Prototypes: */
+		void Mock_WatchdogReset(void);
+		void Mock_WatchdogEnable(int Timeout);
+
+#endif
@@ -0,0 +1,15 @@
+/** \file
+ *
+ *  Host build stand-in for <util/atomic.h>. The harness is single threaded and only "fires"
+ *  interrupts between calls, so atomic blocks need no protection.
+ */
+
+#ifndef _MOCK_UTIL_ATOMIC_H_
+#define _MOCK_UTIL_ATOMIC_H_
+
+	/* Macros: */
+		#define ATOMIC_RESTORESTATE
+		#define ATOMIC_FORCEON
+		#define ATOMIC_BLOCK(type)   for (int _Atomic_Once = 1; _Atomic_Once; _Atomic_Once = 0)
+
+#endif
@@ -0,0 +1,21 @@
+/** \file
+ *
+ *  Host build stand-in for <util/crc16.h>, using the reference C code from the avr-libc manual.
+ */
+
+#ifndef _MOCK_UTIL_CRC16_H_
+#define _MOCK_UTIL_CRC16_H_
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Inline Functions: */
+		static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+		{
+			data ^= (crc & 0xFF);
+			data ^= data << 4;
+
+			return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+		}
+
+#endif
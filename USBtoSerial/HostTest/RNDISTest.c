@@ -0,0 +1,619 @@
+/** \file
+ *
+ *  Host test for the data path of the LUFA RNDIS device class driver (RNDIS.c). The driver is built
+ *  against simulated data endpoints, and a mock host sends packet messages to the OUT endpoint and
+ *  collects the transfers written to the IN endpoint, split into 64 byte packets as on the bus.
+ *
+ *  The receive tests check that several packet messages in one transfer are each streamed into their
+ *  own lent buffer, and that malformed or oversized packet message headers stall the endpoint rather
+ *  than being read. The send tests check that queued frames are batched into one transfer with each
+ *  message but the last padded to the RNDIS_PACKET_ALIGNMENT_FACTOR alignment, and that a transfer
+ *  ending on a packet boundary is ended with a zero length packet, which is left for a later pass of
+ *  the driver's task if the host hasn't yet freed a bank for it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <LUFA/Common/Common.h>
+#include <avr/pgmspace.h>
+
+/** Bytes in each packet of the data endpoints. */
+#define ENDPOINT_BANK_SIZE      64
+
+/** Banks in the IN endpoint. */
+#define IN_BANKS                2
+
+/** Packets the mock host can have waiting to be sent to the OUT endpoint. */
+#define HOST_QUEUE_SIZE         256
+
+/** Endpoint numbers given to the driver. */
+#define DATA_IN_EPNUM           1
+#define DATA_OUT_EPNUM          2
+#define NOTIFICATION_EPNUM      3
+
+/** Size of the frame buffers lent to the driver. */
+#define FRAME_BUFFER_SIZE       ETHERNET_FRAME_SIZE_MAX
+
+/** Transfers kept of those collected by the mock host. */
+#define MAX_TRANSFERS           8
+
+/** Frames queued or lent at once, and packet messages batched into each transfer. */
+#define RNDIS_FRAME_QUEUE_DEPTH        4
+#define RNDIS_MAX_PACKETS_PER_TRANSFER 4
+
+
+/* Stand-ins for the parts of the LUFA USB driver used by RNDIS.c. Its includes of the USB driver headers
+   are skipped by defining their include guards. */
+#define __USBMODE_H__
+#define __USB_H__
+#define USB_CAN_BE_DEVICE
+
+#define NO_STREAM_CALLBACK                  NULL
+
+#define REQDIR_HOSTTODEVICE                 (0 << 7)
+#define REQDIR_DEVICETOHOST                 (1 << 7)
+#define REQTYPE_CLASS                       (1 << 5)
+#define REQREC_INTERFACE                    (1 << 0)
+
+#define EP_TYPE_BULK                        0x02
+#define EP_TYPE_INTERRUPT                   0x03
+#define ENDPOINT_DIR_OUT                    0x00
+#define ENDPOINT_DIR_IN                     0x01
+#define ENDPOINT_BANK_SINGLE                0x00
+#define ENDPOINT_BANK_DOUBLE                0x04
+
+#define memcpy_P(Dest, Src, Size)           memcpy(Dest, Src, Size)
+
+enum Endpoint_WaitUntilReady_ErrorCodes_t
+{
+	ENDPOINT_READYWAIT_NoError = 0,
+	ENDPOINT_READYWAIT_Timeout = 3,
+};
+
+enum Endpoint_Stream_RW_ErrorCodes_t
+{
+	ENDPOINT_RWSTREAM_NoError = 0,
+	ENDPOINT_RWSTREAM_Timeout = 3,
+};
+
+enum USB_Device_States_t
+{
+	DEVICE_STATE_Unattached = 0,
+	DEVICE_STATE_Configured = 4,
+};
+
+typedef struct
+{
+	uint8_t  bmRequestType;
+	uint8_t  bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} USB_Request_Header_t;
+
+static uint8_t              USB_DeviceState = DEVICE_STATE_Configured;
+static USB_Request_Header_t USB_ControlRequest;
+
+#define INCLUDE_FROM_RNDIS_CLASS_DEVICE_C
+#include <LUFA/Drivers/USB/Class/Device/RNDIS.h>
+
+
+/** Packet held in an endpoint bank or queued by the mock host. */
+typedef struct
+{
+	uint8_t  Data[ENDPOINT_BANK_SIZE];
+	uint16_t Length;
+	uint16_t Position; /**< Next byte for the driver to read, for OUT packets */
+} Packet_t;
+
+/** Transfer collected from the IN endpoint by the mock host. */
+typedef struct
+{
+	uint8_t  Data[RNDIS_FRAME_QUEUE_DEPTH * (sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX + 4)];
+	uint32_t Length;
+	uint32_t Packets;
+} Transfer_t;
+
+/** State of the simulated endpoints, and of the mock host on the far end of the bus. */
+static struct
+{
+	uint8_t    Selected;
+	bool       Stalled; /**< Set if the driver stalled the OUT endpoint */
+
+	Packet_t   OUTQueue[HOST_QUEUE_SIZE]; /**< Packets sent by the host, oldest first; the first is in the OUT bank */
+	uint16_t   OUTFirst;
+	uint16_t   OUTQueued;
+
+	Packet_t   INBank; /**< Bank the driver is filling */
+	Packet_t   INHanded[IN_BANKS]; /**< Banks handed to the host and not yet collected, oldest first */
+	uint8_t    INHandedCount;
+
+	bool       HostPaused; /**< Set to stop the host collecting IN packets */
+	uint32_t   INWaits; /**< Times the driver waited for an IN bank while the host was paused */
+
+	Transfer_t Current; /**< Transfer the host is collecting */
+	Transfer_t Transfers[MAX_TRANSFERS]; /**< Transfers collected in full, each ended by a short packet */
+	uint8_t    TransferCount;
+} Endpoints;
+
+static int Failures = 0;
+
+
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+/** Byte of the test pattern at a given offset of a frame. */
+static uint8_t Pattern(const uint8_t Frame, const uint32_t Offset)
+{
+	return (uint8_t)((Offset * 7) ^ (Offset >> 8) ^ (Frame << 4));
+}
+
+
+/** Collect the packets handed to the host from the IN endpoint, ending a transfer at each short packet. */
+static void Host_Collect(void)
+{
+	for (uint8_t PacketIndex = 0; PacketIndex < Endpoints.INHandedCount; PacketIndex++)
+	{
+		Packet_t*   Packet  = &Endpoints.INHanded[PacketIndex];
+		Transfer_t* Current = &Endpoints.Current;
+
+		memcpy(&Current->Data[Current->Length], Packet->Data, Packet->Length);
+		Current->Length += Packet->Length;
+		Current->Packets++;
+
+		if (Packet->Length < ENDPOINT_BANK_SIZE)
+		{
+			if (Endpoints.TransferCount < MAX_TRANSFERS)
+			  Endpoints.Transfers[Endpoints.TransferCount++] = *Current;
+
+			Current->Length  = 0;
+			Current->Packets = 0;
+		}
+	}
+
+	Endpoints.INHandedCount = 0;
+}
+
+/** Queue a transfer for the host to send to the OUT endpoint, split into packets. A transfer filling its last
+ *  packet is ended with a zero length packet.
+ */
+static void Host_SendTransfer(const uint8_t* Data, const uint32_t Length)
+{
+	uint32_t Sent = 0;
+
+	do
+	{
+		Packet_t* Packet      = &Endpoints.OUTQueue[(Endpoints.OUTFirst + Endpoints.OUTQueued) % HOST_QUEUE_SIZE];
+		uint32_t  PacketBytes = ((Length - Sent) < ENDPOINT_BANK_SIZE) ? (Length - Sent) : ENDPOINT_BANK_SIZE;
+
+		if (Endpoints.OUTQueued == HOST_QUEUE_SIZE)
+		  abort();
+
+		memcpy(Packet->Data, &Data[Sent], PacketBytes);
+		Packet->Length   = PacketBytes;
+		Packet->Position = 0;
+		Endpoints.OUTQueued++;
+
+		Sent += PacketBytes;
+
+		if (PacketBytes < ENDPOINT_BANK_SIZE)
+		  break;
+	}
+	while (true);
+}
+
+static bool Endpoint_IsINReady(void)
+{
+	return ((Endpoints.Selected == DATA_IN_EPNUM) && (Endpoints.INHandedCount < IN_BANKS)) ||
+	       (Endpoints.Selected == NOTIFICATION_EPNUM);
+}
+
+static bool Endpoint_IsOUTReceived(void)
+{
+	return ((Endpoints.Selected == DATA_OUT_EPNUM) && Endpoints.OUTQueued);
+}
+
+static uint16_t Endpoint_BytesInEndpoint(void)
+{
+	if (Endpoints.Selected == DATA_IN_EPNUM)
+	  return Endpoints.INBank.Length;
+
+	if (!(Endpoint_IsOUTReceived()))
+	  return 0;
+
+	Packet_t* Packet = &Endpoints.OUTQueue[Endpoints.OUTFirst];
+
+	return (Packet->Length - Packet->Position);
+}
+
+static bool Endpoint_IsReadWriteAllowed(void)
+{
+	if (Endpoints.Selected == DATA_IN_EPNUM)
+	  return (Endpoint_IsINReady() && (Endpoints.INBank.Length < ENDPOINT_BANK_SIZE));
+	else
+	  return (Endpoint_BytesInEndpoint() != 0);
+}
+
+static void Endpoint_ClearIN(void)
+{
+	/* Like the hardware, this does nothing while the host holds every bank */
+	if ((Endpoints.Selected != DATA_IN_EPNUM) || (Endpoints.INHandedCount == IN_BANKS))
+	  return;
+
+	Endpoints.INHanded[Endpoints.INHandedCount++] = Endpoints.INBank;
+	Endpoints.INBank.Length = 0;
+
+	if (!(Endpoints.HostPaused))
+	  Host_Collect();
+}
+
+static void Endpoint_ClearOUT(void)
+{
+	if (!(Endpoint_IsOUTReceived()))
+	  return;
+
+	Endpoints.OUTFirst = ((Endpoints.OUTFirst + 1) % HOST_QUEUE_SIZE);
+	Endpoints.OUTQueued--;
+}
+
+static uint8_t Endpoint_WaitUntilReady(void)
+{
+	if (Endpoints.Selected == DATA_IN_EPNUM)
+	{
+		if (Endpoint_IsINReady())
+		  return ENDPOINT_READYWAIT_NoError;
+
+		Endpoints.INWaits++;
+		return ENDPOINT_READYWAIT_Timeout;
+	}
+
+	return (Endpoint_IsOUTReceived()) ? ENDPOINT_READYWAIT_NoError : ENDPOINT_READYWAIT_Timeout;
+}
+
+/** Move data through the selected endpoint, a bank at a time as the LUFA stream functions do. A NULL
+ *  buffer discards OUT data.
+ */
+static uint8_t Endpoint_Stream(uint8_t* DataStream, const uint8_t* Source, uint16_t Length)
+{
+	while (Length)
+	{
+		if (!(Endpoint_IsReadWriteAllowed()))
+		{
+			if (Endpoints.Selected == DATA_IN_EPNUM)
+			  Endpoint_ClearIN();
+			else
+			  Endpoint_ClearOUT();
+
+			if (Endpoint_WaitUntilReady() != ENDPOINT_READYWAIT_NoError)
+			  return ENDPOINT_RWSTREAM_Timeout;
+
+			continue;
+		}
+
+		if (Endpoints.Selected == DATA_IN_EPNUM)
+		{
+			Endpoints.INBank.Data[Endpoints.INBank.Length++] = *(Source++);
+		}
+		else
+		{
+			Packet_t* Packet = &Endpoints.OUTQueue[Endpoints.OUTFirst];
+			uint8_t   Byte   = Packet->Data[Packet->Position++];
+
+			if (DataStream != NULL)
+			  *(DataStream++) = Byte;
+		}
+
+		Length--;
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+static uint8_t Endpoint_Read_Stream_LE(void* Buffer, uint16_t Length, void* Callback)
+{
+	return Endpoint_Stream(Buffer, NULL, Length);
+}
+
+static uint8_t Endpoint_Discard_Stream(uint16_t Length, void* Callback)
+{
+	return Endpoint_Stream(NULL, NULL, Length);
+}
+
+static uint8_t Endpoint_Write_Stream_LE(const void* Buffer, uint16_t Length, void* Callback)
+{
+	if (Endpoints.Selected == NOTIFICATION_EPNUM)
+	  return ENDPOINT_RWSTREAM_NoError;
+
+	return Endpoint_Stream(NULL, Buffer, Length);
+}
+
+#define Endpoint_SelectEndpoint(Number)                 do { Endpoints.Selected = (Number); } while (0)
+#define Endpoint_StallTransaction()                     do { Endpoints.Stalled = true; } while (0)
+#define Endpoint_ConfigureEndpoint(...)                 true
+#define Endpoint_IsSETUPReceived()                      false
+#define Endpoint_ClearSETUP()                           do { } while (0)
+#define Endpoint_Read_Control_Stream_LE(Buffer, Length) do { } while (0)
+#define Endpoint_Write_Control_Stream_LE(Buffer, Length) do { } while (0)
+
+#include "LUFA/Drivers/USB/Class/Device/RNDIS.c"
+
+
+/** Interface under test. */
+static USB_ClassInfo_RNDIS_Device_t RNDISInterface =
+	{
+		.Config =
+			{
+				.ControlInterfaceNumber     = 0,
+
+				.DataINEndpointNumber       = DATA_IN_EPNUM,
+				.DataINEndpointSize         = ENDPOINT_BANK_SIZE,
+
+				.DataOUTEndpointNumber      = DATA_OUT_EPNUM,
+				.DataOUTEndpointSize        = ENDPOINT_BANK_SIZE,
+
+				.NotificationEndpointNumber = NOTIFICATION_EPNUM,
+				.NotificationEndpointSize   = 8,
+			},
+	};
+
+/** Frame buffers lent to the driver, and their contents. */
+static uint8_t              FrameData[RNDIS_FRAME_QUEUE_DEPTH][FRAME_BUFFER_SIZE];
+static RNDIS_Frame_Buffer_t Frames[RNDIS_FRAME_QUEUE_DEPTH];
+
+
+/** Empty the endpoints and the host, and bring the interface up again ready for data. */
+static void Restart(void)
+{
+	memset(&Endpoints, 0x00, sizeof(Endpoints));
+
+	RNDIS_Device_ConfigureEndpoints(&RNDISInterface);
+
+	RNDISInterface.State.CurrRNDISState      = RNDIS_Data_Initialized;
+	RNDISInterface.State.HostMaxTransferSize = RNDIS_MAX_TRANSFER_SIZE;
+
+	for (uint8_t FrameIndex = 0; FrameIndex < RNDIS_FRAME_QUEUE_DEPTH; FrameIndex++)
+	{
+		Frames[FrameIndex] = (RNDIS_Frame_Buffer_t)
+			{
+				.FrameData  = FrameData[FrameIndex],
+				.BufferSize = FRAME_BUFFER_SIZE,
+			};
+	}
+}
+
+/** Build a packet message holding a frame of the test pattern, padded to the given total length if it is
+ *  longer. Returns the length of the message.
+ */
+static uint32_t BuildPacketMessage(uint8_t* const Message, const uint8_t Frame, const uint16_t FrameLength,
+                                   const uint32_t PaddedLength)
+{
+	RNDIS_Packet_Message_t Header;
+	uint32_t               MessageLength = (sizeof(RNDIS_Packet_Message_t) + FrameLength);
+
+	if (PaddedLength > MessageLength)
+	  MessageLength = PaddedLength;
+
+	memset(&Header, 0x00, sizeof(Header));
+	Header.MessageType   = REMOTE_NDIS_PACKET_MSG;
+	Header.MessageLength = MessageLength;
+	Header.DataOffset    = (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
+	Header.DataLength    = FrameLength;
+
+	memset(Message, 0x00, MessageLength);
+	memcpy(Message, &Header, sizeof(Header));
+
+	for (uint16_t i = 0; i < FrameLength; i++)
+	  Message[sizeof(Header) + i] = Pattern(Frame, i);
+
+	return MessageLength;
+}
+
+/** Check that a frame holds the test pattern. */
+static bool FrameMatches(const uint8_t* Data, const uint8_t Frame, const uint16_t FrameLength)
+{
+	for (uint16_t i = 0; i < FrameLength; i++)
+	{
+		if (Data[i] != Pattern(Frame, i))
+		  return false;
+	}
+
+	return true;
+}
+
+/** Lend every frame buffer to the driver, send the given transfer, and run the driver's task. */
+static void ReceiveTransfer(const uint8_t* Transfer, const uint32_t Length)
+{
+	for (uint8_t FrameIndex = 0; FrameIndex < RNDIS_FRAME_QUEUE_DEPTH; FrameIndex++)
+	  RNDIS_Device_LendReceiveBuffer(&RNDISInterface, &Frames[FrameIndex]);
+
+	Host_SendTransfer(Transfer, Length);
+	RNDIS_Device_USBTask(&RNDISInterface);
+}
+
+/** Send a single packet message whose header has been altered, and check that the driver stalls the endpoint
+ *  without taking it as a frame.
+ */
+static bool MalformedIsRejected(const uint8_t Field, const uint32_t Value)
+{
+	static uint8_t Transfer[sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX];
+	uint32_t       Length = BuildPacketMessage(Transfer, 0, 100, 0);
+
+	Restart();
+
+	memcpy(&Transfer[Field * sizeof(uint32_t)], &Value, sizeof(uint32_t));
+
+	ReceiveTransfer(Transfer, Length);
+
+	return (Endpoints.Stalled && !(RNDISInterface.State.ReceiveFilled) &&
+	        (RNDIS_Device_GetReceivedFrame(&RNDISInterface) == NULL));
+}
+
+/** Check a packet message in a transfer collected from the IN endpoint, and return its length. */
+static uint32_t CheckSentMessage(const uint8_t* Message, const uint8_t Frame, const uint16_t FrameLength,
+                                 const bool Padded, bool* const Passed)
+{
+	RNDIS_Packet_Message_t Header;
+	uint32_t               Unpadded = (sizeof(RNDIS_Packet_Message_t) + FrameLength);
+
+	memcpy(&Header, Message, sizeof(Header));
+
+	*Passed &= (Header.MessageType == REMOTE_NDIS_PACKET_MSG) && (Header.DataLength == FrameLength) &&
+	           (Header.DataOffset == (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t)));
+	*Passed &= FrameMatches(&Message[sizeof(Header)], Frame, FrameLength);
+
+	if (Padded)
+	{
+		*Passed &= !(Header.MessageLength % RNDIS_PACKET_ALIGNMENT) && (Header.MessageLength >= Unpadded) &&
+		           (Header.MessageLength < (Unpadded + RNDIS_PACKET_ALIGNMENT));
+
+		for (uint32_t i = Unpadded; i < Header.MessageLength; i++)
+		  *Passed &= !(Message[i]);
+	}
+	else
+	{
+		*Passed &= (Header.MessageLength == Unpadded);
+	}
+
+	return Header.MessageLength;
+}
+
+
+int main(void)
+{
+	static uint8_t Transfer[RNDIS_MAX_TRANSFER_SIZE];
+	static const uint16_t FrameLengths[] = {60, 1, 514, 1499};
+	uint32_t       Length;
+	bool           Passed;
+
+	/* Several packet messages, each but the last padded as the host does, in one transfer */
+	Restart();
+	Length = 0;
+
+	for (uint8_t FrameIndex = 0; FrameIndex < 3; FrameIndex++)
+	{
+		uint32_t Unpadded = (sizeof(RNDIS_Packet_Message_t) + FrameLengths[FrameIndex]);
+
+		Length += BuildPacketMessage(&Transfer[Length], FrameIndex, FrameLengths[FrameIndex],
+		                             (FrameIndex < 2) ? ((Unpadded + 7) & ~7) : 0);
+	}
+
+	ReceiveTransfer(Transfer, Length);
+
+	Passed = !(Endpoints.Stalled) && !(Endpoints.OUTQueued) && (RNDISInterface.State.ReceiveFilled == 3);
+
+	for (uint8_t FrameIndex = 0; (FrameIndex < 3) && Passed; FrameIndex++)
+	{
+		RNDIS_Frame_Buffer_t* Buffer = RNDIS_Device_GetReceivedFrame(&RNDISInterface);
+
+		Passed &= (Buffer == &Frames[FrameIndex]) && (Buffer->FrameLength == FrameLengths[FrameIndex]) &&
+		          FrameMatches(Buffer->FrameData, FrameIndex, FrameLengths[FrameIndex]);
+	}
+
+	Check(Passed && (RNDIS_Device_GetReceivedFrame(&RNDISInterface) == NULL),
+	      "several packet messages in one transfer are each received");
+
+	/* A transfer ending on a packet boundary, and so followed by a zero length packet */
+	Restart();
+	Length = BuildPacketMessage(Transfer, 1, (2 * ENDPOINT_BANK_SIZE) - sizeof(RNDIS_Packet_Message_t), 0);
+	ReceiveTransfer(Transfer, Length);
+
+	RNDIS_Frame_Buffer_t* Received = RNDIS_Device_GetReceivedFrame(&RNDISInterface);
+
+	Check(!(Endpoints.Stalled) && !(Endpoints.OUTQueued) && (Received != NULL) &&
+	      FrameMatches(Received->FrameData, 1, Received->FrameLength),
+	      "a transfer ended by a zero length packet is received");
+
+	/* A frame too large for the lent buffer is dropped, and the next message in the transfer still read */
+	Restart();
+	Frames[0].BufferSize = 100;
+	Length  = BuildPacketMessage(Transfer, 0, 200, 0);
+	Length += BuildPacketMessage(&Transfer[Length], 1, 50, 0);
+	ReceiveTransfer(Transfer, Length);
+
+	Received = RNDIS_Device_GetReceivedFrame(&RNDISInterface);
+
+	Check(!(Endpoints.Stalled) && !(Endpoints.OUTQueued) && (Received != NULL) && (Received->FrameLength == 50) &&
+	      FrameMatches(Received->FrameData, 1, 50), "a frame too large for its buffer is dropped");
+
+	/* Malformed and oversized packet message headers; fields are indexed in 32-bit words */
+	Passed  = MalformedIsRejected(0, REMOTE_NDIS_QUERY_MSG);
+	Passed &= MalformedIsRejected(1, (RNDIS_PACKET_MESSAGE_SIZE_MAX + 1));
+	Passed &= MalformedIsRejected(3, (ETHERNET_FRAME_SIZE_MAX + 1));
+	Passed &= MalformedIsRejected(2, 0);
+	Passed &= MalformedIsRejected(3, 101);
+	Passed &= MalformedIsRejected(1, 100);
+	Check(Passed, "malformed and oversized packet message headers are rejected");
+
+	/* Queued frames batched into one transfer, each message but the last padded */
+	Restart();
+
+	for (uint8_t FrameIndex = 0; FrameIndex < RNDIS_FRAME_QUEUE_DEPTH; FrameIndex++)
+	{
+		Frames[FrameIndex].FrameLength = FrameLengths[FrameIndex];
+
+		for (uint16_t i = 0; i < FrameLengths[FrameIndex]; i++)
+		  FrameData[FrameIndex][i] = Pattern(FrameIndex, i);
+
+		RNDIS_Device_SendFrame(&RNDISInterface, &Frames[FrameIndex]);
+	}
+
+	RNDIS_Device_USBTask(&RNDISInterface);
+
+	Passed = (Endpoints.TransferCount == 1) && !(RNDISInterface.State.SendCount);
+	Length = 0;
+
+	for (uint8_t FrameIndex = 0; (FrameIndex < RNDIS_FRAME_QUEUE_DEPTH) && Passed; FrameIndex++)
+	{
+		Passed &= !(Frames[FrameIndex].LentToDriver);
+		Length += CheckSentMessage(&Endpoints.Transfers[0].Data[Length], FrameIndex, FrameLengths[FrameIndex],
+		                           (FrameIndex < (RNDIS_FRAME_QUEUE_DEPTH - 1)), &Passed);
+	}
+
+	Check(Passed && (Length == Endpoints.Transfers[0].Length), "queued frames are sent padded in one transfer");
+
+	/* A transfer filling both IN banks exactly, while the host is too busy to free a bank for the zero length
+	   packet which must end it */
+	Restart();
+	Endpoints.HostPaused = true;
+
+	Frames[0].FrameLength = ((2 * ENDPOINT_BANK_SIZE) - sizeof(RNDIS_Packet_Message_t));
+	Frames[1].FrameLength = 10;
+
+	for (uint8_t FrameIndex = 0; FrameIndex < 2; FrameIndex++)
+	{
+		for (uint16_t i = 0; i < Frames[FrameIndex].FrameLength; i++)
+		  FrameData[FrameIndex][i] = Pattern(FrameIndex, i);
+	}
+
+	RNDISInterface.State.HostMaxTransferSize = (2 * ENDPOINT_BANK_SIZE);
+	RNDIS_Device_SendFrame(&RNDISInterface, &Frames[0]);
+	RNDIS_Device_SendFrame(&RNDISInterface, &Frames[1]);
+
+	RNDIS_Device_USBTask(&RNDISInterface);
+
+	Passed  = !(Endpoints.INWaits) && RNDISInterface.State.SendZLP && (RNDISInterface.State.SendCount == 1);
+
+	RNDIS_Device_USBTask(&RNDISInterface);
+	Passed &= !(Endpoints.INWaits) && RNDISInterface.State.SendZLP && (Endpoints.INHandedCount == IN_BANKS);
+
+	Endpoints.HostPaused = false;
+	Host_Collect();
+	RNDIS_Device_USBTask(&RNDISInterface);
+
+	Passed &= !(RNDISInterface.State.SendZLP) && (Endpoints.TransferCount == 2) &&
+	          (Endpoints.Transfers[0].Length == (2 * ENDPOINT_BANK_SIZE)) && (Endpoints.Transfers[0].Packets == 3);
+	CheckSentMessage(Endpoints.Transfers[0].Data, 0, Frames[0].FrameLength, false, &Passed);
+	CheckSentMessage(Endpoints.Transfers[1].Data, 1, Frames[1].FrameLength, false, &Passed);
+	Check(Passed, "a zero length packet ends a transfer on a packet boundary without waiting for the host");
+
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	return (Failures) ? 1 : 0;
+}
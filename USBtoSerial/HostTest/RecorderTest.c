@@ -0,0 +1,619 @@
+/** \file
+ *
+ *  Host test for the mass storage recorder (Lib/Recorder.c). The recorder is run against a simulated
+ *  USB flash drive, whose blocks are kept in a disk image file holding a FAT32 volume with a
+ *  preallocated RECORD.RAW. Samples arrive from a simulated audio source at a fixed rate, "firing"
+ *  between the bus transactions of each WRITE command as the real ISR would, and the recording is
+ *  checked against the samples sent once it has stopped.
+ *
+ *  Recorder.c is built with -fsanitize-coverage=trace-pc, so that its CPU time is charged to the
+ *  simulated AVR clock as in the firmware tests (see Mock.h). The bus is modelled as in StreamBench:
+ *  each 64 byte packet takes a full speed bus transaction, the pipe has two banks so the AVR fills
+ *  one while the other is sent, and each command also costs its CBW and CSW transactions and the
+ *  drive's time to act on it. This gives the sustained write bandwidth the recorder would see from
+ *  a typical drive, which is also reported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../Lib/Recorder.h"
+#include "Mock.h"
+
+/** Cycles in one second of simulated time. */
+#define SECONDS(s)              ((uint64_t)((s) * F_CPU))
+
+/** Cycles charged for each byte moved through the pipe's data register, or copied by memcpy(). */
+#define CYCLES_PER_DATA         (2 * MOCK_CYCLES_PER_ACCESS)
+
+/** Bytes of protocol overhead in each bulk transaction (see StreamBench.c). */
+#define BUS_OVERHEAD_BYTES      16
+
+/** AVR cycles for a bulk transaction of a given number of data bytes on the 12Mbit/s full speed bus. */
+#define BUS_CYCLES(Bytes)       ((uint64_t)((Bytes) + BUS_OVERHEAD_BYTES) * 8 * F_CPU / 12000000)
+
+/** Bytes in each packet of the data pipe. */
+#define PIPE_BANK_SIZE          64
+
+/** Assumed time the drive takes to act on each command once its data has arrived, before it sends
+ *  the CSW (500us, which is typical of cheap flash drives for short writes).
+ */
+#define DEVICE_COMMAND_CYCLES   (F_CPU / 2000)
+
+/** Cycles the main loop takes to go round when there is nothing to write. */
+#define IDLE_LOOP_CYCLES        200
+
+/** Steps in which the bandwidth test raises the source's rate, in bytes per second. */
+#define BANDWIDTH_RATE_STEP     16000
+
+/** Blocks in the disk image, and the first block of its partition. */
+#define IMAGE_BLOCKS            98304
+#define PARTITION_START         2048
+
+/** Reserved blocks at the start of the FAT32 volume, before its two FATs. */
+#define RESERVED_BLOCKS         32
+
+/** Size of the preallocated recording file. */
+#define RECORD_FILE_BYTES       (4UL * 1024 * 1024)
+
+/** Clusters (of one block) of the files in the image's root directory, after the root itself (cluster 2). */
+#define README_CLUSTER          3
+#define RECORD_CLUSTER          4
+
+/** Layouts of the test images. */
+enum ImageLayouts_t
+{
+	IMAGE_Partitioned, /**< MBR with the volume in its first partition, and a contiguous RECORD.RAW */
+	IMAGE_Superfloppy, /**< Volume starting at block 0, with no MBR */
+	IMAGE_Fragmented, /**< RECORD.RAW's cluster chain jumps part way through */
+	IMAGE_NoFile, /**< No RECORD.RAW in the root directory */
+};
+
+/** Number of tests which have failed. */
+static int Failures = 0;
+
+/** Simulated AVR clock, in cycles. */
+static uint64_t Cycles;
+
+/** Disk image backing the simulated drive. */
+static FILE* Image;
+
+/** First block of the volume's data area in the current image. */
+static uint32_t DataStart;
+
+/** The WRITE command in progress, whose data is collected here and written to the image at its end. */
+static struct
+{
+	uint8_t* Data;
+	uint32_t Length;
+	uint32_t Written;
+	uint16_t BankBytes;
+	uint64_t BankFree[2]; /**< When each of the pipe's banks will next be free, oldest first */
+} Command;
+
+/** Simulated audio source, which sends SourceRate bytes per second from SourceStart onwards. */
+static struct
+{
+	uint32_t Rate;
+	uint64_t Start;
+	uint32_t Sent;
+	bool     Running;
+} Source;
+
+/** Recorder's interface, which is only passed through to the mocks. */
+static USB_ClassInfo_MS_Host_t MSInterface;
+
+
+/** Report the result of a test. */
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+
+/** Called by the compiler at the start of every basic block of the recorder. */
+void __sanitizer_cov_trace_pc(void)
+{
+	Cycles += MOCK_CYCLES_PER_BLOCK;
+}
+
+
+/** The byte of the test signal at a given offset from the start of the recording. */
+static uint8_t SampleByte(const uint32_t Offset)
+{
+	return (uint8_t)((Offset * 7) ^ (Offset >> 9));
+}
+
+
+/** Send the samples due from the audio source by now, in the short bursts an ISR would. */
+static void RunSource(void)
+{
+	static bool Busy;
+
+	// the ISR can't interrupt itself
+	if (!(Source.Running) || Busy)
+	  return;
+
+	Busy = true;
+
+	uint32_t Due = (uint32_t)((Cycles - Source.Start) * Source.Rate / F_CPU);
+
+	while (Source.Sent < Due)
+	{
+		uint8_t  Burst[32];
+		uint16_t Length = ((Due - Source.Sent) < sizeof(Burst)) ? (Due - Source.Sent) : sizeof(Burst);
+
+		for (uint16_t i = 0; i < Length; i++)
+		  Burst[i] = SampleByte(Source.Sent + i);
+
+		Cycles += MOCK_CYCLES_PER_ISR + (Length * CYCLES_PER_DATA);
+		Recorder_Append(Burst, Length);
+		Source.Sent += Length;
+	}
+
+	Busy = false;
+}
+
+
+/** Move the clock on to a given time, running the source on the way. */
+static void RunUntil(const uint64_t Time)
+{
+	if (Cycles < Time)
+	  Cycles = Time;
+
+	RunSource();
+}
+
+
+uint32_t TimerWheel_Uptime(void)
+{
+	return (uint32_t)(Cycles * TIMERWHEEL_TICK_HZ / F_CPU);
+}
+
+
+/** Charge the bus time of a command's CBW, or of its CSW (along with the drive's time to act on it). */
+static void SendCBW(void)
+{
+	Cycles += (31 * CYCLES_PER_DATA);
+	RunUntil(Cycles + BUS_CYCLES(31));
+}
+
+static void ReceiveCSW(void)
+{
+	RunUntil(Cycles + DEVICE_COMMAND_CYCLES + BUS_CYCLES(13));
+	Cycles += (13 * CYCLES_PER_DATA);
+}
+
+
+uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                 const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
+                                 void* BlockBuffer)
+{
+	uint32_t Length = ((uint32_t)Blocks * BlockSize);
+
+	if ((BlockAddress + Blocks) > IMAGE_BLOCKS)
+	  return MS_ERROR_LOGICAL_CMD_FAILED;
+
+	SendCBW();
+	RunUntil(Cycles + DEVICE_COMMAND_CYCLES + (Length / PIPE_BANK_SIZE) * BUS_CYCLES(PIPE_BANK_SIZE));
+	Cycles += (Length * CYCLES_PER_DATA);
+	ReceiveCSW();
+
+	if (pread(fileno(Image), BlockBuffer, Length, (off_t)BlockAddress * BlockSize) != (ssize_t)Length)
+	  return MS_ERROR_LOGICAL_CMD_FAILED;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+
+uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                  const uint32_t BlockAddress, const uint16_t Blocks, const uint16_t BlockSize,
+                                  void* BlockBuffer)
+{
+	uint32_t Length = ((uint32_t)Blocks * BlockSize);
+
+	if ((BlockAddress + Blocks) > IMAGE_BLOCKS)
+	  return MS_ERROR_LOGICAL_CMD_FAILED;
+
+	SendCBW();
+	Cycles += (Length * CYCLES_PER_DATA);
+	RunUntil(Cycles + (Length / PIPE_BANK_SIZE) * BUS_CYCLES(PIPE_BANK_SIZE));
+	ReceiveCSW();
+
+	if (pwrite(fileno(Image), BlockBuffer, Length, (off_t)BlockAddress * BlockSize) != (ssize_t)Length)
+	  return MS_ERROR_LOGICAL_CMD_FAILED;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+
+uint8_t MS_Host_WriteDeviceBlockStream(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex,
+                                       const uint32_t BlockAddress, const uint32_t Blocks, const uint16_t BlockSize,
+                                       MS_BlockStreamCallbackPtr_t Callback)
+{
+	uint8_t ErrorCode = PIPE_RWSTREAM_NoError;
+
+	if ((BlockAddress + Blocks) > IMAGE_BLOCKS)
+	  return MS_ERROR_LOGICAL_CMD_FAILED;
+
+	Command.Length      = (Blocks * BlockSize);
+	Command.Written     = 0;
+	Command.Data        = malloc(Command.Length);
+	Command.BankFree[0] = 0;
+	Command.BankFree[1] = 0;
+
+	SendCBW();
+
+	while (Command.Written < Command.Length)
+	{
+		uint32_t BankStart = Command.Written;
+
+		// wait for the older bank to be sent, then fill it and hand it to the host
+		RunUntil(Command.BankFree[0]);
+
+		Command.BankBytes = ((Command.Length - BankStart) < PIPE_BANK_SIZE) ? (Command.Length - BankStart) : PIPE_BANK_SIZE;
+
+		if (!(Callback(MSInterfaceInfo, Command.BankBytes)) || ((Command.Written - BankStart) != Command.BankBytes))
+		{
+			ErrorCode = PIPE_RWSTREAM_CallbackAborted;
+			break;
+		}
+
+		uint64_t SendStart = (Cycles > Command.BankFree[1]) ? Cycles : Command.BankFree[1];
+
+		Command.BankFree[0] = Command.BankFree[1];
+		Command.BankFree[1] = SendStart + BUS_CYCLES(Command.BankBytes);
+
+		RunSource();
+	}
+
+	if (ErrorCode == PIPE_RWSTREAM_NoError)
+	{
+		RunUntil(Command.BankFree[1]);
+		ReceiveCSW();
+
+		if (pwrite(fileno(Image), Command.Data, Command.Length, (off_t)BlockAddress * BlockSize) != (ssize_t)Command.Length)
+		  ErrorCode = MS_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	free(Command.Data);
+	Command.Data = NULL;
+
+	return ErrorCode;
+}
+
+
+uint8_t Pipe_Write_Stream_LE(const void* Buffer, uint16_t Length, void* Callback)
+{
+	if ((Command.Data == NULL) || ((Command.Written + Length) > Command.Length))
+	  return PIPE_RWSTREAM_CallbackAborted;
+
+	memcpy(&Command.Data[Command.Written], Buffer, Length);
+	Command.Written += Length;
+	Cycles          += (Length * CYCLES_PER_DATA);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+
+/** Write a little endian value into a block. */
+static void Put16(uint8_t* Data, const uint16_t Value)
+{
+	Data[0] = (uint8_t)Value;
+	Data[1] = (uint8_t)(Value >> 8);
+}
+
+static void Put32(uint8_t* Data, const uint32_t Value)
+{
+	Put16(Data, (uint16_t)Value);
+	Put16(&Data[2], (uint16_t)(Value >> 16));
+}
+
+
+/** Write a block of the image. */
+static void PutBlock(const uint32_t BlockAddress, const uint8_t* Block)
+{
+	if (pwrite(fileno(Image), Block, RECORDER_BLOCK_SIZE, (off_t)BlockAddress * RECORDER_BLOCK_SIZE) != RECORDER_BLOCK_SIZE)
+	{
+		perror("RecorderTest: image");
+		exit(1);
+	}
+}
+
+
+/** Set a cluster's entry in both FATs. */
+static void PutFATEntry(const uint32_t FATStart, const uint32_t FATBlocks, const uint32_t Cluster, const uint32_t Value)
+{
+	uint8_t  Block[RECORDER_BLOCK_SIZE];
+	uint32_t BlockAddress = (FATStart + (Cluster / (RECORDER_BLOCK_SIZE / 4)));
+
+	for (uint8_t FAT = 0; FAT < 2; FAT++)
+	{
+		if (pread(fileno(Image), Block, sizeof(Block), (off_t)BlockAddress * RECORDER_BLOCK_SIZE) != sizeof(Block))
+		  memset(Block, 0x00, sizeof(Block));
+
+		Put32(&Block[(Cluster % (RECORDER_BLOCK_SIZE / 4)) * 4], Value);
+		PutBlock(BlockAddress, Block);
+
+		BlockAddress += FATBlocks;
+	}
+}
+
+
+/** Add an entry to the root directory block. */
+static void PutDirEntry(uint8_t* Entry, const char* Name, const uint8_t Attributes, const uint32_t Cluster,
+                        const uint32_t Size)
+{
+	memcpy(Entry, Name, 11);
+	Entry[11] = Attributes;
+	Put16(&Entry[20], (uint16_t)(Cluster >> 16));
+	Put16(&Entry[26], (uint16_t)Cluster);
+	Put32(&Entry[28], Size);
+}
+
+
+/** Build a fresh disk image with the given layout, with one block per cluster. */
+static void BuildImage(const enum ImageLayouts_t Layout)
+{
+	uint8_t  Block[RECORDER_BLOCK_SIZE];
+	uint32_t VolumeStart = (Layout == IMAGE_Superfloppy) ? 0 : PARTITION_START;
+	uint32_t VolumeSize  = (IMAGE_BLOCKS - VolumeStart);
+	uint32_t FATBlocks   = (((VolumeSize - RESERVED_BLOCKS + 2) * 4) + RECORDER_BLOCK_SIZE - 1) / RECORDER_BLOCK_SIZE;
+	uint32_t FATStart    = (VolumeStart + RESERVED_BLOCKS);
+	uint32_t FileBlocks  = (RECORD_FILE_BYTES / RECORDER_BLOCK_SIZE);
+
+	if (Image != NULL)
+	  fclose(Image);
+
+	if (((Image = tmpfile()) == NULL) || ftruncate(fileno(Image), (off_t)IMAGE_BLOCKS * RECORDER_BLOCK_SIZE))
+	{
+		perror("RecorderTest: image");
+		exit(1);
+	}
+
+	DataStart = (FATStart + (2 * FATBlocks));
+
+	if (Layout != IMAGE_Superfloppy)
+	{
+		memset(Block, 0x00, sizeof(Block));
+		Block[446 + 4] = 0x0C;
+		Put32(&Block[446 + 8],  VolumeStart);
+		Put32(&Block[446 + 12], VolumeSize);
+		Block[510] = 0x55;
+		Block[511] = 0xAA;
+		PutBlock(0, Block);
+	}
+
+	memset(Block, 0x00, sizeof(Block));
+	memcpy(&Block[3], "MSWIN4.1", 8);
+	Put16(&Block[11], RECORDER_BLOCK_SIZE);
+	Block[13] = 1;
+	Put16(&Block[14], RESERVED_BLOCKS);
+	Block[16] = 2;
+	Block[21] = 0xF8;
+	Put32(&Block[32], VolumeSize);
+	Put32(&Block[36], FATBlocks);
+	Put32(&Block[44], 2);
+	memcpy(&Block[82], "FAT32   ", 8);
+	Block[510] = 0x55;
+	Block[511] = 0xAA;
+	PutBlock(VolumeStart, Block);
+
+	// the volume label, a deleted copy of the file and a long name fragment all have to be skipped
+	memset(Block, 0x00, sizeof(Block));
+	PutDirEntry(&Block[0],  "RECORDER   ", 0x08, 0, 0);
+	PutDirEntry(&Block[32], "\xE5" "ECORD  RAW", 0x20, 9999, RECORD_FILE_BYTES);
+	PutDirEntry(&Block[64], "ARECORD RAW", 0x0F, 9999, RECORD_FILE_BYTES);
+	PutDirEntry(&Block[96], "README  TXT", 0x20, README_CLUSTER, 100);
+
+	if (Layout != IMAGE_NoFile)
+	  PutDirEntry(&Block[128], RECORDER_FILE_NAME, 0x20, RECORD_CLUSTER, RECORD_FILE_BYTES);
+
+	PutBlock(DataStart, Block);
+
+	PutFATEntry(FATStart, FATBlocks, 0, 0x0FFFFFF8);
+	PutFATEntry(FATStart, FATBlocks, 1, 0x0FFFFFFF);
+	PutFATEntry(FATStart, FATBlocks, 2, 0x0FFFFFFF);
+	PutFATEntry(FATStart, FATBlocks, README_CLUSTER, 0x0FFFFFFF);
+
+	for (uint32_t Cluster = RECORD_CLUSTER; Cluster < (RECORD_CLUSTER + FileBlocks); Cluster++)
+	{
+		uint32_t Next = (Cluster == (RECORD_CLUSTER + FileBlocks - 1)) ? 0x0FFFFFFF : (Cluster + 1);
+
+		if ((Layout == IMAGE_Fragmented) && (Cluster == (RECORD_CLUSTER + 1000)))
+		  Next = (RECORD_CLUSTER + FileBlocks + 10);
+
+		PutFATEntry(FATStart, FATBlocks, Cluster, Next);
+	}
+}
+
+
+/** Read the image's blocks before the recording file (the MBR, the volume's reserved blocks and FATs,
+ *  the root directory and README.TXT) into a newly allocated buffer.
+ */
+static uint8_t* ReadMetadata(void)
+{
+	uint32_t Length = ((DataStart + RECORD_CLUSTER - 2) * RECORDER_BLOCK_SIZE);
+	uint8_t* Data   = malloc(Length);
+
+	if (pread(fileno(Image), Data, Length, 0) != (ssize_t)Length)
+	  memset(Data, 0x00, Length);
+
+	return Data;
+}
+
+
+/** Run the recorder with the source at the given rate, until the given time has passed or the file is full. */
+static void Record(const uint32_t Rate, const uint64_t Duration, Recorder_Stats_t* const Stats)
+{
+	uint64_t End = (Cycles + Duration);
+
+	Source.Rate    = Rate;
+	Source.Start   = Cycles;
+	Source.Sent    = 0;
+	Source.Running = true;
+
+	do
+	{
+		uint64_t PassStart = Cycles;
+
+		Recorder_Task();
+		Recorder_GetStats(Stats);
+
+		RunUntil((Cycles == PassStart) ? (Cycles + IDLE_LOOP_CYCLES) : Cycles);
+	}
+	while ((Cycles < End) && Stats->BlocksLeft && Recorder_IsRecording());
+
+	Source.Running = false;
+}
+
+
+/** Check that a recording in the image holds the samples sent, padded to a whole block. */
+static bool RecordingMatches(const uint32_t DataBytes)
+{
+	uint32_t Length = ((DataBytes + RECORDER_BLOCK_SIZE - 1) & ~(RECORDER_BLOCK_SIZE - 1));
+	uint8_t* Data   = malloc(Length);
+	bool     Matches;
+	off_t    Offset = ((off_t)(DataStart + RECORD_CLUSTER - 2 + 1) * RECORDER_BLOCK_SIZE);
+
+	Matches = (pread(fileno(Image), Data, Length, Offset) == (ssize_t)Length);
+
+	for (uint32_t i = 0; Matches && (i < Length); i++)
+	  Matches = (Data[i] == ((i < DataBytes) ? SampleByte(i) : 0x00));
+
+	free(Data);
+	return Matches;
+}
+
+
+/** Read the recording file's header block from the image. */
+static void ReadHeader(Recorder_Header_t* const Header)
+{
+	off_t Offset = ((off_t)(DataStart + RECORD_CLUSTER - 2) * RECORDER_BLOCK_SIZE);
+
+	if (pread(fileno(Image), Header, sizeof(Recorder_Header_t), Offset) != sizeof(Recorder_Header_t))
+	  memset(Header, 0x00, sizeof(Recorder_Header_t));
+}
+
+
+/** Record a stream in real time, and check that all of it reaches the file unchanged. */
+static void TestStream(const char* Name, const uint32_t Rate)
+{
+	Recorder_Stats_t  Stats;
+	Recorder_Header_t Header;
+	char              Description[100];
+
+	BuildImage(IMAGE_Partitioned);
+	uint8_t* Metadata = ReadMetadata();
+
+	Check(Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_NoError, "recorder finds the preallocated file");
+
+	Record(Rate, SECONDS(2), &Stats);
+
+	// stop part way through a block, so the end of the last one is padded
+	Recorder_GetStats(&Stats);
+	Recorder_Append((const uint8_t[]){SampleByte(Stats.DataBytes), SampleByte(Stats.DataBytes + 1)}, 2);
+
+	Recorder_GetStats(&Stats);
+	Check(Recorder_Stop() == RECORDER_ERROR_NoError, "recorder stops");
+	ReadHeader(&Header);
+
+	snprintf(Description, sizeof(Description), "%s recording has no overruns", Name);
+	Check(!(Stats.OverrunBytes) && (Stats.DataBytes >= (Rate * 2)), Description);
+
+	snprintf(Description, sizeof(Description), "%s recording matches the samples sent", Name);
+	Check(!memcmp(Header.Signature, RECORDER_SIGNATURE, sizeof(Header.Signature)) &&
+	      (Header.DataBytes == Stats.DataBytes) && !(Header.OverrunBytes) && RecordingMatches(Header.DataBytes),
+	      Description);
+
+	uint8_t* After = ReadMetadata();
+	snprintf(Description, sizeof(Description), "%s recording leaves the FATs and directory alone", Name);
+	Check(!memcmp(Metadata, After, (DataStart + RECORD_CLUSTER - 2) * RECORDER_BLOCK_SIZE), Description);
+
+	printf("      %s: %lu bytes in %lu WRITE commands (%.1f blocks each)\n", Name, (unsigned long)Stats.DataBytes,
+	       (unsigned long)Stats.WriteCommands, (double)Stats.BlocksWritten / Stats.WriteCommands);
+
+	free(Metadata);
+	free(After);
+}
+
+
+/** Find the fastest source the recorder keeps up with, then record from a source faster than the bus until
+ *  the file is full.
+ */
+static void TestBandwidth(void)
+{
+	Recorder_Stats_t  Stats;
+	Recorder_Header_t Header;
+	uint32_t          Rate = 0;
+
+	BuildImage(IMAGE_Partitioned);
+
+	// raise the rate a step at a time until samples are dropped
+	do
+	{
+		Rate += BANDWIDTH_RATE_STEP;
+
+		Recorder_Start(&MSInterface, 0);
+		Record(Rate, SECONDS(1), &Stats);
+		Recorder_GetStats(&Stats);
+		Recorder_Stop();
+	}
+	while (!(Stats.OverrunBytes) && Stats.BlocksLeft);
+
+	printf("      sustained write bandwidth: %lu bytes/s (%lu bytes/s source without overruns, %.1f blocks per WRITE)\n",
+	       (unsigned long)Stats.BytesPerSecond, (unsigned long)(Rate - BANDWIDTH_RATE_STEP),
+	       (double)Stats.BlocksWritten / Stats.WriteCommands);
+
+	Check(Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_NoError, "recorder starts for the file full test");
+
+	Record(2000000, SECONDS(60), &Stats);
+
+	Check(!(Stats.BlocksLeft) && Recorder_IsRecording(), "recorder fills the file");
+	Check(Recorder_Stop() == RECORDER_ERROR_NoError, "recorder stops with the file full");
+	ReadHeader(&Header);
+
+	Check((Header.DataBytes == (RECORD_FILE_BYTES - RECORDER_BLOCK_SIZE)) && Header.OverrunBytes,
+	      "header counts the samples which fit in the file, and the overruns");
+}
+
+
+/** Check the volumes and files the recorder should and shouldn't accept. */
+static void TestLayouts(void)
+{
+	BuildImage(IMAGE_Fragmented);
+	Check(Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_FileFragmented, "fragmented file is refused");
+
+	BuildImage(IMAGE_NoFile);
+	Check(Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_FileNotFound, "missing file is reported");
+
+	Check(Recorder_Stop() == RECORDER_ERROR_NotRecording, "stop without a recording is reported");
+
+	BuildImage(IMAGE_Superfloppy);
+	Check((Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_NoError) && (Recorder_Stop() == RECORDER_ERROR_NoError),
+	      "volume without an MBR is found");
+
+	if (ftruncate(fileno(Image), 0) == 0)
+	  Check(Recorder_Start(&MSInterface, 0) == RECORDER_ERROR_DeviceError, "failed read is reported");
+}
+
+
+int main(void)
+{
+	TestLayouts();
+	TestStream("8kHz 8-bit mono", 8000);
+	TestStream("44.1kHz 16-bit stereo", 176400);
+	TestBandwidth();
+
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	if (Image != NULL)
+	  fclose(Image);
+
+	return (Failures) ? 1 : 0;
+}
@@ -0,0 +1,796 @@
+/** \file
+ *
+ *  Test and benchmark for the object streaming functions of the LUFA Still Image host class driver,
+ *  SImage_Host_GetObject() and SImage_Host_SendObject(). StillImage.c is built against simulated
+ *  pipes, with a mock PIMA camera on the far end of the bus, and multi-megabyte objects are read from
+ *  and written to the camera through the chunk callbacks. Every byte of each object is checked, as is
+ *  the PIMA container framing on both pipes (transaction IDs, short packet and zero length packet
+ *  termination), and the throughput and CPU cost of each transfer is reported.
+ *
+ *  The driver (and the pipe stream functions, from Template_Pipe_RW.c) is built with
+ *  -fsanitize-coverage=trace-pc, so that its CPU time is charged to the simulated AVR clock as in
+ *  the firmware tests (see Mock.h). The bus is modelled as in StreamBench: each packet takes a full
+ *  speed bus transaction, and each pipe has two banks. An IN transaction is only started while the
+ *  IN pipe is unfrozen, so a slow chunk callback holds off the camera; the slow consumer runs show the
+ *  resulting back-pressure.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Mock.h"
+
+/** Cycles charged for each byte moved through a pipe's data register. */
+#define CYCLES_PER_DATA         (2 * MOCK_CYCLES_PER_ACCESS)
+
+/** Bytes of protocol overhead in each bulk transaction (see StreamBench.c). */
+#define BUS_OVERHEAD_BYTES      16
+
+/** AVR cycles for a bulk transaction of a given number of data bytes on the 12Mbit/s full speed bus. */
+#define BUS_CYCLES(Bytes)       ((uint64_t)((Bytes) + BUS_OVERHEAD_BYTES) * 8 * F_CPU / 12000000)
+
+/** AVR cycles in each USB frame, between start of frame interrupts. */
+#define CYCLES_PER_FRAME        (F_CPU / 1000)
+
+/** Bytes in each packet of the data pipes. */
+#define PIPE_BANK_SIZE          64
+
+/** Banks in each data pipe. */
+#define PIPE_BANKS              2
+
+/** Pipe numbers given to the driver. */
+#define DATA_IN_PIPE            1
+#define DATA_OUT_PIPE           2
+#define EVENTS_PIPE             3
+
+/** Size and handle of the camera's object, for the GetObject transfers. */
+#define OBJECT_SIZE             (4UL * 1024 * 1024)
+#define OBJECT_HANDLE           0x00010001
+
+/** Cycles charged for each byte handled by the slow chunk callbacks, as if each chunk were written
+ *  to or read from an SD card.
+ */
+#define SLOW_CYCLES_PER_BYTE    40
+
+
+/* Stand-ins for the parts of the LUFA USB driver used by StillImage.c. Its includes of the USB driver
+   headers are skipped by defining their include guards. */
+#define __USBMODE_H__
+#define __USB_H__
+#define USB_CAN_BE_HOST
+
+#define NO_STREAM_CALLBACK                  NULL
+#define _CALLBACK_PARAM                     , StreamCallbackPtr_t Callback
+
+#define PIPE_TOKEN_IN                       0x10
+#define PIPE_TOKEN_OUT                      0x20
+#define PIPE_BANK_DOUBLE                    0x04
+#define USB_INT_HSOFI                       0
+#define HOST_SENDCONTROL_DeviceDisconnect   2
+#define CONFIGINDEX_InvalidConfigDescriptor 1
+
+enum StreamCallback_Return_ErrorCodes_t
+{
+	STREAMCALLBACK_Continue = 0,
+	STREAMCALLBACK_Abort    = 1,
+};
+
+enum Pipe_WaitUntilReady_ErrorCodes_t
+{
+	PIPE_READYWAIT_NoError            = 0,
+	PIPE_READYWAIT_PipeStalled        = 1,
+	PIPE_READYWAIT_DeviceDisconnected = 2,
+	PIPE_READYWAIT_Timeout            = 3,
+};
+
+enum Pipe_Stream_RW_ErrorCodes_t
+{
+	PIPE_RWSTREAM_NoError            = 0,
+	PIPE_RWSTREAM_PipeStalled        = 1,
+	PIPE_RWSTREAM_DeviceDisconnected = 2,
+	PIPE_RWSTREAM_Timeout            = 3,
+	PIPE_RWSTREAM_CallbackAborted    = 4,
+};
+
+enum USB_Host_States_t
+{
+	HOST_STATE_Unattached = 0,
+	HOST_STATE_Configured = 1,
+};
+
+typedef uint8_t (* const StreamCallbackPtr_t)(void);
+
+typedef struct
+{
+	uint8_t  EndpointAddress;
+	uint16_t EndpointSize;
+	uint8_t  PollingIntervalMS;
+} USB_ConfigIndex_Endpoint_t;
+
+typedef struct
+{
+	uint8_t Class;
+	uint8_t SubClass;
+	uint8_t Protocol;
+} USB_ConfigIndex_Interface_t;
+
+typedef struct
+{
+	uint8_t                     TotalInterfaces;
+	USB_ConfigIndex_Interface_t Interfaces[1];
+} USB_ConfigIndex_t;
+
+static uint8_t USB_HostState = HOST_STATE_Configured;
+
+
+/** Packet held in a pipe bank or on the bus. */
+typedef struct
+{
+	uint8_t  Data[PIPE_BANK_SIZE];
+	uint16_t Length;
+	uint16_t Position; /**< Next byte for the AVR to read, for IN packets */
+} Packet_t;
+
+/** State of the simulated pipes and bus. */
+static struct
+{
+	uint8_t  Selected;
+	bool     INFrozen;
+
+	Packet_t INBanks[PIPE_BANKS]; /**< Packets received into the IN pipe's banks, oldest first */
+	uint8_t  INFirst;
+	uint8_t  INHeld;
+	bool     INInFlight; /**< Set while an IN transaction is on the bus */
+	Packet_t INFlight;
+	uint64_t INFlightDone;
+
+	Packet_t OUTBank; /**< Bank the AVR is filling */
+	Packet_t OUTQueue[PIPE_BANKS]; /**< Banks handed to the bus, oldest first */
+	uint64_t OUTDone[PIPE_BANKS];
+	uint8_t  OUTQueued;
+
+	uint64_t BusFree; /**< When the bus is free for the next transaction */
+	uint64_t NextSOF;
+} Pipes;
+
+/** Simulated time, and the part of it spent waiting for the bus or the camera. */
+static uint64_t Cycles, WaitCycles;
+
+static int Failures = 0;
+
+
+/** State of the mock camera. */
+static struct
+{
+	uint8_t  RxHeader[32]; /**< Start of the container being received from the host */
+	uint32_t RxCount; /**< Bytes of the container received so far */
+	bool     RxPatternOK; /**< Cleared if a byte of a received data container doesn't match the pattern */
+
+	struct
+	{
+		uint32_t Length;
+		uint16_t Type;
+		uint16_t Code;
+		uint32_t TransactionID;
+	} TxQueue[2]; /**< Containers waiting to be sent to the host */
+	uint8_t  TxCount;
+	uint32_t TxSent; /**< Bytes of the first queued container sent so far */
+
+	uint32_t ObjectSize; /**< Size of the object returned by GetObject */
+	bool     ExpectData; /**< Set after a SendObject command, until its data container arrives */
+	uint32_t SendTransactionID;
+	uint32_t ReceivedObjectSize; /**< Size of the last object received in full by SendObject */
+	uint32_t FramingErrors;
+} Camera;
+
+
+/** Called by the compiler at the start of every basic block of the driver. */
+void __sanitizer_cov_trace_pc(void) __attribute__ ((no_sanitize_coverage));
+void __sanitizer_cov_trace_pc(void)
+{
+	Cycles += MOCK_CYCLES_PER_BLOCK;
+}
+
+
+static void Check(const bool Passed, const char* Name) __attribute__ ((no_sanitize_coverage));
+static void Check(const bool Passed, const char* Name)
+{
+	printf("%s: %s\n", (Passed) ? "PASS" : "FAIL", Name);
+
+	if (!(Passed))
+	  Failures++;
+}
+
+/** Byte of the test pattern at a given offset of an object. */
+static uint8_t Pattern(const uint32_t Offset) __attribute__ ((no_sanitize_coverage));
+static uint8_t Pattern(const uint32_t Offset)
+{
+	return (uint8_t)(Offset ^ (Offset >> 8) ^ (Offset >> 16));
+}
+
+static uint32_t Get32(const uint8_t* Data) __attribute__ ((no_sanitize_coverage));
+static uint32_t Get32(const uint8_t* Data)
+{
+	return (Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24));
+}
+
+
+static void Camera_Receive(const Packet_t* const Packet) __attribute__ ((no_sanitize_coverage));
+static void Camera_NextPacket(Packet_t* const Packet) __attribute__ ((no_sanitize_coverage));
+
+
+/** Move packets on the bus along to the simulated time, and start the next IN transaction if the IN
+ *  pipe is unfrozen and has a bank free.
+ */
+static void Pipes_Update(void) __attribute__ ((no_sanitize_coverage));
+static void Pipes_Update(void)
+{
+	while (Pipes.OUTQueued && (Pipes.OUTDone[0] <= Cycles))
+	{
+		Camera_Receive(&Pipes.OUTQueue[0]);
+
+		Pipes.OUTQueue[0] = Pipes.OUTQueue[1];
+		Pipes.OUTDone[0]  = Pipes.OUTDone[1];
+		Pipes.OUTQueued--;
+	}
+
+	if (Pipes.INInFlight && (Pipes.INFlightDone <= Cycles))
+	{
+		Pipes.INBanks[(Pipes.INFirst + Pipes.INHeld) % PIPE_BANKS] = Pipes.INFlight;
+		Pipes.INHeld++;
+		Pipes.INInFlight = false;
+	}
+
+	if (!(Pipes.INInFlight) && !(Pipes.INFrozen) && (Pipes.INHeld < PIPE_BANKS) && Camera.TxCount)
+	{
+		uint64_t Start = (Pipes.BusFree > Cycles) ? Pipes.BusFree : Cycles;
+
+		Camera_NextPacket(&Pipes.INFlight);
+
+		Pipes.INInFlight   = true;
+		Pipes.INFlightDone = Start + BUS_CYCLES(Pipes.INFlight.Length);
+		Pipes.BusFree      = Pipes.INFlightDone;
+	}
+}
+
+/** Skip ahead to the next change on the bus, or the next start of frame if there is none. */
+static void Pipes_WaitForBus(void) __attribute__ ((no_sanitize_coverage));
+static void Pipes_WaitForBus(void)
+{
+	uint64_t Next = Pipes.NextSOF;
+
+	if (Pipes.OUTQueued && (Pipes.OUTDone[0] < Next))
+	  Next = Pipes.OUTDone[0];
+
+	if (Pipes.INInFlight && (Pipes.INFlightDone < Next))
+	  Next = Pipes.INFlightDone;
+
+	if (Next > Cycles)
+	{
+		WaitCycles += (Next - Cycles);
+		Cycles      = Next;
+	}
+
+	Pipes_Update();
+}
+
+static bool Pipes_IsReady(void) __attribute__ ((no_sanitize_coverage));
+static bool Pipes_IsReady(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+	Pipes_Update();
+
+	if (Pipes.Selected == DATA_IN_PIPE)
+	  return (Pipes.INHeld != 0);
+	else
+	  return (Pipes.OUTQueued < PIPE_BANKS);
+}
+
+static bool Pipes_IsReadWriteAllowed(void) __attribute__ ((no_sanitize_coverage));
+static bool Pipes_IsReadWriteAllowed(void)
+{
+	if (Pipes.Selected == DATA_IN_PIPE)
+	{
+		// the driver polls this while waiting for a block header, so time moves on while no packet is held
+		if (!(Pipes_IsReady()))
+		{
+			Pipes_WaitForBus();
+			return false;
+		}
+
+		return (Pipes.INBanks[Pipes.INFirst].Position < Pipes.INBanks[Pipes.INFirst].Length);
+	}
+	else
+	{
+		return (Pipes_IsReady() && (Pipes.OUTBank.Length < PIPE_BANK_SIZE));
+	}
+}
+
+static uint8_t Pipe_WaitUntilReady(void) __attribute__ ((no_sanitize_coverage));
+static uint8_t Pipe_WaitUntilReady(void)
+{
+	uint16_t TimeoutMSRem = 100;
+
+	while (!(Pipes_IsReady()))
+	{
+		Pipes_WaitForBus();
+
+		if (Cycles >= Pipes.NextSOF)
+		{
+			Pipes.NextSOF += CYCLES_PER_FRAME;
+
+			if (!(TimeoutMSRem--))
+			  return PIPE_READYWAIT_Timeout;
+		}
+	}
+
+	return PIPE_READYWAIT_NoError;
+}
+
+static void Pipe_ClearIN(void) __attribute__ ((no_sanitize_coverage));
+static void Pipe_ClearIN(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (!(Pipes.INHeld))
+	{
+		Camera.FramingErrors++;
+		return;
+	}
+
+	Pipes.INFirst = ((Pipes.INFirst + 1) % PIPE_BANKS);
+	Pipes.INHeld--;
+	Pipes_Update();
+}
+
+static void Pipe_ClearOUT(void) __attribute__ ((no_sanitize_coverage));
+static void Pipe_ClearOUT(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Pipes.OUTQueued == PIPE_BANKS)
+	{
+		Camera.FramingErrors++;
+		return;
+	}
+
+	uint64_t Start = (Pipes.BusFree > Cycles) ? Pipes.BusFree : Cycles;
+
+	Pipes.OUTQueue[Pipes.OUTQueued] = Pipes.OUTBank;
+	Pipes.OUTDone[Pipes.OUTQueued]  = Start + BUS_CYCLES(Pipes.OUTBank.Length);
+	Pipes.BusFree                   = Pipes.OUTDone[Pipes.OUTQueued];
+	Pipes.OUTQueued++;
+
+	Pipes.OUTBank.Length = 0;
+}
+
+static uint8_t Pipe_Read_Byte(void) __attribute__ ((no_sanitize_coverage));
+static uint8_t Pipe_Read_Byte(void)
+{
+	Packet_t* Bank = &Pipes.INBanks[Pipes.INFirst];
+
+	Cycles += CYCLES_PER_DATA;
+
+	return Bank->Data[Bank->Position++];
+}
+
+static void Pipe_Write_Byte(const uint8_t Byte) __attribute__ ((no_sanitize_coverage));
+static void Pipe_Write_Byte(const uint8_t Byte)
+{
+	Cycles += CYCLES_PER_DATA;
+
+	Pipes.OUTBank.Data[Pipes.OUTBank.Length++] = Byte;
+}
+
+static uint16_t Pipe_BytesInPipe(void) __attribute__ ((no_sanitize_coverage));
+static uint16_t Pipe_BytesInPipe(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Pipes.Selected == DATA_IN_PIPE)
+	  return (Pipes.INHeld) ? (Pipes.INBanks[Pipes.INFirst].Length - Pipes.INBanks[Pipes.INFirst].Position) : 0;
+	else
+	  return Pipes.OUTBank.Length;
+}
+
+static void Pipe_SetFrozen(const bool Frozen) __attribute__ ((no_sanitize_coverage));
+static void Pipe_SetFrozen(const bool Frozen)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	if (Pipes.Selected == DATA_IN_PIPE)
+	{
+		Pipes.INFrozen = Frozen;
+		Pipes_Update();
+	}
+}
+
+static bool USB_INT_HasOccurred(const uint8_t Interrupt) __attribute__ ((no_sanitize_coverage));
+static bool USB_INT_HasOccurred(const uint8_t Interrupt)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	return (Cycles >= Pipes.NextSOF);
+}
+
+static void USB_INT_Clear(const uint8_t Interrupt) __attribute__ ((no_sanitize_coverage));
+static void USB_INT_Clear(const uint8_t Interrupt)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+
+	while (Pipes.NextSOF <= Cycles)
+	  Pipes.NextSOF += CYCLES_PER_FRAME;
+}
+
+static uint8_t USB_GetConfigIndex(USB_ConfigIndex_t* const Index, const uint16_t Size, uint8_t* const Descriptor)
+{
+	return CONFIGINDEX_InvalidConfigDescriptor;
+}
+
+static const USB_ConfigIndex_Endpoint_t* USB_ConfigIndex_FindEndpoint(const USB_ConfigIndex_t* const Index,
+                                                                      const USB_ConfigIndex_Interface_t* const Interface,
+                                                                      const uint8_t Type, const bool IN)
+{
+	return NULL;
+}
+
+#define Pipe_SelectPipe(Number)             do { Cycles += MOCK_CYCLES_PER_ACCESS; Pipes.Selected = (Number); } while (0)
+#define Pipe_Freeze()                       Pipe_SetFrozen(true)
+#define Pipe_Unfreeze()                     Pipe_SetFrozen(false)
+#define Pipe_SetToken(Token)                do { Cycles += MOCK_CYCLES_PER_ACCESS; } while (0)
+#define Pipe_IsReadWriteAllowed()           Pipes_IsReadWriteAllowed()
+#define Pipe_IsStalled()                    (Cycles += MOCK_CYCLES_PER_ACCESS, false)
+#define Pipe_ConfigurePipe(...)             do { } while (0)
+#define Pipe_SetInterruptPeriod(Interval)   do { } while (0)
+#define USB_Host_ClearPipeStall(Number)     do { } while (0)
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Write_Stream_LE
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_OUT
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearOUT()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Pipe_Write_Byte(*(BufferPtr++))
+#include "LUFA/Drivers/USB/LowLevel/Template/Template_Pipe_RW.c"
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Read_Stream_LE
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_IN
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearIN()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *(BufferPtr++) = Pipe_Read_Byte()
+#include "LUFA/Drivers/USB/LowLevel/Template/Template_Pipe_RW.c"
+
+#include "LUFA/Drivers/USB/Class/Host/StillImage.c"
+
+
+/** Queue a container for the camera to send to the host. */
+static void Camera_Queue(const uint32_t Length, const uint16_t Type, const uint16_t Code,
+                         const uint32_t TransactionID) __attribute__ ((no_sanitize_coverage));
+static void Camera_Queue(const uint32_t Length, const uint16_t Type, const uint16_t Code,
+                         const uint32_t TransactionID)
+{
+	Camera.TxQueue[Camera.TxCount].Length        = Length;
+	Camera.TxQueue[Camera.TxCount].Type          = Type;
+	Camera.TxQueue[Camera.TxCount].Code          = Code;
+	Camera.TxQueue[Camera.TxCount].TransactionID = TransactionID;
+	Camera.TxCount++;
+}
+
+/** Act on a container from the host, once the transfer holding it has ended. */
+static void Camera_ContainerDone(void) __attribute__ ((no_sanitize_coverage));
+static void Camera_ContainerDone(void)
+{
+	uint32_t Length        = Get32(&Camera.RxHeader[0]);
+	uint16_t Type          = (Camera.RxHeader[4] | (Camera.RxHeader[5] << 8));
+	uint16_t Code          = (Camera.RxHeader[6] | (Camera.RxHeader[7] << 8));
+	uint32_t TransactionID = Get32(&Camera.RxHeader[8]);
+
+	if (Camera.ExpectData)
+	{
+		Camera.ExpectData = false;
+
+		if ((Type == CType_DataBlock) && (Code == PIMA_OPERATION_SENDOBJECT) &&
+		    (TransactionID == Camera.SendTransactionID) && (Camera.RxCount == Length) && Camera.RxPatternOK)
+		{
+			Camera.ReceivedObjectSize = (Length - PIMA_DATA_SIZE(0));
+			Camera_Queue(PIMA_DATA_SIZE(0), CType_ResponseBlock, 0x2001, TransactionID);
+		}
+		else
+		{
+			// IncompleteTransfer
+			Camera_Queue(PIMA_DATA_SIZE(0), CType_ResponseBlock, 0x2007, Camera.SendTransactionID);
+		}
+	}
+	else if ((Type == CType_CommandBlock) && (Camera.RxCount == Length))
+	{
+		switch (Code)
+		{
+			case PIMA_OPERATION_GETOBJECT:
+				if (Get32(&Camera.RxHeader[12]) == OBJECT_HANDLE)
+				{
+					Camera_Queue(PIMA_DATA_SIZE(Camera.ObjectSize), CType_DataBlock, Code, TransactionID);
+					Camera_Queue(PIMA_DATA_SIZE(0), CType_ResponseBlock, 0x2001, TransactionID);
+				}
+				else
+				{
+					// InvalidObjectHandle
+					Camera_Queue(PIMA_DATA_SIZE(0), CType_ResponseBlock, 0x2009, TransactionID);
+				}
+
+				break;
+			case PIMA_OPERATION_SENDOBJECT:
+				Camera.ExpectData        = true;
+				Camera.SendTransactionID = TransactionID;
+				break;
+			default:
+				Camera_Queue(PIMA_DATA_SIZE(0), CType_ResponseBlock, 0x2001, TransactionID);
+				break;
+		}
+	}
+	else
+	{
+		Camera.FramingErrors++;
+	}
+
+	Camera.RxCount     = 0;
+	Camera.RxPatternOK = true;
+}
+
+/** Take a packet sent by the host on the OUT pipe. A short packet ends the transfer, and so the container. */
+static void Camera_Receive(const Packet_t* const Packet)
+{
+	for (uint16_t i = 0; i < Packet->Length; i++)
+	{
+		if (Camera.RxCount < sizeof(Camera.RxHeader))
+		  Camera.RxHeader[Camera.RxCount] = Packet->Data[i];
+
+		if ((Camera.RxCount >= PIMA_DATA_SIZE(0)) && (Packet->Data[i] != Pattern(Camera.RxCount - PIMA_DATA_SIZE(0))))
+		  Camera.RxPatternOK = false;
+
+		Camera.RxCount++;
+	}
+
+	if (Packet->Length < PIPE_BANK_SIZE)
+	  Camera_ContainerDone();
+}
+
+/** Fill the next packet of the camera's queued containers, ending each with a short or zero length packet. */
+static void Camera_NextPacket(Packet_t* const Packet)
+{
+	uint32_t Length = Camera.TxQueue[0].Length;
+
+	Packet->Length   = 0;
+	Packet->Position = 0;
+
+	while ((Packet->Length < PIPE_BANK_SIZE) && (Camera.TxSent < Length))
+	{
+		uint32_t Offset = Camera.TxSent++;
+		uint8_t  Byte;
+
+		if (Offset < PIMA_DATA_SIZE(0))
+		{
+			SI_PIMA_Container_t Header =
+				{
+					.DataLength    = Length,
+					.Type          = Camera.TxQueue[0].Type,
+					.Code          = Camera.TxQueue[0].Code,
+					.TransactionID = Camera.TxQueue[0].TransactionID,
+				};
+
+			Byte = ((uint8_t*)&Header)[Offset];
+		}
+		else
+		{
+			Byte = Pattern(Offset - PIMA_DATA_SIZE(0));
+		}
+
+		Packet->Data[Packet->Length++] = Byte;
+	}
+
+	// a full last packet leaves the container queued for its zero length packet
+	if (Packet->Length < PIPE_BANK_SIZE)
+	{
+		Camera.TxQueue[0] = Camera.TxQueue[1];
+		Camera.TxCount--;
+		Camera.TxSent = 0;
+	}
+}
+
+
+static USB_ClassInfo_SI_Host_t SIInterface =
+	{
+		.Config =
+			{
+				.DataINPipeNumber  = DATA_IN_PIPE,
+				.DataOUTPipeNumber = DATA_OUT_PIPE,
+				.EventsPipeNumber  = EVENTS_PIPE,
+			},
+	};
+
+/** Chunk callback state: the next offset expected, the offset to abort at, and whether every chunk matched. */
+static uint32_t NextOffset, AbortOffset;
+static uint32_t CallbackCycles;
+static bool     ChunksOK;
+
+static uint8_t ConsumeChunk(const uint32_t Offset, uint8_t* const Chunk, const uint16_t Bytes) __attribute__ ((no_sanitize_coverage));
+static uint8_t ConsumeChunk(const uint32_t Offset, uint8_t* const Chunk, const uint16_t Bytes)
+{
+	if (Offset != NextOffset)
+	  ChunksOK = false;
+
+	for (uint16_t i = 0; i < Bytes; i++)
+	{
+		if (Chunk[i] != Pattern(Offset + i))
+		  ChunksOK = false;
+	}
+
+	NextOffset = (Offset + Bytes);
+	Cycles    += (uint64_t)CallbackCycles * Bytes;
+
+	return (NextOffset >= AbortOffset) ? STREAMCALLBACK_Abort : STREAMCALLBACK_Continue;
+}
+
+static uint8_t ProduceChunk(const uint32_t Offset, uint8_t* const Chunk, const uint16_t Bytes) __attribute__ ((no_sanitize_coverage));
+static uint8_t ProduceChunk(const uint32_t Offset, uint8_t* const Chunk, const uint16_t Bytes)
+{
+	if (Offset != NextOffset)
+	  ChunksOK = false;
+
+	if (Offset >= AbortOffset)
+	  return STREAMCALLBACK_Abort;
+
+	for (uint16_t i = 0; i < Bytes; i++)
+	  Chunk[i] = Pattern(Offset + i);
+
+	NextOffset = (Offset + Bytes);
+	Cycles    += (uint64_t)CallbackCycles * Bytes;
+
+	return STREAMCALLBACK_Continue;
+}
+
+/** Start a transfer with the clock at zero and the pipes idle. */
+static void Reset(const uint32_t ObjectSize, const uint32_t Abort, const uint32_t CyclesPerByte) __attribute__ ((no_sanitize_coverage));
+static void Reset(const uint32_t ObjectSize, const uint32_t Abort, const uint32_t CyclesPerByte)
+{
+	Cycles        = 0;
+	WaitCycles    = 0;
+	Pipes.BusFree = 0;
+	Pipes.NextSOF = CYCLES_PER_FRAME;
+
+	Camera.ObjectSize         = ObjectSize;
+	Camera.ReceivedObjectSize = 0;
+	Camera.FramingErrors      = 0;
+	Camera.RxPatternOK        = true;
+
+	NextOffset     = 0;
+	AbortOffset    = Abort;
+	CallbackCycles = CyclesPerByte;
+	ChunksOK       = true;
+}
+
+/** True if the pipes and the camera are idle, with nothing left over from the last transfer. */
+static bool Idle(void) __attribute__ ((no_sanitize_coverage));
+static bool Idle(void)
+{
+	return !(Pipes.INHeld || Pipes.INInFlight || Pipes.OUTQueued || Pipes.OUTBank.Length ||
+	         Camera.TxCount || Camera.RxCount || Camera.ExpectData || Camera.FramingErrors);
+}
+
+/** Print the CPU cost and the throughput of one transfer. */
+static void Report(const char* Name, const uint16_t ChunkSize, const uint32_t Bytes) __attribute__ ((no_sanitize_coverage));
+static void Report(const char* Name, const uint16_t ChunkSize, const uint32_t Bytes)
+{
+	printf("      %-10s %5u %8lu %9.2f %9.0f\n", Name, ChunkSize, (unsigned long)Bytes,
+	       (double)(Cycles - WaitCycles) / Bytes, Bytes * (double)F_CPU / Cycles / 1024);
+}
+
+
+int main(void) __attribute__ ((no_sanitize_coverage));
+int main(void)
+{
+	static uint8_t        Chunk[512];
+	static const uint16_t ChunkSizes[] = {16, 64, 256, 512};
+	char                  Description[100];
+	uint8_t               ErrorCode;
+
+	SIInterface.State.IsActive        = true;
+	SIInterface.State.DataINPipeSize  = PIPE_BANK_SIZE;
+	SIInterface.State.DataOUTPipeSize = PIPE_BANK_SIZE;
+	SIInterface.State.EventsPipeSize  = 8;
+
+	Reset(0, UINT32_MAX, 0);
+	Check(SImage_Host_OpenSession(&SIInterface) == PIPE_RWSTREAM_NoError, "session opens");
+
+	printf("Object transfers of %lu bytes, estimated CPU cycles per byte and KB/s:\n", OBJECT_SIZE);
+	printf("      transfer   chunk    bytes  cycles/B      KB/s\n");
+
+	for (uint8_t i = 0; i < (sizeof(ChunkSizes) / sizeof(ChunkSizes[0])); i++)
+	{
+		Reset(OBJECT_SIZE, UINT32_MAX, 0);
+		ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, ChunkSizes[i], ConsumeChunk);
+		Report("GetObject", ChunkSizes[i], OBJECT_SIZE);
+
+		snprintf(Description, sizeof(Description), "GetObject with %u byte chunks reads the whole object", ChunkSizes[i]);
+		Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (NextOffset == OBJECT_SIZE) && Idle(), Description);
+
+		Reset(0, UINT32_MAX, 0);
+		ErrorCode = SImage_Host_SendObject(&SIInterface, OBJECT_SIZE, Chunk, ChunkSizes[i], ProduceChunk);
+		Report("SendObject", ChunkSizes[i], OBJECT_SIZE);
+
+		snprintf(Description, sizeof(Description), "SendObject with %u byte chunks writes the whole object", ChunkSizes[i]);
+		Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (Camera.ReceivedObjectSize == OBJECT_SIZE) && Idle(),
+		      Description);
+	}
+
+	printf("    with a consumer taking %u cycles per byte:\n", SLOW_CYCLES_PER_BYTE);
+
+	Reset(OBJECT_SIZE, UINT32_MAX, SLOW_CYCLES_PER_BYTE);
+	ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, 512, ConsumeChunk);
+	Report("GetObject", 512, OBJECT_SIZE);
+	Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (NextOffset == OBJECT_SIZE) && Idle(),
+	      "GetObject holds off the camera for a slow consumer without losing data");
+
+	Reset(0, UINT32_MAX, SLOW_CYCLES_PER_BYTE);
+	ErrorCode = SImage_Host_SendObject(&SIInterface, OBJECT_SIZE, Chunk, 512, ProduceChunk);
+	Report("SendObject", 512, OBJECT_SIZE);
+	Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (Camera.ReceivedObjectSize == OBJECT_SIZE) && Idle(),
+	      "SendObject waits for a slow producer without losing data");
+
+	// container lengths which fill their last packet need a zero length packet to end the transfer
+	static const uint32_t EdgeSizes[] = {0, 1, PIPE_BANK_SIZE - PIMA_DATA_SIZE(0), (PIPE_BANK_SIZE * 3) - PIMA_DATA_SIZE(0), 1000};
+
+	for (uint8_t i = 0; i < (sizeof(EdgeSizes) / sizeof(EdgeSizes[0])); i++)
+	{
+		Reset(EdgeSizes[i], UINT32_MAX, 0);
+		ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, 64, ConsumeChunk);
+
+		snprintf(Description, sizeof(Description), "GetObject reads a %lu byte object", (unsigned long)EdgeSizes[i]);
+		Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (NextOffset == EdgeSizes[i]) && Idle(), Description);
+
+		Reset(0, UINT32_MAX, 0);
+		ErrorCode = SImage_Host_SendObject(&SIInterface, EdgeSizes[i], Chunk, 64, ProduceChunk);
+
+		snprintf(Description, sizeof(Description), "SendObject writes a %lu byte object", (unsigned long)EdgeSizes[i]);
+		Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (Camera.ReceivedObjectSize == EdgeSizes[i]) &&
+		      !(Camera.ExpectData) && Idle(), Description);
+	}
+
+	Reset(OBJECT_SIZE, 100000, 0);
+	ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, 512, ConsumeChunk);
+	Check((ErrorCode == PIPE_RWSTREAM_CallbackAborted) && ChunksOK && (NextOffset < 100512) && Idle(),
+	      "GetObject stops calling back once aborted, and reads out the rest of the object");
+
+	Reset(0, 100000, 0);
+	ErrorCode = SImage_Host_SendObject(&SIInterface, OBJECT_SIZE, Chunk, 512, ProduceChunk);
+	Check((ErrorCode == PIPE_RWSTREAM_CallbackAborted) && !(Camera.ReceivedObjectSize) && Idle(),
+	      "SendObject ends an aborted data phase early, and the camera rejects the object");
+
+	Reset(0, 100000, 0);
+	ErrorCode = SImage_Host_SendObject(&SIInterface, OBJECT_SIZE, Chunk, PIPE_BANK_SIZE * 2, ProduceChunk);
+	Check((ErrorCode == PIPE_RWSTREAM_CallbackAborted) && !(Camera.ReceivedObjectSize) && Idle(),
+	      "SendObject ends a data phase aborted on a packet boundary");
+
+	Reset(OBJECT_SIZE, UINT32_MAX, 0);
+	ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE + 1, Chunk, 512, ConsumeChunk);
+	Check((ErrorCode == SI_ERROR_LOGICAL_CMD_FAILED) && !(NextOffset) && Idle(), "GetObject of an unknown handle fails");
+
+	Reset(1000, UINT32_MAX, 0);
+	ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, 0, ConsumeChunk);
+	Check((ErrorCode == SI_ERROR_LOGICAL_CMD_FAILED) && !(NextOffset) && Idle(), "GetObject with no chunk buffer is refused");
+
+	ErrorCode = SImage_Host_SendObject(&SIInterface, 1000, Chunk, 0, ProduceChunk);
+	Check((ErrorCode == SI_ERROR_LOGICAL_CMD_FAILED) && !(Camera.ReceivedObjectSize) && Idle(),
+	      "SendObject with no chunk buffer is refused");
+
+	Reset(1000, UINT32_MAX, 0);
+	ErrorCode = SImage_Host_GetObject(&SIInterface, OBJECT_HANDLE, Chunk, 512, ConsumeChunk);
+	Check((ErrorCode == PIPE_RWSTREAM_NoError) && ChunksOK && (NextOffset == 1000) && Idle(),
+	      "session is still in step after the failed and aborted transfers");
+
+	Reset(0, UINT32_MAX, 0);
+	Check(SImage_Host_CloseSession(&SIInterface) == PIPE_RWSTREAM_NoError, "session closes");
+
+	printf("%s\n", (Failures) ? "FAILED" : "ALL PASSED");
+
+	return (Failures) ? 1 : 0;
+}
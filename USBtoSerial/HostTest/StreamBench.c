@@ -0,0 +1,210 @@
+/** \file
+ *
+ *  Benchmark for the LUFA endpoint stream functions. This builds Template_Endpoint_RW.c (as used for
+ *  Endpoint_Write_Stream_LE() and Endpoint_Read_Stream_LE()) against a simulated endpoint FIFO, and
+ *  reports the estimated AVR cycles per byte for a range of endpoint bank sizes, using the same cost
+ *  model as the firmware tests (see Mock.h).
+ *
+ *  Each access to the endpoint's data register is charged two cycles for the register and two for
+ *  the matching load or store to RAM, which is what the AVR takes for a post-increment load and a
+ *  store to UEDATX.
+ *
+ *  The endpoint's banks are handed back and forth between the AVR and a simulated host, which takes
+ *  a full speed bus transaction's time to send or receive each packet. This gives the throughput of
+ *  a bulk endpoint with one and with two banks: with one, the AVR and the host take turns on every
+ *  packet, and with two, the AVR fills or empties one bank while the host works on the other.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Mock.h"
+
+#define FAST_STREAM_TRANSFERS
+#define NO_STREAM_CALLBACKS
+
+/** Bytes moved by each stream call. */
+#define STREAM_LENGTH       4096
+
+/** Cycles charged for each byte moved through the endpoint's data register. */
+#define CYCLES_PER_DATA     (2 * MOCK_CYCLES_PER_ACCESS)
+
+/** Bytes of protocol overhead in each bulk transaction (token, data and handshake packets, with their
+ *  sync fields, PIDs, CRCs and turnaround gaps).
+ */
+#define BUS_OVERHEAD_BYTES  16
+
+/** AVR cycles for a bulk transaction of a given number of data bytes on the 12Mbit/s full speed bus. */
+#define BUS_CYCLES(Bytes)   ((uint64_t)((Bytes) + BUS_OVERHEAD_BYTES) * 8 * F_CPU / 12000000)
+
+#define _CALLBACK_PARAM
+
+enum
+{
+	ENDPOINT_RWSTREAM_NoError = 0,
+	ENDPOINT_RWSTREAM_CallbackAborted = 4,
+};
+
+/** State of the simulated endpoint. */
+static struct
+{
+	bool     IN;
+	uint16_t Size;
+	uint8_t  Banks;
+	uint8_t  AVRBanks; /**< Banks the AVR can fill (IN) or empty (OUT) */
+	uint8_t  HostBanks; /**< Banks waiting for (or in) a bus transaction */
+	uint64_t HostDone[2]; /**< When each of the host's banks is finished with, oldest first */
+	uint16_t Count; /**< IN: bytes written to the current bank, OUT: bytes left to read from it */
+} Endpoint;
+
+/** Simulated time, and the part of it spent waiting for the host. */
+static uint64_t Cycles, WaitCycles;
+
+/** Called by the compiler at the start of every basic block of the stream functions. */
+void __sanitizer_cov_trace_pc(void) __attribute__ ((no_sanitize_coverage));
+void __sanitizer_cov_trace_pc(void)
+{
+	Cycles += MOCK_CYCLES_PER_BLOCK;
+}
+
+/** Give the AVR back any banks the host has finished with. */
+static void Endpoint_Update(void) __attribute__ ((no_sanitize_coverage));
+static void Endpoint_Update(void)
+{
+	while (Endpoint.HostBanks && (Endpoint.HostDone[0] <= Cycles))
+	{
+		Endpoint.HostDone[0] = Endpoint.HostDone[1];
+		Endpoint.HostBanks--;
+		Endpoint.AVRBanks++;
+	}
+}
+
+/** Hand the current bank to the host, which starts on it once it has finished with the other. */
+static void Endpoint_HandToHost(void) __attribute__ ((no_sanitize_coverage));
+static void Endpoint_HandToHost(void)
+{
+	uint64_t Start = Cycles;
+
+	if (Endpoint.HostBanks && (Endpoint.HostDone[Endpoint.HostBanks - 1] > Start))
+	  Start = Endpoint.HostDone[Endpoint.HostBanks - 1];
+
+	Endpoint.HostDone[Endpoint.HostBanks++] = Start + BUS_CYCLES(Endpoint.Size);
+	Endpoint.AVRBanks--;
+	Endpoint.Count = (Endpoint.IN) ? 0 : Endpoint.Size;
+}
+
+/** Busy wait for a bank, as Endpoint_WaitUntilReady() does. */
+static uint8_t Endpoint_Wait(void) __attribute__ ((no_sanitize_coverage));
+static uint8_t Endpoint_Wait(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+	Endpoint_Update();
+
+	if (!(Endpoint.AVRBanks))
+	{
+		WaitCycles += Endpoint.HostDone[0] - Cycles;
+		Cycles      = Endpoint.HostDone[0];
+		Endpoint_Update();
+	}
+
+	return 0;
+}
+
+/** Returns true if the current bank can be written (IN) or read (OUT), as Endpoint_IsReadWriteAllowed() does. */
+static bool Endpoint_RWAL(void) __attribute__ ((no_sanitize_coverage));
+static bool Endpoint_RWAL(void)
+{
+	Cycles += MOCK_CYCLES_PER_ACCESS;
+	Endpoint_Update();
+
+	if (!(Endpoint.AVRBanks))
+	  return false;
+
+	return (Endpoint.IN) ? (Endpoint.Count < Endpoint.Size) : (Endpoint.Count != 0);
+}
+
+#define Endpoint_WaitUntilReady()         Endpoint_Wait()
+#define Endpoint_BytesInEndpoint()        (Cycles += MOCK_CYCLES_PER_ACCESS, Endpoint.Count)
+#define Endpoint_GetBankSize()            (Cycles += MOCK_CYCLES_PER_ACCESS, Endpoint.Size)
+#define Endpoint_IsReadWriteAllowed()     Endpoint_RWAL()
+#define Endpoint_ClearIN()                do { Cycles += MOCK_CYCLES_PER_ACCESS; Endpoint_HandToHost(); } while (0)
+#define Endpoint_ClearOUT()               do { Cycles += MOCK_CYCLES_PER_ACCESS; Endpoint_HandToHost(); } while (0)
+#define Endpoint_Write_Byte(Byte)         do { Cycles += CYCLES_PER_DATA; (void)(Byte); Endpoint.Count++; } while (0)
+#define Endpoint_Read_Byte()              (Cycles += CYCLES_PER_DATA, Endpoint.Count--, 0x55)
+
+#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_LE
+#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
+#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_Byte(*(BufferPtr++))
+#include "LUFA/Drivers/USB/LowLevel/Template/Template_Endpoint_RW.c"
+
+#define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_LE
+#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BANK_BYTES()                     Endpoint_BytesInEndpoint()
+#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *(BufferPtr++) = Endpoint_Read_Byte()
+#include "LUFA/Drivers/USB/LowLevel/Template/Template_Endpoint_RW.c"
+
+
+/** Set up the simulated endpoint at the start of a stream. An IN endpoint starts with all its banks
+ *  empty, and an OUT endpoint with the host about to send a packet into each.
+ */
+static void Endpoint_Reset(const bool IN, const uint16_t Size, const uint8_t Banks) __attribute__ ((no_sanitize_coverage));
+static void Endpoint_Reset(const bool IN, const uint16_t Size, const uint8_t Banks)
+{
+	Cycles     = 0;
+	WaitCycles = 0;
+
+	Endpoint.IN        = IN;
+	Endpoint.Size      = Size;
+	Endpoint.Banks     = Banks;
+	Endpoint.Count     = (IN) ? 0 : Size;
+	Endpoint.AVRBanks  = (IN) ? Banks : 0;
+	Endpoint.HostBanks = (IN) ? 0 : Banks;
+
+	for (uint8_t Bank = 0; Bank < Endpoint.HostBanks; Bank++)
+	  Endpoint.HostDone[Bank] = (Bank + 1) * BUS_CYCLES(Size);
+}
+
+
+/** Print the CPU cost and the throughput of one stream. */
+static void Report(const char* Direction) __attribute__ ((no_sanitize_coverage));
+static void Report(const char* Direction)
+{
+	// an IN stream isn't finished until the host has the last packet
+	if (Endpoint.IN && Endpoint.HostBanks)
+	  Cycles = Endpoint.HostDone[Endpoint.HostBanks - 1];
+
+	printf("  %6s %4u %5u %9.2f %9.0f\n", Direction, Endpoint.Size, Endpoint.Banks,
+	       (double)(Cycles - WaitCycles) / STREAM_LENGTH, STREAM_LENGTH * (double)F_CPU / Cycles / 1024);
+}
+
+
+int main(void) __attribute__ ((no_sanitize_coverage));
+int main(void)
+{
+	static uint8_t        Buffer[STREAM_LENGTH];
+	static const uint16_t Sizes[] = {8, 16, 32, 64};
+
+	printf("Endpoint stream transfers of %u bytes, estimated CPU cycles per byte and KB/s:\n", STREAM_LENGTH);
+	printf("  stream bank banks  cycles/B      KB/s\n");
+
+	for (uint8_t i = 0; i < (sizeof(Sizes) / sizeof(Sizes[0])); i++)
+	{
+		for (uint8_t Banks = 1; Banks <= 2; Banks++)
+		{
+			Endpoint_Reset(true, Sizes[i], Banks);
+			Endpoint_Write_Stream_LE(Buffer, STREAM_LENGTH);
+			Report("write");
+
+			Endpoint_Reset(false, Sizes[i], Banks);
+			Endpoint_Read_Stream_LE(Buffer, STREAM_LENGTH);
+			Report("read");
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,180 @@
+/** \file
+ *
+ *  Wear-levelled EEPROM event journal. See Journal.h for an overview.
+ *
+ *  Journal_Append() only queues a record in RAM, so it takes constant time and is safe to call
+ *  from an ISR. Journal_Task() is called from the main loop and writes queued records out a byte
+ *  at a time, and only when the EEPROM is idle, so it never waits for the (3.4ms) byte writes.
+ */
+
+#include "Journal.h"
+
+/** Record slots in the EEPROM. */
+static Journal_Record_t EEMEM JournalRecords[JOURNAL_RECORDS];
+
+/** Records waiting to be written to the EEPROM, oldest at QueueOut. */
+static Journal_Record_t QueuedRecords[JOURNAL_QUEUE_LENGTH];
+static volatile uint8_t QueueIn, QueueOut, QueueCount;
+
+/** Count of records lost because the queue was full, reported with a JOURNAL_EVENT_DROPPED record. */
+static volatile uint8_t DroppedRecords;
+
+/** Sequence number to give the next appended record. */
+static volatile uint16_t NextSequence;
+
+/** Slot the record at the head of the queue is being written to, and how many of its bytes are done. */
+static uint8_t NextSlot;
+static uint8_t WriteOffset;
+
+/** Number of valid records in the EEPROM ring, up to JOURNAL_RECORDS. */
+static uint8_t StoredRecords;
+
+
+/** Calculate the CRC protecting a record. */
+static uint16_t Journal_CalculateCRC(const Journal_Record_t* Record)
+{
+	const uint8_t* Data = (const uint8_t*)Record;
+	uint16_t       CRC  = 0xFFFF;
+
+	for (uint8_t i = 0; i < offsetof(Journal_Record_t, CRC); i++)
+	  CRC = _crc_ccitt_update(CRC, Data[i]);
+
+	return CRC;
+}
+
+
+/** Read the record from the given slot, returning true if it is intact. */
+static bool Journal_ReadSlot(const uint8_t Slot, Journal_Record_t* const Record)
+{
+	eeprom_read_block(Record, &JournalRecords[Slot], sizeof(Journal_Record_t));
+
+	// erased EEPROM reads as 0xFF, which is never a valid event
+	return (Record->Event != 0xFF) && (Record->CRC == Journal_CalculateCRC(Record));
+}
+
+
+/** Scan the EEPROM ring to find where the last run left off. This must be called once at startup
+ *  before any records are appended.
+ */
+void Journal_Init(void)
+{
+	Journal_Record_t Record;
+	uint16_t         NewestSequence = 0;
+	bool             Found          = false;
+
+	StoredRecords = 0;
+	NextSlot      = 0;
+	WriteOffset   = 0;
+
+	for (uint8_t Slot = 0; Slot < JOURNAL_RECORDS; Slot++)
+	{
+		if (!(Journal_ReadSlot(Slot, &Record)))
+		  continue;
+
+		StoredRecords++;
+
+		// the ring never holds more than JOURNAL_RECORDS consecutive sequence numbers, so a
+		// wrapping comparison always finds the newest
+		if (!(Found) || ((int16_t)(Record.Sequence - NewestSequence) > 0))
+		{
+			Found          = true;
+			NewestSequence = Record.Sequence;
+			NextSlot       = (Slot + 1) % JOURNAL_RECORDS;
+		}
+	}
+
+	NextSequence = (Found) ? (NewestSequence + 1) : 0;
+}
+
+
+/** Queue a record for writing to the journal. This is safe to call from an ISR. If the queue is
+ *  full the record is dropped, and the loss is recorded once there is space again.
+ */
+void Journal_Append(const uint8_t Event, const uint8_t Argument)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (QueueCount == JOURNAL_QUEUE_LENGTH)
+		{
+			if (DroppedRecords != 0xFF)
+			  DroppedRecords++;
+
+			return;
+		}
+
+		Journal_Record_t* Record = &QueuedRecords[QueueIn];
+
+		Record->Sequence = NextSequence++;
+		Record->Event    = Event;
+		Record->Argument = Argument;
+		Record->CRC      = Journal_CalculateCRC(Record);
+
+		QueueIn = (QueueIn + 1) & (JOURNAL_QUEUE_LENGTH - 1);
+		QueueCount++;
+	}
+}
+
+
+/** Task to write queued records to the EEPROM. Each call writes at most one byte, and returns
+ *  immediately if the EEPROM is still busy with the previous one.
+ */
+void Journal_Task(void)
+{
+	if (DroppedRecords && (QueueCount < JOURNAL_QUEUE_LENGTH))
+	{
+		uint8_t Dropped;
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			Dropped        = DroppedRecords;
+			DroppedRecords = 0;
+		}
+
+		Journal_Append(JOURNAL_EVENT_DROPPED, Dropped);
+	}
+
+	if (!(QueueCount) || !(eeprom_is_ready()))
+	  return;
+
+	uint8_t* Address = (uint8_t*)&JournalRecords[NextSlot] + WriteOffset;
+	uint8_t  Data    = ((uint8_t*)&QueuedRecords[QueueOut])[WriteOffset];
+
+	// skip bytes which already hold the right value, to save wear
+	if (eeprom_read_byte(Address) != Data)
+	  eeprom_write_byte(Address, Data);
+
+	if (++WriteOffset < sizeof(Journal_Record_t))
+	  return;
+
+	// the CRC has been written, so the record is committed
+	WriteOffset = 0;
+	NextSlot    = (NextSlot + 1) % JOURNAL_RECORDS;
+
+	if (StoredRecords < JOURNAL_RECORDS)
+	  StoredRecords++;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		QueueOut = (QueueOut + 1) & (JOURNAL_QUEUE_LENGTH - 1);
+		QueueCount--;
+	}
+}
+
+
+/** Read a committed record from the journal, where an Age of 0 is the most recently written record.
+ *  Returns false if there is no such record, or if it has been corrupted. Records still queued in
+ *  RAM are not visible. This reads the EEPROM, so it will wait if a write is in progress.
+ */
+bool Journal_ReadRecent(const uint8_t Age, Journal_Record_t* const Record)
+{
+	if (Age >= StoredRecords)
+	  return false;
+
+	uint8_t Slot = (NextSlot + JOURNAL_RECORDS - 1 - Age) % JOURNAL_RECORDS;
+
+	// the slot being written can't be read until the record is finished
+	if ((Slot == NextSlot) && WriteOffset)
+	  return false;
+
+	return Journal_ReadSlot(Slot, Record);
+}
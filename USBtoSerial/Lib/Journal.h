@@ -0,0 +1,59 @@
+/** \file
+ *
+ *  Header file for Journal.c.
+ *
+ *  The journal is an append-only ring of fixed size records in EEPROM, used to remember resets,
+ *  watchdog firings and power transitions across power cycles. Records are written to successive
+ *  slots, so every slot wears at the same rate. Each record carries a sequence number and a CRC
+ *  which is written last, so a record torn by a power failure is simply ignored when the journal
+ *  is scanned at startup.
+ */
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/eeprom.h>
+		#include <util/atomic.h>
+		#include <util/crc16.h>
+		#include <stddef.h>
+		#include <stdbool.h>
+
+	/* Macros: */
+		/** Number of record slots in the EEPROM ring. */
+		#define JOURNAL_RECORDS           128
+
+		/** Number of records which can be queued in RAM waiting to be written to the EEPROM. Must be a
+		 *  power of two.
+		 */
+		#define JOURNAL_QUEUE_LENGTH      8
+
+	/* Type Defines: */
+		/** Type define for a single journal record, as stored in the EEPROM. */
+		typedef struct
+		{
+			uint16_t Sequence; /**< Sequence number of the record, incremented for every record appended */
+			uint8_t  Event; /**< Event type, a value from the Journal_Events_t enum */
+			uint8_t  Argument; /**< Event specific argument */
+			uint16_t CRC; /**< CRC-CCITT of the preceding fields, written last */
+		} Journal_Record_t;
+
+	/* Enums: */
+		/** Enum for the types of event recorded in the journal. */
+		enum Journal_Events_t
+		{
+			JOURNAL_EVENT_RESET           = 1, /**< The AVR has started, argument is the MCUSR reset cause flags */
+			JOURNAL_EVENT_BEAGLE_WATCHDOG = 2, /**< The Beagleboard watchdog expired */
+			JOURNAL_EVENT_POWER_ON        = 3, /**< Power turned on, argument is the power port pin */
+			JOURNAL_EVENT_POWER_OFF       = 4, /**< Power turned off, argument is the power port pin */
+			JOURNAL_EVENT_DROPPED         = 5, /**< The RAM queue overflowed, argument is the number of records lost */
+		};
+
+	/* Function Prototypes: */
+		void Journal_Init(void);
+		void Journal_Append(const uint8_t Event, const uint8_t Argument);
+		void Journal_Task(void);
+		bool Journal_ReadRecent(const uint8_t Age, Journal_Record_t* const Record);
+
+#endif
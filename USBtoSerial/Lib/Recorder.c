@@ -0,0 +1,470 @@
+/** \file
+ *
+ *  Append-only sample recorder for USB mass storage. See Recorder.h for an overview.
+ *
+ *  Recorder_Append() copies samples into the block being filled and only touches the ring's counts
+ *  with interrupts disabled, so it can be called from an ISR (but only from one place). Recorder_Task()
+ *  is called from the main loop, and once RECORDER_WRITE_BLOCKS blocks are full it writes every full
+ *  block in one command, passing each pipe bank straight from the ring. Each block is handed back
+ *  to the ring as soon as its last byte is in the pipe, so Recorder_Append() can refill it while the
+ *  rest of the command is still going.
+ */
+
+#include "Recorder.h"
+
+#if (RECORDER_RING_BLOCKS & (RECORDER_RING_BLOCKS - 1)) || (RECORDER_WRITE_BLOCKS > RECORDER_RING_BLOCKS)
+	#error RECORDER_RING_BLOCKS must be a power of two, and no less than RECORDER_WRITE_BLOCKS.
+#endif
+
+/** FAT32 cluster numbers at or above this mark the end of a cluster chain. */
+#define FAT32_END_OF_CHAIN        0x0FFFFFF8UL
+
+/** Ring of sample blocks. The full blocks start at WriteIndex, and the block after them is being filled. */
+static uint8_t          Ring[RECORDER_RING_BLOCKS][RECORDER_BLOCK_SIZE];
+static uint8_t          WriteIndex;
+static volatile uint8_t FullBlocks;
+
+/** Bytes in the block being filled, and bytes of the block at WriteIndex already passed to the pipe. */
+static uint16_t FillOffset;
+static uint16_t StreamOffset;
+
+/** Device being recorded to. */
+static USB_ClassInfo_MS_Host_t* MSInterface;
+static uint8_t                  MSLUNIndex;
+
+/** Layout of the FAT32 volume holding the recording file, in device blocks. */
+static struct
+{
+	uint32_t FATStart;
+	uint32_t DataStart;
+	uint8_t  BlocksPerCluster;
+} Volume;
+
+/** Device block held in Ring[0] while the volume is being searched, so that runs of lookups in the
+ *  same FAT block only read it once.
+ */
+static uint32_t LoadedBlock;
+
+/** The recording file's header block, the next block to write and the block after the file's last. */
+static uint32_t HeaderBlock, NextBlock, EndBlock;
+
+static volatile bool     Recording;
+static volatile uint32_t DataBytes, OverrunBytes;
+static uint32_t          BlocksWritten, WriteCommands;
+static uint32_t          StartTicks;
+
+
+/** Read a little endian 16-bit value from a block. */
+static uint16_t Recorder_Read16(const uint8_t* Data)
+{
+	return ((uint16_t)Data[1] << 8) | Data[0];
+}
+
+
+/** Read a little endian 32-bit value from a block. */
+static uint32_t Recorder_Read32(const uint8_t* Data)
+{
+	return ((uint32_t)Recorder_Read16(&Data[2]) << 16) | Recorder_Read16(Data);
+}
+
+
+/** Read a device block into Ring[0], unless it is already there. */
+static uint8_t Recorder_ReadBlock(const uint32_t BlockAddress)
+{
+	if (BlockAddress == LoadedBlock)
+	  return RECORDER_ERROR_NoError;
+
+	LoadedBlock = 0xFFFFFFFF;
+
+	if (MS_Host_ReadDeviceBlocks(MSInterface, MSLUNIndex, BlockAddress, 1, RECORDER_BLOCK_SIZE,
+	                             Ring[0]) != PIPE_RWSTREAM_NoError)
+	{
+		return RECORDER_ERROR_DeviceError;
+	}
+
+	LoadedBlock = BlockAddress;
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Returns true if the block in Ring[0] is the boot sector of a FAT32 volume with the recorder's block size. */
+static bool Recorder_IsFAT32BootSector(void)
+{
+	const uint8_t* Block = Ring[0];
+
+	// FAT32 is told apart from FAT12/16 by its empty fixed root directory and 16-bit FAT size fields
+	return (Block[510] == 0x55) && (Block[511] == 0xAA) &&
+	       (Recorder_Read16(&Block[11]) == RECORDER_BLOCK_SIZE) && Block[13] && Block[16] &&
+	       !(Recorder_Read16(&Block[17])) && !(Recorder_Read16(&Block[22])) && Recorder_Read32(&Block[36]);
+}
+
+
+/** Returns the first device block of a cluster. */
+static uint32_t Recorder_ClusterBlock(const uint32_t Cluster)
+{
+	return Volume.DataStart + ((Cluster - 2) * Volume.BlocksPerCluster);
+}
+
+
+/** Look up the cluster after the given one in the FAT. */
+static uint8_t Recorder_NextCluster(uint32_t* const Cluster)
+{
+	uint8_t ErrorCode;
+
+	if ((ErrorCode = Recorder_ReadBlock(Volume.FATStart + (*Cluster / (RECORDER_BLOCK_SIZE / 4)))) != RECORDER_ERROR_NoError)
+	  return ErrorCode;
+
+	*Cluster = Recorder_Read32(&Ring[0][(*Cluster % (RECORDER_BLOCK_SIZE / 4)) * 4]) & 0x0FFFFFFF;
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Find the device's FAT32 volume, either at the start of the device or in the first partition of
+ *  its MBR, and fill in Volume. Returns the volume's root directory cluster through RootCluster.
+ */
+static uint8_t Recorder_OpenVolume(uint32_t* const RootCluster)
+{
+	uint32_t VolumeStart = 0;
+	uint8_t  ErrorCode;
+
+	if ((ErrorCode = Recorder_ReadBlock(0)) != RECORDER_ERROR_NoError)
+	  return ErrorCode;
+
+	if (!(Recorder_IsFAT32BootSector()))
+	{
+		if ((Ring[0][510] != 0x55) || (Ring[0][511] != 0xAA))
+		  return RECORDER_ERROR_NoFAT32Volume;
+
+		VolumeStart = Recorder_Read32(&Ring[0][446 + 8]);
+
+		if ((ErrorCode = Recorder_ReadBlock(VolumeStart)) != RECORDER_ERROR_NoError)
+		  return ErrorCode;
+
+		if (!(Recorder_IsFAT32BootSector()))
+		  return RECORDER_ERROR_NoFAT32Volume;
+	}
+
+	Volume.BlocksPerCluster = Ring[0][13];
+	Volume.FATStart         = VolumeStart + Recorder_Read16(&Ring[0][14]);
+	Volume.DataStart        = Volume.FATStart + (Ring[0][16] * Recorder_Read32(&Ring[0][36]));
+	*RootCluster            = Recorder_Read32(&Ring[0][44]);
+
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Search the root directory for RECORDER_FILE_NAME, returning its first cluster and size. */
+static uint8_t Recorder_FindFile(uint32_t Cluster, uint32_t* const FileCluster, uint32_t* const FileSize)
+{
+	uint8_t ErrorCode;
+
+	while ((Cluster >= 2) && (Cluster < FAT32_END_OF_CHAIN))
+	{
+		for (uint8_t BlockInCluster = 0; BlockInCluster < Volume.BlocksPerCluster; BlockInCluster++)
+		{
+			if ((ErrorCode = Recorder_ReadBlock(Recorder_ClusterBlock(Cluster) + BlockInCluster)) != RECORDER_ERROR_NoError)
+			  return ErrorCode;
+
+			for (uint16_t Offset = 0; Offset < RECORDER_BLOCK_SIZE; Offset += 32)
+			{
+				const uint8_t* Entry = &Ring[0][Offset];
+
+				// a free entry marks the end of the directory
+				if (!(Entry[0]))
+				  return RECORDER_ERROR_FileNotFound;
+
+				// skip deleted entries, long name fragments, volume labels and subdirectories
+				if ((Entry[0] == 0xE5) || (Entry[11] & 0x18) || ((Entry[11] & 0x3F) == 0x0F))
+				  continue;
+
+				if (!(memcmp(Entry, RECORDER_FILE_NAME, 11)))
+				{
+					*FileCluster = ((uint32_t)Recorder_Read16(&Entry[20]) << 16) | Recorder_Read16(&Entry[26]);
+					*FileSize    = Recorder_Read32(&Entry[28]);
+					return RECORDER_ERROR_NoError;
+				}
+			}
+		}
+
+		if ((ErrorCode = Recorder_NextCluster(&Cluster)) != RECORDER_ERROR_NoError)
+		  return ErrorCode;
+	}
+
+	return RECORDER_ERROR_FileNotFound;
+}
+
+
+/** Check that the given number of clusters from FirstCluster are one run in the FAT. */
+static uint8_t Recorder_CheckContiguous(const uint32_t FirstCluster, const uint32_t Clusters)
+{
+	uint32_t Cluster = FirstCluster;
+	uint8_t  ErrorCode;
+
+	for (uint32_t ClusterIndex = 1; ClusterIndex < Clusters; ClusterIndex++)
+	{
+		uint32_t Expected = (Cluster + 1);
+
+		if ((ErrorCode = Recorder_NextCluster(&Cluster)) != RECORDER_ERROR_NoError)
+		  return ErrorCode;
+
+		if (Cluster != Expected)
+		  return RECORDER_ERROR_FileFragmented;
+	}
+
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Write the header block, recording how much of the file holds sample data. */
+static uint8_t Recorder_WriteHeader(const uint32_t RecordedBytes)
+{
+	Recorder_Header_t* Header = (Recorder_Header_t*)Ring[0];
+
+	// the ring is empty whenever the header is written, so its first block is free to build it in
+	memset(Ring[0], 0x00, RECORDER_BLOCK_SIZE);
+	memcpy(Header->Signature, RECORDER_SIGNATURE, sizeof(Header->Signature));
+	Header->DataBytes    = RecordedBytes;
+	Header->OverrunBytes = OverrunBytes;
+
+	if (MS_Host_WriteDeviceBlocks(MSInterface, MSLUNIndex, HeaderBlock, 1, RECORDER_BLOCK_SIZE,
+	                              Ring[0]) != PIPE_RWSTREAM_NoError)
+	{
+		return RECORDER_ERROR_DeviceError;
+	}
+
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Block stream callback, which passes each bank of the WRITE command's data straight from the ring. */
+static bool Recorder_StreamCallback(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint16_t BankBytes)
+{
+	uint16_t BytesRem = BankBytes;
+
+	while (BytesRem)
+	{
+		uint16_t ChunkBytes = (RECORDER_BLOCK_SIZE - StreamOffset);
+
+		if (ChunkBytes > BytesRem)
+		  ChunkBytes = BytesRem;
+
+		if (Pipe_Write_Stream_LE(&Ring[WriteIndex][StreamOffset], ChunkBytes, NO_STREAM_CALLBACK) != PIPE_RWSTREAM_NoError)
+		  return false;
+
+		BytesRem     -= ChunkBytes;
+		StreamOffset += ChunkBytes;
+
+		if (StreamOffset == RECORDER_BLOCK_SIZE)
+		{
+			StreamOffset = 0;
+
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				WriteIndex = ((WriteIndex + 1) & (RECORDER_RING_BLOCKS - 1));
+				FullBlocks--;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/** Write the given number of full blocks from the ring in one command, as far as the file has room. */
+static uint8_t Recorder_WriteBlocks(uint8_t Blocks)
+{
+	if (Blocks > (EndBlock - NextBlock))
+	  Blocks = (EndBlock - NextBlock);
+
+	if (!(Blocks))
+	  return RECORDER_ERROR_NoError;
+
+	StreamOffset = 0;
+	WriteCommands++;
+
+	if (MS_Host_WriteDeviceBlockStream(MSInterface, MSLUNIndex, NextBlock, Blocks, RECORDER_BLOCK_SIZE,
+	                                   Recorder_StreamCallback) != PIPE_RWSTREAM_NoError)
+	{
+		return RECORDER_ERROR_DeviceError;
+	}
+
+	NextBlock     += Blocks;
+	BlocksWritten += Blocks;
+
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Find the recording file on the given device and start recording into it, from its second block.
+ *  The device must be configured, and hold a FAT32 volume with a RECORDER_FILE_NAME file in its root
+ *  directory whose clusters are all in one run.
+ */
+uint8_t Recorder_Start(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex)
+{
+	uint32_t RootCluster, FileCluster, FileSize;
+	uint8_t  ErrorCode;
+
+	Recording   = false;
+	MSInterface = MSInterfaceInfo;
+	MSLUNIndex  = LUNIndex;
+	LoadedBlock = 0xFFFFFFFF;
+
+	if (((ErrorCode = Recorder_OpenVolume(&RootCluster)) != RECORDER_ERROR_NoError) ||
+	    ((ErrorCode = Recorder_FindFile(RootCluster, &FileCluster, &FileSize)) != RECORDER_ERROR_NoError))
+	{
+		return ErrorCode;
+	}
+
+	uint32_t ClusterBytes = ((uint32_t)Volume.BlocksPerCluster * RECORDER_BLOCK_SIZE);
+
+	// the file needs room for the header block and at least one block of samples
+	if ((FileCluster < 2) || (FileSize < (2 * RECORDER_BLOCK_SIZE)))
+	  return RECORDER_ERROR_FileFragmented;
+
+	if ((ErrorCode = Recorder_CheckContiguous(FileCluster, (FileSize + ClusterBytes - 1) / ClusterBytes)) != RECORDER_ERROR_NoError)
+	  return ErrorCode;
+
+	HeaderBlock = Recorder_ClusterBlock(FileCluster);
+	NextBlock   = (HeaderBlock + 1);
+	EndBlock    = (HeaderBlock + (FileSize / RECORDER_BLOCK_SIZE));
+
+	WriteIndex    = 0;
+	FullBlocks    = 0;
+	FillOffset    = 0;
+	DataBytes     = 0;
+	OverrunBytes  = 0;
+	BlocksWritten = 0;
+	WriteCommands = 0;
+
+	// a header from an earlier recording is cleared first, so it can't be taken for this one's
+	if ((ErrorCode = Recorder_WriteHeader(0)) != RECORDER_ERROR_NoError)
+	  return ErrorCode;
+
+	StartTicks = TimerWheel_Uptime();
+	Recording  = true;
+
+	return RECORDER_ERROR_NoError;
+}
+
+
+/** Stop recording, write out the samples left in the ring (padding the last block with zeroes) and
+ *  write the header block.
+ */
+uint8_t Recorder_Stop(void)
+{
+	uint8_t ErrorCode;
+
+	if (!(Recording))
+	  return RECORDER_ERROR_NotRecording;
+
+	Recording = false;
+
+	if (FillOffset)
+	{
+		memset(&Ring[(WriteIndex + FullBlocks) & (RECORDER_RING_BLOCKS - 1)][FillOffset], 0x00,
+		       RECORDER_BLOCK_SIZE - FillOffset);
+
+		FillOffset = 0;
+		FullBlocks++;
+	}
+
+	if ((ErrorCode = Recorder_WriteBlocks(FullBlocks)) != RECORDER_ERROR_NoError)
+	  return ErrorCode;
+
+	// samples which didn't fit in the file are left in the ring, and aren't counted in the header
+	uint32_t FileDataBytes = ((NextBlock - HeaderBlock - 1) * RECORDER_BLOCK_SIZE);
+
+	WriteIndex = 0;
+	FullBlocks = 0;
+
+	return Recorder_WriteHeader((DataBytes < FileDataBytes) ? DataBytes : FileDataBytes);
+}
+
+
+/** Returns true if the recorder is accepting samples. Recording stops if a write to the device fails. */
+bool Recorder_IsRecording(void)
+{
+	return Recording;
+}
+
+
+/** Append samples to the recording. Samples which arrive while the ring is full are dropped and
+ *  counted as overruns.
+ */
+void Recorder_Append(const uint8_t* Data, uint16_t Length)
+{
+	if (!(Recording))
+	  return;
+
+	while (Length)
+	{
+		uint8_t FillIndex;
+		bool    RingFull;
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			RingFull  = (FullBlocks == RECORDER_RING_BLOCKS);
+			FillIndex = ((WriteIndex + FullBlocks) & (RECORDER_RING_BLOCKS - 1));
+		}
+
+		if (RingFull)
+		{
+			OverrunBytes += Length;
+			return;
+		}
+
+		uint16_t ChunkBytes = (RECORDER_BLOCK_SIZE - FillOffset);
+
+		if (ChunkBytes > Length)
+		  ChunkBytes = Length;
+
+		memcpy(&Ring[FillIndex][FillOffset], Data, ChunkBytes);
+
+		Data       += ChunkBytes;
+		Length     -= ChunkBytes;
+		FillOffset += ChunkBytes;
+		DataBytes  += ChunkBytes;
+
+		if (FillOffset == RECORDER_BLOCK_SIZE)
+		{
+			FillOffset = 0;
+
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				FullBlocks++;
+			}
+		}
+	}
+}
+
+
+/** Task to write full blocks to the device, once enough have built up. */
+void Recorder_Task(void)
+{
+	if (!(Recording) || (FullBlocks < RECORDER_WRITE_BLOCKS))
+	  return;
+
+	if (Recorder_WriteBlocks(FullBlocks) != RECORDER_ERROR_NoError)
+	  Recording = false;
+}
+
+
+/** Fill in the recorder's statistics. The bandwidth is the rate blocks have been written at since
+ *  recording started, so it is the sustained write bandwidth of the device whenever samples arrive
+ *  faster than they can be written.
+ */
+void Recorder_GetStats(Recorder_Stats_t* const Stats)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Stats->DataBytes    = DataBytes;
+		Stats->OverrunBytes = OverrunBytes;
+	}
+
+	uint32_t Ticks = (TimerWheel_Uptime() - StartTicks);
+
+	Stats->BlocksWritten  = BlocksWritten;
+	Stats->WriteCommands  = WriteCommands;
+	Stats->BlocksLeft     = (EndBlock - NextBlock);
+	Stats->BytesPerSecond = (Ticks) ? ((BlocksWritten * TIMERWHEEL_TICK_HZ / Ticks) * RECORDER_BLOCK_SIZE) : 0;
+}
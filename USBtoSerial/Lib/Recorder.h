@@ -0,0 +1,91 @@
+/** \file
+ *
+ *  Header file for Recorder.c.
+ *
+ *  The recorder streams sample data to a USB mass storage device on the AVR's host port, so that
+ *  the board can record without the Beagleboard. Samples are appended to a ring of blocks in RAM,
+ *  from an ISR if need be, and Recorder_Task() writes the full blocks out with multi-block WRITE (10)
+ *  commands.
+ *
+ *  The recording goes into a file which has been preallocated on a FAT32 volume, in one run of
+ *  clusters (for example by copying a file of zeroes onto a freshly formatted stick). The file is
+ *  found when recording starts, and from then on only its data blocks are written; the FAT and the
+ *  directory are never changed, so removing the stick part way through a recording can't damage the
+ *  volume. The first block of the file holds a Recorder_Header_t giving the length of the recording,
+ *  which is written when recording stops.
+ *
+ *  The recorder needs the LUFA Mass Storage host class driver, so it is only for host mode builds of
+ *  the firmware (the console bridge build is device only).
+ */
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+	/* Includes: */
+		#include <util/atomic.h>
+		#include <string.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Drivers/USB/Class/MassStorage.h>
+
+		#include "TimerWheel.h"
+
+	/* Macros: */
+		/** Bytes in each block of the ring and of the device, which must match the device's block size. */
+		#define RECORDER_BLOCK_SIZE       512
+
+		/** Number of blocks in the ring. Must be a power of two. */
+		#define RECORDER_RING_BLOCKS      4
+
+		/** Number of full blocks Recorder_Task() waits for before writing, so that each WRITE command
+		 *  moves several blocks. Must be no more than RECORDER_RING_BLOCKS.
+		 */
+		#define RECORDER_WRITE_BLOCKS     2
+
+		/** Name of the preallocated file in the volume's root directory, in its 8.3 directory form. */
+		#define RECORDER_FILE_NAME        "RECORD  RAW"
+
+		/** Signature at the start of the file's header block. */
+		#define RECORDER_SIGNATURE        "AVRREC01"
+
+	/* Type Defines: */
+		/** Type define for the header in the first block of the recording file. */
+		typedef struct
+		{
+			char     Signature[8]; /**< RECORDER_SIGNATURE, without a terminator */
+			uint32_t DataBytes; /**< Bytes of sample data recorded, starting in the file's second block */
+			uint32_t OverrunBytes; /**< Bytes of sample data dropped because the ring was full */
+		} Recorder_Header_t;
+
+		/** Type define for the recorder's statistics, filled by Recorder_GetStats(). */
+		typedef struct
+		{
+			uint32_t DataBytes; /**< Bytes of sample data accepted since recording started */
+			uint32_t OverrunBytes; /**< Bytes of sample data dropped because the ring was full */
+			uint32_t BlocksWritten; /**< Blocks written to the device */
+			uint32_t WriteCommands; /**< WRITE commands issued to the device */
+			uint32_t BlocksLeft; /**< Blocks of the file not yet written */
+			uint32_t BytesPerSecond; /**< Sustained write bandwidth since recording started */
+		} Recorder_Stats_t;
+
+	/* Enums: */
+		/** Enum for the error codes returned by Recorder_Start() and Recorder_Stop(). */
+		enum Recorder_ErrorCodes_t
+		{
+			RECORDER_ERROR_NoError        = 0, /**< No error */
+			RECORDER_ERROR_DeviceError    = 1, /**< A command to the device failed */
+			RECORDER_ERROR_NoFAT32Volume  = 2, /**< The device doesn't hold a FAT32 volume with the right block size */
+			RECORDER_ERROR_FileNotFound   = 3, /**< RECORDER_FILE_NAME isn't in the root directory */
+			RECORDER_ERROR_FileFragmented = 4, /**< The file's clusters aren't one run, or it is too short */
+			RECORDER_ERROR_NotRecording   = 5, /**< Recorder_Stop() was called while not recording */
+		};
+
+	/* Function Prototypes: */
+		uint8_t Recorder_Start(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo, const uint8_t LUNIndex);
+		uint8_t Recorder_Stop(void);
+		bool    Recorder_IsRecording(void);
+		void    Recorder_Append(const uint8_t* Data, uint16_t Length);
+		void    Recorder_Task(void);
+		void    Recorder_GetStats(Recorder_Stats_t* const Stats);
+
+#endif
@@ -0,0 +1,217 @@
+/** \file
+ *
+ *  Hashed timer wheel. See TimerWheel.h for an overview.
+ *
+ *  The Timer0 ISR only counts ticks. TimerWheel_Task() is called from the main loop, advances the
+ *  wheel once for each tick counted, and runs the callbacks of the timers which expire, so callbacks
+ *  can take as long as they like without holding up interrupts. Timers can be started and stopped
+ *  from an ISR as well as from the main loop.
+ */
+
+#include "TimerWheel.h"
+
+#if (TIMERWHEEL_SLOTS & (TIMERWHEEL_SLOTS - 1)) || (TIMERWHEEL_SLOTS > 256)
+	#error TIMERWHEEL_SLOTS must be a power of two no larger than 256.
+#endif
+
+/** Lists of the timers waiting in each slot. */
+static TimerWheel_Timer_t* Slots[TIMERWHEEL_SLOTS];
+
+/** Slot for the tick most recently processed by TimerWheel_Task(). */
+static uint8_t Position;
+
+/** Ticks counted by the ISR but not yet processed by TimerWheel_Task(). */
+static volatile uint8_t PendingTicks;
+
+/** Ticks processed since TimerWheel_Init(). */
+static uint32_t Uptime;
+
+
+/** Remove a timer from whichever list it is on. Must be called with interrupts disabled. */
+static void TimerWheel_Unlink(TimerWheel_Timer_t* const Timer)
+{
+	if (!(Timer->PPrev))
+	  return;
+
+	*Timer->PPrev = Timer->Next;
+
+	if (Timer->Next)
+	  Timer->Next->PPrev = Timer->PPrev;
+
+	Timer->PPrev = NULL;
+}
+
+
+/** Add a timer to the front of a list. Must be called with interrupts disabled. */
+static void TimerWheel_Link(TimerWheel_Timer_t** const Head, TimerWheel_Timer_t* const Timer)
+{
+	Timer->Next  = *Head;
+	Timer->PPrev = Head;
+
+	if (*Head)
+	  (*Head)->PPrev = &Timer->Next;
+
+	*Head = Timer;
+}
+
+
+/** Start the Timer0 tick. This must be called once at startup, before interrupts are enabled. */
+void TimerWheel_Init(void)
+{
+	Position     = 0;
+	PendingTicks = 0;
+	Uptime       = 0;
+
+	// 1 tick = prescaler * (1 + OCR0A) / F_CPU
+	OCR0A  = (uint8_t)(F_CPU / 256 / TIMERWHEEL_TICK_HZ - 1);
+	TCCR0A = (1 << WGM01); // Clear-timer-on-compare-match-OCR0A (CTC) mode
+	TCCR0B = (1 << CS02);  // prescaler divides by 256
+	TIMSK0 |= (1 << OCIE0A);
+}
+
+
+/** Start (or restart) a timer, so that its callback is run after the given number of ticks. A
+ *  timer which is already pending is rescheduled. A delay of 0 is taken as 1 tick.
+ */
+void TimerWheel_Start(TimerWheel_Timer_t* const Timer, const uint32_t Ticks)
+{
+	uint32_t Delay = (Ticks) ? Ticks : 1;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TimerWheel_Unlink(Timer);
+
+		// the slot after Position is the next one processed, so a timer due in n ticks (where n is
+		// at most TIMERWHEEL_SLOTS) is reached on the first visit to its slot
+		Timer->Slot   = (Position + Delay) & (TIMERWHEEL_SLOTS - 1);
+		Timer->Rounds = (Delay - 1) / TIMERWHEEL_SLOTS;
+
+		TimerWheel_Link(&Slots[Timer->Slot], Timer);
+	}
+}
+
+
+/** Stop a timer, so that its callback won't be run. Stopping a timer which isn't pending does nothing. */
+void TimerWheel_Stop(TimerWheel_Timer_t* const Timer)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TimerWheel_Unlink(Timer);
+	}
+}
+
+
+/** Returns true if the timer has been started and hasn't expired or been stopped yet. */
+bool TimerWheel_IsPending(const TimerWheel_Timer_t* const Timer)
+{
+	return (Timer->PPrev != NULL);
+}
+
+
+/** Returns the number of ticks until a pending timer expires, or 0 if it isn't pending. Ticks counted
+ *  by the ISR but not yet processed by TimerWheel_Task() aren't taken into account.
+ */
+uint32_t TimerWheel_Remaining(const TimerWheel_Timer_t* const Timer)
+{
+	uint32_t Remaining = 0;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (Timer->PPrev)
+		{
+			Remaining = (Timer->Rounds * TIMERWHEEL_SLOTS)
+			          + ((uint8_t)(Timer->Slot - Position - 1) & (TIMERWHEEL_SLOTS - 1)) + 1;
+		}
+	}
+
+	return Remaining;
+}
+
+
+/** Returns true if there are ticks waiting for TimerWheel_Task(), so that the main loop knows not
+ *  to go to sleep.
+ */
+bool TimerWheel_TicksPending(void)
+{
+	return (PendingTicks != 0);
+}
+
+
+/** Returns the number of ticks processed since the wheel was started. */
+uint32_t TimerWheel_Uptime(void)
+{
+	return Uptime;
+}
+
+
+/** Task to advance the wheel by the ticks counted since the last call, running the callbacks of any
+ *  timers which expire. Periodic timers are restarted before their callback is run, so the callback
+ *  can stop them.
+ */
+void TimerWheel_Task(void)
+{
+	while (PendingTicks)
+	{
+		TimerWheel_Timer_t* Expired = NULL;
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			PendingTicks--;
+			Uptime++;
+			Position = (Position + 1) & (TIMERWHEEL_SLOTS - 1);
+
+			TimerWheel_Timer_t* Timer = Slots[Position];
+
+			// move the timers which are due onto a list of their own, so that the callbacks can be
+			// run with interrupts enabled and can start and stop any timer (including expired ones)
+			while (Timer)
+			{
+				TimerWheel_Timer_t* Next = Timer->Next;
+
+				if (Timer->Rounds)
+				{
+					Timer->Rounds--;
+				}
+				else
+				{
+					TimerWheel_Unlink(Timer);
+					TimerWheel_Link(&Expired, Timer);
+				}
+
+				Timer = Next;
+			}
+		}
+
+		for (;;)
+		{
+			TimerWheel_Timer_t* Timer;
+
+			// an ISR may stop or restart a timer on the expired list, so it is only read atomically
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				Timer = Expired;
+
+				if (Timer)
+				  TimerWheel_Unlink(Timer);
+			}
+
+			if (!(Timer))
+			  break;
+
+			if (Timer->Period)
+			  TimerWheel_Start(Timer, Timer->Period);
+
+			Timer->Callback(Timer);
+		}
+	}
+}
+
+
+/** ISR for the timer wheel tick. This only counts the tick; the work is done by TimerWheel_Task(). If
+ *  the main loop falls a long way behind, ticks are lost rather than the count wrapping.
+ */
+ISR(TIMER0_COMPA_vect, ISR_BLOCK)
+{
+	if (PendingTicks != 0xFF)
+	  PendingTicks++;
+}
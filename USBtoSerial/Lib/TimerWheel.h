@@ -0,0 +1,59 @@
+/** \file
+ *
+ *  Header file for TimerWheel.c.
+ *
+ *  The timer wheel runs any number of software timers from a single hardware tick (Timer0). Timers
+ *  are hashed into a ring of slots by their expiry tick, and each slot holds a list of the timers
+ *  which fall due on it, along with how many more times round the ring they have to wait. Starting
+ *  or stopping a timer takes constant time, and each tick only looks at the timers in one slot.
+ *
+ *  Timers are allocated by the caller (usually statically), and only need their Callback set before
+ *  they are first started.
+ */
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/interrupt.h>
+		#include <util/atomic.h>
+		#include <stddef.h>
+		#include <stdbool.h>
+
+	/* Macros: */
+		/** Rate of the timer wheel tick, in Hz. The tick comes from Timer0 in CTC mode, with the clock
+		 *  divided by 256, so this must divide F_CPU / 256 to give an exact rate.
+		 */
+		#define TIMERWHEEL_TICK_HZ        250
+
+		/** Number of slots in the wheel. Must be a power of two no larger than 256. */
+		#define TIMERWHEEL_SLOTS          64
+
+		/** Convert a number of seconds to timer wheel ticks. */
+		#define TIMERWHEEL_SECONDS(s)     ((uint32_t)(s) * TIMERWHEEL_TICK_HZ)
+
+	/* Type Defines: */
+		/** Type define for a software timer. The list fields are private to the timer wheel. */
+		typedef struct TimerWheel_Timer
+		{
+			struct TimerWheel_Timer*  Next; /**< Next timer in the same slot */
+			struct TimerWheel_Timer** PPrev; /**< Pointer which points to this timer, or NULL if not pending */
+			uint32_t                  Rounds; /**< Times round the wheel left to wait before expiring */
+			uint8_t                   Slot; /**< Slot the timer is waiting in */
+			uint16_t                  Period; /**< If non-zero, the timer is restarted for this many ticks when it expires */
+			void                    (*Callback)(struct TimerWheel_Timer* const Timer); /**< Called from TimerWheel_Task() on expiry */
+			uint8_t                   Argument; /**< Free for use by the callback */
+		} TimerWheel_Timer_t;
+
+	/* Function Prototypes: */
+		void     TimerWheel_Init(void);
+		void     TimerWheel_Start(TimerWheel_Timer_t* const Timer, const uint32_t Ticks);
+		void     TimerWheel_Stop(TimerWheel_Timer_t* const Timer);
+		bool     TimerWheel_IsPending(const TimerWheel_Timer_t* const Timer);
+		uint32_t TimerWheel_Remaining(const TimerWheel_Timer_t* const Timer);
+		bool     TimerWheel_TicksPending(void);
+		uint32_t TimerWheel_Uptime(void);
+		void     TimerWheel_Task(void);
+
+#endif
@@ -88,6 +88,17 @@
 static void toggle_e(void);
 #endif
 
+/*
+** framebuffer
+** Blank cells are stored as '\0' and sent to the display as spaces, so that
+** the zero-initialised buffers match a freshly cleared display.
+*/
+static volatile char lcd_fb[LCD_LINES][LCD_DISP_LENGTH];   /* what the display should show       */
+static char lcd_fb_shown[LCD_LINES][LCD_DISP_LENGTH];      /* what the display is showing        */
+static volatile uint8_t lcd_fb_pending;                    /* lcd_fb may differ from lcd_fb_shown */
+static uint8_t lcd_fb_x, lcd_fb_y;                         /* next cell to compare               */
+static uint8_t lcd_fb_cursor;                              /* DDRAM address of the cursor        */
+
 /*
 ** local functions
 */
@@ -614,4 +625,144 @@ void lcd_init(uint8_t dispAttr)
     lcd_command(LCD_MODE_DEFAULT);          /* set entry mode               */
     lcd_command(dispAttr);                  /* display/cursor control       */
 
+    /* the display is now blank, so redraw the whole framebuffer onto it */
+    for (uint8_t y = 0; y < LCD_LINES; y++)
+        for (uint8_t x = 0; x < LCD_DISP_LENGTH; x++)
+            lcd_fb_shown[y][x] = '\0';
+    lcd_fb_cursor  = LCD_START_LINE1;
+    lcd_fb_pending = 1;
+
 }/* lcd_init */
+
+
+/*************************************************************************
+Return the DDRAM address of the given framebuffer cell
+*************************************************************************/
+static inline uint8_t lcd_fb_address(uint8_t x, uint8_t y)
+{
+#if LCD_LINES==1
+    return LCD_START_LINE1+x;
+#elif LCD_LINES==2
+    return (y==0 ? LCD_START_LINE1 : LCD_START_LINE2)+x;
+#else
+    static const uint8_t lineStart[4] = {LCD_START_LINE1, LCD_START_LINE2,
+                                         LCD_START_LINE3, LCD_START_LINE4};
+    return lineStart[y]+x;
+#endif
+}/* lcd_fb_address */
+
+
+/*************************************************************************
+Clear the framebuffer
+Returns:  none
+*************************************************************************/
+void lcd_fb_clear(void)
+{
+    for (uint8_t y = 0; y < LCD_LINES; y++)
+        for (uint8_t x = 0; x < LCD_DISP_LENGTH; x++)
+            lcd_fb[y][x] = '\0';
+    lcd_fb_pending = 1;
+
+}/* lcd_fb_clear */
+
+
+/*************************************************************************
+Replace one line of the framebuffer, truncating or blank padding the string
+to the display width. The string ends at a NUL, CR or LF.
+Input:    y  line to replace (0: first line)
+          s  string to be displayed
+Returns:  none
+*************************************************************************/
+void lcd_fb_puts_line(uint8_t y, const char *s)
+{
+    uint8_t x;
+
+
+    if ( y >= LCD_LINES )
+        return;
+
+    for (x = 0; x < LCD_DISP_LENGTH && *s && *s != '\n' && *s != '\r'; x++)
+        lcd_fb[y][x] = *s++;
+    for (; x < LCD_DISP_LENGTH; x++)
+        lcd_fb[y][x] = '\0';
+    lcd_fb_pending = 1;
+
+}/* lcd_fb_puts_line */
+
+
+/*************************************************************************
+Scroll the framebuffer up by one line, leaving the last line blank
+Returns:  none
+*************************************************************************/
+void lcd_fb_scroll(void)
+{
+    for (uint8_t y = 1; y < LCD_LINES; y++)
+        for (uint8_t x = 0; x < LCD_DISP_LENGTH; x++)
+            lcd_fb[y-1][x] = lcd_fb[y][x];
+    for (uint8_t x = 0; x < LCD_DISP_LENGTH; x++)
+        lcd_fb[LCD_LINES-1][x] = '\0';
+    lcd_fb_pending = 1;
+
+}/* lcd_fb_scroll */
+
+
+/*************************************************************************
+Push the framebuffer to the display, one controller operation per call.
+Never waits for the busy flag: if the controller is still busy with the
+previous operation, this returns straight away and the work is retried on
+the next call. Sequential changed cells are written without re-addressing
+because the controller auto-increments its address counter.
+Returns:  0 if the display matches the framebuffer, 1 if work remains
+*************************************************************************/
+uint8_t lcd_fb_refresh(void)
+{
+    uint8_t cells, address;
+    char c;
+
+
+    if ( !lcd_fb_pending )
+        return 0;
+
+    if ( lcd_read(0) & (1<<LCD_BUSY) )
+        return 1;
+
+    /*
+     * Clear the flag before scanning, so that a cell changed from an ISR
+     * behind the scan position is picked up by the next call.
+     */
+    lcd_fb_pending = 0;
+
+    for (cells = LCD_LINES*LCD_DISP_LENGTH; cells; cells--)
+    {
+        c = lcd_fb[lcd_fb_y][lcd_fb_x];
+        if ( c != lcd_fb_shown[lcd_fb_y][lcd_fb_x] )
+        {
+            lcd_fb_pending = 1;
+
+            address = lcd_fb_address(lcd_fb_x, lcd_fb_y);
+            if ( address != lcd_fb_cursor )
+            {
+                lcd_write((1<<LCD_DDRAM)+address, 0);
+                lcd_fb_cursor = address;
+                return 1;
+            }
+
+            lcd_write(c ? c : ' ', 1);
+            lcd_fb_shown[lcd_fb_y][lcd_fb_x] = c;
+            lcd_fb_cursor++;
+        }
+
+        if ( ++lcd_fb_x == LCD_DISP_LENGTH )
+        {
+            lcd_fb_x = 0;
+            if ( ++lcd_fb_y == LCD_LINES )
+                lcd_fb_y = 0;
+        }
+
+        if ( lcd_fb_pending )
+            return 1;
+    }
+
+    return 0;
+
+}/* lcd_fb_refresh */
@@ -261,5 +261,47 @@ extern void lcd_data(uint8_t data);
 */
 #define lcd_puts_P(__s)         lcd_puts_p(PSTR(__s))
 
+
+/**
+ *  @name  Framebuffer Functions
+ *  The framebuffer functions only touch RAM, so they are cheap enough to call
+ *  from an ISR. lcd_fb_refresh() must be called regularly from the main loop
+ *  to copy changes onto the display.
+ */
+
+
+/**
+ @brief    Clear the framebuffer
+ @param    void
+ @return   none
+*/
+extern void lcd_fb_clear(void);
+
+
+/**
+ @brief    Replace one line of the framebuffer, padding it with blanks
+ @param    y vertical position\n (0: first line)
+ @param    s string to be displayed, ending at a NUL, CR or LF
+ @return   none
+*/
+extern void lcd_fb_puts_line(uint8_t y, const char *s);
+
+
+/**
+ @brief    Scroll the framebuffer up by one line, leaving the last line blank
+ @param    void
+ @return   none
+*/
+extern void lcd_fb_scroll(void);
+
+
+/**
+ @brief    Send at most one changed character (or cursor move) to the display.
+           Returns immediately if the controller is busy.
+ @param    void
+ @return   0 if the display is up to date, 1 if more work remains
+*/
+extern uint8_t lcd_fb_refresh(void);
+
 /*@}*/
 #endif //LCD_H
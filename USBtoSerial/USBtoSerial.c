@@ -39,7 +39,17 @@
 // defining this causes the watchdog to be reset by *any* comms from the beagle
 //#define WATCHDOG_RESET_ON_ALL_COMMS
 
+// defining this makes the AVR also look for avr:// commands in the console
+// traffic, as it did before it had a command port of its own
+//#define CONSOLE_COMMANDS
+
+// defining this uses Timer1 to measure how long the main loop takes to get
+// going again after an interrupt wakes it from idle (see the stats command)
+//#define MEASURE_WAKE_LATENCY
+
 #define MAX_LINE_LENGTH 1024
+// longest line accepted on the command port, anything after this is dropped
+#define MAX_COMMAND_LENGTH 128
 #define COMMAND_PREFIX "avr://"
 
 #define WATCHDOG_CMD "watchdog"
@@ -47,7 +57,6 @@
 #define WATCHDOG_DISABLE "disable"
 #define WATCHDOG_PULSE "pulse"
 #define WATCHDOG_TIMEOUT_S 600
-#define WATCHDOG_PRESCALER 1024
 
 #define LCD_CMD "lcd"
 #define LCD_CLEAR_CMD "clear"
@@ -76,9 +85,18 @@
 #define POWER_OFF "off"
 #define POWER_MIC "usbmic"
 #define DEVICE_NAME_MIC "USB Microphones"
+#define CYCLE_CMD "cycle"
 
 #define RESET_CMD "REALLY reset the AVR"
 
+#define STATS_CMD "stats"
+
+#define JOURNAL_CMD "journal"
+// number of records reported by a journal command with no count
+#define JOURNAL_REPORT_DEFAULT 16
+// longest line of a journal report, which must fit in the Cmd_Tx_Buffer
+#define JOURNAL_REPORT_LINE_LENGTH 48
+
 
 #define soft_reset()        \
 do {                        \
@@ -86,6 +104,28 @@ do {                        \
     for(;;) {}              \
 } while(0)
 
+// flags for Pending_Events, set by the ISRs which can wake the main loop
+#define EVENT_SERIAL_RX    (1 << 0)
+#define EVENT_SERIAL_READY (1 << 1)
+#define EVENT_USB          (1 << 2)
+
+// note an event for the main loop, from an ISR
+#ifdef MEASURE_WAKE_LATENCY
+#define WAKE_EVENT(event)           \
+do {                                \
+    Pending_Events |= (event);      \
+    if (!Wake_Stamped) {            \
+        Wake_Stamp = TCNT1;         \
+        Wake_Stamped = true;        \
+    }                               \
+} while(0)
+#else
+#define WAKE_EVENT(event)           \
+do {                                \
+    Pending_Events |= (event);      \
+} while(0)
+#endif
+
 
 /* Globals: */
 /** Contains the current baud rate and other settings of the virtual serial port.
@@ -106,27 +146,72 @@ RingBuff_t Rx_Buffer;
 /** Ring (circular) buffer to hold the TX data - data from the attached device on the serial port to the host. */
 RingBuff_t Tx_Buffer;
 
+/** Ring (circular) buffer to hold replies to AVR commands, sent to the host on the command port. */
+RingBuff_t Cmd_Tx_Buffer;
+
 /** Flag to indicate if the USART is currently transmitting data from the Rx_Buffer circular buffer. */
 volatile bool Transmitting = false;
 
+/** Buffer to store the command line being received on the command port */
+char CommandLine[MAX_COMMAND_LENGTH];
+short CommandLineIndex = 0;
+// set when the last packet sent on the command port was full, so the host
+// needs an empty packet to see the end of the reply
+bool Cmd_Tx_PendingZLP = false;
+
+#ifdef CONSOLE_COMMANDS
 /** Buffer to store the last AVR command received on the serial port */
 char CommandBuffer[MAX_LINE_LENGTH];
 short CommandBufferIndex = 0;
 short CommandPrefixIndex = 0;
 short InCommand = 0;
+#endif
 
-// buffer to store the second line so it can be "scrolled" up to the first line
-// on the next write
+// the LCD is drawn from a framebuffer by LCD_Task(); this counts how many
+// lines of it are in use, so new lines can be "scrolled" in at the bottom
 short LCD_on = 1;
-char LCD_Buffer[LCD_LINE_LENGTH + 1];
 short LCD_Lines = 0;
-
-// counter to store how many seconds since we last heard from the beagle
-int Beagle_Watchdog_Counter;
-// counters for delayed beagle power up/down (in seconds)
-uint32_t Beagle_Delayed_Power_Down, Beagle_Delayed_Power_Up;
+// set when the LCD has been powered up and needs initialising by LCD_Task()
+volatile short LCD_init_pending = 0;
+// runs LCD_Task() every timer wheel tick
+TimerWheel_Timer_t LCD_Refresh_Timer = { .Callback = LCD_Task, .Period = 1 };
+
+// goes off if we haven't heard from the beagle for WATCHDOG_TIMEOUT_S
+TimerWheel_Timer_t Beagle_Watchdog_Timer = { .Callback = BeagleWatchdog_Expired };
+// number of times the beagle watchdog has gone off since the AVR was reset
+uint16_t Beagle_Watchdog_Firings = 0;
+// timers for delayed beagle power down and up, and how long (in seconds) to
+// keep the beagle powered down for
+TimerWheel_Timer_t Beagle_Power_Down_Timer = { .Callback = BeaglePowerDown_Expired };
+TimerWheel_Timer_t Beagle_Power_Up_Timer = { .Callback = BeaglePowerUp_Expired };
+uint32_t Beagle_Delayed_Power_Up;
+// per pin power schedules: each pin's timer switches it to its bit of
+// Power_Next_State, and then if the pin has a duty cycle, carries on switching
+// it on for Power_On_Seconds and off for Power_Off_Seconds
+TimerWheel_Timer_t Power_Timers[ALL_POWER_PINS];
+uint8_t Power_Next_State = 0;
+uint16_t Power_On_Seconds[ALL_POWER_PINS], Power_Off_Seconds[ALL_POWER_PINS];
 // set to 0 for power on after delay, set to 1 for power on after delay
 int AVR_watchdog_reset = 0;
+// MCUSR reset cause flags from the last AVR reset
+uint8_t AVR_reset_flags = 0;
+// number of journal records still to be reported to the host
+volatile uint8_t Journal_Report_Remaining = 0;
+
+// EVENT_* flags for things that have happened since the main loop last looked
+volatile uint8_t Pending_Events = 0;
+// number of times the main loop has gone to sleep
+uint32_t Sleep_Count = 0;
+// bytes passed through the console bridge, each way
+volatile uint32_t Bridge_Bytes_To_Beagle = 0, Bridge_Bytes_To_Host = 0;
+#ifdef MEASURE_WAKE_LATENCY
+// Timer1 count when the first ISR since the main loop went to sleep ran
+volatile uint16_t Wake_Stamp;
+volatile bool Wake_Stamped = false;
+// Timer1 ticks from that ISR to the main loop running again
+uint16_t Wake_Latency_Max = 0;
+uint32_t Wake_Latency_Total = 0, Wake_Latency_Count = 0;
+#endif
 
 
 /** Main program entry point. This routine configures the hardware required by the application, then
@@ -137,17 +222,131 @@ int main(void)
 	/* Ring buffer Initialization */
 	Buffer_Initialize(&Rx_Buffer);
 	Buffer_Initialize(&Tx_Buffer);
+	Buffer_Initialize(&Cmd_Tx_Buffer);
 
 	SetupHardware();
 
 	for (;;)
 	{
+		Pending_Events = 0;
+
 		CDC_Task();
+		Command_Task();
 		USB_USBTask();
+		TimerWheel_Task();
+		Journal_Task();
+		JournalReport_Task();
 
 		// reset the internal watchdog
 		wdt_reset();
+
+		// wait for something else to do (the timer wheel tick wakes us at
+		// least every few ms, so the watchdog is still reset in time)
+		IdleSleep();
+	}
+}
+
+
+/** Check whether the tasks in the main loop have anything they could do right
+ * now. Anything they are waiting on has its interrupt armed, so that it wakes
+ * the main loop when it happens. Must be called with interrupts disabled.
+ */
+bool WorkPending(void)
+{
+	if (Pending_Events || TimerWheel_TicksPending())
+		return true;
+
+	// a control request could come at any time, even during enumeration
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+	if (Endpoint_IsSETUPReceived())
+		return true;
+	Endpoint_ArmCallback(ENDPOINT_INT_SETUP);
+
+	// data from the host waiting to go out of the USART
+	if (Rx_Buffer.Elements) {
+		if (UCSR1A & (1 << UDRE1))
+			return true;
+		UCSR1B |= (1 << UDRIE1);
+	}
+
+	if (Journal_Report_Remaining && (BUFF_STATICSIZE - Cmd_Tx_Buffer.Elements) >= JOURNAL_REPORT_LINE_LENGTH)
+		return true;
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+		return false;
+
+	// console data from the host (only read when there's room for it)
+	Endpoint_SelectEndpoint(CDC_RX_EPNUM);
+	if (Endpoint_IsOUTReceived()) {
+		if (Rx_Buffer.Elements != BUFF_STATICSIZE)
+			return true;
+	}
+	else {
+		Endpoint_ArmCallback(ENDPOINT_INT_OUT);
+	}
+
+	// console data for the host
+	if (Tx_Buffer.Elements && LineEncoding.BaudRateBPS) {
+		Endpoint_SelectEndpoint(CDC_TX_EPNUM);
+		if (Endpoint_IsINReady())
+			return true;
+		Endpoint_ArmCallback(ENDPOINT_INT_IN);
 	}
+
+	// commands and replies
+	Endpoint_SelectEndpoint(CMD_RX_EPNUM);
+	if (Endpoint_IsOUTReceived())
+		return true;
+	Endpoint_ArmCallback(ENDPOINT_INT_OUT);
+
+	if (Cmd_Tx_Buffer.Elements || Cmd_Tx_PendingZLP) {
+		Endpoint_SelectEndpoint(CMD_TX_EPNUM);
+		if (Endpoint_IsINReady())
+			return true;
+		Endpoint_ArmCallback(ENDPOINT_INT_IN);
+	}
+
+	return false;
+}
+
+
+/** Put the AVR into idle sleep until an interrupt happens, unless the main
+ * loop has work to do. Idle mode keeps the clocks, USB, USART and timers
+ * running, so any of their interrupts wake it.
+ */
+void IdleSleep(void)
+{
+	cli();
+
+	if (WorkPending()) {
+		sei();
+		return;
+	}
+
+#ifdef MEASURE_WAKE_LATENCY
+	Wake_Stamped = false;
+#endif
+
+	Sleep_Count++;
+	sleep_enable();
+	// the instruction after sei() always runs before any interrupt, so an
+	// interrupt can't sneak in between checking for work and sleeping
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+#ifdef MEASURE_WAKE_LATENCY
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (Wake_Stamped) {
+			uint16_t latency = TCNT1 - Wake_Stamp;
+
+			if (latency > Wake_Latency_Max)
+				Wake_Latency_Max = latency;
+			Wake_Latency_Total += latency;
+			Wake_Latency_Count++;
+		}
+	}
+#endif
 }
 
 /** Configures the board hardware and chip peripherals for the demo's functionality. */
@@ -171,6 +370,27 @@ void SetupHardware(void)
 	DDRA = 0xFF;
 	DDRC = 0xFF;
 
+	// the main loop idles when there's nothing to do, and the endpoints it
+	// waits on wake it
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	Endpoint_SetCallback(ENDPOINT_CONTROLEP, EndpointWakeup);
+	Endpoint_SetCallback(CMD_RX_EPNUM, EndpointWakeup);
+	Endpoint_SetCallback(CDC_TX_EPNUM, EndpointWakeup);
+	Endpoint_SetCallback(CDC_RX_EPNUM, EndpointWakeup);
+	Endpoint_SetCallback(CMD_TX_EPNUM, EndpointWakeup);
+#ifdef MEASURE_WAKE_LATENCY
+	// Timer1 free runs at F_CPU/8, to time wake ups
+	TCCR1A = 0;
+	TCCR1B = (1 << CS11);
+#endif
+
+	// all the power, watchdog and LCD timing is run from the timer wheel
+	TimerWheel_Init();
+	for (int pin = 0; pin < ALL_POWER_PINS; pin++) {
+		Power_Timers[pin].Callback = PowerSchedule_Expired;
+		Power_Timers[pin].Argument = pin;
+	}
+
 	// Turn on power to devices that should have it (Beagle at least)
 	LCD_PORT |= (1 << POWER_PIN_LCD);
 	// Turn everything on (soon)
@@ -193,9 +413,9 @@ void SetupHardware(void)
 	// if we were reset by the AVR watchdog, then report this:
 	if (AVR_watchdog_reset)
 		WriteStringToLCD("AVR Internal WDT Reset");
+	TimerWheel_Start(&LCD_Refresh_Timer, 1);
 	
-	// set up beagle watchdog and restart timer
-	InitialiseTimers();
+	// set up beagle watchdog
 	StartBeagleWatchdog();
 }
 
@@ -216,6 +436,9 @@ void EVENT_USB_Device_Disconnect(void)
 	/* Reset Tx and Rx buffers, device disconnected */
 	Buffer_Initialize(&Rx_Buffer);
 	Buffer_Initialize(&Tx_Buffer);
+	Buffer_Initialize(&Cmd_Tx_Buffer);
+	CommandLineIndex = 0;
+	Cmd_Tx_PendingZLP = false;
 
 	/* Indicate USB not ready */
 	WriteStringToLCD("USB Disconnected");
@@ -230,6 +453,15 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 	/* Indicate USB connected and ready */
 	//WriteStringToLCD("USB Config Changed");
 
+	/* Endpoints are set up in ascending order, as the USB controller allocates
+	   their memory in that order */
+
+	/* Setup the command port's Rx Endpoint */
+	if (!(Endpoint_ConfigureEndpoint(CMD_RX_EPNUM, EP_TYPE_BULK,
+			ENDPOINT_DIR_OUT, CDC_TXRX_EPSIZE, CDC_TXRX_EPBANKS))) {
+		WriteStringToLCD("USBConfErr Cmd Rx EP");
+	}
+
 	/* Setup CDC Notification, Rx and Tx Endpoints */
 	if (!(Endpoint_ConfigureEndpoint(CDC_NOTIFICATION_EPNUM, EP_TYPE_INTERRUPT,
 			 ENDPOINT_DIR_IN, CDC_NOTIFICATION_EPSIZE, ENDPOINT_BANK_SINGLE))) {
@@ -237,14 +469,25 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 	}
 	
 	if (!(Endpoint_ConfigureEndpoint(CDC_TX_EPNUM, EP_TYPE_BULK,
-			ENDPOINT_DIR_IN, CDC_TXRX_EPSIZE, ENDPOINT_BANK_SINGLE))) {
+			ENDPOINT_DIR_IN, CDC_TXRX_EPSIZE, CDC_TXRX_EPBANKS))) {
 		WriteStringToLCD("USBConfErr Transmit EP");
 	}							   
 
 	if (!(Endpoint_ConfigureEndpoint(CDC_RX_EPNUM, EP_TYPE_BULK,
-			ENDPOINT_DIR_OUT, CDC_TXRX_EPSIZE, ENDPOINT_BANK_SINGLE))) {
+			ENDPOINT_DIR_OUT, CDC_TXRX_EPSIZE, CDC_TXRX_EPBANKS))) {
 		WriteStringToLCD("USBConfErr Receive EP");
 	}
+
+	/* Setup the command port's Notification and Tx Endpoints */
+	if (!(Endpoint_ConfigureEndpoint(CMD_NOTIFICATION_EPNUM, EP_TYPE_INTERRUPT,
+			 ENDPOINT_DIR_IN, CDC_NOTIFICATION_EPSIZE, ENDPOINT_BANK_SINGLE))) {
+		WriteStringToLCD("USBConfErr Cmd Notify EP");
+	}
+
+	if (!(Endpoint_ConfigureEndpoint(CMD_TX_EPNUM, EP_TYPE_BULK,
+			ENDPOINT_DIR_IN, CDC_TXRX_EPSIZE, CDC_TXRX_EPBANKS))) {
+		WriteStringToLCD("USBConfErr Cmd Tx EP");
+	}
 }
 
 /** Event handler for the USB_UnhandledControlRequest event. This is used to
@@ -255,7 +498,15 @@ void EVENT_USB_Device_ConfigurationChanged(void)
  */
 void EVENT_USB_Device_UnhandledControlRequest(void)
 {
-	/* Process CDC specific control requests */
+	/* Process requests to the telemetry interface */
+	if (((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_TYPE) == REQTYPE_VENDOR)
+			&& (USB_ControlRequest.wIndex == TELEMETRY_INTERFACE_NUMBER)) {
+		ProcessTelemetryRequest();
+		return;
+	}
+
+	/* Process CDC specific control requests. The console and command ports
+	   are treated the same, as neither really has a line to configure. */
 	switch (USB_ControlRequest.bRequest)
 	{
 		case REQ_GetLineEncoding:
@@ -306,6 +557,86 @@ void EVENT_USB_Device_UnhandledControlRequest(void)
 	}
 }
 
+/** Handle a vendor specific request to the telemetry interface. This gives
+ *  the host a binary status report and binary power and watchdog commands, so
+ *  it doesn't have to send avr:// commands and parse the replies out of the
+ *  console stream. Requests not handled here are stalled by the library.
+ */
+void ProcessTelemetryRequest(void)
+{
+	Telemetry_Report_t report;
+	uint8_t pin, on;
+
+	switch (USB_ControlRequest.bRequest)
+	{
+		case REQ_GetTelemetryReport:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST
+					| REQTYPE_VENDOR | REQREC_INTERFACE)) {
+				report.Version = TELEMETRY_REPORT_VERSION;
+				// the power port is active low
+				report.PowerState = ~POWER_PORT;
+				report.Flags = 0;
+				report.WatchdogCounter = 0;
+				if (TimerWheel_IsPending(&Beagle_Watchdog_Timer)) {
+					report.Flags |= TELEMETRY_FLAG_WATCHDOG;
+					report.WatchdogCounter = WATCHDOG_TIMEOUT_S
+							- SecondsRemaining(&Beagle_Watchdog_Timer);
+				}
+				if (LCD_on)
+					report.Flags |= TELEMETRY_FLAG_LCD;
+				report.DelayedPowerDown = SecondsRemaining(&Beagle_Power_Down_Timer);
+				report.DelayedPowerUp = SecondsRemaining(&Beagle_Power_Up_Timer);
+				if (TimerWheel_IsPending(&Beagle_Power_Down_Timer)) {
+					// the power up timer isn't started until the power down
+					report.DelayedPowerUp = Beagle_Delayed_Power_Up;
+				}
+				if (report.DelayedPowerDown || report.DelayedPowerUp)
+					report.Flags |= TELEMETRY_FLAG_DELAYED_POWER;
+				report.ResetCause = AVR_reset_flags;
+				report.WatchdogTimeout = WATCHDOG_TIMEOUT_S;
+				report.WatchdogFirings = Beagle_Watchdog_Firings;
+
+				Endpoint_ClearSETUP();
+				Endpoint_Write_Control_Stream_LE(&report, sizeof(report));
+				Endpoint_ClearOUT();
+			}
+
+			break;
+		case REQ_SetPower:
+			pin = (USB_ControlRequest.wValue & 0xFF);
+			on = (USB_ControlRequest.wValue >> 8);
+
+			if ((USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE
+					| REQTYPE_VENDOR | REQREC_INTERFACE)) && (pin <= ALL_POWER_PINS)) {
+				Endpoint_ClearSETUP();
+				CancelPowerSchedule(pin);
+				PowerOn(pin, on);
+				WriteStringToLCD("%s: pin[%d] (USB)", on ? "ON" : "OFF", pin);
+				Endpoint_ClearStatusStage();
+			}
+
+			break;
+		case REQ_SetWatchdog:
+			if ((USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE
+					| REQTYPE_VENDOR | REQREC_INTERFACE))
+					&& (USB_ControlRequest.wValue <= TELEMETRY_WATCHDOG_PULSE)) {
+				Endpoint_ClearSETUP();
+
+				if (USB_ControlRequest.wValue == TELEMETRY_WATCHDOG_DISABLE)
+					StopBeagleWatchdog();
+				else if (USB_ControlRequest.wValue == TELEMETRY_WATCHDOG_ENABLE)
+					StartBeagleWatchdog();
+				else
+					PulseBeagleWatchdog();
+
+				Endpoint_ClearStatusStage();
+			}
+
+			break;
+	}
+}
+
+
 /** Task to manage CDC data transmission and reception to and from the host, from and to the physical USART. */
 void CDC_Task(void)
 {
@@ -335,8 +666,10 @@ void CDC_Task(void)
 	}
 	
 	/* Check if Rx buffer contains data - if so, send it */
-	if (Rx_Buffer.Elements)
+	if (Rx_Buffer.Elements) {
 	  Serial_TxByte(Buffer_GetElement(&Rx_Buffer));
+	  Bridge_Bytes_To_Beagle++;
+	}
 
 	/* Select the Serial Tx Endpoint */
 	Endpoint_SelectEndpoint(CDC_TX_EPNUM);
@@ -375,59 +708,145 @@ void CDC_Task(void)
 }
 
 
-/** Setup the watchdog timer */
-void InitialiseTimers()
+/** Task to read AVR commands from the command port, one line at a time, and
+ * to send the replies back. Unlike the console this never waits on the host,
+ * so nothing stalls if no program has the command port open.
+ */
+void Command_Task(void)
 {
-	// save the status register
-	unsigned char ucSREG = SREG;
-	// disable interrupts to prevent race conditions with 16bit registers
-	cli();
+	/* Device must be connected and configured for the task to run */
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+		return;
+
+	Endpoint_SelectEndpoint(CMD_RX_EPNUM);
+
+	if (Endpoint_IsOUTReceived()) {
+		while (Endpoint_BytesInEndpoint()) {
+			uint8_t ReceivedByte = Endpoint_Read_Byte();
+
+			if (ReceivedByte == '\n' || ReceivedByte == '\r') {
+				CommandLine[CommandLineIndex] = '\0';
+				CommandLineIndex = 0;
 
-	// Maximum timer tick is around 4 seconds, so we'll set the timer
-	// to go off once a second, and use a counter.
-	// 1 = prescaler * (1 + OCR1A) / F_CPU
-	// So OCR1A = (F_CPU / prescaler) - 1
-	// NOTE: ensure this value fits into 16bits - change prescaler if necessary
-	OCR1A = (uint16_t)(F_CPU / WATCHDOG_PRESCALER - 1);
-	OCR3A = (uint16_t)(F_CPU / WATCHDOG_PRESCALER - 1);
+				// the avr:// prefix is optional here, so scripts written for
+				// the console keep working
+				char *cmd = CommandLine;
+				if (strncmp(cmd, COMMAND_PREFIX, strlen(COMMAND_PREFIX)) == 0)
+					cmd += strlen(COMMAND_PREFIX);
 
-	// restore status register (will re-enable interrupts if the were enabled)
-	SREG = ucSREG;
+				// ignore blank lines (e.g. the \n of a \r\n)
+				if (*cmd)
+					ProcessCommand(cmd);
+
+				// ProcessCommand() may have selected another endpoint
+				Endpoint_SelectEndpoint(CMD_RX_EPNUM);
+			}
+			else if (CommandLineIndex < MAX_COMMAND_LENGTH - 1) {
+				CommandLine[CommandLineIndex++] = ReceivedByte;
+			}
+		}
+
+		Endpoint_ClearOUT();
+	}
+
+	Endpoint_SelectEndpoint(CMD_TX_EPNUM);
+
+	if (!(Endpoint_IsINReady()))
+		return;
+
+	if (Cmd_Tx_Buffer.Elements) {
+		while (Cmd_Tx_Buffer.Elements && Endpoint_IsReadWriteAllowed())
+			Endpoint_Write_Byte(Buffer_GetElement(&Cmd_Tx_Buffer));
+
+		Cmd_Tx_PendingZLP = (Endpoint_BytesInEndpoint() == CDC_TXRX_EPSIZE);
+		Endpoint_ClearIN();
+	}
+	else if (Cmd_Tx_PendingZLP) {
+		/* Send an empty packet to terminate the transfer */
+		Cmd_Tx_PendingZLP = false;
+		Endpoint_ClearIN();
+	}
 }
 
 
 /** Start the watchdog timer */
 void StartBeagleWatchdog()
 {
-	Beagle_Watchdog_Counter = 0;
 	WriteStringToLCD("Beagle Watchdog enabled");
-	
-	TCCR1B  = (1 << WGM12)  // Clear-timer-on-compare-match-OCR1A (CTC) mode
-			| (1 << CS12) | (1 << CS10);  // prescaler divides by 1024
-	TIMSK1 |= (1 << OCIE1A); // Enable timer interrupt
+	TimerWheel_Start(&Beagle_Watchdog_Timer, TIMERWHEEL_SECONDS(WATCHDOG_TIMEOUT_S));
 }
 
 
-/** Start the watchdog timer */
+/** Stop the watchdog timer */
 void StopBeagleWatchdog()
 {
 	WriteStringToLCD("Beagle Watchdog disabled");
-	TIMSK1 &= ~(1 << OCIE1A); // Disable timer interrupt
-	TCCR1B &= ~(1 << CS10) & ~(1 << CS11) & ~(1 << CS12); // disable clock
+	TimerWheel_Stop(&Beagle_Watchdog_Timer);
+}
+
+
+/** Restart the watchdog timeout, if the watchdog is enabled. This is safe to
+ * call from an ISR.
+ */
+void PulseBeagleWatchdog()
+{
+	if (TimerWheel_IsPending(&Beagle_Watchdog_Timer))
+		TimerWheel_Start(&Beagle_Watchdog_Timer, TIMERWHEEL_SECONDS(WATCHDOG_TIMEOUT_S));
 }
 
 
+/** Number of seconds (rounded up) until a timer goes off, or 0 if it isn't
+ * running.
+ */
+uint32_t SecondsRemaining(TimerWheel_Timer_t *timer)
+{
+	return (TimerWheel_Remaining(timer) + TIMERWHEEL_TICK_HZ - 1) / TIMERWHEEL_TICK_HZ;
+}
+
+
+/** Carry out a command to the AVR itself (without the avr:// prefix). */
+void ProcessCommand(char *cmd)
+{
+	// see if we understand the command
+	if (strncmp(cmd, BEAGLE_RESET_CMD, strlen(BEAGLE_RESET_CMD)) == 0) {
+		ProcessBeaglePowerDownCommand(cmd + strlen(BEAGLE_RESET_CMD) + 1);
+	}
+	else if (strncmp(cmd, POWER_CMD, strlen(POWER_CMD)) == 0) {
+		ProcessPowerCommand(cmd + strlen(POWER_CMD) + 1);
+	}
+	else if (strncmp(cmd, LCD_CMD, strlen(LCD_CMD)) == 0) {
+		ProcessLCDCommand(cmd + strlen(LCD_CMD) + 1);
+	}
+	else if (strncmp(cmd, WATCHDOG_CMD, strlen(WATCHDOG_CMD)) == 0) {
+		ProcessWatchdogCommand(cmd + strlen(WATCHDOG_CMD) + 1);
+	}
+	else if (strncmp(cmd, CYCLE_CMD, strlen(CYCLE_CMD)) == 0) {
+		ProcessCycleCommand(cmd + strlen(CYCLE_CMD) + 1);
+	}
+	else if (strncmp(cmd, JOURNAL_CMD, strlen(JOURNAL_CMD)) == 0) {
+		ProcessJournalCommand(cmd + strlen(JOURNAL_CMD));
+	}
+	else if (strncmp(cmd, STATS_CMD, strlen(STATS_CMD)) == 0) {
+		ProcessStatsCommand(cmd + strlen(STATS_CMD));
+	}
+	else if (strncmp(cmd, RESET_CMD, strlen(RESET_CMD)) == 0) {
+		soft_reset();
+	}
+	else {
+		WriteStringToUSB("\r\nGot unknown AVR command '%s'\r\n", cmd);
+		WriteStringToLCD("Unknown command:");
+		WriteStringToLCD(cmd);
+	}
+}
+
+
+#ifdef CONSOLE_COMMANDS
 /** Process bytes received on the serial port to see if there's any commands to
  *  the AVR itself. We're looking for strings that start with the #defined
  *  magic string and end with a newline.
  */
 void ProcessByte(uint8_t ReceivedByte)
 {
-#ifdef WATCHDOG_RESET_ON_ALL_COMMS
-	// reset the watchdog
-	Beagle_Watchdog_Counter = 0;
-#endif
-
 	// If we're currently read in a command, then pay attention
 	if (InCommand) {
 		// check if this is the end of the line
@@ -435,27 +854,7 @@ void ProcessByte(uint8_t ReceivedByte)
 			// null-terminate the string in the buffer
 			CommandBuffer[CommandBufferIndex] = '\0';
 
-			// see if we understand the command
-			if (strncmp(CommandBuffer, BEAGLE_RESET_CMD, strlen(BEAGLE_RESET_CMD)) == 0) {
-				ProcessBeaglePowerDownCommand(CommandBuffer + strlen(BEAGLE_RESET_CMD) + 1);
-			}
-			else if (strncmp(CommandBuffer, POWER_CMD, strlen(POWER_CMD)) == 0) {
-				ProcessPowerCommand(CommandBuffer + strlen(POWER_CMD) + 1);
-			}
-			else if (strncmp(CommandBuffer, LCD_CMD, strlen(LCD_CMD)) == 0) {
-				ProcessLCDCommand(CommandBuffer + strlen(LCD_CMD) + 1);
-			}
-			else if (strncmp(CommandBuffer, WATCHDOG_CMD, strlen(WATCHDOG_CMD)) == 0) {
-				ProcessWatchdogCommand(CommandBuffer + strlen(WATCHDOG_CMD) + 1);
-			}
-			else if (strncmp(CommandBuffer, RESET_CMD, strlen(RESET_CMD)) == 0) {
-				soft_reset();
-			}
-			else {
-				WriteStringToUSB("\r\nGot unknown AVR command '%s'\r\n", CommandBuffer);
-				WriteStringToLCD("Unknown command:");
-				WriteStringToLCD(CommandBuffer);
-			}
+			ProcessCommand(CommandBuffer);
 
 			// clear the buffer
 			CommandBufferIndex = 0;
@@ -478,6 +877,7 @@ void ProcessByte(uint8_t ReceivedByte)
 		CommandPrefixIndex = 0;
 	}
 }
+#endif
 
 // strtol/stroul apparently broken in some avr-gcc versions
 uint32_t strtouint32(const char *nptr, char **endptr, int base) {
@@ -521,12 +921,25 @@ void ProcessBeaglePowerDownCommand(char *cmd)
 }
 
 
+/** Map a switch number (counting from 1) to its pin on the power port. */
+int PowerPinForSwitch(int sw)
+{
+	int pin = sw - 1;
+#ifdef NEW_CABLE
+	pin = 7 - pin;
+#endif
+	return pin;
+}
+
+
 /** Handle a command to turn on or off power to one of the devices.
- *  This is just toggling gpios.
+ *  This is just toggling gpios, either straight away or (if the command ends
+ *  with a number of seconds) after a delay.
  */
 void ProcessPowerCommand(char *cmd)
 {
 	int new_power_state, is_on_power_port, pin;
+	uint32_t delay_seconds = 0;
 	char *device_name;
 
 	// parse if it's an on or an off command
@@ -550,16 +963,15 @@ void ProcessPowerCommand(char *cmd)
 	// now parse what device to turn on or off
 	if (cmd[0] >= '1' && cmd[0] <= '9') {
 		is_on_power_port = 1;
-		pin = cmd[0] - '1';
-        sw = pin + 1;
-#ifdef NEW_CABLE
-		pin = 7 - pin;
-#endif
+        sw = cmd[0] - '0';
+		pin = PowerPinForSwitch(sw);
+		delay_seconds = strtouint32(cmd + 1, NULL, 10);
 		device_name = "pin";
 	}
 	else if (strncmp(cmd, POWER_MIC, strlen(POWER_MIC)) == 0) {
 		is_on_power_port = 1;
 		pin = POWER_PIN_MIC;
+		delay_seconds = strtouint32(cmd + strlen(POWER_MIC), NULL, 10);
 		device_name = DEVICE_NAME_MIC;
 	}
 	else if (strncmp(cmd, POWER_LCD, strlen(POWER_LCD)) == 0) {
@@ -571,8 +983,8 @@ void ProcessPowerCommand(char *cmd)
 		if (new_power_state) {
 			// turn on the power to the LCD
 			LCD_PORT = (1 << POWER_PIN_LCD);
-			// re-initialise the lcd
-			lcd_init(LCD_DISP_ON);
+			// re-initialise the lcd (this is slow, so leave it to LCD_Task)
+			LCD_init_pending = 1;
 		}
 		else {
 			// shut down all pins to the LCD (including the power enable pin)
@@ -591,7 +1003,18 @@ void ProcessPowerCommand(char *cmd)
 	}
 
 	// carry out command (if it's on the power port)
+	if (is_on_power_port && delay_seconds) {
+		if (SchedulePower(pin, new_power_state, delay_seconds)) {
+			WriteStringToUSB("\r\nAVR Power System: Turning %s %s[%d] sw%d in (%ld) seconds\r\n",
+					new_power_state ? "on" : "off", device_name, pin, sw, delay_seconds);
+		}
+		else {
+			WriteStringToUSB("\r\nCan't schedule power for %s[%d]\r\n", device_name, pin);
+		}
+		return;
+	}
 	if (is_on_power_port) {
+		CancelPowerSchedule(pin);
 		PowerOn(pin, new_power_state);
 	}
 
@@ -608,9 +1031,7 @@ void ProcessPowerCommand(char *cmd)
 void ProcessLCDCommand(char *cmd)
 {
 	if (strncmp(cmd, LCD_CLEAR_CMD, strlen(LCD_CLEAR_CMD)) == 0) {
-		lcd_clrscr();
-		// clear the buffer
-		LCD_Buffer[0] = '\0';
+		lcd_fb_clear();
 		LCD_Lines = 0;
 		WriteStringToUSB("\r\nCleared LCD screen\r\n");
 	}
@@ -633,7 +1054,7 @@ void ProcessWatchdogCommand(char *cmd)
 	}
 	else if (strncmp(cmd, WATCHDOG_PULSE, strlen(WATCHDOG_PULSE)) == 0) {
 		// Reset the beagle watchdog counter
-		Beagle_Watchdog_Counter = 0;
+		PulseBeagleWatchdog();
 		WriteStringToUSB("WATCHDOG pulse\n");
 		WriteStringToLCD("WATCHDOG pulse\n");
 	}
@@ -645,11 +1066,140 @@ void ProcessWatchdogCommand(char *cmd)
 }
 
 
+/** Handle a command to duty cycle the power to a device: "cycle n on off"
+ * turns switch n on now, and then keeps turning it off after "on" seconds and
+ * back on after "off" seconds. Leaving out the times stops the cycle (leaving
+ * the power as it is).
+ */
+void ProcessCycleCommand(char *cmd)
+{
+	uint32_t on_seconds, off_seconds;
+	int sw, pin;
+	char *p;
+
+	if (!(cmd[0] >= '1' && cmd[0] <= '8')) {
+		WriteStringToUSB("\r\nGot unrecognised CYCLE command '%s'\r\n", cmd);
+		WriteStringToLCD("Unknown cycle command:");
+		WriteStringToLCD(cmd);
+		return;
+	}
+
+	sw = cmd[0] - '0';
+	pin = PowerPinForSwitch(sw);
+	on_seconds = strtouint32(cmd + 1, &p, 10);
+	off_seconds = strtouint32(p, NULL, 10);
+
+	if (!on_seconds || !off_seconds || on_seconds > UINT16_MAX || off_seconds > UINT16_MAX) {
+		CancelPowerSchedule(pin);
+		WriteStringToUSB("\r\nAVR Power System: Stopped cycling pin[%d] sw%d\r\n", pin, sw);
+		return;
+	}
+
+	CancelPowerSchedule(pin);
+	Power_On_Seconds[pin] = on_seconds;
+	Power_Off_Seconds[pin] = off_seconds;
+	PowerOn(pin, 1);
+	Power_Next_State &= ~(1 << pin);
+	TimerWheel_Start(&Power_Timers[pin], TIMERWHEEL_SECONDS(on_seconds));
+
+	WriteStringToUSB("\r\nAVR Power System: Cycling pin[%d] sw%d, (%ld) seconds on, (%ld) off\r\n",
+			pin, sw, on_seconds, off_seconds);
+	WriteStringToLCD("CYCLE: pin[%d] sw%d %ld/%ld", pin, sw, on_seconds, off_seconds);
+}
+
+
+/** Report how busy the console bridge and main loop have been: bytes through
+ * the bridge each way, how often the main loop has slept, and (if
+ * MEASURE_WAKE_LATENCY is defined) how long it takes to wake up.
+ */
+void ProcessStatsCommand(char *cmd)
+{
+	uint32_t to_beagle, to_host;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		to_beagle = Bridge_Bytes_To_Beagle;
+		to_host = Bridge_Bytes_To_Host;
+	}
+
+	WriteStringToUSB("\r\nBridge bytes: to beagle (%lu) to host (%lu)\r\n", to_beagle, to_host);
+	WriteStringToUSB("Uptime (%lu) s, slept (%lu) times\r\n",
+			TimerWheel_Uptime() / TIMERWHEEL_TICK_HZ, Sleep_Count);
+#ifdef MEASURE_WAKE_LATENCY
+	// Timer1 ticks are 8 cycles
+	WriteStringToUSB("Wake latency: max (%u) avg (%lu) cycles over (%lu) wakes\r\n",
+			Wake_Latency_Max * 8,
+			Wake_Latency_Count ? (Wake_Latency_Total * 8 / Wake_Latency_Count) : 0,
+			Wake_Latency_Count);
+#endif
+}
+
+
+/** Report the last n records of the event journal to the host (default
+ * JOURNAL_REPORT_DEFAULT). The report is too long for the Cmd_Tx_Buffer, so this
+ * just starts it off, and JournalReport_Task() writes it out a line at a time.
+ */
+void ProcessJournalCommand(char *cmd)
+{
+	uint32_t count = strtouint32(cmd, NULL, 10);
+
+	if (!count)
+		count = JOURNAL_REPORT_DEFAULT;
+	if (count > JOURNAL_RECORDS)
+		count = JOURNAL_RECORDS;
+
+	WriteStringToUSB("\r\nAVR event journal (oldest first):\r\n");
+	Journal_Report_Remaining = count;
+}
+
+
+/** Task to write out a journal report started by ProcessJournalCommand(), one
+ * record per call, whenever there's room for it in the Cmd_Tx_Buffer.
+ */
+void JournalReport_Task(void)
+{
+	Journal_Record_t record;
+	char *event;
+
+	if (!Journal_Report_Remaining || !eeprom_is_ready() ||
+			(BUFF_STATICSIZE - Cmd_Tx_Buffer.Elements) < JOURNAL_REPORT_LINE_LENGTH)
+		return;
+
+	// records that don't exist (yet) are skipped
+	if (!Journal_ReadRecent(--Journal_Report_Remaining, &record))
+		return;
+
+	switch (record.Event) {
+		case JOURNAL_EVENT_RESET:
+			event = "AVR reset, MCUSR";
+			break;
+		case JOURNAL_EVENT_BEAGLE_WATCHDOG:
+			event = "Beagle watchdog";
+			break;
+		case JOURNAL_EVENT_POWER_ON:
+			event = "power on, pin";
+			break;
+		case JOURNAL_EVENT_POWER_OFF:
+			event = "power off, pin";
+			break;
+		case JOURNAL_EVENT_DROPPED:
+			event = "records dropped";
+			break;
+		default:
+			event = "unknown event";
+			break;
+	}
+
+	WriteStringToUSB("#%u %s %u\r\n", record.Sequence, event, record.Argument);
+}
+
+
 /** Turn on or off power to the given pin.
  * Abstracted to prevent mistakes with active low connection.
  */
 void PowerOn(int pin, int on)
 {
+	Journal_Append(on ? JOURNAL_EVENT_POWER_ON : JOURNAL_EVENT_POWER_OFF, pin);
+
 	if (pin == ALL_POWER_PINS) {
 		if (on)
 			POWER_PORT = 0;
@@ -664,59 +1214,121 @@ void PowerOn(int pin, int on)
 }
 
 
-/** Set timer3 to go off after the given number of seconds and wake the
- * beagleboard up again.
+/** Schedule a power port pin to be turned on or off after the given number of
+ * seconds, replacing any schedule the pin already had. Returns false if the
+ * pin can't be scheduled.
+ */
+bool SchedulePower(int pin, int on, uint32_t delay_seconds)
+{
+	if (pin < 0 || pin >= ALL_POWER_PINS)
+		return false;
+
+	CancelPowerSchedule(pin);
+	if (on)
+		Power_Next_State |= (1 << pin);
+	else
+		Power_Next_State &= ~(1 << pin);
+	TimerWheel_Start(&Power_Timers[pin], TIMERWHEEL_SECONDS(delay_seconds));
+
+	return true;
+}
+
+
+/** Cancel any delayed power change or duty cycle for a power port pin. */
+void CancelPowerSchedule(int pin)
+{
+	if (pin < 0 || pin >= ALL_POWER_PINS)
+		return;
+
+	TimerWheel_Stop(&Power_Timers[pin]);
+	Power_On_Seconds[pin] = 0;
+	Power_Off_Seconds[pin] = 0;
+}
+
+
+/** Timer callback for a power port pin's schedule. This carries out the power
+ * change, and sets up the next one if the pin is being duty cycled.
+ */
+void PowerSchedule_Expired(TimerWheel_Timer_t *timer)
+{
+	int pin = timer->Argument;
+	int on = (Power_Next_State >> pin) & 1;
+
+	PowerOn(pin, on);
+	WriteStringToLCD("%s: pin[%d] (timer)", on ? "ON" : "OFF", pin);
+
+	if (Power_On_Seconds[pin] && Power_Off_Seconds[pin]) {
+		Power_Next_State ^= (1 << pin);
+		TimerWheel_Start(timer, TIMERWHEEL_SECONDS(on ? Power_On_Seconds[pin] : Power_Off_Seconds[pin]));
+	}
+}
+
+
+/** Power the beagleboard down after the given number of seconds, and wake it
+ * up again (by turning everything on) power_down_seconds after that. With no
+ * wait the beagleboard isn't powered down, just powered up after the delay.
  */
 void SetDelayedBeaglePowerDown(uint32_t wait_seconds, uint32_t power_down_seconds)
 {
     // don't want the watchdog disturbing our sleep
     StopBeagleWatchdog();
-	// set the countdown
-	Beagle_Delayed_Power_Down = wait_seconds;
 	Beagle_Delayed_Power_Up = power_down_seconds;
 
-	// start the timer
-	TCCR3B  = (1 << WGM32)  // Clear-timer-on-compare-match-OCR3A (CTC) mode
-			| (1 << CS32) | (1 << CS30);  // prescaler divides by 1024
-	TIMSK3 |= (1 << OCIE3A); // Enable timer interrupt
+	if (wait_seconds) {
+		TimerWheel_Stop(&Beagle_Power_Up_Timer);
+		TimerWheel_Start(&Beagle_Power_Down_Timer, TIMERWHEEL_SECONDS(wait_seconds));
+	}
+	else {
+		TimerWheel_Stop(&Beagle_Power_Down_Timer);
+		TimerWheel_Start(&Beagle_Power_Up_Timer, TIMERWHEEL_SECONDS(power_down_seconds));
+	}
 }
 
 
-/** Write a single line to the LCD screen. Don't put any newlines in the string
- * because it'll confuse me. (or change this code to support it)
+/** Task to copy changes in the LCD framebuffer onto the panel, run every tick
+ * by the LCD_Refresh_Timer. This sends at most one character per call and
+ * never waits for the panel, so it costs the main loop next to nothing.
  */
-void WriteStringToLCD(char *format, ...)
+void LCD_Task(TimerWheel_Timer_t *timer)
 {
-	// prevent lengthy timeout when LCD is off
+	// leave the pins alone when the LCD is powered down
 	if (!LCD_on)
 		return;
 
-	char string[MAX_LINE_LENGTH];
+	if (LCD_init_pending) {
+		LCD_init_pending = 0;
+		lcd_init(LCD_DISP_ON);
+	}
+
+	lcd_fb_refresh();
+}
+
+
+/** Write a single line to the LCD screen. Anything after a newline in the
+ * string is dropped. This only updates the framebuffer, so it is safe to call
+ * from an ISR, and while the LCD is off (it'll be shown when it's turned on).
+ */
+void WriteStringToLCD(char *format, ...)
+{
+	// anything longer than a line would be truncated anyway
+	char string[LCD_DISP_LENGTH + 1];
 	va_list ap;
 	va_start(ap, format);
-	vsnprintf(string, MAX_LINE_LENGTH, format, ap);
+	vsnprintf(string, sizeof(string), format, ap);
 	va_end(ap);
 
 	// handle scrolling of lines
-	switch (LCD_Lines) {
-		case 2:
-			lcd_clrscr();
-			lcd_puts(LCD_Buffer);
-		case 1:
-			lcd_putc('\n');
-			strncpy(LCD_Buffer, string, LCD_LINE_LENGTH);
-		case 0:
-			lcd_puts(string);
-			break;
-	}
-
-	if (LCD_Lines < 2)
+	if (LCD_Lines == LCD_LINES)
+		lcd_fb_scroll();
+	else
 		LCD_Lines++;
+
+	lcd_fb_puts_line(LCD_Lines - 1, string);
 }
 
 
-/** Write to the USB endpoint. This is actually done by pushing the string onto
- * the ring buffer, so we can't get race conditions
+/** Write to the command port's USB endpoint. This is actually done by pushing
+ * the string onto the ring buffer, so we can't get race conditions
  */
 void WriteStringToUSB(char *format, ...)
 {
@@ -730,59 +1342,55 @@ void WriteStringToUSB(char *format, ...)
 
 	len = strlen(string);
 	for (i = 0; i < len; ++i)
-		Buffer_StoreElement(&Tx_Buffer, string[i]);
+		Buffer_StoreElement(&Cmd_Tx_Buffer, string[i]);
 }
 
 
-/** ISR to handle when the beagle watchdog timer goes off. This means that we
+/** Timer callback for when the beagle watchdog goes off. This means that we
  * haven't heard from the beagle in too long, so we're going to reset it.
  */
-ISR(TIMER1_COMPA_vect, ISR_BLOCK)
+void BeagleWatchdog_Expired(TimerWheel_Timer_t *timer)
 {
-	if (++Beagle_Watchdog_Counter > WATCHDOG_TIMEOUT_S) {
-		ProcessLCDCommand("Beagle Watchdog went off");
+	ProcessLCDCommand("Beagle Watchdog went off");
 #ifndef WATCHDOG_DRY_RUN
-        PowerOn(ALL_POWER_PINS, 0);
-		ProcessBeaglePowerDownCommand(NULL);
+	PowerOn(ALL_POWER_PINS, 0);
+	ProcessBeaglePowerDownCommand(NULL);
+#else
+	TimerWheel_Start(timer, TIMERWHEEL_SECONDS(WATCHDOG_TIMEOUT_S));
 #endif
-		Beagle_Watchdog_Counter = 0;
+	Beagle_Watchdog_Firings++;
 
-		// TODO add this to the count in EEPROM
-	}
+	Journal_Append(JOURNAL_EVENT_BEAGLE_WATCHDOG, 0);
 }
 
 
-/** ISR to handle when the delayed beagle power up/down timer goes off. This basically
- * requires us to decrement the counter, and when it gets to zero to turn the
- * beagle on/off, and disable the timer
+/** Timer callback for a delayed beagle power down. This turns the beagle off,
+ * and starts the countdown to turning it back on.
  */
-ISR(TIMER3_COMPA_vect, ISR_BLOCK)
+void BeaglePowerDown_Expired(TimerWheel_Timer_t *timer)
 {
-    if (Beagle_Delayed_Power_Down > 0) {
-        Beagle_Delayed_Power_Down--;
-        if (Beagle_Delayed_Power_Down > 0)
-            return;
-        // turn off beagle board
-        PowerOn(POWER_PIN_BEAGLE, 0);
-        // safe to do this with interrupt on??
-		WriteStringToLCD("Beagleboard -> off");
-		WriteStringToUSB("\r\nBeagleboard turned off.\r\n");
-    }
-	if (--Beagle_Delayed_Power_Up <= 0) {
-		// disable the timer
-		TIMSK3 &= ~(1 << OCIE3A); // Disable timer interrupt
-		TCCR3B &= ~(1 << CS30) & ~(1 << CS31) & ~(1 << CS32); // disable clock
+	// turn off beagle board
+	PowerOn(POWER_PIN_BEAGLE, 0);
+	WriteStringToLCD("Beagleboard -> off");
+	WriteStringToUSB("\r\nBeagleboard turned off.\r\n");
 
-		// turn everything on
-		PowerOn(ALL_POWER_PINS, 1);
-		WriteStringToLCD("Beagleboard -> on");
-		WriteStringToUSB("\r\nBeagleboard turned on.\r\n");
-	}
+	TimerWheel_Start(&Beagle_Power_Up_Timer, TIMERWHEEL_SECONDS(Beagle_Delayed_Power_Up));
+}
+
+
+/** Timer callback for the end of a delayed beagle power down. */
+void BeaglePowerUp_Expired(TimerWheel_Timer_t *timer)
+{
+	// turn everything on
+	PowerOn(ALL_POWER_PINS, 1);
+	WriteStringToLCD("Beagleboard -> on");
+	WriteStringToUSB("\r\nBeagleboard turned on.\r\n");
 }
 
 
 /** ISR to handle the USART receive complete interrupt, fired each time the USART has received a character. This stores the received
- *  character into the Tx_Buffer circular buffer for later transmission to the host.
+ *  character into the Tx_Buffer circular buffer for later transmission to the host. The console is passed through untouched; AVR
+ *  commands come in on the command port instead.
  */
 ISR(USART1_RX_vect, ISR_BLOCK)
 {
@@ -791,23 +1399,58 @@ ISR(USART1_RX_vect, ISR_BLOCK)
 	/* Only store received characters if the USB interface is connected */
 	if ((USB_DeviceState == DEVICE_STATE_Configured) && LineEncoding.BaudRateBPS) {
 		Buffer_StoreElement(&Tx_Buffer, ReceivedByte);
+		Bridge_Bytes_To_Host++;
 	}
 
+	WAKE_EVENT(EVENT_SERIAL_RX);
+
+#ifdef WATCHDOG_RESET_ON_ALL_COMMS
+	// reset the watchdog
+	PulseBeagleWatchdog();
+#endif
+
+#ifdef CONSOLE_COMMANDS
 	// process any special commands to the AVR
 	ProcessByte(ReceivedByte);
+#endif
+}
+
+
+/** ISR to handle the USART data register empty interrupt, which is only
+ *  enabled while the main loop sleeps waiting to send a byte to the beagle.
+ */
+ISR(USART1_UDRE_vect, ISR_BLOCK)
+{
+	UCSR1B &= ~(1 << UDRIE1);
+	WAKE_EVENT(EVENT_SERIAL_READY);
+}
+
+
+/** Endpoint callback, run from LUFA's USB_COM ISR with the endpoint selected.
+ *  The endpoint interrupts are only armed while the main loop sleeps waiting
+ *  for an endpoint (see WorkPending()), so this just disarms them again and
+ *  wakes the main loop, which services the endpoint.
+ */
+void EndpointWakeup(void)
+{
+	Endpoint_DisarmCallback();
+	WAKE_EVENT(EVENT_USB);
 }
 
 
 /** Implementation for watchdog initialisation */
 void InitialiseAVRWatchdog(void)
 {
-	// if we had an internal watchdog reset, then clear the flag and add it to
-	// our count in non-volatile memory
-	if (MCUSR & (1 << WDRF)) {
-		MCUSR &= ~(1 << WDRF);
+	// record why we were reset in non-volatile memory, and clear the flags so
+	// we can tell next time
+	Journal_Init();
+	AVR_reset_flags = MCUSR;
+	Journal_Append(JOURNAL_EVENT_RESET, AVR_reset_flags);
+
+	// if we had an internal watchdog reset, then report it on the LCD
+	if (MCUSR & (1 << WDRF))
 		AVR_watchdog_reset = 1;
-		// TODO add this to the count in EEPROM
-	}
+	MCUSR = 0;
 
 	// Enable watchdog at maximum timeout (8 seconds)
 	// NOTE: if setting this to a small value, make sure that the code will get
@@ -41,10 +41,13 @@
 		#include <avr/wdt.h>
 		#include <avr/interrupt.h>
 		#include <avr/power.h>
+		#include <avr/sleep.h>
 
 		#include "Descriptors.h"
 
 		#include "Lib/RingBuff.h"
+		#include "Lib/Journal.h"
+		#include "Lib/TimerWheel.h"
 		#include "Lib/lcd.h"
 
 		#include <LUFA/Version.h>
@@ -112,6 +115,40 @@
 		 */
 		#define CONTROL_LINE_IN_OVERRUNERROR (1 << 6)
 
+		/** Vendor specific request to the telemetry interface to read a Telemetry_Report_t status report. */
+		#define REQ_GetTelemetryReport       0x01
+
+		/** Vendor specific request to the telemetry interface to turn power on or off. The low byte of wValue
+		 *  is the power port pin (or 8 for all pins), and the high byte is 1 to turn it on or 0 to turn it off.
+		 */
+		#define REQ_SetPower                 0x02
+
+		/** Vendor specific request to the telemetry interface to control the Beagleboard watchdog. wValue is
+		 *  one of the TELEMETRY_WATCHDOG_* values.
+		 */
+		#define REQ_SetWatchdog              0x03
+
+		/** wValue for the REQ_SetWatchdog request to disable the watchdog. */
+		#define TELEMETRY_WATCHDOG_DISABLE   0
+
+		/** wValue for the REQ_SetWatchdog request to enable the watchdog. */
+		#define TELEMETRY_WATCHDOG_ENABLE    1
+
+		/** wValue for the REQ_SetWatchdog request to pulse (reset the counter of) the watchdog. */
+		#define TELEMETRY_WATCHDOG_PULSE     2
+
+		/** Version of the Telemetry_Report_t layout, bumped whenever it changes. */
+		#define TELEMETRY_REPORT_VERSION     1
+
+		/** Mask for the Flags field of a Telemetry_Report_t, set when the Beagleboard watchdog is enabled. */
+		#define TELEMETRY_FLAG_WATCHDOG      (1 << 0)
+
+		/** Mask for the Flags field of a Telemetry_Report_t, set when the LCD is powered. */
+		#define TELEMETRY_FLAG_LCD           (1 << 1)
+
+		/** Mask for the Flags field of a Telemetry_Report_t, set when a delayed power down or up is pending. */
+		#define TELEMETRY_FLAG_DELAYED_POWER (1 << 2)
+
 	/* Type Defines: */
 		/** Type define for the virtual serial port line encoding settings, for storing the current USART configuration
 		 *  as set by the host via a class specific request.
@@ -141,6 +178,22 @@
 			uint16_t wIndex; /**< Notification wIndex, notification-specific */
 			uint16_t wLength; /**< Notification wLength, notification-specific */
 		} USB_Notification_Header_t;
+
+		/** Type define for the binary status report read from the telemetry interface with the
+		 *  REQ_GetTelemetryReport request. Multi-byte values are little endian.
+		 */
+		typedef struct
+		{
+			uint8_t  Version; /**< Report layout version, TELEMETRY_REPORT_VERSION */
+			uint8_t  PowerState; /**< Bit n is set when power port pin n is on */
+			uint8_t  Flags; /**< Mask of TELEMETRY_FLAG_* values */
+			uint8_t  ResetCause; /**< MCUSR reset cause flags from the last AVR reset */
+			uint16_t WatchdogCounter; /**< Seconds since the Beagleboard watchdog was last pulsed */
+			uint16_t WatchdogTimeout; /**< Seconds without a pulse before the watchdog fires */
+			uint16_t WatchdogFirings; /**< Number of times the watchdog has fired since the AVR reset */
+			uint32_t DelayedPowerDown; /**< Seconds until a delayed Beagleboard power down */
+			uint32_t DelayedPowerUp; /**< Seconds the Beagleboard will then stay powered down */
+		} Telemetry_Report_t;
 		
 	/* Enums: */
 		/** Enum for the possible line encoding formats of a virtual serial port. */
@@ -163,16 +216,34 @@
 		
 	/* Function Prototypes: */
 		void SetupHardware(void);
+		bool WorkPending(void);
+		void IdleSleep(void);
+		void EndpointWakeup(void);
+		void ProcessStatsCommand(char *);
 		void CDC_Task(void);
-		void InitialiseTimers(void);
+		void Command_Task(void);
+		void LCD_Task(TimerWheel_Timer_t *);
 		void StartBeagleWatchdog(void);
 		void StopBeagleWatchdog(void);
+		void PulseBeagleWatchdog(void);
+		uint32_t SecondsRemaining(TimerWheel_Timer_t *);
+		void BeagleWatchdog_Expired(TimerWheel_Timer_t *);
+		void BeaglePowerDown_Expired(TimerWheel_Timer_t *);
+		void BeaglePowerUp_Expired(TimerWheel_Timer_t *);
 		void ProcessByte(uint8_t);
+		void ProcessCommand(char *);
 		void ProcessBeaglePowerDownCommand(char *);
 		void ProcessPowerCommand(char *);
 		void ProcessLCDCommand(char *);
 		void ProcessWatchdogCommand(char *);
+		void ProcessCycleCommand(char *);
+		void ProcessJournalCommand(char *);
+		void JournalReport_Task(void);
 		void PowerOn(int, int);
+		int PowerPinForSwitch(int);
+		bool SchedulePower(int, int, uint32_t);
+		void CancelPowerSchedule(int);
+		void PowerSchedule_Expired(TimerWheel_Timer_t *);
 		void SetDelayedBeaglePowerDown(uint32_t, uint32_t);
 		void WriteStringToLCD(char *, ...);
 		void WriteStringToUSB(char *, ...);
@@ -182,6 +253,7 @@
 		void EVENT_USB_Device_Disconnect(void);
 		void EVENT_USB_Device_ConfigurationChanged(void);
 		void EVENT_USB_Device_UnhandledControlRequest(void);
+		void ProcessTelemetryRequest(void);
 		void ReconfigureUSART(void);
 
 #endif